@@ -30,7 +30,9 @@ public class CHShuffleSplitterJniWrapper {
       String codec,
       String dataFile,
       String localDirs,
-      int subDirsPerLocalDir) {
+      int subDirsPerLocalDir,
+      long spillThreshold,
+      boolean mergeInBackground) {
     return nativeMake(
         part.getShortName(),
         part.getNumPartitions(),
@@ -42,7 +44,9 @@ public class CHShuffleSplitterJniWrapper {
         codec,
         dataFile,
         localDirs,
-        subDirsPerLocalDir);
+        subDirsPerLocalDir,
+        spillThreshold,
+        mergeInBackground);
   }
 
   public native long nativeMake(
@@ -56,7 +60,9 @@ public class CHShuffleSplitterJniWrapper {
       String codec,
       String dataFile,
       String localDirs,
-      int subDirsPerLocalDir);
+      int subDirsPerLocalDir,
+      long spillThreshold,
+      boolean mergeInBackground);
 
   public native void split(long splitterId, int numRows, long block);
 
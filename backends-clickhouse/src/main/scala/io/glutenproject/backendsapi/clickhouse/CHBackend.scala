@@ -66,6 +66,20 @@ object CHBackendSettings extends BackendSettingsApi with Logging {
       ".customized.buffer.size"
   val GLUTEN_CLICKHOUSE_CUSTOMIZED_BUFFER_SIZE_DEFAULT = "4096"
 
+  // The shuffle writer keeps the serialized partitions in memory, and spills them all into one
+  // file once they exceed this size.
+  val GLUTEN_CLICKHOUSE_SHUFFLE_SPILL_THRESHOLD =
+    GlutenConfig.GLUTEN_CONFIG_PREFIX + GlutenConfig.GLUTEN_CLICKHOUSE_BACKEND +
+      ".shuffle.spill.threshold"
+  val GLUTEN_CLICKHOUSE_SHUFFLE_SPILL_THRESHOLD_DEFAULT = "64MB"
+
+  // Merge the spill files into the shuffle data file on a background thread, while the last
+  // partition buffers are serialized.
+  val GLUTEN_CLICKHOUSE_SHUFFLE_MERGE_IN_BACKGROUND =
+    GlutenConfig.GLUTEN_CONFIG_PREFIX + GlutenConfig.GLUTEN_CLICKHOUSE_BACKEND +
+      ".shuffle.merge.in.background"
+  val GLUTEN_CLICKHOUSE_SHUFFLE_MERGE_IN_BACKGROUND_DEFAULT = "false"
+
   val GLUTEN_CLICKHOUSE_BROADCAST_CACHE_EXPIRED_TIME: String =
     GlutenConfig.GLUTEN_CONFIG_PREFIX + GlutenConfig.GLUTEN_CLICKHOUSE_BACKEND +
       ".broadcast.cache.expired.time"
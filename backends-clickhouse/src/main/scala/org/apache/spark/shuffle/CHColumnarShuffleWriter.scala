@@ -17,6 +17,7 @@
 package org.apache.spark.shuffle
 
 import io.glutenproject.GlutenConfig
+import io.glutenproject.backendsapi.clickhouse.CHBackendSettings
 import io.glutenproject.vectorized._
 
 import org.apache.spark.SparkEnv
@@ -54,6 +55,12 @@ class CHColumnarShuffleWriter[K, V](
     GlutenConfig.getConf.columnarShuffleBatchCompressThreshold;
   private val preferSpill = GlutenConfig.getConf.columnarShufflePreferSpill
   private val writeSchema = GlutenConfig.getConf.columnarShuffleWriteSchema
+  private val spillThreshold = conf.getSizeAsBytes(
+    CHBackendSettings.GLUTEN_CLICKHOUSE_SHUFFLE_SPILL_THRESHOLD,
+    CHBackendSettings.GLUTEN_CLICKHOUSE_SHUFFLE_SPILL_THRESHOLD_DEFAULT)
+  private val mergeInBackground = conf.getBoolean(
+    CHBackendSettings.GLUTEN_CLICKHOUSE_SHUFFLE_MERGE_IN_BACKGROUND,
+    CHBackendSettings.GLUTEN_CLICKHOUSE_SHUFFLE_MERGE_IN_BACKGROUND_DEFAULT.toBoolean)
   private val jniWrapper = new CHShuffleSplitterJniWrapper
   // Are we in the process of stopping? Because map tasks can call stop() with success = true
   // and then call stop() with success = false if they get an exception, we want to make sure
@@ -99,7 +106,9 @@ class CHColumnarShuffleWriter[K, V](
         customizedCompressCodec,
         dataTmp.getAbsolutePath,
         localDirs,
-        subDirsPerLocalDir)
+        subDirsPerLocalDir,
+        spillThreshold,
+        mergeInBackground)
     }
     while (records.hasNext) {
       val cb = records.next()._2.asInstanceOf[ColumnarBatch]
@@ -36,6 +36,37 @@ class MetricsHandler extends MetricsApi with Logging{
     MetricsUtil.updateNativeMetrics(child, relMap, joinParamsMap, aggParamsMap)
   }
 
+  override def genWholeStageTransformerMetrics(
+      sparkContext: SparkContext): Map[String, SQLMetric] =
+    super.genWholeStageTransformerMetrics(sparkContext) ++ Map(
+      "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "number of output batches"),
+      "avgOutputBatchRows" -> SQLMetrics.createAverageMetric(
+        sparkContext, "avg rows per output batch"),
+      "avgOutputBatchBytes" -> SQLMetrics.createAverageMetric(
+        sparkContext, "avg bytes per output batch"),
+      "numCoalescedBatches" -> SQLMetrics.createMetric(
+        sparkContext, "number of coalesced native batches"),
+      "numSplitBatches" -> SQLMetrics.createMetric(sparkContext, "number of split native batches"))
+
+  override def genWholeStageTransformerMetricsUpdater(
+      metrics: Map[String, SQLMetric]): IMetrics => Unit = {
+    val numOutputBatches = metrics("numOutputBatches")
+    val avgOutputBatchRows = metrics("avgOutputBatchRows")
+    val avgOutputBatchBytes = metrics("avgOutputBatchBytes")
+    val numCoalescedBatches = metrics("numCoalescedBatches")
+    val numSplitBatches = metrics("numSplitBatches")
+    nativeMetrics => {
+      val singleMetric = nativeMetrics.asInstanceOf[Metrics].getSingleMetrics
+      numOutputBatches += singleMetric.outputBatches
+      if (singleMetric.outputBatches > 0) {
+        avgOutputBatchRows.set(singleMetric.outputBatchRows / singleMetric.outputBatches)
+        avgOutputBatchBytes.set(singleMetric.outputBatchBytes / singleMetric.outputBatches)
+      }
+      numCoalescedBatches += singleMetric.coalescedBatches
+      numSplitBatches += singleMetric.splitBatches
+    }
+  }
+
   override def genBatchScanTransformerMetrics(
       sparkContext: SparkContext): Map[String, SQLMetric] =
     Map(
@@ -58,7 +89,8 @@ class MetricsHandler extends MetricsApi with Logging{
       "skippedSplits" -> SQLMetrics.createMetric(sparkContext, "number of skipped splits"),
       "processedSplits" -> SQLMetrics.createMetric(sparkContext, "number of processed splits"),
       "skippedStrides" -> SQLMetrics.createMetric(sparkContext, "number of skipped row groups"),
-      "processedStrides" -> SQLMetrics.createMetric(sparkContext, "number of processed row groups"))
+      "processedStrides" -> SQLMetrics.createMetric(sparkContext, "number of processed row groups"),
+      "ioWaitTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "io wait time"))
 
   override def genBatchScanTransformerMetricsUpdater(
       metrics: Map[String, SQLMetric]): MetricsUpdater = new BatchScanMetricsUpdater(metrics)
@@ -90,7 +122,8 @@ class MetricsHandler extends MetricsApi with Logging{
       "skippedSplits" -> SQLMetrics.createMetric(sparkContext, "number of skipped splits"),
       "processedSplits" -> SQLMetrics.createMetric(sparkContext, "number of processed splits"),
       "skippedStrides" -> SQLMetrics.createMetric(sparkContext, "number of skipped row groups"),
-      "processedStrides" -> SQLMetrics.createMetric(sparkContext, "number of processed row groups")
+      "processedStrides" -> SQLMetrics.createMetric(sparkContext, "number of processed row groups"),
+      "ioWaitTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "io wait time")
     )
 
   override def genHiveTableScanTransformerMetricsUpdater(
@@ -123,7 +156,8 @@ class MetricsHandler extends MetricsApi with Logging{
       "skippedSplits" -> SQLMetrics.createMetric(sparkContext, "number of skipped splits"),
       "processedSplits" -> SQLMetrics.createMetric(sparkContext, "number of processed splits"),
       "skippedStrides" -> SQLMetrics.createMetric(sparkContext, "number of skipped row groups"),
-      "processedStrides" -> SQLMetrics.createMetric(sparkContext, "number of processed row groups")
+      "processedStrides" -> SQLMetrics.createMetric(sparkContext, "number of processed row groups"),
+      "ioWaitTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "io wait time")
     )
 
 
@@ -236,11 +270,15 @@ class MetricsHandler extends MetricsApi with Logging{
     Map(
       "dataSize" -> SQLMetrics.createSizeMetric(sparkContext, "data size"),
       "bytesSpilled" -> SQLMetrics.createSizeMetric(sparkContext, "shuffle bytes spilled"),
+      "numSpills" -> SQLMetrics.createMetric(sparkContext, "number of shuffle spills"),
+      "bufferPoolHits" -> SQLMetrics.createMetric(sparkContext, "number of reused shuffle buffers"),
+      "bufferPoolMisses" -> SQLMetrics.createMetric(sparkContext, "number of allocated shuffle buffers"),
       "splitTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "totaltime to split"),
       "spillTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "totaltime to spill"),
       "compressTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "totaltime to compress"),
       "prepareTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "totaltime to prepare"),
       "decompressTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "totaltime_decompress"),
+      "coalesceTime" -> SQLMetrics.createNanoTimingMetric(sparkContext, "totaltime to coalesce read batches"),
       "avgReadBatchNumRows" -> SQLMetrics
         .createAverageMetric(sparkContext, "avg read batch num rows"),
       "numInputRows" -> SQLMetrics.createMetric(sparkContext, "number of input rows"),
@@ -186,13 +186,21 @@ class SparkPlanExecHandler extends SparkPlanExecApi {
     val readBatchNumRows = metrics("avgReadBatchNumRows")
     val numOutputRows = metrics("numOutputRows")
     val decompressTime = metrics("decompressTime")
+    val coalesceTime = metrics("coalesceTime")
     if (GlutenConfig.getConf.isUseCelebornShuffleManager) {
       val clazz = ClassUtils.getClass("org.apache.spark.shuffle.CelebornColumnarBatchSerializer")
       val constructor = clazz.getConstructor(classOf[StructType],
         classOf[SQLMetric], classOf[SQLMetric])
       constructor.newInstance(schema, readBatchNumRows, numOutputRows).asInstanceOf[Serializer]
     } else {
-      new ColumnarBatchSerializer(schema, readBatchNumRows, numOutputRows, decompressTime)
+      new ColumnarBatchSerializer(
+        schema,
+        readBatchNumRows,
+        numOutputRows,
+        decompressTime,
+        coalesceTime,
+        GlutenConfig.getConf.columnarShuffleReaderCoalesceBatchSize,
+        GlutenConfig.getConf.columnarShuffleReaderCoalesceMaxBytes)
     }
   }
 
@@ -203,6 +211,7 @@ class SparkPlanExecHandler extends SparkPlanExecApi {
                                        child: SparkPlan,
                                        numOutputRows: SQLMetric,
                                        dataSize: SQLMetric): BuildSideRelation = {
+    val broadcastCodec = GlutenConfig.getConf.columnarBroadcastCodec
     val countsAndBytes = child
       .executeColumnar()
       .mapPartitions { iter =>
@@ -223,7 +232,8 @@ class SparkPlanExecHandler extends SparkPlanExecApi {
         } else {
           val handleArray = input.map(ColumnarBatches.getNativeHandle).toArray
           val serializeResult = ColumnarBatchSerializerJniWrapper.INSTANCE.serialize(handleArray,
-            NativeMemoryAllocators.getDefault.contextInstance().getNativeInstanceId)
+            NativeMemoryAllocators.getDefault.contextInstance().getNativeInstanceId,
+            broadcastCodec.orNull)
           input.foreach(ColumnarBatches.release)
           Iterator((serializeResult.getNumRows, serializeResult.getSerialized))
         }
@@ -19,10 +19,12 @@ package org.apache.spark.sql.execution
 
 import scala.collection.JavaConverters._
 
+import io.glutenproject.GlutenConfig
 import io.glutenproject.columnarbatch.ColumnarBatches
 import io.glutenproject.execution.ColumnarToRowExecBase
 import io.glutenproject.memory.alloc.NativeMemoryAllocators
-import io.glutenproject.vectorized.NativeColumnarToRowJniWrapper
+import io.glutenproject.vectorized.{NativeColumnarToRowChunkIterator, NativeColumnarToRowInfo,
+  NativeColumnarToRowJniWrapper}
 
 import org.apache.spark.{OneToOneDependency, Partition, SparkContext, TaskContext}
 import org.apache.spark.broadcast.Broadcast
@@ -79,7 +81,8 @@ case class VeloxColumnarToRowExec(child: SparkPlan)
     val convertTime = longMetric("convertTime")
 
     new ColumnarToRowRDD(sparkContext, child.executeColumnar(), this.output,
-      numOutputRows, numInputBatches, convertTime)
+      numOutputRows, numInputBatches, convertTime,
+      GlutenConfig.getConf.columnarToRowMemoryThreshold)
   }
 
   override def output: Seq[Attribute] = child.output
@@ -94,7 +97,7 @@ case class VeloxColumnarToRowExec(child: SparkPlan)
 
 class ColumnarToRowRDD(@transient sc: SparkContext, rdd: RDD[ColumnarBatch],
     output: Seq[Attribute], numOutputRows: SQLMetric, numInputBatches: SQLMetric,
-    convertTime: SQLMetric)
+    convertTime: SQLMetric, memoryThreshold: Long)
   extends RDD[InternalRow](sc, Seq(new OneToOneDependency(rdd))) {
 
   private val cleanedF = sc.clean(f)
@@ -157,7 +160,9 @@ class ColumnarToRowRDD(@transient sc: SparkContext, rdd: RDD[ColumnarBatch],
                 batchHandle,
                 NativeMemoryAllocators.getDefault().contextInstance().getNativeInstanceId)
             }
-            val info = jniWrapper.nativeColumnarToRowWrite(batchHandle, c2rId)
+            val chunks = new NativeColumnarToRowChunkIterator(
+              jniWrapper, batchHandle, c2rId, batch.numRows(), memoryThreshold)
+            var info: NativeColumnarToRowInfo = chunks.next()
 
             convertTime += (System.currentTimeMillis() - beforeConvert)
 
@@ -166,10 +171,16 @@ class ColumnarToRowRDD(@transient sc: SparkContext, rdd: RDD[ColumnarBatch],
               val row = new UnsafeRow(batch.numCols())
 
               override def hasNext: Boolean = {
-                rowId < batch.numRows()
+                rowId < info.lengths.length || chunks.hasNext
               }
 
               override def next: UnsafeRow = {
+                if (rowId >= info.lengths.length) {
+                  val beforeConvert = System.currentTimeMillis()
+                  info = chunks.next()
+                  convertTime += (System.currentTimeMillis() - beforeConvert)
+                  rowId = 0
+                }
                 val (offset, length) = (info.offsets(rowId), info.lengths(rowId))
                 row.pointTo(null, info.memoryAddress + offset, length)
                 rowId += 1
@@ -9,11 +9,14 @@
 #include <Functions/FunctionFactory.h>
 #include <IO/BrotliWriteBuffer.h>
 #include <IO/ReadBufferFromFile.h>
+#include <IO/WriteBufferFromString.h>
 #include <IO/WriteHelpers.h>
+#include <IO/copyData.h>
 #include <Parser/SerializedPlanParser.h>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <Poco/StringTokenizer.h>
 #include <Common/DebugUtils.h>
+#include <Common/ThreadPool.h>
 
 namespace local_engine
 {
@@ -31,19 +34,46 @@ void ShuffleSplitter::split(DB::Block & block)
 }
 SplitResult ShuffleSplitter::stop()
 {
-    // spill all buffers
     Stopwatch watch;
     watch.start();
-    for (size_t i = 0; i < options.partition_nums; i++)
+    if (options.merge_in_background)
     {
-        spillPartition(i);
-        partition_outputs[i]->flush();
-        partition_write_buffers[i].reset();
+        std::exception_ptr merge_exception;
+        ThreadFromGlobalPool merge_thread(
+            [this, &merge_exception]()
+            {
+                try
+                {
+                    mergeSpills();
+                }
+                catch (...)
+                {
+                    merge_exception = std::current_exception();
+                }
+            });
+        try
+        {
+            cacheAllPartitions();
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard lock(cached_partitions_mutex);
+                cache_failed = true;
+            }
+            cached_partitions_cv.notify_one();
+            merge_thread.join();
+            throw;
+        }
+        merge_thread.join();
+        if (merge_exception)
+            std::rethrow_exception(merge_exception);
+    }
+    else
+    {
+        cacheAllPartitions();
+        mergeSpills();
     }
-    partition_outputs.clear();
-    partition_cached_write_buffers.clear();
-    partition_write_buffers.clear();
-    mergePartitionFiles();
     split_result.total_write_time += watch.elapsedNanoseconds();
     stopped = true;
     return split_result;
@@ -92,16 +122,18 @@ void ShuffleSplitter::splitBlockByPartition(DB::Block & block)
         ColumnsBuffer & buffer = partition_buffer[i];
         if (buffer.size() >= options.split_size)
         {
-            spillPartition(i);
+            cachePartition(i);
         }
     }
+    if (total_cached_bytes >= options.spill_threshold)
+    {
+        spillCachedPartitions();
+    }
 }
 void ShuffleSplitter::init()
 {
     partition_buffer.reserve(options.partition_nums);
-    partition_outputs.reserve(options.partition_nums);
-    partition_write_buffers.reserve(options.partition_nums);
-    partition_cached_write_buffers.reserve(options.partition_nums);
+    partition_cached_data.resize(options.partition_nums);
     split_result.partition_length.reserve(options.partition_nums);
     split_result.raw_partition_length.reserve(options.partition_nums);
     for (size_t i = 0; i < options.partition_nums; ++i)
@@ -109,52 +141,107 @@ void ShuffleSplitter::init()
         partition_buffer.emplace_back(ColumnsBuffer());
         split_result.partition_length.emplace_back(0);
         split_result.raw_partition_length.emplace_back(0);
-        partition_outputs.emplace_back(nullptr);
-        partition_write_buffers.emplace_back(nullptr);
-        partition_cached_write_buffers.emplace_back(nullptr);
+    }
+    if (!options.compress_method.empty()
+        && std::find(compress_methods.begin(), compress_methods.end(), options.compress_method) != compress_methods.end())
+    {
+        compression_codec = DB::CompressionCodecFactory::instance().get(boost::to_upper_copy(options.compress_method), {});
     }
 }
 
-void ShuffleSplitter::spillPartition(size_t partition_id)
+void ShuffleSplitter::cachePartition(size_t partition_id)
 {
-    Stopwatch watch;
-    watch.start();
-    if (!partition_outputs[partition_id])
+    DB::Block result = partition_buffer[partition_id].releaseColumns();
+    if (result.rows() == 0)
+        return;
+    auto & cached_data = partition_cached_data[partition_id];
+    auto cached_size = cached_data.size();
     {
-        partition_write_buffers[partition_id] = getPartitionWriteBuffer(partition_id);
-        partition_outputs[partition_id]
-            = std::make_unique<DB::NativeWriter>(*partition_write_buffers[partition_id], 0, partition_buffer[partition_id].getHeader());
+        DB::WriteBufferFromString cache_buffer(cached_data, DB::AppendModeTag{});
+        if (compression_codec)
+        {
+            DB::CompressedWriteBuffer compressed_buffer(cache_buffer, compression_codec);
+            DB::NativeWriter(compressed_buffer, 0, partition_buffer[partition_id].getHeader()).write(result);
+            compressed_buffer.finalize();
+        }
+        else
+        {
+            DB::NativeWriter(cache_buffer, 0, partition_buffer[partition_id].getHeader()).write(result);
+        }
+        cache_buffer.finalize();
     }
-    DB::Block result = partition_buffer[partition_id].releaseColumns();
-    if (result.rows() > 0)
+    total_cached_bytes += cached_data.size() - cached_size;
+}
+
+void ShuffleSplitter::cacheAllPartitions()
+{
+    for (size_t i = 0; i < options.partition_nums; ++i)
+    {
+        cachePartition(i);
+        {
+            std::lock_guard lock(cached_partitions_mutex);
+            num_cached_partitions = i + 1;
+        }
+        cached_partitions_cv.notify_one();
+    }
+}
+
+void ShuffleSplitter::spillCachedPartitions()
+{
+    Stopwatch watch;
+    watch.start();
+    SpillInfo spill{.file = getSpillFile(spills.size()), .partition_length = std::vector<size_t>(options.partition_nums)};
+    DB::WriteBufferFromFile spill_write_buffer(spill.file, options.io_buffer_size);
+    for (size_t i = 0; i < options.partition_nums; ++i)
     {
-        partition_outputs[partition_id]->write(result);
+        auto & cached_data = partition_cached_data[i];
+        spill_write_buffer.write(cached_data.data(), cached_data.size());
+        spill.partition_length[i] = cached_data.size();
+        split_result.total_bytes_spilled += cached_data.size();
+        std::string().swap(cached_data);
     }
+    spill_write_buffer.close();
+    total_cached_bytes = 0;
+    spills.emplace_back(std::move(spill));
     split_result.total_spill_time += watch.elapsedNanoseconds();
-    split_result.total_bytes_spilled += result.bytes();
 }
 
-void ShuffleSplitter::mergePartitionFiles()
+void ShuffleSplitter::mergeSpills()
 {
     DB::WriteBufferFromFile data_write_buffer = DB::WriteBufferFromFile(options.data_file);
-    std::string buffer;
-    size_t buffer_size = options.io_buffer_size;
-    buffer.reserve(buffer_size);
+    // The partitions are in the same order in all spill files, each file is read once from start to end.
+    std::vector<std::unique_ptr<DB::ReadBufferFromFile>> spill_readers;
+    for (const auto & spill : spills)
+    {
+        spill_readers.emplace_back(std::make_unique<DB::ReadBufferFromFile>(spill.file, options.io_buffer_size));
+    }
     for (size_t i = 0; i < options.partition_nums; ++i)
     {
-        auto file = getPartitionTempFile(i);
-        DB::ReadBufferFromFile reader = DB::ReadBufferFromFile(file, options.io_buffer_size);
-        while (reader.next())
+        if (options.merge_in_background)
         {
-            auto bytes = reader.readBig(buffer.data(), buffer_size);
-            data_write_buffer.write(buffer.data(), bytes);
-            split_result.partition_length[i] += bytes;
-            split_result.total_bytes_written += bytes;
+            std::unique_lock lock(cached_partitions_mutex);
+            cached_partitions_cv.wait(lock, [&] { return num_cached_partitions > i || cache_failed; });
+            if (cache_failed)
+                return;
         }
-        reader.close();
-        std::filesystem::remove(file);
+        size_t bytes = 0;
+        for (size_t j = 0; j < spills.size(); ++j)
+        {
+            DB::copyData(*spill_readers[j], data_write_buffer, spills[j].partition_length[i]);
+            bytes += spills[j].partition_length[i];
+        }
+        auto & cached_data = partition_cached_data[i];
+        data_write_buffer.write(cached_data.data(), cached_data.size());
+        bytes += cached_data.size();
+        std::string().swap(cached_data);
+        split_result.partition_length[i] += bytes;
+        split_result.total_bytes_written += bytes;
     }
     data_write_buffer.close();
+    for (const auto & spill : spills)
+    {
+        std::filesystem::remove(spill.file);
+    }
 }
 
 ShuffleSplitter::ShuffleSplitter(SplitOptions && options_) : options(options_)
@@ -187,9 +274,9 @@ ShuffleSplitter::Ptr ShuffleSplitter::create(const std::string & short_name, Spl
     }
 }
 
-std::string ShuffleSplitter::getPartitionTempFile(size_t partition_id)
+std::string ShuffleSplitter::getSpillFile(size_t spill_id)
 {
-    auto file_name = std::to_string(options.shuffle_id) + "_" + std::to_string(options.map_id) + "_" + std::to_string(partition_id);
+    auto file_name = std::to_string(options.shuffle_id) + "_" + std::to_string(options.map_id) + "_spill_" + std::to_string(spill_id);
     std::hash<std::string> hasher;
     auto hash = hasher(file_name);
     auto dir_id = hash % options.local_dirs_list.size();
@@ -201,24 +288,6 @@ std::string ShuffleSplitter::getPartitionTempFile(size_t partition_id)
     return std::filesystem::path(dir) / file_name;
 }
 
-std::unique_ptr<DB::WriteBuffer> ShuffleSplitter::getPartitionWriteBuffer(size_t partition_id)
-{
-    auto file = getPartitionTempFile(partition_id);
-    if (partition_cached_write_buffers[partition_id] == nullptr)
-        partition_cached_write_buffers[partition_id]
-            = std::make_unique<DB::WriteBufferFromFile>(file, options.io_buffer_size, O_CREAT | O_WRONLY | O_APPEND);
-    if (!options.compress_method.empty()
-        && std::find(compress_methods.begin(), compress_methods.end(), options.compress_method) != compress_methods.end())
-    {
-        auto codec = DB::CompressionCodecFactory::instance().get(boost::to_upper_copy(options.compress_method), {});
-        return std::make_unique<DB::CompressedWriteBuffer>(*partition_cached_write_buffers[partition_id], codec);
-    }
-    else
-    {
-        return std::move(partition_cached_write_buffers[partition_id]);
-    }
-}
-
 const std::vector<std::string> ShuffleSplitter::compress_methods = {"", "ZSTD", "LZ4"};
 
 void ShuffleSplitter::writeIndexFile()
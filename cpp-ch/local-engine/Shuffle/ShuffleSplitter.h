@@ -1,5 +1,8 @@
 #pragma once
+#include <condition_variable>
+#include <mutex>
 #include <Columns/IColumn.h>
+#include <Compression/ICompressionCodec.h>
 #include <Core/Block.h>
 #include <Formats/NativeWriter.h>
 #include <Functions/IFunction.h>
@@ -26,6 +29,11 @@ struct SplitOptions
     // std::vector<std::string> exprs;
     std::string compress_method = "zstd";
     int compress_level;
+    // The serialized partition data is cached in memory, and spilled into one file once it exceeds this many bytes.
+    // 0 spills after every split block, so that little is held in memory.
+    size_t spill_threshold = 64 * 1024 * 1024;
+    // Merge the spill files into data_file on a background thread, while the last partition buffers are serialized.
+    bool merge_in_background = false;
 };
 
 class ColumnsBuffer
@@ -55,6 +63,13 @@ struct SplitResult
     std::vector<Int64> raw_partition_length;
 };
 
+struct SpillInfo
+{
+    std::string file;
+    // The partitions are written one after another, in partition order.
+    std::vector<size_t> partition_length;
+};
+
 class ShuffleSplitter
 {
 public:
@@ -76,18 +91,26 @@ public:
 private:
     void init();
     void splitBlockByPartition(DB::Block & block);
-    void spillPartition(size_t partition_id);
-    std::string getPartitionTempFile(size_t partition_id);
-    void mergePartitionFiles();
-    std::unique_ptr<DB::WriteBuffer> getPartitionWriteBuffer(size_t partition_id);
+    void cachePartition(size_t partition_id);
+    void cacheAllPartitions();
+    void spillCachedPartitions();
+    std::string getSpillFile(size_t spill_id);
+    void mergeSpills();
 
 protected:
     bool stopped = false;
     PartitionInfo partition_info;
     std::vector<ColumnsBuffer> partition_buffer;
-    std::vector<std::unique_ptr<DB::NativeWriter>> partition_outputs;
-    std::vector<std::unique_ptr<DB::WriteBuffer>> partition_write_buffers;
-    std::vector<std::unique_ptr<DB::WriteBuffer>> partition_cached_write_buffers;
+    DB::CompressionCodecPtr compression_codec;
+    // Serialized blocks of each partition, not spilled yet.
+    std::vector<std::string> partition_cached_data;
+    size_t total_cached_bytes = 0;
+    std::vector<SpillInfo> spills;
+    // The merge on a background thread waits for the partitions to be cached.
+    std::mutex cached_partitions_mutex;
+    std::condition_variable cached_partitions_cv;
+    size_t num_cached_partitions = 0;
+    bool cache_failed = false;
     std::vector<size_t> output_columns_indicies;
     DB::Block output_header;
     SplitOptions options;
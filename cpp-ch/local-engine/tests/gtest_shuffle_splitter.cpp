@@ -0,0 +1,128 @@
+#include <filesystem>
+#include <Columns/ColumnsNumber.h>
+#include <Compression/CompressedReadBuffer.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Formats/NativeReader.h>
+#include <IO/ReadBufferFromFile.h>
+#include <IO/ReadBufferFromString.h>
+#include <IO/ReadHelpers.h>
+#include <Shuffle/ShuffleSplitter.h>
+#include <gtest/gtest.h>
+
+using namespace DB;
+using namespace local_engine;
+
+namespace
+{
+constexpr size_t num_partitions = 3;
+constexpr Int64 num_rows_per_block = 100;
+constexpr Int64 num_blocks = 20;
+
+Block makeBlock(Int64 start)
+{
+    auto type = std::make_shared<DataTypeInt64>();
+    auto column = ColumnInt64::create();
+    for (Int64 i = start; i < start + num_rows_per_block; ++i)
+        column->insertValue(i);
+    return Block({ColumnWithTypeAndName(std::move(column), type, "id")});
+}
+
+SplitOptions makeOptions(const std::filesystem::path & dir, bool merge_in_background)
+{
+    return SplitOptions{
+        .split_size = 16,
+        .data_file = dir / "data",
+        .local_dirs_list = {dir / "local"},
+        .num_sub_dirs = 4,
+        .shuffle_id = 1,
+        .map_id = 2,
+        .partition_nums = num_partitions,
+        .compress_method = "LZ4",
+        // Spill whatever is cached after every block.
+        .spill_threshold = 1,
+        .merge_in_background = merge_in_background};
+}
+
+std::vector<Int64> readPartition(const std::string & data)
+{
+    ReadBufferFromString in(data);
+    CompressedReadBuffer compressed_in(in);
+    NativeReader reader(compressed_in, 0);
+    std::vector<Int64> values;
+    while (auto block = reader.read())
+    {
+        const auto & column = assert_cast<const ColumnInt64 &>(*block.getByPosition(0).column);
+        values.insert(values.end(), column.getData().begin(), column.getData().end());
+    }
+    return values;
+}
+
+void testSpillAndMerge(bool merge_in_background)
+{
+    auto dir = std::filesystem::temp_directory_path() / ("gtest_shuffle_splitter_" + std::to_string(merge_in_background));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto options = makeOptions(dir, merge_in_background);
+    auto splitter = ShuffleSplitter::create("rr", options);
+    for (Int64 i = 0; i < num_blocks; ++i)
+    {
+        auto block = makeBlock(i * num_rows_per_block);
+        splitter->split(block);
+    }
+    auto result = splitter->stop();
+    splitter->writeIndexFile();
+    ASSERT_GT(result.total_bytes_spilled, 0);
+
+    // The partitions are laid out in the data file one after another, as long as their reported lengths.
+    std::string data;
+    {
+        ReadBufferFromFile in(options.data_file);
+        readStringUntilEOF(data, in);
+    }
+    ASSERT_EQ(result.partition_length.size(), num_partitions);
+    Int64 total_length = 0;
+    for (auto length : result.partition_length)
+        total_length += length;
+    ASSERT_EQ(total_length, static_cast<Int64>(data.size()));
+    ASSERT_EQ(result.total_bytes_written, static_cast<Int64>(data.size()));
+
+    // Round robin continues across blocks, and each partition keeps the order of its rows over spills and the final cache.
+    size_t offset = 0;
+    for (size_t pid = 0; pid < num_partitions; ++pid)
+    {
+        auto length = static_cast<size_t>(result.partition_length[pid]);
+        auto values = readPartition(data.substr(offset, length));
+        offset += length;
+        std::vector<Int64> expected;
+        for (auto v = static_cast<Int64>(pid); v < num_blocks * num_rows_per_block; v += static_cast<Int64>(num_partitions))
+            expected.push_back(v);
+        ASSERT_EQ(values, expected) << "partition " << pid;
+    }
+
+    // The index file holds the partition lengths.
+    ReadBufferFromFile index(options.data_file + ".index");
+    for (size_t pid = 0; pid < num_partitions; ++pid)
+    {
+        Int64 length;
+        readIntText(length, index);
+        assertChar('\n', index);
+        ASSERT_EQ(length, result.partition_length[pid]);
+    }
+
+    // Spill files are removed once merged.
+    for (const auto & entry : std::filesystem::recursive_directory_iterator(dir / "local"))
+        ASSERT_FALSE(entry.is_regular_file()) << entry.path();
+    std::filesystem::remove_all(dir);
+}
+}
+
+TEST(ShuffleSplitter, SpillAndMerge)
+{
+    testSpillAndMerge(false);
+}
+
+TEST(ShuffleSplitter, SpillAndMergeInBackground)
+{
+    testSpillAndMerge(true);
+}
@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "memory/ArenaAllocator.h"
+#include "memory/MemoryAllocator.h"
+#include "utils/exception.h"
+
+#ifdef GLUTEN_BENCHMARK_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+
+// Fragmentation benchmark: a sequence of tasks allocates and frees short-lived buffers of shuffle/columnar-to-row
+// sizes, while a few buffers of each task live until the task ends. Reports the RSS left after the tasks on top of
+// the RSS before them. RSS is process wide, run one allocator per process (--benchmark_filter) to compare.
+
+namespace gluten {
+
+namespace {
+
+#ifdef GLUTEN_BENCHMARK_JEMALLOC
+class JemallocMemoryAllocator final : public MemoryAllocator {
+ public:
+  bool allocate(int64_t size, void** out) override {
+    *out = je_gluten_malloc(size);
+    bytes_ += size;
+    return *out != nullptr;
+  }
+
+  bool allocateZeroFilled(int64_t nmemb, int64_t size, void** out) override {
+    *out = je_gluten_calloc(nmemb, size);
+    bytes_ += nmemb * size;
+    return *out != nullptr;
+  }
+
+  bool allocateAligned(uint16_t alignment, int64_t size, void** out) override {
+    *out = je_gluten_aligned_alloc(alignment, size);
+    bytes_ += size;
+    return *out != nullptr;
+  }
+
+  bool reallocate(void* p, int64_t size, int64_t newSize, void** out) override {
+    *out = je_gluten_realloc(p, newSize);
+    bytes_ += newSize - size;
+    return *out != nullptr;
+  }
+
+  bool reallocateAligned(void* p, uint16_t alignment, int64_t size, int64_t newSize, void** out) override {
+    return reallocate(p, size, newSize, out);
+  }
+
+  bool free(void* p, int64_t size) override {
+    je_gluten_free(p);
+    bytes_ -= size;
+    return true;
+  }
+
+  bool reserveBytes(int64_t size) override {
+    bytes_ += size;
+    return true;
+  }
+
+  bool unreserveBytes(int64_t size) override {
+    bytes_ -= size;
+    return true;
+  }
+
+  int64_t getBytes() const override {
+    return bytes_;
+  }
+
+ private:
+  std::atomic_int64_t bytes_{0};
+};
+#endif
+
+int64_t residentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  int64_t size = 0;
+  int64_t resident = 0;
+  statm >> size >> resident;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+constexpr int32_t kNumTasks = 32;
+constexpr int32_t kAllocationsPerTask = 20000;
+constexpr int32_t kMaxLive = 512;
+
+void runTask(MemoryAllocator* allocator, std::mt19937& gen) {
+  // Mostly small buffers, sometimes large ones, as for partition buffers.
+  std::uniform_int_distribution<int32_t> sizeClass(6, 20);
+  std::vector<std::pair<void*, int64_t>> live;
+  for (auto i = 0; i < kAllocationsPerTask; ++i) {
+    if (live.size() >= kMaxLive || (!live.empty() && gen() % 3 == 0)) {
+      auto idx = gen() % live.size();
+      GLUTEN_CHECK(allocator->free(live[idx].first, live[idx].second), "Free failed");
+      live[idx] = live.back();
+      live.pop_back();
+      continue;
+    }
+    int64_t size = (1L << sizeClass(gen)) + gen() % 1024;
+    void* p;
+    GLUTEN_CHECK(allocator->allocate(size, &p), "Allocation failed");
+    // Touch the pages as the real buffers are written.
+    memset(p, 1, size);
+    live.emplace_back(p, size);
+  }
+  for (auto& [p, size] : live) {
+    allocator->free(p, size);
+  }
+}
+
+template <typename MakeAllocator>
+void tasks(benchmark::State& state, MakeAllocator makeAllocator) {
+  std::mt19937 gen(42);
+  auto rssBefore = residentBytes();
+  for (auto _ : state) {
+    for (auto task = 0; task < kNumTasks; ++task) {
+      // Arenas are per task, the other allocators are process wide.
+      auto allocator = makeAllocator();
+      runTask(allocator.get(), gen);
+    }
+  }
+  state.counters["rss_retained_mb"] = static_cast<double>(residentBytes() - rssBefore) / (1 << 20);
+  state.SetItemsProcessed(state.iterations() * kNumTasks * kAllocationsPerTask);
+}
+
+void glibcMalloc(benchmark::State& state) {
+  auto allocator = std::make_shared<StdMemoryAllocator>();
+  tasks(state, [&]() { return allocator; });
+}
+
+void arena(benchmark::State& state) {
+  tasks(state, []() { return std::make_shared<ArenaMemoryAllocator>(); });
+}
+
+#ifdef GLUTEN_BENCHMARK_JEMALLOC
+void jemalloc(benchmark::State& state) {
+  auto allocator = std::make_shared<JemallocMemoryAllocator>();
+  tasks(state, [&]() { return allocator; });
+}
+#endif
+
+} // namespace
+
+BENCHMARK(glibcMalloc)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(arena)->Iterations(1)->Unit(benchmark::kMillisecond);
+#ifdef GLUTEN_BENCHMARK_JEMALLOC
+BENCHMARK(jemalloc)->Iterations(1)->Unit(benchmark::kMillisecond);
+#endif
+
+} // namespace gluten
+
+BENCHMARK_MAIN();
@@ -64,6 +64,7 @@ namespace gluten {
 const int32_t kQatGzip = 0;
 const int32_t kQplGzip = 1;
 const int32_t kLZ4 = 2;
+const int32_t kZstd = 3;
 
 class MyMemoryPool final : public arrow::MemoryPool {
  public:
@@ -166,9 +167,15 @@ class BenchmarkCompression {
     ipcWriteOptions.use_threads = false;
     auto splitBufferSize = (uint32_t)state.range(1);
     auto compressionType = state.range(0);
+    auto compressionLevel = static_cast<int32_t>(state.range(3));
     switch (compressionType) {
       case gluten::kLZ4: {
-        GLUTEN_ASSIGN_OR_THROW(ipcWriteOptions.codec, createArrowIpcCodec(arrow::Compression::LZ4_FRAME));
+        GLUTEN_ASSIGN_OR_THROW(
+            ipcWriteOptions.codec, createArrowIpcCodec(arrow::Compression::LZ4_FRAME, compressionLevel));
+        break;
+      }
+      case gluten::kZstd: {
+        GLUTEN_ASSIGN_OR_THROW(ipcWriteOptions.codec, createArrowIpcCodec(arrow::Compression::ZSTD, compressionLevel));
         break;
       }
 #ifdef GLUTEN_ENABLE_QAT
@@ -186,7 +193,11 @@ class BenchmarkCompression {
       }
 #endif
       default:
-        throw GlutenException("Codec not supported. Only support LZ4 or QATGzip");
+        throw GlutenException("Codec not supported. Only support LZ4, ZSTD or QATGzip");
+    }
+    // In percent, buffers saving less are written uncompressed as the shuffle writer does.
+    if (state.range(4) >= 0) {
+      ipcWriteOptions.min_space_savings = state.range(4) / 100.0;
     }
     std::shared_ptr<arrow::MemoryPool> pool = std::make_shared<MyMemoryPool>();
     ipcWriteOptions.memory_pool = pool.get();
@@ -391,6 +402,8 @@ int main(int argc, char** argv) {
   uint32_t cpuOffset = 0;
   std::string datafile;
   auto codec = gluten::kLZ4;
+  int32_t compressionLevel = arrow::util::kUseDefaultCompressionLevel;
+  int32_t minSpaceSavings = -1;
   uint32_t splitBufferSize = 8192;
 
   for (int i = 0; i < argc; i++) {
@@ -406,6 +419,13 @@ int main(int argc, char** argv) {
     } else if (strcmp(argv[i], "--qpl-gzip") == 0) {
       std::cout << "QPL gzip is used as codec" << std::endl;
       codec = gluten::kQplGzip;
+    } else if (strcmp(argv[i], "--zstd") == 0) {
+      std::cout << "ZSTD is used as codec" << std::endl;
+      codec = gluten::kZstd;
+    } else if (strcmp(argv[i], "--level") == 0) {
+      compressionLevel = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--min-space-savings") == 0) {
+      minSpaceSavings = atol(argv[i + 1]);
     } else if (strcmp(argv[i], "--busy") == 0) {
       GLUTEN_THROW_NOT_OK(arrow::internal::SetEnvVar("QZ_POLLING_MODE", "BUSY"));
     } else if (strcmp(argv[i], "--buffer-size") == 0) {
@@ -427,6 +447,8 @@ int main(int argc, char** argv) {
           codec,
           splitBufferSize,
           cpuOffset,
+          compressionLevel,
+          minSpaceSavings,
       })
       ->Threads(threads)
       ->ReportAggregatesOnly(false)
@@ -438,6 +460,9 @@ int main(int argc, char** argv) {
       ->Args({
           codec,
           splitBufferSize,
+          cpuOffset,
+          compressionLevel,
+          minSpaceSavings,
       })
       ->Threads(threads)
       ->ReportAggregatesOnly(false)
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "jni/ConcurrentMap.h"
+
+namespace gluten {
+
+namespace {
+
+// The registry as it was before sharding, one lock for all the handles.
+template <typename Holder>
+class GlobalLockMap {
+ public:
+  jlong insert(Holder holder) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    jlong result = moduleId_++;
+    map_.emplace(result, holder);
+    return result;
+  }
+
+  void erase(jlong moduleId) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    map_.erase(moduleId);
+  }
+
+  Holder lookup(jlong moduleId) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = map_.find(moduleId);
+    return it == map_.end() ? nullptr : it->second;
+  }
+
+ private:
+  int64_t moduleId_ = 4;
+  std::mutex mtx_;
+  std::unordered_map<jlong, Holder> map_;
+};
+
+// Handles of other tasks live in the map while each thread looks up its own, as every JNI call does.
+constexpr int32_t kNumResidentHandles = 1024;
+constexpr int32_t kHandlesPerThread = 4;
+
+template <typename Map>
+Map& sharedMap() {
+  static Map map;
+  static std::once_flag populated;
+  std::call_once(populated, []() {
+    for (auto i = 0; i < kNumResidentHandles; ++i) {
+      map.insert(std::make_shared<int64_t>(i));
+    }
+  });
+  return map;
+}
+
+template <typename Map>
+void lookup(benchmark::State& state) {
+  auto& map = sharedMap<Map>();
+  std::vector<jlong> handles;
+  for (auto i = 0; i < kHandlesPerThread; ++i) {
+    handles.push_back(map.insert(std::make_shared<int64_t>(i)));
+  }
+  int64_t sum = 0;
+  for (auto _ : state) {
+    for (auto handle : handles) {
+      sum += *map.lookup(handle);
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  for (auto handle : handles) {
+    map.erase(handle);
+  }
+  state.SetItemsProcessed(state.iterations() * kHandlesPerThread);
+}
+
+// A batch handle is inserted, looked up and erased for every batch crossing JNI.
+template <typename Map>
+void insertLookupErase(benchmark::State& state) {
+  auto& map = sharedMap<Map>();
+  int64_t sum = 0;
+  for (auto _ : state) {
+    auto handle = map.insert(std::make_shared<int64_t>(1));
+    sum += *map.lookup(handle);
+    map.erase(handle);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+using Holder = std::shared_ptr<int64_t>;
+
+} // namespace
+
+BENCHMARK_TEMPLATE(lookup, GlobalLockMap<Holder>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(lookup, ConcurrentMap<Holder>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(insertLookupErase, GlobalLockMap<Holder>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(insertLookupErase, ConcurrentMap<Holder>)->ThreadRange(1, 64)->UseRealTime();
+
+} // namespace gluten
+
+BENCHMARK_MAIN();
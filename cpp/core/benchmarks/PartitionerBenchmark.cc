@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "shuffle/HashPartitioner.h"
+#include "shuffle/RoundRobinPartitioner.h"
+#include "utils/exception.h"
+
+namespace gluten {
+
+namespace {
+
+constexpr int64_t kNumRows = 4096;
+
+std::vector<int32_t> makeHashValues() {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int32_t> dist(std::numeric_limits<int32_t>::min());
+  std::vector<int32_t> values(kNumRows);
+  for (auto& v : values) {
+    v = dist(gen);
+  }
+  return values;
+}
+
+// Partition id computation plus the row offset scatter done by the shuffle writer for each input batch.
+template <typename PartitionIdType, typename PartitionerType>
+void partitionRows(benchmark::State& state) {
+  auto numPartitions = static_cast<int32_t>(state.range(0));
+  auto partitioner = ShuffleWriter::Partitioner::create<PartitionerType>(numPartitions, true);
+  auto hashValues = makeHashValues();
+
+  std::vector<PartitionIdType> row2Partition;
+  std::vector<uint32_t> partition2RowCount(numPartitions);
+  std::vector<uint32_t> partition2RowOffset(numPartitions + 1);
+  std::vector<uint32_t> rowOffset2RowId(kNumRows);
+
+  for (auto _ : state) {
+    GLUTEN_THROW_NOT_OK(partitioner->compute(hashValues.data(), kNumRows, row2Partition, partition2RowCount));
+
+    partition2RowOffset[0] = 0;
+    for (auto pid = 1; pid <= numPartitions; ++pid) {
+      partition2RowOffset[pid] = partition2RowOffset[pid - 1] + partition2RowCount[pid - 1];
+    }
+    for (uint32_t row = 0; row < kNumRows; ++row) {
+      rowOffset2RowId[partition2RowOffset[row2Partition[row]]++] = row;
+    }
+    benchmark::DoNotOptimize(rowOffset2RowId.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumRows);
+  state.SetBytesProcessed(state.iterations() * kNumRows * sizeof(PartitionIdType));
+}
+
+// Partition id and histogram computation alone, per HashPartitioner kernel.
+template <HashPartitioner::Kernel kernel>
+void hashPartitionKernel(benchmark::State& state) {
+  if (kernel > HashPartitioner::detectKernel(true)) {
+    state.SkipWithError("Kernel not supported by this CPU");
+    return;
+  }
+  auto numPartitions = static_cast<int32_t>(state.range(0));
+  auto partitioner = ShuffleWriter::Partitioner::create<HashPartitioner>(numPartitions, true, kernel);
+  auto hashValues = makeHashValues();
+
+  std::vector<uint16_t> row2Partition;
+  std::vector<uint32_t> partition2RowCount(numPartitions);
+  for (auto _ : state) {
+    GLUTEN_THROW_NOT_OK(partitioner->compute(hashValues.data(), kNumRows, row2Partition, partition2RowCount));
+    benchmark::DoNotOptimize(row2Partition.data());
+    benchmark::DoNotOptimize(partition2RowCount.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumRows);
+}
+
+void hashPartitionArgs(benchmark::internal::Benchmark* bm) {
+  for (auto numPartitions : {1, 8, 64, 200, 1000, 2000, 5000, 10000}) {
+    bm->Arg(numPartitions);
+  }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(hashPartitionKernel, HashPartitioner::Kernel::kScalar)->Apply(hashPartitionArgs);
+BENCHMARK_TEMPLATE(hashPartitionKernel, HashPartitioner::Kernel::kAvx2)->Apply(hashPartitionArgs);
+BENCHMARK_TEMPLATE(hashPartitionKernel, HashPartitioner::Kernel::kAvx512)->Apply(hashPartitionArgs);
+
+// 16-bit ids are used up to 64k partitions, 32-bit ids above that. The 32-bit variants over the small range are the
+// baseline the 16-bit path is expected not to regress against.
+BENCHMARK_TEMPLATE(partitionRows, uint16_t, HashPartitioner)->RangeMultiplier(8)->Range(8, 64 * 1024);
+BENCHMARK_TEMPLATE(partitionRows, uint32_t, HashPartitioner)->RangeMultiplier(8)->Range(8, 64 * 1024)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(partitionRows, uint16_t, RoundRobinPartitioner)->RangeMultiplier(8)->Range(8, 64 * 1024);
+BENCHMARK_TEMPLATE(partitionRows, uint32_t, RoundRobinPartitioner)
+    ->RangeMultiplier(8)
+    ->Range(8, 64 * 1024)
+    ->Arg(1 << 20);
+
+} // namespace gluten
+
+BENCHMARK_MAIN();
@@ -117,7 +117,8 @@ class Backend : public std::enable_shared_from_this<Backend> {
 
   virtual std::shared_ptr<ColumnarBatchSerializer> getColumnarBatchSerializer(
       MemoryAllocator* allocator,
-      struct ArrowSchema* cSchema) {
+      struct ArrowSchema* cSchema,
+      arrow::Compression::type compressionType = arrow::Compression::UNCOMPRESSED) {
     throw GlutenException("Not implement getColumnarBatchSerializer");
   }
 
@@ -18,6 +18,8 @@
 #pragma once
 
 #include <jni.h>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -27,6 +29,8 @@ namespace gluten {
 
 /**
  * An utility class that map module id to module pointers.
+ * The ids are spread over shards with one lock each, so that concurrent tasks looking up their own modules don't
+ * contend on a single lock. Ids are never reused, a lookup of an erased id returns nullptr.
  * @tparam Holder class of the object to hold.
  */
 template <typename Holder>
@@ -35,34 +39,43 @@ class ConcurrentMap {
   ConcurrentMap() : moduleId_(kInitModuleId) {}
 
   jlong insert(Holder holder) {
-    std::lock_guard<std::mutex> lock(mtx_);
     jlong result = moduleId_++;
-    map_.insert(std::pair<jlong, Holder>(result, holder));
+    auto& shard = shardOf(result);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    shard.map.insert(std::pair<jlong, Holder>(result, holder));
     return result;
   }
 
   void erase(jlong moduleId) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    map_.erase(moduleId);
+    auto& shard = shardOf(moduleId);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    shard.map.erase(moduleId);
   }
 
   Holder lookup(jlong moduleId) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    auto it = map_.find(moduleId);
-    if (it != map_.end()) {
+    auto& shard = shardOf(moduleId);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto it = shard.map.find(moduleId);
+    if (it != shard.map.end()) {
       return it->second;
     }
     return nullptr;
   }
 
   void clear() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    map_.clear();
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      shard.map.clear();
+    }
   }
 
   size_t size() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    return map_.size();
+    size_t size = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      size += shard.map.size();
+    }
+    return size;
   }
 
  private:
@@ -70,11 +83,22 @@ class ConcurrentMap {
   // to allow for easier debugging of uninitialized java variables.
   static constexpr int kInitModuleId = 4;
 
-  int64_t moduleId_;
-  std::mutex mtx_;
+  static constexpr size_t kNumShards = 64;
+
+  // Padded to a cache line so that locking one shard doesn't invalidate its neighbours.
+  struct alignas(64) Shard {
+    std::mutex mtx;
+    // map from module ids returned to Java and module pointers
+    std::unordered_map<jlong, Holder> map;
+  };
+
+  Shard& shardOf(jlong moduleId) {
+    // Consecutive ids go to different shards.
+    return shards_[static_cast<uint64_t>(moduleId) % kNumShards];
+  }
 
-  // map from module ids returned to Java and module pointers
-  std::unordered_map<jlong, Holder> map_;
+  std::atomic<int64_t> moduleId_;
+  std::array<Shard, kNumShards> shards_;
 };
 
 } // namespace gluten
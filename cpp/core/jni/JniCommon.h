@@ -21,6 +21,8 @@
 #include <arrow/ipc/writer.h>
 #include <arrow/util/parallel.h>
 #include <jni.h>
+#include <numeric>
+#include <vector>
 
 #include "compute/ProtobufUtils.h"
 #include "memory/ArrowMemoryPool.h"
@@ -152,7 +154,7 @@ class SparkAllocationListener final : public gluten::AllocationListener {
       : vm_(vm),
         javaReserveMethod_(javaReserveMethod),
         javaUnreserveMethod_(javaUnreserveMethod),
-        blockSize_(blockSize) {
+        reservation_(blockSize) {
     JNIEnv* env;
     attachCurrentThreadAsDaemonOrThrow(vm_, &env);
     javaListener_ = env->NewGlobalRef(javaListener);
@@ -172,37 +174,34 @@ class SparkAllocationListener final : public gluten::AllocationListener {
     updateReservation(size);
   };
 
- private:
-  int64_t reserve(int64_t diff) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    bytesReserved_ += diff;
-    int64_t newBlockCount;
-    if (bytesReserved_ == 0) {
-      newBlockCount = 0;
-    } else {
-      // ceil to get the required block number
-      newBlockCount = (bytesReserved_ - 1) / blockSize_ + 1;
-    }
-    int64_t bytesGranted = (newBlockCount - blocksReserved_) * blockSize_;
-    blocksReserved_ = newBlockCount;
-    if (bytesReserved_ > maxBytesReserved_) {
-      maxBytesReserved_ = bytesReserved_;
-    }
-    return bytesGranted;
+  // Number of reserve / unreserve calls made to Spark.
+  int64_t reserveCalls() const {
+    return reserveCalls_;
   }
 
+  int64_t unreserveCalls() const {
+    return unreserveCalls_;
+  }
+
+  int64_t maxBytesReserved() const {
+    return reservation_.maxBytesReserved();
+  }
+
+ private:
   void updateReservation(int64_t diff) {
-    JNIEnv* env;
-    attachCurrentThreadAsDaemonOrThrow(vm_, &env);
-    int64_t granted = reserve(diff);
+    int64_t granted = reservation_.reserve(diff);
     if (granted == 0) {
       return;
     }
+    JNIEnv* env;
+    attachCurrentThreadAsDaemonOrThrow(vm_, &env);
     if (granted < 0) {
+      unreserveCalls_++;
       env->CallObjectMethod(javaListener_, javaUnreserveMethod_, -granted);
       checkException(env);
       return;
     }
+    reserveCalls_++;
     env->CallObjectMethod(javaListener_, javaReserveMethod_, granted);
     checkException(env);
   }
@@ -211,11 +210,9 @@ class SparkAllocationListener final : public gluten::AllocationListener {
   jobject javaListener_;
   jmethodID javaReserveMethod_;
   jmethodID javaUnreserveMethod_;
-  int64_t blockSize_;
-  int64_t blocksReserved_ = 0L;
-  int64_t bytesReserved_ = 0L;
-  int64_t maxBytesReserved_ = 0L;
-  std::mutex mutex_;
+  gluten::BlockReservation reservation_;
+  std::atomic_int64_t reserveCalls_{0};
+  std::atomic_int64_t unreserveCalls_{0};
 };
 
 class RssClient {
@@ -245,14 +242,24 @@ class CelebornClient : public RssClient {
     env->DeleteGlobalRef(javaCelebornShuffleWriter_);
   }
 
-  void pushPartitonData(int32_t partitionId, char* bytes, int64_t size) {
+  // Pushes the data of several partitions laid out back to back in bytes. The native memory is handed to Java as a
+  // direct ByteBuffer, without a copy into a Java byte array.
+  void pushPartitionsData(const std::vector<int32_t>& partitionIds, const std::vector<int32_t>& lengths, char* bytes) {
     JNIEnv* env;
     if (vm_->GetEnv(reinterpret_cast<void**>(&env), jniVersion) != JNI_OK) {
       throw gluten::GlutenException("JNIEnv was not attached to current thread");
     }
-    jbyteArray array = env->NewByteArray(size);
-    env->SetByteArrayRegion(array, 0, size, reinterpret_cast<jbyte*>(bytes));
-    env->CallIntMethod(javaCelebornShuffleWriter_, javaCelebornPushPartitionData_, partitionId, array);
+    int64_t size = std::accumulate(lengths.begin(), lengths.end(), 0L);
+    jobject buffer = env->NewDirectByteBuffer(bytes, size);
+    jintArray partitionIdArray = env->NewIntArray(partitionIds.size());
+    env->SetIntArrayRegion(partitionIdArray, 0, partitionIds.size(), partitionIds.data());
+    jintArray lengthArray = env->NewIntArray(lengths.size());
+    env->SetIntArrayRegion(lengthArray, 0, lengths.size(), lengths.data());
+    env->CallIntMethod(
+        javaCelebornShuffleWriter_, javaCelebornPushPartitionData_, partitionIdArray, lengthArray, buffer);
+    env->DeleteLocalRef(lengthArray);
+    env->DeleteLocalRef(partitionIdArray);
+    env->DeleteLocalRef(buffer);
     checkException(env);
   }
 
@@ -25,10 +25,12 @@
 #include "jni/ConcurrentMap.h"
 #include "jni/JniCommon.h"
 #include "jni/JniErrors.h"
+#include "memory/ArenaAllocator.h"
 
 #include "operators/writer/Datasource.h"
 
 #include <arrow/c/bridge.h>
+#include <arrow/io/memory.h>
 #include "operators/serializer/ColumnarBatchSerializer.h"
 #include "shuffle/LocalPartitionWriter.h"
 #include "shuffle/PartitionWriterCreator.h"
@@ -54,6 +56,9 @@ static jclass jniByteInputStreamClass;
 static jmethodID jniByteInputStreamRead;
 static jmethodID jniByteInputStreamTell;
 static jmethodID jniByteInputStreamClose;
+static jmethodID jniByteInputStreamDirectAddress;
+static jmethodID jniByteInputStreamDirectSize;
+static jmethodID jniByteInputStreamReleaseDirect;
 
 static jclass splitResultClass;
 static jmethodID splitResultConstructor;
@@ -77,6 +82,7 @@ static jmethodID veloxColumnarbatchScannerNext;
 
 static jclass shuffleReaderMetricsClass;
 static jmethodID shuffleReaderMetricsSetDecompressTime;
+static jmethodID shuffleReaderMetricsSetCoalesceTime;
 
 static ConcurrentMap<std::shared_ptr<ColumnarToRowConverter>> columnarToRowConverterHolder;
 
@@ -175,6 +181,52 @@ class JavaInputStreamAdaptor final : public arrow::io::InputStream {
   bool closed_ = false;
 };
 
+// Off-heap bytes of a JniByteInputStream, wrapped without copy. Slices of it (the IPC message bodies and, if not
+// compressed, the column buffers) keep it alive, the bytes are released back to Java when the last slice is gone.
+class JavaDirectBuffer final : public arrow::Buffer {
+ public:
+  JavaDirectBuffer(JNIEnv* env, jobject jniIn, int64_t address, int64_t size)
+      : arrow::Buffer(reinterpret_cast<const uint8_t*>(address), size) {
+    if (env->GetJavaVM(&vm_) != JNI_OK) {
+      std::string errorMessage = "Unable to get JavaVM instance";
+      throw gluten::GlutenException(errorMessage);
+    }
+    jniIn_ = env->NewGlobalRef(jniIn);
+  }
+
+  ~JavaDirectBuffer() override {
+    try {
+      JNIEnv* env;
+      attachCurrentThreadAsDaemonOrThrow(vm_, &env);
+      env->CallVoidMethod(jniIn_, jniByteInputStreamReleaseDirect);
+      checkException(env);
+      env->DeleteGlobalRef(jniIn_);
+    } catch (std::exception& e) {
+#ifdef GLUTEN_PRINT_DEBUG
+      std::cout << __func__ << " call JniByteInputStream#releaseDirect() got exception:" << e.what() << std::endl;
+#endif
+    }
+  }
+
+ private:
+  JavaVM* vm_;
+  jobject jniIn_;
+};
+
+std::shared_ptr<arrow::io::InputStream> makeShuffleInputStream(JNIEnv* env, jobject jniIn) {
+  auto size = env->CallLongMethod(jniIn, jniByteInputStreamDirectSize);
+  checkException(env);
+  if (size <= 0) {
+    return std::make_shared<JavaInputStreamAdaptor>(env, jniIn);
+  }
+  auto address = env->CallLongMethod(jniIn, jniByteInputStreamDirectAddress);
+  checkException(env);
+  if (address == 0) {
+    return std::make_shared<JavaInputStreamAdaptor>(env, jniIn);
+  }
+  return std::make_shared<arrow::io::BufferReader>(std::make_shared<JavaDirectBuffer>(env, jniIn, address, size));
+}
+
 class JniColumnarBatchIterator : public ColumnarBatchIterator {
  public:
   explicit JniColumnarBatchIterator(
@@ -257,6 +309,24 @@ jclass createGlobalClassReferenceOrError(JNIEnv* env, const char* className) {
   return globalClass;
 }
 
+jobject makeNativeColumnarToRowInfo(JNIEnv* env, ColumnarToRowConverter* columnarToRowConverter) {
+  const auto& offsets = columnarToRowConverter->getOffsets();
+  const auto& lengths = columnarToRowConverter->getLengths();
+
+  auto numRows = columnarToRowConverter->getNumRows();
+
+  auto offsetsArr = env->NewIntArray(numRows);
+  auto offsetsSrc = reinterpret_cast<const jint*>(offsets.data());
+  env->SetIntArrayRegion(offsetsArr, 0, numRows, offsetsSrc);
+  auto lengthsArr = env->NewIntArray(numRows);
+  auto lengthsSrc = reinterpret_cast<const jint*>(lengths.data());
+  env->SetIntArrayRegion(lengthsArr, 0, numRows, lengthsSrc);
+  long address = reinterpret_cast<long>(columnarToRowConverter->getBufferAddress());
+
+  return env->NewObject(
+      nativeColumnarToRowInfoClass, nativeColumnarToRowInfoConstructor, offsetsArr, lengthsArr, address);
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -277,9 +347,12 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
   jniByteInputStreamRead = getMethodIdOrError(env, jniByteInputStreamClass, "read", "(JJ)J");
   jniByteInputStreamTell = getMethodIdOrError(env, jniByteInputStreamClass, "tell", "()J");
   jniByteInputStreamClose = getMethodIdOrError(env, jniByteInputStreamClass, "close", "()V");
+  jniByteInputStreamDirectAddress = getMethodIdOrError(env, jniByteInputStreamClass, "directAddress", "()J");
+  jniByteInputStreamDirectSize = getMethodIdOrError(env, jniByteInputStreamClass, "directSize", "()J");
+  jniByteInputStreamReleaseDirect = getMethodIdOrError(env, jniByteInputStreamClass, "releaseDirect", "()V");
 
   splitResultClass = createGlobalClassReferenceOrError(env, "Lio/glutenproject/vectorized/SplitResult;");
-  splitResultConstructor = getMethodIdOrError(env, splitResultClass, "<init>", "(JJJJJJ[J[J)V");
+  splitResultConstructor = getMethodIdOrError(env, splitResultClass, "<init>", "(JJJJJJJJJ[J[J)V");
 
   columnarBatchSerializeResultClass =
       createGlobalClassReferenceOrError(env, "Lio/glutenproject/vectorized/ColumnarBatchSerializeResult;");
@@ -288,8 +361,8 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
 
   metricsBuilderClass = createGlobalClassReferenceOrError(env, "Lio/glutenproject/metrics/Metrics;");
 
-  metricsBuilderConstructor =
-      getMethodIdOrError(env, metricsBuilderClass, "<init>", "([J[J[J[J[J[J[J[J[J[JJ[J[J[J[J[J[J[J[J[J[J[J[J[J[J[J)V");
+  metricsBuilderConstructor = getMethodIdOrError(
+      env, metricsBuilderClass, "<init>", "([J[J[J[J[J[J[J[J[J[JJ[J[J[J[J[J[J[J[J[J[J[J[J[J[J[J[JJJJJJ)V");
 
   serializedColumnarBatchIteratorClass =
       createGlobalClassReferenceOrError(env, "Lio/glutenproject/vectorized/ColumnarBatchInIterator;");
@@ -322,6 +395,8 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
       createGlobalClassReferenceOrError(env, "Lio/glutenproject/vectorized/ShuffleReaderMetrics;");
   shuffleReaderMetricsSetDecompressTime =
       getMethodIdOrError(env, shuffleReaderMetricsClass, "setDecompressTime", "(J)V");
+  shuffleReaderMetricsSetCoalesceTime =
+      getMethodIdOrError(env, shuffleReaderMetricsClass, "setCoalesceTime", "(J)V");
 
   return jniVersion;
 }
@@ -469,6 +544,7 @@ JNIEXPORT jobject JNICALL Java_io_glutenproject_vectorized_ColumnarBatchOutItera
   auto processedSplits = env->NewLongArray(numMetrics);
   auto skippedStrides = env->NewLongArray(numMetrics);
   auto processedStrides = env->NewLongArray(numMetrics);
+  auto ioWaitTime = env->NewLongArray(numMetrics);
 
   if (metrics) {
     env->SetLongArrayRegion(inputRows, 0, numMetrics, metrics->inputRows);
@@ -496,6 +572,7 @@ JNIEXPORT jobject JNICALL Java_io_glutenproject_vectorized_ColumnarBatchOutItera
     env->SetLongArrayRegion(processedSplits, 0, numMetrics, metrics->processedSplits);
     env->SetLongArrayRegion(skippedStrides, 0, numMetrics, metrics->skippedStrides);
     env->SetLongArrayRegion(processedStrides, 0, numMetrics, metrics->processedStrides);
+    env->SetLongArrayRegion(ioWaitTime, 0, numMetrics, metrics->ioWaitTime);
   }
 
   return env->NewObject(
@@ -526,7 +603,13 @@ JNIEXPORT jobject JNICALL Java_io_glutenproject_vectorized_ColumnarBatchOutItera
       skippedSplits,
       processedSplits,
       skippedStrides,
-      processedStrides);
+      processedStrides,
+      ioWaitTime,
+      metrics ? metrics->outputBatches : 0,
+      metrics ? metrics->outputBatchRows : 0,
+      metrics ? metrics->outputBatchBytes : 0,
+      metrics ? metrics->coalescedBatches : 0,
+      metrics ? metrics->splitBatches : 0);
   JNI_METHOD_END(nullptr)
 }
 
@@ -587,23 +670,23 @@ Java_io_glutenproject_vectorized_NativeColumnarToRowJniWrapper_nativeColumnarToR
   auto columnarToRowConverter = columnarToRowConverterHolder.lookup(instanceId);
   std::shared_ptr<ColumnarBatch> cb = columnarBatchHolder.lookup(batchHandle);
   GLUTEN_THROW_NOT_OK(columnarToRowConverter->write(cb));
+  return makeNativeColumnarToRowInfo(env, columnarToRowConverter.get());
+  JNI_METHOD_END(nullptr)
+}
 
-  const auto& offsets = columnarToRowConverter->getOffsets();
-  const auto& lengths = columnarToRowConverter->getLengths();
-
-  auto numRows = cb->numRows();
-
-  auto offsetsArr = env->NewIntArray(numRows);
-  auto offsetsSrc = reinterpret_cast<const jint*>(offsets.data());
-  env->SetIntArrayRegion(offsetsArr, 0, numRows, offsetsSrc);
-  auto lengthsArr = env->NewIntArray(numRows);
-  auto lengthsSrc = reinterpret_cast<const jint*>(lengths.data());
-  env->SetIntArrayRegion(lengthsArr, 0, numRows, lengthsSrc);
-  long address = reinterpret_cast<long>(columnarToRowConverter->getBufferAddress());
-
-  jobject nativeColumnarToRowInfo =
-      env->NewObject(nativeColumnarToRowInfoClass, nativeColumnarToRowInfoConstructor, offsetsArr, lengthsArr, address);
-  return nativeColumnarToRowInfo;
+JNIEXPORT jobject JNICALL
+Java_io_glutenproject_vectorized_NativeColumnarToRowJniWrapper_nativeColumnarToRowConvert( // NOLINT
+    JNIEnv* env,
+    jobject,
+    jlong batchHandle,
+    jlong instanceId,
+    jint startRow,
+    jlong memoryThreshold) {
+  JNI_METHOD_START
+  auto columnarToRowConverter = columnarToRowConverterHolder.lookup(instanceId);
+  std::shared_ptr<ColumnarBatch> cb = columnarBatchHolder.lookup(batchHandle);
+  GLUTEN_THROW_NOT_OK(columnarToRowConverter->writeChunk(cb, startRow, memoryThreshold));
+  return makeNativeColumnarToRowInfo(env, columnarToRowConverter.get());
   JNI_METHOD_END(nullptr)
 }
 
@@ -779,7 +862,12 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
     jlong taskAttemptId,
     jint pushBufferMaxSize,
     jobject partitionPusher,
-    jstring partitionWriterTypeJstr) {
+    jstring partitionWriterTypeJstr,
+    jboolean sortBased,
+    jlong sortBufferMaxSize,
+    jboolean asyncSpill,
+    jlong asyncSpillMaxInflightBytes,
+    jstring evictionPolicyJstr) {
   JNI_METHOD_START
   if (partitioningNameJstr == nullptr) {
     throw gluten::GlutenException(std::string("Short partitioning name can't be null"));
@@ -823,6 +911,13 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
 
   shuffleWriterOptions.task_attempt_id = (int64_t)taskAttemptId;
   shuffleWriterOptions.batch_compress_threshold = batchCompressThreshold;
+  shuffleWriterOptions.sort_based = sortBased;
+  if (evictionPolicyJstr != nullptr) {
+    shuffleWriterOptions.eviction_policy = jStringToCString(env, evictionPolicyJstr);
+  }
+  if (sortBufferMaxSize > 0) {
+    shuffleWriterOptions.sort_buffer_max_size = sortBufferMaxSize;
+  }
 
   auto partitionWriterTypeC = env->GetStringUTFChars(partitionWriterTypeJstr, JNI_FALSE);
   auto partitionWriterType = std::string(partitionWriterTypeC);
@@ -841,6 +936,10 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
 
     shuffleWriterOptions.write_schema = writeSchema;
     shuffleWriterOptions.prefer_evict = preferEvict;
+    shuffleWriterOptions.async_spill = asyncSpill;
+    if (asyncSpillMaxInflightBytes > 0) {
+      shuffleWriterOptions.async_spill_max_inflight_bytes = asyncSpillMaxInflightBytes;
+    }
 
     if (numSubDirs > 0) {
       shuffleWriterOptions.num_sub_dirs = numSubDirs;
@@ -859,7 +958,7 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper
     jclass celebornPartitionPusherClass =
         createGlobalClassReferenceOrError(env, "Lorg/apache/spark/shuffle/CelebornPartitionPusher;");
     jmethodID celebornPushPartitionDataMethod =
-        getMethodIdOrError(env, celebornPartitionPusherClass, "pushPartitionData", "(I[B)I");
+        getMethodIdOrError(env, celebornPartitionPusherClass, "pushPartitionsData", "([I[ILjava/nio/ByteBuffer;)I");
     if (pushBufferMaxSize > 0) {
       shuffleWriterOptions.push_buffer_max_size = pushBufferMaxSize;
     }
@@ -952,6 +1051,9 @@ Java_io_glutenproject_vectorized_ShuffleWriterJniWrapper_stop(JNIEnv* env, jobje
       shuffleWriter->totalCompressTime(),
       shuffleWriter->totalBytesWritten(),
       shuffleWriter->totalBytesEvicted(),
+      shuffleWriter->numSpills(),
+      shuffleWriter->pool()->numHits(),
+      shuffleWriter->pool()->numMisses(),
       partitionLengthArr,
       rawPartitionLengthArr);
 
@@ -984,17 +1086,21 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_vectorized_ShuffleReaderJniWrapper
     jobject,
     jobject jniIn,
     jlong cSchema,
-    jlong allocId) {
+    jlong allocId,
+    jint coalesceBatchSize,
+    jlong coalesceBatchMaxBytes) {
   JNI_METHOD_START
   auto* allocator = reinterpret_cast<std::shared_ptr<MemoryAllocator>*>(allocId);
   if (allocator == nullptr) {
     throw gluten::GlutenException("Allocator does not exist or has been closed");
   }
   auto pool = asArrowMemoryPool((*allocator).get());
-  std::shared_ptr<arrow::io::InputStream> in = std::make_shared<JavaInputStreamAdaptor>(env, jniIn);
+  auto in = makeShuffleInputStream(env, jniIn);
   ReaderOptions options = ReaderOptions::defaults();
   options.ipc_read_options.memory_pool = pool.get();
   options.ipc_read_options.use_threads = false;
+  options.coalesce_batch_size = coalesceBatchSize;
+  options.coalesce_batch_max_bytes = coalesceBatchMaxBytes;
   std::shared_ptr<arrow::Schema> schema =
       gluten::arrowGetOrThrow(arrow::ImportSchema(reinterpret_cast<struct ArrowSchema*>(cSchema)));
 
@@ -1025,6 +1131,7 @@ JNIEXPORT void JNICALL Java_io_glutenproject_vectorized_ShuffleReaderJniWrapper_
   JNI_METHOD_START
   auto reader = shuffleReaderHolder.lookup(handle);
   env->CallVoidMethod(metrics, shuffleReaderMetricsSetDecompressTime, reader->getDecompressTime());
+  env->CallVoidMethod(metrics, shuffleReaderMetricsSetCoalesceTime, reader->getCoalesceTime());
   checkException(env);
   JNI_METHOD_END()
 }
@@ -1118,6 +1225,10 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_memory_alloc_NativeMemoryAllocator
   std::shared_ptr<MemoryAllocator>* allocator = new std::shared_ptr<MemoryAllocator>;
   if (typeName == "DEFAULT") {
     *allocator = defaultMemoryAllocator();
+  } else if (typeName == "ARENA") {
+    // Only used outside of tasks, each task gets its own arena from createListenableAllocator.
+    static std::shared_ptr<MemoryAllocator> arenaAllocator = std::make_shared<ArenaMemoryAllocator>();
+    *allocator = arenaAllocator;
   } else {
     throw GlutenException("Unexpected allocator type name: " + typeName);
   }
@@ -1142,7 +1253,13 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_memory_alloc_NativeMemoryAllocator
   std::shared_ptr<AllocationListener> listener = std::make_shared<SparkAllocationListener>(
       vm, jlistener, reserveMemoryMethod, unreserveMemoryMethod, 8L << 10 << 10);
   std::shared_ptr<MemoryAllocator>* allocator = new std::shared_ptr<MemoryAllocator>;
-  *allocator = std::make_shared<ListenableMemoryAllocator>((*delegatedAllocator).get(), listener);
+  if (auto arena = std::dynamic_pointer_cast<ArenaMemoryAllocator>(*delegatedAllocator)) {
+    // A fresh arena per task, released as a whole with the task's allocator.
+    *allocator = std::make_shared<ListenableMemoryAllocator>(
+        std::make_shared<ArenaMemoryAllocator>(arena->chunkSize()), listener);
+  } else {
+    *allocator = std::make_shared<ListenableMemoryAllocator>((*delegatedAllocator).get(), listener);
+  }
   return reinterpret_cast<jlong>(allocator);
   JNI_METHOD_END(-1L)
 }
@@ -1169,6 +1286,27 @@ JNIEXPORT jlong JNICALL Java_io_glutenproject_memory_alloc_NativeMemoryAllocator
   JNI_METHOD_END(-1L)
 }
 
+JNIEXPORT jlong JNICALL Java_io_glutenproject_memory_alloc_NativeMemoryAllocator_reservationCalls( // NOLINT
+    JNIEnv* env,
+    jclass,
+    jlong allocatorId) {
+  JNI_METHOD_START
+  auto* alloc = reinterpret_cast<std::shared_ptr<MemoryAllocator>*>(allocatorId);
+  if (alloc == nullptr) {
+    throw gluten::GlutenException("Memory allocator instance not found. It may not exist nor has been closed");
+  }
+  auto listenable = std::dynamic_pointer_cast<ListenableMemoryAllocator>(*alloc);
+  if (listenable == nullptr) {
+    return 0L;
+  }
+  auto listener = std::dynamic_pointer_cast<SparkAllocationListener>(listenable->listener());
+  if (listener == nullptr) {
+    return 0L;
+  }
+  return listener->reserveCalls() + listener->unreserveCalls();
+  JNI_METHOD_END(-1L)
+}
+
 JNIEXPORT void JNICALL Java_io_glutenproject_tpc_MallocUtils_mallocTrim(JNIEnv* env, jobject obj) { // NOLINT
   //  malloc_stats_print(statsPrint, nullptr, nullptr);
   std::cout << "Calling malloc_trim... " << std::endl;
@@ -1185,7 +1323,8 @@ JNIEXPORT jobject JNICALL Java_io_glutenproject_vectorized_ColumnarBatchSerializ
     JNIEnv* env,
     jobject,
     jlongArray handles,
-    jlong allocId) {
+    jlong allocId,
+    jstring codecJstr) {
   JNI_METHOD_START
   int32_t numBatches = env->GetArrayLength(handles);
   jlong* batchhandles = env->GetLongArrayElements(handles, JNI_FALSE);
@@ -1202,7 +1341,11 @@ JNIEXPORT jobject JNICALL Java_io_glutenproject_vectorized_ColumnarBatchSerializ
   env->ReleaseLongArrayElements(handles, batchhandles, JNI_ABORT);
 
   auto backend = createBackend();
-  auto serializer = backend->getColumnarBatchSerializer((*allocator).get(), nullptr);
+  auto compressionType = arrow::Compression::UNCOMPRESSED;
+  if (codecJstr != nullptr) {
+    compressionType = gluten::arrowGetOrThrow(getCompressionType(env, codecJstr));
+  }
+  auto serializer = backend->getColumnarBatchSerializer((*allocator).get(), nullptr, compressionType);
   auto buffer = serializer->serializeColumnarBatches(batches);
   auto bufferArr = env->NewByteArray(buffer->size());
   env->SetByteArrayRegion(bufferArr, 0, buffer->size(), reinterpret_cast<const jbyte*>(buffer->data()));
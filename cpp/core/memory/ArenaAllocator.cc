@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ArenaAllocator.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstring>
+
+#include "utils/exception.h"
+
+namespace gluten {
+
+namespace {
+
+constexpr int64_t kDefaultAlignment = 64;
+// Number of empty chunks kept for reuse instead of being unmapped.
+constexpr size_t kMaxFreeChunks = 1;
+
+int64_t alignUp(int64_t value, int64_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Maps size bytes at an address aligned to alignment, by trimming a larger mapping.
+void* mapAligned(int64_t size, int64_t alignment) {
+  auto mapped = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  auto start = reinterpret_cast<uintptr_t>(mapped);
+  auto aligned = static_cast<uintptr_t>(alignUp(start, alignment));
+  if (aligned > start) {
+    munmap(mapped, aligned - start);
+  }
+  auto tail = start + size + alignment - (aligned + size);
+  if (tail > 0) {
+    munmap(reinterpret_cast<void*>(aligned + size), tail);
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+  return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace
+
+ArenaMemoryAllocator::ArenaMemoryAllocator(int64_t chunkSize) : chunkSize_(chunkSize) {
+  GLUTEN_CHECK(
+      chunkSize_ >= kHugePageSize && (chunkSize_ & (chunkSize_ - 1)) == 0,
+      "Arena chunk size must be a power of two and at least " + std::to_string(kHugePageSize));
+}
+
+ArenaMemoryAllocator::~ArenaMemoryAllocator() {
+  for (auto& [base, chunk] : chunks_) {
+    munmap(chunk.base, chunkSize_);
+  }
+  for (auto& [p, mappedSize] : large_) {
+    munmap(p, mappedSize);
+  }
+}
+
+bool ArenaMemoryAllocator::allocate(int64_t size, void** out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocateLocked(kDefaultAlignment, size, out);
+}
+
+bool ArenaMemoryAllocator::allocateZeroFilled(int64_t nmemb, int64_t size, void** out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!allocateLocked(kDefaultAlignment, nmemb * size, out)) {
+    return false;
+  }
+  // Reused chunks are not zeroed.
+  memset(*out, 0, nmemb * size);
+  return true;
+}
+
+bool ArenaMemoryAllocator::allocateAligned(uint16_t alignment, int64_t size, void** out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocateLocked(std::max<int64_t>(alignment, kDefaultAlignment), size, out);
+}
+
+bool ArenaMemoryAllocator::reallocate(void* p, int64_t size, int64_t newSize, void** out) {
+  return reallocateAligned(p, kDefaultAlignment, size, newSize, out);
+}
+
+bool ArenaMemoryAllocator::reallocateAligned(void* p, uint16_t alignment, int64_t size, int64_t newSize, void** out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (p == nullptr) {
+    return allocateLocked(std::max<int64_t>(alignment, kDefaultAlignment), newSize, out);
+  }
+  // The last allocation of the current chunk is resized in place.
+  auto data = static_cast<char*>(p);
+  if (!isLarge(size) && !isLarge(newSize) && current_ != nullptr && data >= current_->base &&
+      data + size == current_->base + current_->offset && data - current_->base + newSize < chunkSize_) {
+    current_->offset += newSize - size;
+    usedBytes_ += newSize - size;
+    *out = p;
+    return true;
+  }
+  void* reallocated;
+  if (!allocateLocked(std::max<int64_t>(alignment, kDefaultAlignment), newSize, &reallocated)) {
+    return false;
+  }
+  memcpy(reallocated, p, std::min(size, newSize));
+  freeLocked(p, size);
+  *out = reallocated;
+  return true;
+}
+
+bool ArenaMemoryAllocator::free(void* p, int64_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return freeLocked(p, size);
+}
+
+bool ArenaMemoryAllocator::reserveBytes(int64_t size) {
+  reservedBytes_ += size;
+  return true;
+}
+
+bool ArenaMemoryAllocator::unreserveBytes(int64_t size) {
+  reservedBytes_ -= size;
+  return true;
+}
+
+int64_t ArenaMemoryAllocator::getBytes() const {
+  return mappedBytes_ + reservedBytes_;
+}
+
+int64_t ArenaMemoryAllocator::getUsedBytes() const {
+  return usedBytes_;
+}
+
+bool ArenaMemoryAllocator::allocateLocked(int64_t alignment, int64_t size, void** out) {
+  if (size < 0) {
+    return false;
+  }
+  if (isLarge(size)) {
+    auto mappedSize = alignUp(size, kHugePageSize);
+    auto p = mapAligned(mappedSize, kHugePageSize);
+    if (p == nullptr) {
+      return false;
+    }
+    large_.emplace(p, mappedSize);
+    mappedBytes_ += mappedSize;
+    usedBytes_ += size;
+    *out = p;
+    return true;
+  }
+
+  auto offset = current_ == nullptr ? 0 : alignUp(current_->offset, alignment);
+  // Keep even empty allocations inside the chunk, so that their chunk can be found from their address.
+  if (current_ == nullptr || offset + std::max<int64_t>(size, 1) > chunkSize_) {
+    auto previous = current_;
+    current_ = takeChunk();
+    if (current_ == nullptr) {
+      current_ = previous;
+      return false;
+    }
+    if (previous != nullptr && previous->numAllocations == 0) {
+      releaseChunk(previous);
+    }
+    offset = 0;
+  }
+  *out = current_->base + offset;
+  current_->offset = offset + size;
+  current_->numAllocations++;
+  usedBytes_ += size;
+  return true;
+}
+
+bool ArenaMemoryAllocator::freeLocked(void* p, int64_t size) {
+  if (p == nullptr) {
+    return true;
+  }
+  auto it = chunks_.find(reinterpret_cast<uintptr_t>(p) & ~(chunkSize_ - 1));
+  if (it == chunks_.end()) {
+    auto large = large_.find(p);
+    if (large == large_.end()) {
+      return false;
+    }
+    munmap(p, large->second);
+    mappedBytes_ -= large->second;
+    usedBytes_ -= size;
+    large_.erase(large);
+    return true;
+  }
+
+  auto& chunk = it->second;
+  usedBytes_ -= size;
+  if (--chunk.numAllocations == 0) {
+    if (&chunk == current_) {
+      chunk.offset = 0;
+    } else {
+      releaseChunk(&chunk);
+    }
+  }
+  return true;
+}
+
+ArenaMemoryAllocator::Chunk* ArenaMemoryAllocator::takeChunk() {
+  if (!freeChunks_.empty()) {
+    auto chunk = freeChunks_.back();
+    freeChunks_.pop_back();
+    return chunk;
+  }
+  auto base = mapAligned(chunkSize_, chunkSize_);
+  if (base == nullptr) {
+    return nullptr;
+  }
+  mappedBytes_ += chunkSize_;
+  auto& chunk = chunks_[reinterpret_cast<uintptr_t>(base)];
+  chunk.base = static_cast<char*>(base);
+  return &chunk;
+}
+
+void ArenaMemoryAllocator::releaseChunk(Chunk* chunk) {
+  chunk->offset = 0;
+  if (freeChunks_.size() < kMaxFreeChunks) {
+    freeChunks_.push_back(chunk);
+    return;
+  }
+  munmap(chunk->base, chunkSize_);
+  mappedBytes_ -= chunkSize_;
+  chunks_.erase(reinterpret_cast<uintptr_t>(chunk->base));
+}
+
+} // namespace gluten
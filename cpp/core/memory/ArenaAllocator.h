@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "MemoryAllocator.h"
+
+namespace gluten {
+
+// Bump allocator serving the allocations of one task out of large chunks mapped from the OS. Chunks are aligned to
+// their size, a multiple of the 2MB huge page size, and advised to be backed by transparent huge pages. A chunk is
+// reused once all allocations carved from it are freed, and all chunks are unmapped when the allocator is destroyed at
+// the end of the task. Allocations larger than a quarter of a chunk are mapped separately.
+class ArenaMemoryAllocator final : public MemoryAllocator {
+ public:
+  static constexpr int64_t kHugePageSize = 2L << 20;
+  static constexpr int64_t kDefaultChunkSize = 8L << 20;
+
+  // chunkSize must be a power of two, and at least kHugePageSize.
+  explicit ArenaMemoryAllocator(int64_t chunkSize = kDefaultChunkSize);
+
+  ~ArenaMemoryAllocator() override;
+
+  bool allocate(int64_t size, void** out) override;
+
+  bool allocateZeroFilled(int64_t nmemb, int64_t size, void** out) override;
+
+  bool allocateAligned(uint16_t alignment, int64_t size, void** out) override;
+
+  bool reallocate(void* p, int64_t size, int64_t newSize, void** out) override;
+
+  bool reallocateAligned(void* p, uint16_t alignment, int64_t size, int64_t newSize, void** out) override;
+
+  bool free(void* p, int64_t size) override;
+
+  bool reserveBytes(int64_t size) override;
+
+  bool unreserveBytes(int64_t size) override;
+
+  // Bytes mapped by the arena plus reserved bytes. Freed allocations are only accounted for once their chunk is
+  // released, as that is when their memory is.
+  int64_t getBytes() const override;
+
+  // Bytes of the allocations not freed yet.
+  int64_t getUsedBytes() const;
+
+  int64_t chunkSize() const {
+    return chunkSize_;
+  }
+
+ private:
+  struct Chunk {
+    char* base;
+    int64_t offset = 0;
+    int64_t numAllocations = 0;
+  };
+
+  bool allocateLocked(int64_t alignment, int64_t size, void** out);
+
+  bool freeLocked(void* p, int64_t size);
+
+  bool isLarge(int64_t size) const {
+    return size > chunkSize_ / 4;
+  }
+
+  // Returns a chunk with no allocations, mapping a new one if none is cached.
+  Chunk* takeChunk();
+
+  void releaseChunk(Chunk* chunk);
+
+  const int64_t chunkSize_;
+  std::mutex mutex_;
+  Chunk* current_ = nullptr;
+  // Chunks by base address.
+  std::unordered_map<uintptr_t, Chunk> chunks_;
+  std::vector<Chunk*> freeChunks_;
+  // Separately mapped allocations and their mapped sizes.
+  std::unordered_map<void*, int64_t> large_;
+  std::atomic_int64_t mappedBytes_{0};
+  std::atomic_int64_t usedBytes_{0};
+  std::atomic_int64_t reservedBytes_{0};
+};
+
+} // namespace gluten
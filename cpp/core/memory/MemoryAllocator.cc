@@ -21,6 +21,30 @@
 
 namespace gluten {
 
+int64_t BlockReservation::reserve(int64_t diff) {
+  auto bytes = bytesReserved_.fetch_add(diff) + diff;
+  auto max = maxBytesReserved_.load();
+  while (bytes > max && !maxBytesReserved_.compare_exchange_weak(max, bytes)) {
+  }
+  if (blocksFor(bytes) == blocksReserved_.load()) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t granted = 0;
+  // Re-read after publishing the new block count. A concurrent caller that took the fast path against the previous
+  // count did its update before that, so it is seen here.
+  while (true) {
+    auto blocks = blocksFor(bytesReserved_.load());
+    auto reserved = blocksReserved_.load();
+    if (blocks == reserved) {
+      return granted;
+    }
+    granted += (blocks - reserved) * blockSize_;
+    blocksReserved_.store(blocks);
+  }
+}
+
 bool ListenableMemoryAllocator::allocate(int64_t size, void** out) {
   listener_->allocationChanged(size);
   bool succeed = delegated_->allocate(size, out);
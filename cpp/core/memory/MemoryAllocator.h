@@ -21,6 +21,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 #include "arrow/memory_pool.h"
@@ -57,11 +58,52 @@ class AllocationListener {
   AllocationListener() = default;
 };
 
+// Bytes reserved by an AllocationListener, rounded up to whole blocks of blockSize. Changes within the reserved
+// blocks only update an atomic counter, a mutex is taken only when the block count has to change.
+class BlockReservation {
+ public:
+  explicit BlockReservation(int64_t blockSize) : blockSize_(blockSize) {}
+
+  // Returns the bytes to acquire (positive) or release (negative) from upstream, 0 if the reserved blocks still
+  // cover the current usage.
+  int64_t reserve(int64_t diff);
+
+  int64_t bytesReserved() const {
+    return bytesReserved_;
+  }
+
+  int64_t maxBytesReserved() const {
+    return maxBytesReserved_;
+  }
+
+  int64_t blocksReserved() const {
+    return blocksReserved_;
+  }
+
+ private:
+  int64_t blocksFor(int64_t bytes) const {
+    // Ceil to get the required block number.
+    return bytes <= 0 ? 0 : (bytes - 1) / blockSize_ + 1;
+  }
+
+  const int64_t blockSize_;
+  std::atomic_int64_t bytesReserved_{0};
+  std::atomic_int64_t blocksReserved_{0};
+  std::atomic_int64_t maxBytesReserved_{0};
+  std::mutex mutex_;
+};
+
 class ListenableMemoryAllocator final : public MemoryAllocator {
  public:
   explicit ListenableMemoryAllocator(MemoryAllocator* delegated, std::shared_ptr<AllocationListener> listener)
       : delegated_(delegated), listener_(std::move(listener)) {}
 
+  // Takes ownership of the delegated allocator.
+  explicit ListenableMemoryAllocator(
+      std::shared_ptr<MemoryAllocator> delegated,
+      std::shared_ptr<AllocationListener> listener)
+      : delegated_(delegated.get()), ownedDelegated_(std::move(delegated)), listener_(std::move(listener)) {}
+
  public:
   bool allocate(int64_t size, void** out) override;
 
@@ -81,8 +123,13 @@ class ListenableMemoryAllocator final : public MemoryAllocator {
 
   int64_t getBytes() const override;
 
+  const std::shared_ptr<AllocationListener>& listener() const {
+    return listener_;
+  }
+
  private:
   MemoryAllocator* delegated_;
+  std::shared_ptr<MemoryAllocator> ownedDelegated_;
   std::shared_ptr<AllocationListener> listener_;
   std::atomic_int64_t bytes_{0};
 };
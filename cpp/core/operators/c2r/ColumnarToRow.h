@@ -38,6 +38,20 @@ class ColumnarToRowConverter {
 
   virtual arrow::Status write(std::shared_ptr<ColumnarBatch> cb = nullptr) = 0;
 
+  // Converts the rows of cb from startRow into the reused buffer, stopping before the chunk exceeds memoryThreshold
+  // bytes. At least one row is converted. getNumRows(), getOffsets() and getLengths() then describe the chunk.
+  // Converters that don't support chunking convert the whole batch.
+  virtual arrow::Status writeChunk(std::shared_ptr<ColumnarBatch> cb, int32_t startRow, int64_t memoryThreshold) {
+    if (startRow != 0) {
+      return arrow::Status::NotImplemented("Chunked columnar to row conversion is not supported by this converter.");
+    }
+    return write(cb);
+  }
+
+  int32_t getNumRows() const {
+    return numRows_;
+  }
+
   uint8_t* getBufferAddress() {
     return bufferAddress_;
   }
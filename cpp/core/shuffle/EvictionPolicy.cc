@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shuffle/EvictionPolicy.h"
+
+#include <algorithm>
+
+namespace gluten {
+
+namespace {
+
+// The partitions holding some bytes, largest first.
+template <typename BytesOf>
+std::vector<int32_t> largestFirst(const std::vector<PartitionMemoryUsage>& partitions, BytesOf bytesOf) {
+  std::vector<int32_t> partitionIds;
+  for (int32_t pid = 0; pid < static_cast<int32_t>(partitions.size()); ++pid) {
+    if (bytesOf(partitions[pid]) > 0) {
+      partitionIds.push_back(pid);
+    }
+  }
+  std::sort(partitionIds.begin(), partitionIds.end(), [&](int32_t a, int32_t b) {
+    auto aBytes = bytesOf(partitions[a]);
+    auto bBytes = bytesOf(partitions[b]);
+    if (aBytes != bBytes) {
+      return aBytes > bBytes;
+    }
+    return partitions[a].numSpills > partitions[b].numSpills;
+  });
+  return partitionIds;
+}
+
+int64_t totalCachedBytes(const std::vector<PartitionMemoryUsage>& partitions) {
+  int64_t bytes = 0;
+  for (const auto& partition : partitions) {
+    bytes += partition.cachedBytes;
+  }
+  return bytes;
+}
+
+} // namespace
+
+arrow::Result<std::unique_ptr<EvictionPolicy>> EvictionPolicy::create(const std::string& name) {
+  if (name == kLargestFirstEvictionPolicy) {
+    return std::make_unique<LargestFirstEvictionPolicy>();
+  }
+  if (name == kSpillAllEvictionPolicy) {
+    return std::make_unique<SpillAllEvictionPolicy>();
+  }
+  return arrow::Status::Invalid("Unknown eviction policy: ", name);
+}
+
+std::vector<EvictStep> LargestFirstEvictionPolicy::plan(const EvictionState& state, int64_t target) {
+  const auto& partitions = state.partitions;
+  std::vector<EvictStep> steps;
+  int64_t planned = 0;
+
+  for (auto pid : largestFirst(partitions, [](const auto& p) { return p.shrinkableBytes; })) {
+    if (planned >= target) {
+      return steps;
+    }
+    steps.push_back({EvictAction::kShrinkBuffers, pid, partitions[pid].shrinkableBytes});
+    planned += partitions[pid].shrinkableBytes;
+  }
+
+  if (state.canSpillPartition) {
+    for (auto pid : largestFirst(partitions, [](const auto& p) { return p.cachedBytes; })) {
+      if (planned >= target) {
+        return steps;
+      }
+      steps.push_back({EvictAction::kSpillPayloads, pid, partitions[pid].cachedBytes});
+      planned += partitions[pid].cachedBytes;
+    }
+  } else if (planned < target) {
+    if (auto cachedBytes = totalCachedBytes(partitions); cachedBytes > 0) {
+      steps.push_back({EvictAction::kSpillPayloads, -1, cachedBytes});
+      planned += cachedBytes;
+    }
+  }
+
+  // All the partition buffers were shrunk, what remains holds rows.
+  bool flushed = false;
+  for (auto pid : largestFirst(partitions, [](const auto& p) { return p.bufferedBytes - p.shrinkableBytes; })) {
+    if (planned >= target) {
+      break;
+    }
+    auto bytes = partitions[pid].bufferedBytes - partitions[pid].shrinkableBytes;
+    steps.push_back({EvictAction::kFlushBuffers, pid, bytes});
+    if (state.canSpillPartition) {
+      steps.push_back({EvictAction::kSpillPayloads, pid, 0});
+    }
+    planned += bytes;
+    flushed = true;
+  }
+  if (flushed && !state.canSpillPartition) {
+    steps.push_back({EvictAction::kSpillPayloads, -1, 0});
+  }
+  return steps;
+}
+
+std::vector<EvictStep> SpillAllEvictionPolicy::plan(const EvictionState& state, int64_t target) {
+  const auto& partitions = state.partitions;
+  std::vector<EvictStep> steps;
+  auto cachedBytes = totalCachedBytes(partitions);
+  if (cachedBytes > 0) {
+    steps.push_back({EvictAction::kSpillPayloads, -1, cachedBytes});
+  }
+  if (cachedBytes >= target) {
+    return steps;
+  }
+  bool flushed = false;
+  for (int32_t pid = 0; pid < static_cast<int32_t>(partitions.size()); ++pid) {
+    if (partitions[pid].bufferedBytes > 0) {
+      steps.push_back({EvictAction::kFlushBuffers, pid, partitions[pid].bufferedBytes});
+      flushed = true;
+    }
+  }
+  if (flushed) {
+    steps.push_back({EvictAction::kSpillPayloads, -1, 0});
+  }
+  return steps;
+}
+
+} // namespace gluten
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/result.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gluten {
+
+static const std::string kLargestFirstEvictionPolicy = "largest_first";
+static const std::string kSpillAllEvictionPolicy = "spill_all";
+
+// The memory a shuffle writer holds for one partition.
+struct PartitionMemoryUsage {
+  // Bytes of the partition buffers the rows are split into.
+  int64_t bufferedBytes = 0;
+  // Part of bufferedBytes released by shrinking the partition buffers, without writing anything.
+  int64_t shrinkableBytes = 0;
+  // Bytes of the payloads cached for the partition, which are released by spilling them.
+  int64_t cachedBytes = 0;
+  // Times the payloads of the partition were spilled so far.
+  int32_t numSpills = 0;
+};
+
+struct EvictionState {
+  std::vector<PartitionMemoryUsage> partitions;
+  // Whether the payloads of a single partition can be spilled. Otherwise a spill takes all cached payloads.
+  bool canSpillPartition = true;
+};
+
+enum class EvictAction {
+  // Shrink the partition buffers to the rows they hold, or release them if they hold none.
+  kShrinkBuffers,
+  // Turn the rows of the partition buffers into a payload and release the buffers.
+  kFlushBuffers,
+  // Spill the cached payloads.
+  kSpillPayloads
+};
+
+struct EvictStep {
+  EvictAction action;
+  // -1 for all partitions.
+  int32_t partitionId;
+  // Bytes the step is expected to release.
+  int64_t bytes;
+};
+
+// Decides which of the memory held by a shuffle writer to release when it's asked to free some.
+class EvictionPolicy {
+ public:
+  static arrow::Result<std::unique_ptr<EvictionPolicy>> create(const std::string& name);
+
+  virtual ~EvictionPolicy() = default;
+
+  // Returns the steps releasing at least `target` bytes, or as much as there is, in the order to carry them out.
+  // A kFlushBuffers step is followed by a kSpillPayloads step taking the new payload.
+  virtual std::vector<EvictStep> plan(const EvictionState& state, int64_t target) = 0;
+};
+
+// Releases the largest memory first, stopping as soon as the target is reached: the partition buffers are shrunk,
+// then the cached payloads are spilled, then the partition buffers are flushed and spilled. Among as large
+// partitions, the ones already spilled go first, their spill file being open.
+class LargestFirstEvictionPolicy final : public EvictionPolicy {
+ public:
+  std::vector<EvictStep> plan(const EvictionState& state, int64_t target) override;
+};
+
+// Spills all cached payloads at once, then flushes and spills all partition buffers if that isn't enough.
+class SpillAllEvictionPolicy final : public EvictionPolicy {
+ public:
+  std::vector<EvictStep> plan(const EvictionState& state, int64_t target) override;
+};
+
+} // namespace gluten
@@ -19,10 +19,11 @@
 #include "shuffle/FallbackRangePartitioner.h"
 
 namespace gluten {
-arrow::Status gluten::FallbackRangePartitioner::compute(
+template <typename T>
+arrow::Status gluten::FallbackRangePartitioner::computeImpl(
     const int32_t* pidArr,
     const int64_t numRows,
-    std::vector<uint16_t>& partitionId,
+    std::vector<T>& partitionId,
     std::vector<uint32_t>& partitionIdCnt) {
   partitionId.resize(numRows);
   std::fill(std::begin(partitionIdCnt), std::end(partitionIdCnt), 0);
@@ -38,4 +39,20 @@ arrow::Status gluten::FallbackRangePartitioner::compute(
   return arrow::Status::OK();
 }
 
+arrow::Status gluten::FallbackRangePartitioner::compute(
+    const int32_t* pidArr,
+    const int64_t numRows,
+    std::vector<uint16_t>& partitionId,
+    std::vector<uint32_t>& partitionIdCnt) {
+  return computeImpl(pidArr, numRows, partitionId, partitionIdCnt);
+}
+
+arrow::Status gluten::FallbackRangePartitioner::compute(
+    const int32_t* pidArr,
+    const int64_t numRows,
+    std::vector<uint32_t>& partitionId,
+    std::vector<uint32_t>& partitionIdCnt) {
+  return computeImpl(pidArr, numRows, partitionId, partitionIdCnt);
+}
+
 } // namespace gluten
@@ -17,35 +17,204 @@
 
 #include "shuffle/HashPartitioner.h"
 
+#include <algorithm>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 namespace gluten {
 
-arrow::Status gluten::HashPartitioner::compute(
+namespace {
+
+// Consecutive rows are counted into different sub-histograms, so runs of the same partition id don't serialize on
+// one counter. Beyond kMaxSubHistogramPartitions the sub-histograms no longer fit in L1 and a single one is used.
+constexpr uint32_t kNumSubHistograms = 4;
+constexpr int32_t kMaxSubHistogramPartitions = 2048;
+
+// Granlund-Montgomery round-up division: q = (t + ((u - t) >> 1)) >> shift, t = mulhi(u, magic).
+// The unsigned remainder of the hash is then moved to pmod by subtracting 2^32 mod divisor for negative hashes,
+// min(r, r + divisor) folds a wrapped-around result back into [0, divisor).
+inline uint32_t pmod(int32_t hash, const PmodReciprocal& r) {
+  auto u = static_cast<uint32_t>(hash);
+  auto t = static_cast<uint32_t>((static_cast<uint64_t>(u) * r.magic) >> 32);
+  auto q = (t + ((u - t) >> 1)) >> r.shift;
+  auto rem = u - q * r.divisor;
+  rem -= r.wrapRemainder & static_cast<uint32_t>(hash >> 31);
+  return std::min(rem, rem + r.divisor);
+}
+
+template <typename T>
+void pmodScalar(const int32_t* hashes, int64_t begin, int64_t numRows, const PmodReciprocal& r, T* out) {
+  for (auto i = begin; i < numRows; ++i) {
+    out[i] = pmod(hashes[i], r);
+  }
+}
+
+#if defined(__x86_64__)
+// Returns the number of rows processed, the tail is left to pmodScalar.
+template <typename T>
+__attribute__((target("avx2"))) int64_t
+pmodAvx2(const int32_t* hashes, int64_t numRows, const PmodReciprocal& r, T* out) {
+  const __m256i magic = _mm256_set1_epi32(r.magic);
+  const __m128i shift = _mm_cvtsi32_si128(r.shift);
+  const __m256i divisor = _mm256_set1_epi32(r.divisor);
+  const __m256i wrapRemainder = _mm256_set1_epi32(r.wrapRemainder);
+  int64_t i = 0;
+  for (; i + 8 <= numRows; i += 8) {
+    __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hashes + i));
+    // mulhi for the even lanes, then for the odd lanes shifted down
+    __m256i tEven = _mm256_srli_epi64(_mm256_mul_epu32(u, magic), 32);
+    __m256i tOdd = _mm256_mul_epu32(_mm256_srli_epi64(u, 32), magic);
+    __m256i t = _mm256_blend_epi32(tEven, tOdd, 0xAA);
+    __m256i q = _mm256_srl_epi32(_mm256_add_epi32(t, _mm256_srli_epi32(_mm256_sub_epi32(u, t), 1)), shift);
+    __m256i rem = _mm256_sub_epi32(u, _mm256_mullo_epi32(q, divisor));
+    rem = _mm256_sub_epi32(rem, _mm256_and_si256(_mm256_srai_epi32(u, 31), wrapRemainder));
+    rem = _mm256_min_epu32(rem, _mm256_add_epi32(rem, divisor));
+    if constexpr (sizeof(T) == sizeof(uint16_t)) {
+      __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rem, rem), 0x08);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+    } else {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), rem);
+    }
+  }
+  return i;
+}
+
+template <typename T>
+__attribute__((target("avx512f,avx512bw"))) int64_t
+pmodAvx512(const int32_t* hashes, int64_t numRows, const PmodReciprocal& r, T* out) {
+  const __m512i magic = _mm512_set1_epi32(r.magic);
+  const __m128i shift = _mm_cvtsi32_si128(r.shift);
+  const __m512i divisor = _mm512_set1_epi32(r.divisor);
+  const __m512i wrapRemainder = _mm512_set1_epi32(r.wrapRemainder);
+  int64_t i = 0;
+  for (; i + 16 <= numRows; i += 16) {
+    __m512i u = _mm512_loadu_si512(hashes + i);
+    __m512i tEven = _mm512_srli_epi64(_mm512_mul_epu32(u, magic), 32);
+    __m512i tOdd = _mm512_mul_epu32(_mm512_srli_epi64(u, 32), magic);
+    __m512i t = _mm512_mask_blend_epi32(0xAAAA, tEven, tOdd);
+    __m512i q = _mm512_srl_epi32(_mm512_add_epi32(t, _mm512_srli_epi32(_mm512_sub_epi32(u, t), 1)), shift);
+    __m512i rem = _mm512_sub_epi32(u, _mm512_mullo_epi32(q, divisor));
+    rem = _mm512_sub_epi32(rem, _mm512_and_si512(_mm512_srai_epi32(u, 31), wrapRemainder));
+    rem = _mm512_min_epu32(rem, _mm512_add_epi32(rem, divisor));
+    if constexpr (sizeof(T) == sizeof(uint16_t)) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm512_cvtepi32_epi16(rem));
+    } else {
+      _mm512_storeu_si512(out + i, rem);
+    }
+  }
+  return i;
+}
+#endif
+
+template <typename T>
+void countPartitionIds(
+    const T* partitionId,
+    int64_t numRows,
+    int32_t numPartitions,
+    std::vector<uint32_t>& subHistogram,
+    std::vector<uint32_t>& partitionIdCnt) {
+  if (numPartitions > kMaxSubHistogramPartitions) {
+    for (auto i = 0; i < numRows; ++i) {
+      partitionIdCnt[partitionId[i]]++;
+    }
+    return;
+  }
+
+  // layout: partition id * kNumSubHistograms + lane
+  subHistogram.assign(numPartitions * kNumSubHistograms, 0);
+  auto hist = subHistogram.data();
+  int64_t i = 0;
+  for (; i + kNumSubHistograms <= numRows; i += kNumSubHistograms) {
+    hist[partitionId[i] * kNumSubHistograms]++;
+    hist[partitionId[i + 1] * kNumSubHistograms + 1]++;
+    hist[partitionId[i + 2] * kNumSubHistograms + 2]++;
+    hist[partitionId[i + 3] * kNumSubHistograms + 3]++;
+  }
+  for (; i < numRows; ++i) {
+    hist[partitionId[i] * kNumSubHistograms]++;
+  }
+  for (auto pid = 0; pid < numPartitions; ++pid) {
+    auto lanes = hist + pid * kNumSubHistograms;
+    partitionIdCnt[pid] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+}
+
+} // namespace
+
+PmodReciprocal PmodReciprocal::make(uint32_t divisor) {
+  PmodReciprocal r;
+  r.divisor = divisor;
+  // l = ceil(log2(divisor)), magic = floor(2^32 * (2^l - divisor) / divisor) + 1
+  uint32_t l = 32 - __builtin_clz(divisor - 1);
+  r.magic = static_cast<uint32_t>((((1ULL << l) - divisor) << 32) / divisor + 1);
+  r.shift = l - 1;
+  r.wrapRemainder = static_cast<uint32_t>((1ULL << 32) % divisor);
+  return r;
+}
+
+HashPartitioner::HashPartitioner(int32_t numPartitions, bool hasPid, Kernel kernel)
+    : Partitioner(numPartitions, hasPid), kernel_(std::min(kernel, detectKernel(true))) {
+  if (numPartitions_ > 1) {
+    reciprocal_ = PmodReciprocal::make(numPartitions_);
+  }
+}
+
+HashPartitioner::Kernel HashPartitioner::detectKernel(bool supportAvx512) {
+#if defined(__x86_64__)
+  if (supportAvx512 && __builtin_cpu_supports("avx512bw")) {
+    return Kernel::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return Kernel::kAvx2;
+  }
+#endif
+  return Kernel::kScalar;
+}
+
+template <typename T>
+arrow::Status gluten::HashPartitioner::computeImpl(
     const int32_t* pidArr,
     const int64_t numRows,
-    std::vector<uint16_t>& partitionId,
+    std::vector<T>& partitionId,
     std::vector<uint32_t>& partitionIdCnt) {
   partitionId.resize(numRows);
   std::fill(std::begin(partitionIdCnt), std::end(partitionIdCnt), 0);
 
-  for (auto i = 0; i < numRows; ++i) {
-    auto pid = pidArr[i] % numPartitions_;
+  if (numPartitions_ == 1) {
+    std::fill(std::begin(partitionId), std::end(partitionId), 0);
+    partitionIdCnt[0] = numRows;
+    return arrow::Status::OK();
+  }
+
+  int64_t processed = 0;
 #if defined(__x86_64__)
-    // force to generate ASM
-    __asm__(
-        "lea (%[num_partitions],%[pid],1),%[tmp]\n"
-        "test %[pid],%[pid]\n"
-        "cmovs %[tmp],%[pid]\n"
-        : [pid] "+r"(pid)
-        : [num_partitions] "r"(numPartitions_), [tmp] "r"(0));
-#else
-    if (pid < 0) {
-      pid += numPartitions_;
-    }
-#endif
-    partitionId[i] = pid;
-    partitionIdCnt[pid]++;
+  if (kernel_ == Kernel::kAvx512) {
+    processed = pmodAvx512(pidArr, numRows, reciprocal_, partitionId.data());
+  } else if (kernel_ == Kernel::kAvx2) {
+    processed = pmodAvx2(pidArr, numRows, reciprocal_, partitionId.data());
   }
+#endif
+  pmodScalar(pidArr, processed, numRows, reciprocal_, partitionId.data());
+
+  countPartitionIds(partitionId.data(), numRows, numPartitions_, subHistogram_, partitionIdCnt);
   return arrow::Status::OK();
 }
 
+arrow::Status gluten::HashPartitioner::compute(
+    const int32_t* pidArr,
+    const int64_t numRows,
+    std::vector<uint16_t>& partitionId,
+    std::vector<uint32_t>& partitionIdCnt) {
+  return computeImpl(pidArr, numRows, partitionId, partitionIdCnt);
+}
+
+arrow::Status gluten::HashPartitioner::compute(
+    const int32_t* pidArr,
+    const int64_t numRows,
+    std::vector<uint32_t>& partitionId,
+    std::vector<uint32_t>& partitionIdCnt) {
+  return computeImpl(pidArr, numRows, partitionId, partitionIdCnt);
+}
+
 } // namespace gluten
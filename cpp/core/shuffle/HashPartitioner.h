@@ -21,15 +21,57 @@
 
 namespace gluten {
 
+// Precomputed constants to evaluate pmod(hash, divisor) with a multiply and shifts instead of a division.
+// divisor must be at least 2.
+struct PmodReciprocal {
+  uint32_t divisor = 0;
+  uint32_t magic = 0;
+  uint32_t shift = 0;
+  // 2^32 mod divisor, corrects the remainder of negative hash values
+  uint32_t wrapRemainder = 0;
+
+  static PmodReciprocal make(uint32_t divisor);
+};
+
 class HashPartitioner final : public ShuffleWriter::Partitioner {
  public:
-  HashPartitioner(int32_t numPartitions, bool hasPid) : Partitioner(numPartitions, hasPid) {}
+  enum class Kernel { kScalar, kAvx2, kAvx512 };
+
+  HashPartitioner(int32_t numPartitions, bool hasPid, Kernel kernel = Kernel::kScalar);
+
+  // Widest kernel the CPU supports. AVX-512 is only used if the caller allows it.
+  static Kernel detectKernel(bool supportAvx512);
+
+  Kernel kernel() const {
+    return kernel_;
+  }
 
   arrow::Status compute(
       const int32_t* pidArr,
       const int64_t numRows,
       std::vector<uint16_t>& partitionId,
       std::vector<uint32_t>& partitionIdCnt) override;
+
+  arrow::Status compute(
+      const int32_t* pidArr,
+      const int64_t numRows,
+      std::vector<uint32_t>& partitionId,
+      std::vector<uint32_t>& partitionIdCnt) override;
+
+ private:
+  template <typename T>
+  arrow::Status computeImpl(
+      const int32_t* pidArr,
+      const int64_t numRows,
+      std::vector<T>& partitionId,
+      std::vector<uint32_t>& partitionIdCnt);
+
+  Kernel kernel_;
+
+  PmodReciprocal reciprocal_;
+
+  // interleaved sub-histograms, see kNumSubHistograms
+  std::vector<uint32_t> subHistogram_;
 };
 
 } // namespace gluten
@@ -19,6 +19,10 @@
 
 namespace gluten {
 
+namespace {
+constexpr int64_t kDataFileBufferSize = 16384;
+}
+
 std::string LocalPartitionWriterBase::nextSpilledFileDir() {
   auto spilledFileDir = getSpilledShuffleFileDir(configuredDirs_[dirSelection_], subDirSelection_[dirSelection_]);
   subDirSelection_[dirSelection_] = (subDirSelection_[dirSelection_] + 1) % shuffleWriter_->options().num_sub_dirs;
@@ -40,21 +44,73 @@ arrow::Status LocalPartitionWriterBase::setLocalDirs() {
   return arrow::Status::OK();
 }
 
+void LocalPartitionWriterBase::initSpillExecutor() {
+  if (shuffleWriter_->options().async_spill) {
+    spillExecutor_ = std::make_unique<SpillIoExecutor>(shuffleWriter_->options().async_spill_max_inflight_bytes);
+  }
+}
+
+arrow::Status LocalPartitionWriterBase::submitSpill(int64_t bytes, std::function<arrow::Status()> write) {
+  if (spillExecutor_) {
+    return spillExecutor_->submit(bytes, std::move(write));
+  }
+  return write();
+}
+
+int64_t LocalPartitionWriterBase::inFlightBytes() {
+  return spillExecutor_ ? spillExecutor_->inFlightBytes() : 0;
+}
+
+arrow::Status LocalPartitionWriterBase::waitForEvicted() {
+  return spillExecutor_ ? spillExecutor_->waitAll() : arrow::Status::OK();
+}
+
+void LocalPartitionWriterBase::collectSpillTime() {
+  if (spillExecutor_) {
+    shuffleWriter_->setTotalEvictTime(shuffleWriter_->totalEvictTime() + spillExecutor_->writeTime());
+  }
+}
+
+void LocalPartitionWriterBase::stopSpillExecutor() {
+  // The executor runs the queued writes before its thread exits.
+  spillExecutor_.reset();
+}
+
 arrow::Status LocalPartitionWriterBase::openDataFile() {
   // open data file output stream
-  std::shared_ptr<arrow::io::FileOutputStream> fout;
-  ARROW_ASSIGN_OR_RAISE(fout, arrow::io::FileOutputStream::Open(shuffleWriter_->options().data_file, true));
+  ARROW_ASSIGN_OR_RAISE(dataFile_, arrow::io::FileOutputStream::Open(shuffleWriter_->options().data_file, true));
   if (shuffleWriter_->options().buffered_write) {
     ARROW_ASSIGN_OR_RAISE(
-        dataFileOs_, arrow::io::BufferedOutputStream::Create(16384, shuffleWriter_->options().memory_pool.get(), fout));
+        dataFileOs_,
+        arrow::io::BufferedOutputStream::Create(
+            kDataFileBufferSize, shuffleWriter_->options().memory_pool.get(), dataFile_));
   } else {
-    dataFileOs_ = fout;
+    dataFileOs_ = dataFile_;
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status LocalPartitionWriterBase::appendToDataFile(int fd, int64_t offset, int64_t length) {
+  // Buffered bytes must reach the file first. The buffered stream caches the file position, so it's recreated
+  // after the kernel moved it.
+  auto buffered = std::dynamic_pointer_cast<arrow::io::BufferedOutputStream>(dataFileOs_);
+  if (buffered) {
+    RETURN_NOT_OK(buffered->Detach().status());
+  }
+  RETURN_NOT_OK(copyFileRange(fd, offset, dataFile_->file_descriptor(), length));
+  if (buffered) {
+    ARROW_ASSIGN_OR_RAISE(
+        dataFileOs_,
+        arrow::io::BufferedOutputStream::Create(
+            kDataFileBufferSize, shuffleWriter_->options().memory_pool.get(), dataFile_));
   }
   return arrow::Status::OK();
 }
 
 arrow::Status LocalPartitionWriterBase::clearResource() {
+  stopSpillExecutor();
   RETURN_NOT_OK(dataFileOs_->Close());
+  dataFile_.reset();
   schemaPayload_.reset();
   shuffleWriter_->pool()->reset();
   shuffleWriter_->partitionBuffer().clear();
@@ -73,17 +129,20 @@ class PreferEvictPartitionWriter::LocalPartitionWriterInstance {
 #ifndef SKIPWRITE
     RETURN_NOT_OK(ensureOpened());
 #endif
-    RETURN_NOT_OK(writeRecordBatchPayload(spilledFileOs_.get()));
+    auto payloads = std::move(shuffleWriter_->partitionCachedRecordbatch()[partitionId_]);
+    auto bytes = shuffleWriter_->partitionCachedRecordbatchSize()[partitionId_];
     clearCache();
-    return arrow::Status::OK();
+    return partitionWriter_->submitSpill(bytes, [this, payloads = std::move(payloads)]() mutable {
+      return writeRecordBatchPayload(spilledFileOs_.get(), payloads);
+    });
   }
 
   arrow::Status writeCachedRecordBatchAndClose() {
-    const auto& dataFileOs = partitionWriter_->dataFileOs_;
-    ARROW_ASSIGN_OR_RAISE(auto before_write, dataFileOs->Tell());
+    // mergeSpilled() may replace the buffered data file stream, don't hold on to it.
+    ARROW_ASSIGN_OR_RAISE(auto before_write, partitionWriter_->dataFileOs_->Tell());
 
     if (shuffleWriter_->options().write_schema) {
-      RETURN_NOT_OK(writeSchemaPayload(dataFileOs.get()));
+      RETURN_NOT_OK(writeSchemaPayload(partitionWriter_->dataFileOs_.get()));
     }
 
     if (spilledFileOpened_) {
@@ -95,11 +154,12 @@ class PreferEvictPartitionWriter::LocalPartitionWriterInstance {
       }
     }
 
-    RETURN_NOT_OK(writeRecordBatchPayload(dataFileOs.get()));
-    RETURN_NOT_OK(writeEos(dataFileOs.get()));
+    RETURN_NOT_OK(writeRecordBatchPayload(
+        partitionWriter_->dataFileOs_.get(), shuffleWriter_->partitionCachedRecordbatch()[partitionId_]));
+    RETURN_NOT_OK(writeEos(partitionWriter_->dataFileOs_.get()));
     clearCache();
 
-    ARROW_ASSIGN_OR_RAISE(auto after_write, dataFileOs->Tell());
+    ARROW_ASSIGN_OR_RAISE(auto after_write, partitionWriter_->dataFileOs_->Tell());
     partition_length = after_write - before_write;
 
     return arrow::Status::OK();
@@ -121,12 +181,10 @@ class PreferEvictPartitionWriter::LocalPartitionWriterInstance {
   }
 
   arrow::Status mergeSpilled() {
-    ARROW_ASSIGN_OR_RAISE(
-        auto spilled_file_is_, arrow::io::MemoryMappedFile::Open(spilledFile_, arrow::io::FileMode::READ));
+    ARROW_ASSIGN_OR_RAISE(auto spilled_file_is_, arrow::io::ReadableFile::Open(spilledFile_));
     // copy spilled data blocks
     ARROW_ASSIGN_OR_RAISE(auto nbytes, spilled_file_is_->GetSize());
-    ARROW_ASSIGN_OR_RAISE(auto buffer, spilled_file_is_->Read(nbytes));
-    RETURN_NOT_OK(partitionWriter_->dataFileOs_->Write(buffer));
+    RETURN_NOT_OK(partitionWriter_->appendToDataFile(spilled_file_is_->file_descriptor(), 0, nbytes));
 
     // close spilled file streams and delete the file
     RETURN_NOT_OK(spilled_file_is_->Close());
@@ -144,10 +202,12 @@ class PreferEvictPartitionWriter::LocalPartitionWriterInstance {
     return arrow::Status::OK();
   }
 
-  arrow::Status writeRecordBatchPayload(arrow::io::OutputStream* os) {
+  arrow::Status writeRecordBatchPayload(
+      arrow::io::OutputStream* os,
+      std::vector<std::shared_ptr<arrow::ipc::IpcPayload>>& payloads) {
     int32_t metadataLength = 0; // unused
 #ifndef SKIPWRITE
-    for (auto& payload : shuffleWriter_->partitionCachedRecordbatch()[partitionId_]) {
+    for (auto& payload : payloads) {
       RETURN_NOT_OK(
           arrow::ipc::WriteIpcPayload(*payload, shuffleWriter_->options().ipc_write_options, os, &metadataLength));
       payload = nullptr;
@@ -182,6 +242,7 @@ class PreferEvictPartitionWriter::LocalPartitionWriterInstance {
 arrow::Status PreferEvictPartitionWriter::init() {
   partitionWriterInstances_.resize(shuffleWriter_->numPartitions());
   RETURN_NOT_OK(setLocalDirs());
+  initSpillExecutor();
   return arrow::Status::OK();
 }
 
@@ -210,6 +271,8 @@ arrow::Status PreferEvictPartitionWriter::evictPartition(int32_t partitionId) {
 }
 
 arrow::Status PreferEvictPartitionWriter::stop() {
+  RETURN_NOT_OK(waitForEvicted());
+  collectSpillTime();
   RETURN_NOT_OK(openDataFile());
   // stop PartitionWriter and collect metrics
   for (auto pid = 0; pid < shuffleWriter_->numPartitions(); ++pid) {
@@ -243,6 +306,7 @@ arrow::Status PreferEvictPartitionWriter::clearResource() {
 
 arrow::Status PreferCachePartitionWriter::init() {
   RETURN_NOT_OK(setLocalDirs());
+  initSpillExecutor();
   return arrow::Status::OK();
 }
 
@@ -262,28 +326,25 @@ arrow::Status PreferCachePartitionWriter::evictPartition(int32_t partitionId /*
 
   int64_t evictTime = 0;
   TIME_NANO_START(evictTime)
-  ARROW_ASSIGN_OR_RAISE(auto spilledFile, createTempShuffleFile(nextSpilledFileDir()));
-  SpillInfo spillInfo = {spilledFile};
-  // Spill all cached batches into one file, record their start and length.
-  ARROW_ASSIGN_OR_RAISE(auto spilledFileOs, arrow::io::FileOutputStream::Open(spilledFile, true));
+  auto spillInfo = std::make_shared<SpillInfo>();
+  ARROW_ASSIGN_OR_RAISE(spillInfo->spilledFile, createTempShuffleFile(nextSpilledFileDir()));
+  // Take all cached batches, they are written into one file by writeSpill.
+  PartitionPayloads payloads;
+  int64_t payloadBytes = 0;
   for (auto pid = 0; pid < shuffleWriter_->numPartitions(); ++pid) {
     auto cachedPayloadSize = shuffleWriter_->partitionCachedRecordbatchSize()[pid];
     if (cachedPayloadSize > 0) {
-      ARROW_ASSIGN_OR_RAISE(auto start, spilledFileOs->Tell());
-      RETURN_NOT_OK(flushCachedPayloads(spilledFileOs.get(), shuffleWriter_->partitionCachedRecordbatch()[pid]));
-      ARROW_ASSIGN_OR_RAISE(auto end, spilledFileOs->Tell());
-      spillInfo.partitionSpillInfos.push_back({pid, start, end - start});
-#ifdef GLUTEN_PRINT_DEBUG
-      std::cout << "Spilled partition " << pid << " file start: " << start << ", file end: " << end
-                << ", cachedPayloadSize: " << cachedPayloadSize << std::endl;
-#endif
+      payloads.emplace_back(pid, std::move(shuffleWriter_->partitionCachedRecordbatch()[pid]));
+      payloadBytes += cachedPayloadSize;
       // clearCache();
       shuffleWriter_->partitionCachedRecordbatch()[pid].clear();
       shuffleWriter_->setPartitionCachedRecordbatchSize(pid, 0);
     }
   }
-  RETURN_NOT_OK(spilledFileOs->Close());
-  spills_.push_back(std::move(spillInfo));
+  spills_.push_back(spillInfo);
+  RETURN_NOT_OK(submitSpill(payloadBytes, [this, spillInfo, payloads = std::move(payloads)]() mutable {
+    return writeSpill(*spillInfo, payloads);
+  }));
 
   TIME_NANO_END(evictTime)
   shuffleWriter_->setTotalEvictTime(shuffleWriter_->totalEvictTime() + evictTime);
@@ -291,8 +352,26 @@ arrow::Status PreferCachePartitionWriter::evictPartition(int32_t partitionId /*
   return arrow::Status::OK();
 }
 
+arrow::Status PreferCachePartitionWriter::writeSpill(SpillInfo& spillInfo, PartitionPayloads& payloads) {
+  // Spill all cached batches into one file, record their start and length.
+  ARROW_ASSIGN_OR_RAISE(auto spilledFileOs, arrow::io::FileOutputStream::Open(spillInfo.spilledFile, true));
+  for (auto& [pid, partitionPayloads] : payloads) {
+    ARROW_ASSIGN_OR_RAISE(auto start, spilledFileOs->Tell());
+    RETURN_NOT_OK(flushCachedPayloads(spilledFileOs.get(), partitionPayloads));
+    ARROW_ASSIGN_OR_RAISE(auto end, spilledFileOs->Tell());
+    spillInfo.partitionSpillInfos.push_back({pid, start, end - start});
+#ifdef GLUTEN_PRINT_DEBUG
+    std::cout << "Spilled partition " << pid << " file start: " << start << ", file end: " << end << std::endl;
+#endif
+  }
+  RETURN_NOT_OK(spilledFileOs->Close());
+  return arrow::Status::OK();
+}
+
 arrow::Status PreferCachePartitionWriter::stop() {
   inStop_ = true;
+  RETURN_NOT_OK(waitForEvicted());
+  collectSpillTime();
 
   int64_t totalWriteTime = 0;
   int64_t totalBytesEvicted = 0;
@@ -306,9 +385,9 @@ arrow::Status PreferCachePartitionWriter::stop() {
   RETURN_NOT_OK(openDataFile());
   // 1. Open all spilled files, update totalBytesEvicted.
   std::vector<int32_t> spillInfoOffsets(spills_.size(), 0);
-  std::vector<std::shared_ptr<arrow::io::MemoryMappedFile>> spilledFiles;
+  std::vector<std::shared_ptr<arrow::io::ReadableFile>> spilledFiles;
   for (const auto& spill : spills_) {
-    ARROW_ASSIGN_OR_RAISE(auto is, arrow::io::MemoryMappedFile::Open(spill.spilledFile, arrow::io::FileMode::READ));
+    ARROW_ASSIGN_OR_RAISE(auto is, arrow::io::ReadableFile::Open(spill->spilledFile));
     ARROW_ASSIGN_OR_RAISE(auto spilledSize, is->GetSize());
     totalBytesEvicted += spilledSize;
     spilledFiles.push_back(std::move(is));
@@ -320,8 +399,12 @@ arrow::Status PreferCachePartitionWriter::stop() {
     ARROW_ASSIGN_OR_RAISE(auto startInFinalFile, dataFileOs_->Tell());
     // 4. Iterator over all spilled files
     for (auto i = 0; i < spills_.size(); ++i) {
-      auto partitionSpillInfo = spills_[i].partitionSpillInfos[spillInfoOffsets[i]];
-      // 5. read if partition exists in the spilled file and write to the final file
+      const auto& partitionSpillInfos = spills_[i]->partitionSpillInfos;
+      if (spillInfoOffsets[i] == partitionSpillInfos.size()) {
+        continue;
+      }
+      auto partitionSpillInfo = partitionSpillInfos[spillInfoOffsets[i]];
+      // 5. copy if partition exists in the spilled file and write to the final file
       if (partitionSpillInfo.partitionId == pid) { // A hit
         if (firstWrite) {
           // Write schema payload for this partition
@@ -330,8 +413,8 @@ arrow::Status PreferCachePartitionWriter::stop() {
           }
           firstWrite = false;
         }
-        ARROW_ASSIGN_OR_RAISE(auto raw, spilledFiles[i]->ReadAt(partitionSpillInfo.start, partitionSpillInfo.length));
-        RETURN_NOT_OK(dataFileOs_->Write(raw));
+        RETURN_NOT_OK(appendToDataFile(
+            spilledFiles[i]->file_descriptor(), partitionSpillInfo.start, partitionSpillInfo.length));
         // Goto next partition in this spillInfo
         spillInfoOffsets[i]++;
       }
@@ -384,11 +467,11 @@ arrow::Status PreferCachePartitionWriter::stop() {
   auto fs = std::make_shared<arrow::fs::LocalFileSystem>();
   for (auto i = 0; i < spills_.size(); ++i) {
     // Check if all spilled data are merged.
-    if (spillInfoOffsets[i] != spills_[i].partitionSpillInfos.size()) {
+    if (spillInfoOffsets[i] != spills_[i]->partitionSpillInfos.size()) {
       return arrow::Status::Invalid("Merging from spilled file NO." + std::to_string(i) + " is not exhausted.");
     }
     RETURN_NOT_OK(spilledFiles[i]->Close());
-    RETURN_NOT_OK(fs->DeleteFile(spills_[i].spilledFile));
+    RETURN_NOT_OK(fs->DeleteFile(spills_[i]->spilledFile));
   }
 
   ARROW_ASSIGN_OR_RAISE(totalBytesWritten, dataFileOs_->Tell());
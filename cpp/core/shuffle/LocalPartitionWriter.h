@@ -23,23 +23,45 @@
 #include "shuffle/ShuffleWriter.h"
 
 #include "PartitionWriterCreator.h"
+#include "SpillIoExecutor.h"
 #include "utils.h"
 #include "utils/macros.h"
 
 namespace gluten {
 
 class LocalPartitionWriterBase : public ShuffleWriter::PartitionWriter {
+ public:
+  int64_t inFlightBytes() override;
+
+  arrow::Status waitForEvicted() override;
+
  protected:
   explicit LocalPartitionWriterBase(ShuffleWriter* shuffleWriter) : PartitionWriter(shuffleWriter) {}
 
   arrow::Status setLocalDirs();
 
+  void initSpillExecutor();
+
+  // Runs write on the spill executor if async_spill is set, otherwise right away. bytes is the size of the payloads
+  // the write holds.
+  arrow::Status submitSpill(int64_t bytes, std::function<arrow::Status()> write);
+
+  // Adds the time of background spill writes to the evict time.
+  void collectSpillTime();
+
+  // Finishes the queued spill writes and joins the spill thread. The writes capture the derived writers, so their
+  // destructors call this before their members go away.
+  void stopSpillExecutor();
+
   std::string nextSpilledFileDir();
 
   arrow::Result<std::shared_ptr<arrow::ipc::IpcPayload>> getSchemaPayload(std::shared_ptr<arrow::Schema> schema);
 
   arrow::Status openDataFile();
 
+  // Appends a range of a spilled file to the data file, copied by the kernel.
+  arrow::Status appendToDataFile(int fd, int64_t offset, int64_t length);
+
   virtual arrow::Status clearResource();
 
   // configured local dirs for spilled file
@@ -50,12 +72,20 @@ class LocalPartitionWriterBase : public ShuffleWriter::PartitionWriter {
   // shared among all partitions
   std::shared_ptr<arrow::ipc::IpcPayload> schemaPayload_;
   std::shared_ptr<arrow::io::OutputStream> dataFileOs_;
+  // unbuffered stream under dataFileOs_
+  std::shared_ptr<arrow::io::FileOutputStream> dataFile_;
+
+  std::unique_ptr<SpillIoExecutor> spillExecutor_;
 };
 
 class PreferEvictPartitionWriter : public LocalPartitionWriterBase {
  public:
   explicit PreferEvictPartitionWriter(ShuffleWriter* shuffleWriter) : LocalPartitionWriterBase(shuffleWriter) {}
 
+  ~PreferEvictPartitionWriter() override {
+    stopSpillExecutor();
+  }
+
   arrow::Status init() override;
 
   arrow::Status evictPartition(int32_t partitionId) override;
@@ -74,10 +104,18 @@ class PreferCachePartitionWriter : public LocalPartitionWriterBase {
  public:
   explicit PreferCachePartitionWriter(ShuffleWriter* shuffleWriter) : LocalPartitionWriterBase(shuffleWriter) {}
 
+  ~PreferCachePartitionWriter() override {
+    stopSpillExecutor();
+  }
+
   arrow::Status init() override;
 
   arrow::Status evictPartition(int32_t partitionId) override;
 
+  bool canEvictPartition() const override {
+    return false;
+  }
+
   arrow::Status stop() override;
 
  private:
@@ -135,7 +173,12 @@ class PreferCachePartitionWriter : public LocalPartitionWriterBase {
     std::vector<PartitionSpillInfo> partitionSpillInfos;
   };
 
-  std::vector<SpillInfo> spills_;
+  using PartitionPayloads = std::vector<std::pair<int32_t, std::vector<std::shared_ptr<arrow::ipc::IpcPayload>>>>;
+
+  arrow::Status writeSpill(SpillInfo& spillInfo, PartitionPayloads& payloads);
+
+  // Filled by the spill writes, only read once they are done.
+  std::vector<std::shared_ptr<SpillInfo>> spills_;
   bool inStop_{false};
 };
 
@@ -28,10 +28,26 @@ class ShuffleWriter::PartitionWriter {
 
   virtual arrow::Status init() = 0;
 
+  // Spills the cached payloads of a partition, or of all partitions if partitionId is -1.
   virtual arrow::Status evictPartition(int32_t partitionId) = 0;
 
+  // Whether the payloads of a single partition can be spilled, rather than all of them at once.
+  virtual bool canEvictPartition() const {
+    return true;
+  }
+
   virtual arrow::Status stop() = 0;
 
+  // Bytes of evicted payloads whose write hasn't finished yet, their memory is still held.
+  virtual int64_t inFlightBytes() {
+    return 0;
+  }
+
+  // Blocks until all evicted payloads are written and their memory is released.
+  virtual arrow::Status waitForEvicted() {
+    return arrow::Status::OK();
+  }
+
   ShuffleWriter* shuffleWriter_;
 };
 
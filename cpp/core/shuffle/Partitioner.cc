@@ -24,10 +24,12 @@
 namespace gluten {
 arrow::Result<std::shared_ptr<ShuffleWriter::Partitioner>> ShuffleWriter::Partitioner::make(
     const std::string& name,
-    int32_t numPartitions) {
+    int32_t numPartitions,
+    bool supportAvx512) {
   std::shared_ptr<ShuffleWriter::Partitioner> partitioner = nullptr;
   if (name == "hash") {
-    partitioner = ShuffleWriter::Partitioner::create<HashPartitioner>(numPartitions, true);
+    partitioner = ShuffleWriter::Partitioner::create<HashPartitioner>(
+        numPartitions, true, HashPartitioner::detectKernel(supportAvx512));
   } else if (name == "rr") {
     partitioner = ShuffleWriter::Partitioner::create<RoundRobinPartitioner>(numPartitions, false);
   } else if (name == "range") {
@@ -17,31 +17,47 @@
 
 #pragma once
 
+#include <limits>
+#include <utility>
+
 #include "shuffle/ShuffleWriter.h"
 
 namespace gluten {
 
 class ShuffleWriter::Partitioner {
  public:
-  template <typename Partitioner>
-  static std::shared_ptr<Partitioner> create(int32_t numPartitions, bool hasPid) {
-    return std::make_shared<Partitioner>(numPartitions, hasPid);
+  template <typename Partitioner, typename... Args>
+  static std::shared_ptr<Partitioner> create(int32_t numPartitions, bool hasPid, Args&&... args) {
+    return std::make_shared<Partitioner>(numPartitions, hasPid, std::forward<Args>(args)...);
   }
 
+  // supportAvx512 allows AVX-512 kernels where the partitioner has them.
   static arrow::Result<std::shared_ptr<ShuffleWriter::Partitioner>> make(
       const std::string& name,
-      int32_t numPartitions);
+      int32_t numPartitions,
+      bool supportAvx512 = false);
   // whether the first column is partition key
   bool hasPid() {
     return hasPid_;
   }
 
+  // 16-bit partition ids are enough for up to 64k partitions, see needWidePartitionId.
   virtual arrow::Status compute(
       const int32_t* pidArr,
       const int64_t numRows,
       std::vector<uint16_t>& partitionId,
       std::vector<uint32_t>& partitionIdCnt) = 0;
 
+  virtual arrow::Status compute(
+      const int32_t* pidArr,
+      const int64_t numRows,
+      std::vector<uint32_t>& partitionId,
+      std::vector<uint32_t>& partitionIdCnt) = 0;
+
+  static bool needWidePartitionId(int32_t numPartitions) {
+    return numPartitions > std::numeric_limits<uint16_t>::max() + 1;
+  }
+
  protected:
   Partitioner(int32_t numPartitions, bool hasPid) : numPartitions_(numPartitions), hasPid_(hasPid) {}
   virtual ~Partitioner() = default;
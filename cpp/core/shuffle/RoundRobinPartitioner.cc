@@ -19,10 +19,11 @@
 
 namespace gluten {
 
-arrow::Status gluten::RoundRobinPartitioner::compute(
+template <typename T>
+arrow::Status gluten::RoundRobinPartitioner::computeImpl(
     const int32_t* pidArr,
     const int64_t numRows,
-    std::vector<uint16_t>& partitionId,
+    std::vector<T>& partitionId,
     std::vector<uint32_t>& partitionIdCnt) {
   std::fill(std::begin(partitionIdCnt), std::end(partitionIdCnt), 0);
   partitionId.resize(numRows);
@@ -33,4 +34,21 @@ arrow::Status gluten::RoundRobinPartitioner::compute(
   }
   return arrow::Status::OK();
 }
+
+arrow::Status gluten::RoundRobinPartitioner::compute(
+    const int32_t* pidArr,
+    const int64_t numRows,
+    std::vector<uint16_t>& partitionId,
+    std::vector<uint32_t>& partitionIdCnt) {
+  return computeImpl(pidArr, numRows, partitionId, partitionIdCnt);
+}
+
+arrow::Status gluten::RoundRobinPartitioner::compute(
+    const int32_t* pidArr,
+    const int64_t numRows,
+    std::vector<uint32_t>& partitionId,
+    std::vector<uint32_t>& partitionIdCnt) {
+  return computeImpl(pidArr, numRows, partitionId, partitionIdCnt);
+}
+
 } // namespace gluten
@@ -20,31 +20,47 @@
 #include <arrow/type.h>
 
 namespace gluten {
+// Adds a field per buffer of a column of `type`, the children of nested types following their parent's buffers. The
+// fields of the column `i` are suffixed with `i`, and those of its children with their path, e.g. `i.0`.
+inline void appendBufferFields(
+    const arrow::DataType& type,
+    const std::string& suffix,
+    std::vector<std::shared_ptr<arrow::Field>>& fields) {
+  fields.emplace_back(std::make_shared<arrow::Field>("nullBuffer" + suffix, arrow::large_utf8()));
+  switch (type.id()) {
+    case arrow::BinaryType::type_id:
+    case arrow::StringType::type_id:
+      fields.emplace_back(std::make_shared<arrow::Field>("offsetBuffer" + suffix, arrow::large_utf8()));
+      fields.emplace_back(std::make_shared<arrow::Field>("valueBuffer" + suffix, arrow::large_utf8()));
+      break;
+    case arrow::StructType::type_id:
+      for (int32_t i = 0; i < type.num_fields(); ++i) {
+        appendBufferFields(*type.field(i)->type(), suffix + "." + std::to_string(i), fields);
+      }
+      break;
+    case arrow::MapType::type_id: {
+      const auto& mapType = static_cast<const arrow::MapType&>(type);
+      fields.emplace_back(std::make_shared<arrow::Field>("offsetBuffer" + suffix, arrow::large_utf8()));
+      fields.emplace_back(std::make_shared<arrow::Field>("sizeBuffer" + suffix, arrow::large_utf8()));
+      appendBufferFields(*mapType.key_type(), suffix + ".0", fields);
+      appendBufferFields(*mapType.item_type(), suffix + ".1", fields);
+    } break;
+    case arrow::ListType::type_id:
+      fields.emplace_back(std::make_shared<arrow::Field>("offsetBuffer" + suffix, arrow::large_utf8()));
+      fields.emplace_back(std::make_shared<arrow::Field>("sizeBuffer" + suffix, arrow::large_utf8()));
+      appendBufferFields(*static_cast<const arrow::ListType&>(type).value_type(), suffix + ".0", fields);
+      break;
+    default:
+      fields.emplace_back(std::make_shared<arrow::Field>("valueBuffer" + suffix, arrow::large_utf8()));
+      break;
+  }
+}
+
 inline std::shared_ptr<arrow::Schema> toWriteSchema(arrow::Schema& schema) {
   std::vector<std::shared_ptr<arrow::Field>> fields;
   fields.emplace_back(std::make_shared<arrow::Field>("header", arrow::large_utf8()));
-  bool hasComplexType = false;
   for (int32_t i = 0; i < schema.num_fields(); i++) {
-    switch (schema.field(i)->type()->id()) {
-      case arrow::BinaryType::type_id:
-      case arrow::StringType::type_id: {
-        fields.emplace_back(std::make_shared<arrow::Field>("nullBuffer" + std::to_string(i), arrow::large_utf8()));
-        fields.emplace_back(std::make_shared<arrow::Field>("offsetBuffer" + std::to_string(i), arrow::large_utf8()));
-        fields.emplace_back(std::make_shared<arrow::Field>("valueBuffer" + std::to_string(i), arrow::large_utf8()));
-      } break;
-      case arrow::StructType::type_id:
-      case arrow::MapType::type_id:
-      case arrow::ListType::type_id:
-        hasComplexType = true;
-        break;
-      default:
-        fields.emplace_back(std::make_shared<arrow::Field>("nullBuffer" + std::to_string(i), arrow::large_utf8()));
-        fields.emplace_back(std::make_shared<arrow::Field>("valueBuffer" + std::to_string(i), arrow::large_utf8()));
-        break;
-    }
-  }
-  if (hasComplexType) {
-    fields.emplace_back(std::make_shared<arrow::Field>("complexBuffer", arrow::large_utf8()));
+    appendBufferFields(*schema.field(i)->type(), std::to_string(i), fields);
   }
   return std::make_shared<arrow::Schema>(fields);
 }
@@ -19,12 +19,16 @@
 
 #include <arrow/result.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 #include "ShuffleSchema.h"
 
 namespace gluten {
 
 #ifndef SPLIT_BUFFER_SIZE
-// by default, allocate 8M block, 2M page size
+// buffers larger than this aren't pooled
 #define SPLIT_BUFFER_SIZE 16 * 1024 * 1024
 #endif
 
@@ -32,21 +36,113 @@ ShuffleWriterOptions ShuffleWriterOptions::defaults() {
   return {};
 }
 
+namespace {
+
+// Four size classes per power of two, so that a buffer wastes at most a quarter of its size. The sizes stay 64-byte
+// aligned.
+int64_t roundUpToSizeClass(int64_t size) {
+  if (size <= 256) {
+    return std::max<int64_t>(64, (size + 63) & ~63);
+  }
+  auto step = int64_t(1) << (63 - __builtin_clzll(size - 1) - 2);
+  return (size + step - 1) & ~(step - 1);
+}
+
+} // namespace
+
+class ShuffleBufferPool::FreeLists {
+ public:
+  explicit FreeLists(std::shared_ptr<arrow::MemoryPool> pool) : pool_(std::move(pool)) {}
+
+  ~FreeLists() {
+    shrink(std::numeric_limits<int64_t>::max());
+  }
+
+  // Returns nullptr if the free list of the size class is empty.
+  uint8_t* acquire(int64_t sizeClass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(sizeClass);
+    if (it == blocks_.end() || it->second.empty()) {
+      return nullptr;
+    }
+    auto block = it->second.back();
+    it->second.pop_back();
+    freeBytes_ -= sizeClass;
+    return block;
+  }
+
+  // Buffers may be released by the thread writing the spilled payloads.
+  void release(int64_t sizeClass, uint8_t* block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_[sizeClass].push_back(block);
+    freeBytes_ += sizeClass;
+  }
+
+  int64_t shrink(int64_t target) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t freed = 0;
+    for (auto it = blocks_.rbegin(); it != blocks_.rend() && freed < target; ++it) {
+      auto sizeClass = it->first;
+      auto& blocks = it->second;
+      while (!blocks.empty() && freed < target) {
+        pool_->Free(blocks.back(), sizeClass);
+        blocks.pop_back();
+        freed += sizeClass;
+      }
+    }
+    freeBytes_ -= freed;
+    return freed;
+  }
+
+  int64_t freeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return freeBytes_;
+  }
+
+ private:
+  std::shared_ptr<arrow::MemoryPool> pool_;
+  mutable std::mutex mutex_;
+  // Size class -> free buffers.
+  std::map<int64_t, std::vector<uint8_t*>> blocks_;
+  int64_t freeBytes_ = 0;
+};
+
+namespace {
+
+// A buffer going back to the free list of its size class when destroyed.
+class PooledBuffer final : public arrow::MutableBuffer {
+ public:
+  PooledBuffer(std::shared_ptr<ShuffleBufferPool::FreeLists> freeLists, uint8_t* block, int64_t sizeClass)
+      : arrow::MutableBuffer(block, sizeClass), freeLists_(std::move(freeLists)), block_(block) {}
+
+  ~PooledBuffer() override {
+    freeLists_->release(capacity_, block_);
+  }
+
+ private:
+  std::shared_ptr<ShuffleBufferPool::FreeLists> freeLists_;
+  uint8_t* block_;
+};
+
+} // namespace
+
+ShuffleBufferPool::ShuffleBufferPool(std::shared_ptr<arrow::MemoryPool> pool)
+    : pool_(pool), freeLists_(std::make_shared<FreeLists>(pool)) {}
+
 arrow::Status ShuffleBufferPool::allocate(std::shared_ptr<arrow::Buffer>& buffer, uint32_t size) {
   // if size is already larger than buffer pool size, allocate it directly
-  // make size 64byte aligned
-  auto reminder = size & 0x3f;
-  size += (64 - reminder) & ((reminder == 0) - 1);
   if (size > SPLIT_BUFFER_SIZE) {
-    ARROW_ASSIGN_OR_RAISE(buffer, arrow::AllocateResizableBuffer(size, pool_.get()));
-    return arrow::Status::OK();
-  } else if (combineBuffer_->capacity() - combineBuffer_->size() < size) {
-    // memory pool is not enough
-    ARROW_ASSIGN_OR_RAISE(combineBuffer_, arrow::AllocateResizableBuffer(SPLIT_BUFFER_SIZE, pool_.get()));
-    RETURN_NOT_OK(combineBuffer_->Resize(0, /*shrink_to_fit = */ false));
+    return allocateDirectly(buffer, size);
+  }
+  auto sizeClass = roundUpToSizeClass(size);
+  auto block = freeLists_->acquire(sizeClass);
+  if (block != nullptr) {
+    numHits_++;
+  } else {
+    RETURN_NOT_OK(pool_->Allocate(sizeClass, &block));
+    numMisses_++;
   }
-  buffer = arrow::SliceMutableBuffer(combineBuffer_, combineBuffer_->size(), size);
-  RETURN_NOT_OK(combineBuffer_->Resize(combineBuffer_->size() + size, /*shrink_to_fit = */ false));
+  buffer = std::make_shared<PooledBuffer>(freeLists_, block, sizeClass);
   return arrow::Status::OK();
 }
 
@@ -57,6 +153,14 @@ arrow::Status ShuffleBufferPool::allocateDirectly(std::shared_ptr<arrow::Buffer>
   return arrow::Status::OK();
 }
 
+int64_t ShuffleBufferPool::shrink(int64_t target) {
+  return freeLists_->shrink(target);
+}
+
+int64_t ShuffleBufferPool::freeBytes() const {
+  return freeLists_->freeBytes();
+}
+
 std::shared_ptr<arrow::Schema> ShuffleWriter::writeSchema() {
   if (writeSchema_ != nullptr) {
     return writeSchema_;
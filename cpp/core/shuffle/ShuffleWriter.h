@@ -18,17 +18,23 @@
 #pragma once
 
 #include <arrow/ipc/writer.h>
+#include <limits>
 #include <numeric>
 #include <utility>
 
 #include "memory/ArrowMemoryPool.h"
 #include "memory/ColumnarBatch.h"
+#include "shuffle/EvictionPolicy.h"
 
 namespace gluten {
 
 static constexpr int32_t kDefaultShuffleWriterBufferSize = 4096;
 static constexpr int32_t kDefaultNumSubDirs = 64;
 static constexpr int32_t kDefaultBatchCompressThreshold = 256;
+static constexpr double kDefaultCompressionMinSavings = -1;
+static constexpr int32_t kDefaultCompressionMaxBackoff = 16;
+static constexpr int64_t kDefaultSortBufferMaxSize = 64 * 1024 * 1024;
+static constexpr int64_t kDefaultAsyncSpillMaxInFlightBytes = 64 * 1024 * 1024;
 
 struct ShuffleWriterOptions {
   int64_t offheap_per_task = 0;
@@ -37,11 +43,31 @@ struct ShuffleWriterOptions {
   int32_t num_sub_dirs = kDefaultNumSubDirs;
   int32_t batch_compress_threshold = kDefaultBatchCompressThreshold;
   arrow::Compression::type compression_type = arrow::Compression::LZ4_FRAME;
+  int32_t compression_level = arrow::util::kUseDefaultCompressionLevel;
+
+  // Buffers saving less than this fraction of their size when compressed are written uncompressed, so that they
+  // aren't decompressed on read. Payloads saving less skip compression for the next few payloads, at most
+  // compression_max_backoff of them. A negative value, the default, compresses everything.
+  double compression_min_savings = kDefaultCompressionMinSavings;
+  int32_t compression_max_backoff = kDefaultCompressionMaxBackoff;
 
   bool prefer_evict = true;
   bool write_schema = true; // just used in test
   bool buffered_write = false;
 
+  // Sort-based split: buffer whole input batches and sort rows by partition id instead of
+  // keeping one set of buffers per partition. Memory is bounded by sort_buffer_max_size.
+  bool sort_based = false;
+  int64_t sort_buffer_max_size = kDefaultSortBufferMaxSize;
+
+  // Write spilled payloads on a background thread. Evicted payloads stay in memory until written, at most
+  // async_spill_max_inflight_bytes of them at a time.
+  bool async_spill = false;
+  int64_t async_spill_max_inflight_bytes = kDefaultAsyncSpillMaxInFlightBytes;
+
+  // Which memory to release first when the writer is asked to free some, see EvictionPolicy.
+  std::string eviction_policy = kLargestFirstEvictionPolicy;
+
   std::string data_file;
   std::string partition_writer_type = "local";
 
@@ -60,32 +86,47 @@ struct ShuffleWriterOptions {
   static ShuffleWriterOptions defaults();
 };
 
+// Allocates the partition buffers. Buffers up to SPLIT_BUFFER_SIZE are rounded up to a size class and go back to the
+// free list of their size class once released, the next allocation of that size class reuses them. The free lists are
+// shared by all partitions of a writer.
 class ShuffleBufferPool {
  public:
-  explicit ShuffleBufferPool(std::shared_ptr<arrow::MemoryPool> pool) : pool_(pool) {}
-
-  arrow::Status init() {
-    // Allocate first buffer for split reducer
-    ARROW_ASSIGN_OR_RAISE(combineBuffer_, arrow::AllocateResizableBuffer(0, pool_.get()));
-    RETURN_NOT_OK(combineBuffer_->Resize(0, /*shrink_to_fit =*/false));
-    return arrow::Status::OK();
-  }
+  explicit ShuffleBufferPool(std::shared_ptr<arrow::MemoryPool> pool);
 
   arrow::Status allocate(std::shared_ptr<arrow::Buffer>& buffer, uint32_t size);
 
   arrow::Status allocateDirectly(std::shared_ptr<arrow::Buffer>& buffer, uint32_t size);
 
+  // Frees the buffers held in the free lists, the largest first, until at least `target` bytes are freed. Returns the
+  // bytes freed.
+  int64_t shrink(int64_t target = std::numeric_limits<int64_t>::max());
+
   void reset() {
-    if (combineBuffer_ != nullptr) {
-      combineBuffer_.reset();
-    }
+    shrink();
+  }
+
+  // Bytes held in the free lists.
+  int64_t freeBytes() const;
+
+  // Allocations served from the free lists.
+  int64_t numHits() const {
+    return numHits_;
+  }
+
+  // Allocations served from the memory pool.
+  int64_t numMisses() const {
+    return numMisses_;
   }
 
+  class FreeLists;
+
  private:
   std::shared_ptr<arrow::MemoryPool> pool_;
-  // slice the buffer for each reducer's column, in this way we can combine into
-  // large page
-  std::shared_ptr<arrow::ResizableBuffer> combineBuffer_;
+  // Buffers still in use when the pool is destroyed return to the free lists, which free them last.
+  std::shared_ptr<FreeLists> freeLists_;
+
+  int64_t numHits_ = 0;
+  int64_t numMisses_ = 0;
 };
 
 class ShuffleWriter {
@@ -146,6 +187,10 @@ class ShuffleWriter {
     return totalCompressTime_;
   }
 
+  int64_t numSpills() const {
+    return numSpills_;
+  }
+
   const std::vector<int64_t>& partitionLengths() const {
     return partitionLengths_;
   }
@@ -234,6 +279,7 @@ class ShuffleWriter {
   int64_t totalWriteTime_ = 0;
   int64_t totalEvictTime_ = 0;
   int64_t totalCompressTime_ = 0;
+  int64_t numSpills_ = 0;
   int64_t peakMemoryAllocated_ = 0;
 
   std::vector<int64_t> partitionLengths_;
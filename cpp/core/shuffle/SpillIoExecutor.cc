@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shuffle/SpillIoExecutor.h"
+
+#include "utils/macros.h"
+
+namespace gluten {
+
+SpillIoExecutor::SpillIoExecutor(int64_t maxInFlightBytes)
+    : maxInFlightBytes_(maxInFlightBytes), thread_([this] { run(); }) {}
+
+SpillIoExecutor::~SpillIoExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  taskAdded_.notify_one();
+  thread_.join();
+}
+
+arrow::Status SpillIoExecutor::submit(int64_t bytes, std::function<arrow::Status()> task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  RETURN_NOT_OK(status_);
+  // Always admit one task, otherwise a single payload larger than the limit could never be written.
+  taskDone_.wait(lock, [&] { return inFlightBytes_ == 0 || inFlightBytes_ + bytes <= maxInFlightBytes_; });
+  inFlightBytes_ += bytes;
+  tasks_.emplace_back(bytes, std::move(task));
+  lock.unlock();
+  taskAdded_.notify_one();
+  return arrow::Status::OK();
+}
+
+arrow::Status SpillIoExecutor::waitAll() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  taskDone_.wait(lock, [&] { return tasks_.empty() && !running_; });
+  return status_;
+}
+
+int64_t SpillIoExecutor::inFlightBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return inFlightBytes_;
+}
+
+int64_t SpillIoExecutor::writeTime() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writeTime_;
+}
+
+void SpillIoExecutor::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    taskAdded_.wait(lock, [&] { return !tasks_.empty() || stopped_; });
+    if (tasks_.empty()) {
+      return;
+    }
+    auto [bytes, task] = std::move(tasks_.front());
+    tasks_.pop_front();
+    running_ = true;
+    lock.unlock();
+
+    int64_t taskTime = 0;
+    arrow::Status status;
+    TIME_NANO_START(taskTime)
+    // Once a write failed the spill files are unusable, drop the remaining tasks but still release their payloads.
+    status = status_.ok() ? task() : arrow::Status::OK();
+    TIME_NANO_END(taskTime)
+    // Destroy the task, and with it the payloads it captured, before the bytes are released.
+    task = nullptr;
+
+    lock.lock();
+    running_ = false;
+    inFlightBytes_ -= bytes;
+    writeTime_ += taskTime;
+    if (status_.ok() && !status.ok()) {
+      status_ = status;
+    }
+    taskDone_.notify_all();
+  }
+}
+
+} // namespace gluten
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/status.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace gluten {
+
+// Runs the spill writes of one partition writer on a background thread, in submission order, so the task thread
+// can keep splitting and compressing while a previous payload is written. The bytes held by queued writes are
+// accounted until the write finishes, and submit() blocks while they exceed maxInFlightBytes.
+class SpillIoExecutor {
+ public:
+  explicit SpillIoExecutor(int64_t maxInFlightBytes);
+
+  ~SpillIoExecutor();
+
+  // bytes: payload memory owned by the task until it finishes.
+  arrow::Status submit(int64_t bytes, std::function<arrow::Status()> task);
+
+  // Waits for all submitted tasks. Returns the first error raised by any of them.
+  arrow::Status waitAll();
+
+  int64_t inFlightBytes();
+
+  // Time spent in background writes, in nanoseconds.
+  int64_t writeTime();
+
+ private:
+  void run();
+
+  const int64_t maxInFlightBytes_;
+
+  std::mutex mutex_;
+  std::condition_variable taskAdded_;
+  std::condition_variable taskDone_;
+  std::deque<std::pair<int64_t, std::function<arrow::Status()>>> tasks_;
+  int64_t inFlightBytes_ = 0;
+  int64_t writeTime_ = 0;
+  arrow::Status status_;
+  bool running_ = false;
+  bool stopped_ = false;
+
+  std::thread thread_;
+};
+
+} // namespace gluten
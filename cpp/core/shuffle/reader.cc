@@ -35,7 +35,7 @@ Reader::Reader(
     std::shared_ptr<arrow::Schema> schema,
     ReaderOptions options,
     std::shared_ptr<arrow::MemoryPool> pool)
-    : pool_(pool), in_(std::move(in)), options_(std::move(options)) {
+    : options_(std::move(options)), pool_(pool), in_(std::move(in)) {
   GLUTEN_ASSIGN_OR_THROW(firstMessage_, arrow::ipc::ReadMessage(in_.get()))
   if (firstMessage_ == nullptr) {
     throw GlutenException("Failed to read message from shuffle.");
@@ -77,4 +77,8 @@ int64_t Reader::getDecompressTime() {
   return decompressTime_;
 }
 
+int64_t Reader::getCoalesceTime() {
+  return coalesceTime_;
+}
+
 } // namespace gluten
@@ -24,9 +24,16 @@
 
 namespace gluten {
 
+static constexpr int64_t kDefaultCoalesceBatchMaxBytes = 16 * 1024 * 1024;
+
 struct ReaderOptions {
   arrow::ipc::IpcReadOptions ipc_read_options = arrow::ipc::IpcReadOptions::Defaults();
 
+  // Concatenate consecutive batches of a partition until coalesce_batch_size rows or coalesce_batch_max_bytes bytes
+  // are reached. Disabled if coalesce_batch_size is 0. Only supported by backends that override Reader::next.
+  int32_t coalesce_batch_size = 0;
+  int64_t coalesce_batch_max_bytes = kDefaultCoalesceBatchMaxBytes;
+
   static ReaderOptions defaults();
 };
 
@@ -43,11 +50,15 @@ class Reader {
   virtual arrow::Result<std::shared_ptr<ColumnarBatch>> next();
   arrow::Status close();
   int64_t getDecompressTime();
+  int64_t getCoalesceTime();
+
+ protected:
+  ReaderOptions options_;
+  int64_t coalesceTime_ = 0;
 
  private:
   std::shared_ptr<arrow::MemoryPool> pool_;
   std::shared_ptr<arrow::io::InputStream> in_;
-  ReaderOptions options_;
   std::shared_ptr<arrow::Schema> writeSchema_;
   std::unique_ptr<arrow::ipc::Message> firstMessage_;
   bool firstMessageConsumed_ = false;
@@ -20,6 +20,11 @@
 namespace gluten {
 
 arrow::Status CelebornPartitionWriter::init() {
+  ARROW_ASSIGN_OR_RAISE(
+      pushBuffer_,
+      arrow::AllocateResizableBuffer(
+          shuffleWriter_->options().buffer_size, shuffleWriter_->options().memory_pool.get()));
+  celebornBufferOs_ = std::make_shared<arrow::io::BufferOutputStream>(pushBuffer_);
   return arrow::Status::OK();
 }
 
@@ -27,21 +32,31 @@ arrow::Status CelebornPartitionWriter::evictPartition(int32_t partitionId) {
   int64_t tempTotalTime = 0;
   TIME_NANO_OR_RAISE(tempTotalTime, writeArrowToOutputStream(partitionId));
   shuffleWriter_->setTotalWriteTime(shuffleWriter_->totalWriteTime() + tempTotalTime);
-  TIME_NANO_OR_RAISE(tempTotalTime, pushPartition(partitionId));
-  shuffleWriter_->setTotalEvictTime(shuffleWriter_->totalEvictTime() + tempTotalTime);
+  // Small partitions are batched into one push, up to the size Celeborn merges data for before pushing itself.
+  ARROW_ASSIGN_OR_RAISE(auto pending, celebornBufferOs_->Tell());
+  if (pending >= shuffleWriter_->options().push_buffer_max_size) {
+    TIME_NANO_OR_RAISE(tempTotalTime, pushPartitions());
+    shuffleWriter_->setTotalEvictTime(shuffleWriter_->totalEvictTime() + tempTotalTime);
+  }
   return arrow::Status::OK();
 };
 
-arrow::Status CelebornPartitionWriter::pushPartition(int32_t partitionId) {
-  auto buffer = celebornBufferOs_->Finish();
-  int32_t size = buffer->get()->size();
-  char* dst = reinterpret_cast<char*>(buffer->get()->mutable_data());
-  celebornClient_->pushPartitonData(partitionId, dst, size);
-  shuffleWriter_->partitionCachedRecordbatch()[partitionId].clear();
-  shuffleWriter_->setPartitionCachedRecordbatchSize(partitionId, 0);
-  shuffleWriter_->setPartitionLengths(partitionId, shuffleWriter_->partitionLengths()[partitionId] + size);
+arrow::Status CelebornPartitionWriter::pushPartitions() {
+  if (pushPartitionIds_.empty()) {
+    return arrow::Status::OK();
+  }
+  // Finishing keeps the capacity of pushBuffer_, it is written from the start again after the push.
+  ARROW_ASSIGN_OR_RAISE(auto buffer, celebornBufferOs_->Finish());
+  celebornClient_->pushPartitionsData(pushPartitionIds_, pushLengths_, reinterpret_cast<char*>(buffer->mutable_data()));
+  pushPartitionIds_.clear();
+  pushLengths_.clear();
+  // A single large partition can grow pushBuffer_ far beyond the push threshold, don't hold that memory until stop.
+  if (pushBuffer_->capacity() > 2 * static_cast<int64_t>(shuffleWriter_->options().push_buffer_max_size)) {
+    RETURN_NOT_OK(pushBuffer_->Resize(0, /*shrink_to_fit=*/true));
+  }
+  celebornBufferOs_ = std::make_shared<arrow::io::BufferOutputStream>(pushBuffer_);
   return arrow::Status::OK();
-};
+}
 
 arrow::Status CelebornPartitionWriter::stop() {
   // push data and collect metrics
@@ -52,16 +67,16 @@ arrow::Status CelebornPartitionWriter::stop() {
     }
     shuffleWriter_->setTotalBytesWritten(shuffleWriter_->totalBytesWritten() + shuffleWriter_->partitionLengths()[pid]);
   }
+  int64_t tempTotalTime = 0;
+  TIME_NANO_OR_RAISE(tempTotalTime, pushPartitions());
+  shuffleWriter_->setTotalEvictTime(shuffleWriter_->totalEvictTime() + tempTotalTime);
   shuffleWriter_->pool()->reset();
   shuffleWriter_->partitionBuffer().clear();
   return arrow::Status::OK();
 };
 
 arrow::Status CelebornPartitionWriter::writeArrowToOutputStream(int32_t partitionId) {
-  ARROW_ASSIGN_OR_RAISE(
-      celebornBufferOs_,
-      arrow::io::BufferOutputStream::Create(
-          shuffleWriter_->options().buffer_size, shuffleWriter_->options().memory_pool.get()));
+  ARROW_ASSIGN_OR_RAISE(auto start, celebornBufferOs_->Tell());
   int32_t metadataLength = 0; // unused
 #ifndef SKIPWRITE
   for (auto& payload : shuffleWriter_->partitionCachedRecordbatch()[partitionId]) {
@@ -70,6 +85,16 @@ arrow::Status CelebornPartitionWriter::writeArrowToOutputStream(int32_t partitio
     payload = nullptr;
   }
 #endif
+  shuffleWriter_->partitionCachedRecordbatch()[partitionId].clear();
+  shuffleWriter_->setPartitionCachedRecordbatchSize(partitionId, 0);
+
+  ARROW_ASSIGN_OR_RAISE(auto end, celebornBufferOs_->Tell());
+  auto length = static_cast<int32_t>(end - start);
+  if (length > 0) {
+    pushPartitionIds_.push_back(partitionId);
+    pushLengths_.push_back(length);
+    shuffleWriter_->setPartitionLengths(partitionId, shuffleWriter_->partitionLengths()[partitionId] + length);
+  }
   return arrow::Status::OK();
 }
 
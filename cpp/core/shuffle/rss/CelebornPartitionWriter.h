@@ -41,11 +41,16 @@ class CelebornPartitionWriter : public RemotePartitionWriter {
 
   arrow::Status stop() override;
 
-  arrow::Status pushPartition(int32_t partitionId);
+  // Pushes the partitions serialized since the last push in one call.
+  arrow::Status pushPartitions();
 
+  // Appends the cached payloads of the partition to the push buffer.
   arrow::Status writeArrowToOutputStream(int32_t partitionId);
 
+  std::shared_ptr<arrow::ResizableBuffer> pushBuffer_;
   std::shared_ptr<arrow::io::BufferOutputStream> celebornBufferOs_;
+  std::vector<int32_t> pushPartitionIds_;
+  std::vector<int32_t> pushLengths_;
 
   std::shared_ptr<CelebornClient> celebornClient_;
 };
@@ -24,6 +24,9 @@
 #include <arrow/ipc/writer.h>
 #include <arrow/type.h>
 #include <arrow/util/io_util.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
 
 #include <bits/stdc++.h>
 #include <boost/uuid/uuid_generators.hpp>
@@ -163,4 +166,37 @@ static inline int64_t getBufferSizes(const std::shared_ptr<arrow::Array>& array)
       });
 }
 
+// Appends `length` bytes of inFd starting at inOffset to outFd at its current file offset. The copy is done in the
+// kernel by copy_file_range, or sendfile where the former isn't available (e.g. across file systems on old kernels).
+static inline arrow::Status copyFileRange(int inFd, int64_t inOffset, int outFd, int64_t length) {
+  off_t offset = inOffset;
+  bool useSendfile = false;
+  while (length > 0) {
+    ssize_t copied = -1;
+    if (!useSendfile) {
+      loff_t loffset = offset;
+      copied = ::copy_file_range(inFd, &loffset, outFd, nullptr, length, 0);
+      if (copied < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+        useSendfile = true;
+        continue;
+      }
+    } else {
+      off_t soffset = offset;
+      copied = ::sendfile(outFd, inFd, &soffset, length);
+    }
+    if (copied < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return arrow::Status::IOError("Failed to copy spilled data: ", strerror(errno));
+    }
+    if (copied == 0) {
+      return arrow::Status::IOError("Unexpected end of spilled file at offset ", offset);
+    }
+    offset += copied;
+    length -= copied;
+  }
+  return arrow::Status::OK();
+}
+
 } // namespace gluten
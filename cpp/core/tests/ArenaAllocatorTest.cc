@@ -0,0 +1,221 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory/ArenaAllocator.h"
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+namespace gluten {
+
+namespace {
+
+constexpr int64_t kChunkSize = ArenaMemoryAllocator::kHugePageSize;
+
+uintptr_t chunkOf(void* p) {
+  return reinterpret_cast<uintptr_t>(p) & ~(kChunkSize - 1);
+}
+
+bool isMapped(void* p) {
+  auto pageSize = sysconf(_SC_PAGESIZE);
+  auto page = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(p) & ~(pageSize - 1));
+  unsigned char residency;
+  return mincore(page, pageSize, &residency) == 0 || errno != ENOMEM;
+}
+
+} // namespace
+
+TEST(ArenaAllocatorTest, reallocateInPlace) {
+  ArenaMemoryAllocator allocator(kChunkSize);
+  void* p;
+  ASSERT_TRUE(allocator.allocate(100, &p));
+  memset(p, 'a', 100);
+
+  // The last allocation of the chunk grows and shrinks without moving.
+  void* grown;
+  ASSERT_TRUE(allocator.reallocate(p, 100, 1000, &grown));
+  ASSERT_EQ(grown, p);
+  ASSERT_EQ(allocator.getUsedBytes(), 1000);
+  void* shrunk;
+  ASSERT_TRUE(allocator.reallocate(grown, 1000, 10, &shrunk));
+  ASSERT_EQ(shrunk, p);
+  ASSERT_EQ(allocator.getUsedBytes(), 10);
+  ASSERT_EQ(static_cast<char*>(shrunk)[9], 'a');
+
+  // Other allocations are copied.
+  void* next;
+  ASSERT_TRUE(allocator.allocate(10, &next));
+  void* moved;
+  ASSERT_TRUE(allocator.reallocate(shrunk, 10, 20, &moved));
+  ASSERT_NE(moved, shrunk);
+  ASSERT_EQ(std::string(static_cast<char*>(moved), 10), std::string(10, 'a'));
+  ASSERT_EQ(allocator.getUsedBytes(), 30);
+  ASSERT_EQ(allocator.getBytes(), kChunkSize);
+}
+
+TEST(ArenaAllocatorTest, reallocateAcrossChunks) {
+  ArenaMemoryAllocator allocator(kChunkSize);
+  constexpr int64_t kSize = 400'000;
+  void* p[5];
+  for (auto& allocation : p) {
+    ASSERT_TRUE(allocator.allocate(kSize, &allocation));
+    ASSERT_EQ(chunkOf(allocation), chunkOf(p[0]));
+  }
+  memset(p[4], 'b', kSize);
+
+  // Growing the last allocation past the end of the chunk moves it to a new chunk.
+  constexpr int64_t kNewSize = 520'000;
+  void* moved;
+  ASSERT_TRUE(allocator.reallocate(p[4], kSize, kNewSize, &moved));
+  ASSERT_NE(chunkOf(moved), chunkOf(p[0]));
+  ASSERT_EQ(std::string(static_cast<char*>(moved), kSize), std::string(kSize, 'b'));
+  ASSERT_EQ(allocator.getUsedBytes(), 4 * kSize + kNewSize);
+  ASSERT_EQ(allocator.getBytes(), 2 * kChunkSize);
+
+  for (auto i = 0; i < 4; ++i) {
+    ASSERT_TRUE(allocator.free(p[i], kSize));
+  }
+  ASSERT_TRUE(allocator.free(moved, kNewSize));
+  ASSERT_EQ(allocator.getUsedBytes(), 0);
+}
+
+TEST(ArenaAllocatorTest, largeAllocation) {
+  ArenaMemoryAllocator allocator(kChunkSize);
+  for (auto size : {kChunkSize / 4 + 1, kChunkSize, 3 * kChunkSize + 1}) {
+    void* p;
+    ASSERT_TRUE(allocator.allocate(size, &p));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % ArenaMemoryAllocator::kHugePageSize, 0);
+    memset(p, 'c', size);
+    // Mapped separately, rounded up to huge pages.
+    auto mappedSize = (size + ArenaMemoryAllocator::kHugePageSize - 1) & ~(ArenaMemoryAllocator::kHugePageSize - 1);
+    ASSERT_EQ(allocator.getBytes(), mappedSize);
+    ASSERT_EQ(allocator.getUsedBytes(), size);
+    ASSERT_TRUE(allocator.free(p, size));
+    ASSERT_EQ(allocator.getBytes(), 0);
+    ASSERT_EQ(allocator.getUsedBytes(), 0);
+  }
+
+  // A small allocation growing large moves out of its chunk.
+  void* p;
+  ASSERT_TRUE(allocator.allocate(100, &p));
+  memset(p, 'd', 100);
+  void* large;
+  ASSERT_TRUE(allocator.reallocate(p, 100, kChunkSize, &large));
+  ASSERT_NE(chunkOf(large), chunkOf(p));
+  ASSERT_EQ(std::string(static_cast<char*>(large), 100), std::string(100, 'd'));
+  ASSERT_EQ(allocator.getBytes(), 2 * kChunkSize);
+  ASSERT_TRUE(allocator.free(large, kChunkSize));
+  ASSERT_EQ(allocator.getBytes(), kChunkSize);
+}
+
+TEST(ArenaAllocatorTest, chunkReuse) {
+  ArenaMemoryAllocator allocator(kChunkSize);
+  constexpr int64_t kSize = kChunkSize / 4;
+  void* first[4];
+  for (auto& p : first) {
+    ASSERT_TRUE(allocator.allocate(kSize, &p));
+  }
+  // The first chunk is full, the next allocation opens a second one.
+  void* second;
+  ASSERT_TRUE(allocator.allocate(kSize, &second));
+  ASSERT_NE(chunkOf(second), chunkOf(first[0]));
+  ASSERT_EQ(allocator.getBytes(), 2 * kChunkSize);
+
+  // Once empty, the first chunk is cached and taken again instead of mapping a third one.
+  for (auto& p : first) {
+    ASSERT_TRUE(allocator.free(p, kSize));
+  }
+  ASSERT_EQ(allocator.getBytes(), 2 * kChunkSize);
+  void* more[3];
+  for (auto& p : more) {
+    ASSERT_TRUE(allocator.allocate(kSize, &p));
+    ASSERT_EQ(chunkOf(p), chunkOf(second));
+  }
+  void* reused;
+  ASSERT_TRUE(allocator.allocate(kSize, &reused));
+  ASSERT_EQ(chunkOf(reused), chunkOf(first[0]));
+  ASSERT_EQ(allocator.getBytes(), 2 * kChunkSize);
+
+  // The current chunk is reset when all its allocations are freed.
+  ASSERT_TRUE(allocator.free(reused, kSize));
+  void* again;
+  ASSERT_TRUE(allocator.allocate(kSize, &again));
+  ASSERT_EQ(again, reused);
+}
+
+TEST(ArenaAllocatorTest, allocateZeroFilledOnReusedChunk) {
+  ArenaMemoryAllocator allocator(kChunkSize);
+  constexpr int64_t kSize = 4096;
+  void* p;
+  ASSERT_TRUE(allocator.allocate(kSize, &p));
+  memset(p, 0xff, kSize);
+  ASSERT_TRUE(allocator.free(p, kSize));
+
+  void* zeroed;
+  ASSERT_TRUE(allocator.allocateZeroFilled(kSize / 8, 8, &zeroed));
+  ASSERT_EQ(zeroed, p);
+  auto data = static_cast<unsigned char*>(zeroed);
+  for (auto i = 0; i < kSize; ++i) {
+    ASSERT_EQ(data[i], 0) << "at " << i;
+  }
+}
+
+TEST(ArenaAllocatorTest, getBytes) {
+  ArenaMemoryAllocator allocator(kChunkSize);
+  ASSERT_EQ(allocator.getBytes(), 0);
+
+  void* small;
+  ASSERT_TRUE(allocator.allocate(10, &small));
+  ASSERT_EQ(allocator.getBytes(), kChunkSize);
+  ASSERT_EQ(allocator.getUsedBytes(), 10);
+
+  ASSERT_TRUE(allocator.reserveBytes(100));
+  ASSERT_EQ(allocator.getBytes(), kChunkSize + 100);
+  ASSERT_TRUE(allocator.unreserveBytes(100));
+
+  // Freed allocations stay accounted for as long as their chunk is mapped.
+  ASSERT_TRUE(allocator.free(small, 10));
+  ASSERT_EQ(allocator.getUsedBytes(), 0);
+  ASSERT_EQ(allocator.getBytes(), kChunkSize);
+
+  void* aligned;
+  ASSERT_TRUE(allocator.allocateAligned(4096, 10, &aligned));
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned) % 4096, 0);
+  ASSERT_EQ(allocator.getBytes(), kChunkSize);
+}
+
+TEST(ArenaAllocatorTest, unmapOnDestruction) {
+  auto allocator = std::make_unique<ArenaMemoryAllocator>(kChunkSize);
+  void* small;
+  void* large;
+  ASSERT_TRUE(allocator->allocate(100, &small));
+  ASSERT_TRUE(allocator->allocate(kChunkSize, &large));
+  ASSERT_TRUE(isMapped(small));
+  ASSERT_TRUE(isMapped(large));
+
+  // Leaked allocations are unmapped with the arena.
+  allocator.reset();
+  ASSERT_FALSE(isMapped(small));
+  ASSERT_FALSE(isMapped(large));
+}
+
+} // namespace gluten
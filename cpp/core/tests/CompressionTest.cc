@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/compression.h"
+
+#include <gtest/gtest.h>
+
+namespace gluten {
+
+class CompressionTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    // The registry is global, the codecs replaced by a test would leak into the next ones.
+    for (auto& [type, factory] : replacedFactories_) {
+      registerArrowIpcCodec(type, std::move(factory));
+    }
+    replacedFactories_.clear();
+  }
+
+  void replaceCodec(arrow::Compression::type type, ArrowIpcCodecFactory factory) {
+    auto replaced = registerArrowIpcCodec(type, std::move(factory));
+    // Only the first replacement of a type holds the original factory.
+    replacedFactories_.emplace(type, std::move(replaced));
+  }
+
+ private:
+  std::unordered_map<arrow::Compression::type, ArrowIpcCodecFactory> replacedFactories_;
+};
+
+TEST_F(CompressionTest, codecRegistry) {
+  auto codec = createArrowIpcCodec(arrow::Compression::ZSTD, 3);
+  ASSERT_TRUE(codec.ok());
+  ASSERT_EQ((*codec)->compression_type(), arrow::Compression::ZSTD);
+  ASSERT_EQ((*codec)->compression_level(), 3);
+  ASSERT_EQ(*createArrowIpcCodec(arrow::Compression::UNCOMPRESSED), nullptr);
+
+  int32_t requestedLevel = 0;
+  replaceCodec(arrow::Compression::LZ4_FRAME, [&requestedLevel](int32_t level) {
+    requestedLevel = level;
+    return arrow::util::Codec::Create(arrow::Compression::LZ4_FRAME);
+  });
+  ASSERT_TRUE(createArrowIpcCodec(arrow::Compression::LZ4_FRAME, 5).ok());
+  ASSERT_EQ(requestedLevel, 5);
+}
+
+TEST_F(CompressionTest, compressibilitySampler) {
+  CompressibilitySampler sampler(0.1, 4);
+  ASSERT_TRUE(sampler.shouldCompress());
+  sampler.update(100, 50);
+  ASSERT_TRUE(sampler.shouldCompress());
+
+  // Skips one payload, then two, then up to four while compression doesn't pay off.
+  sampler.update(100, 95);
+  ASSERT_FALSE(sampler.shouldCompress());
+  ASSERT_TRUE(sampler.shouldCompress());
+  sampler.update(100, 95);
+  ASSERT_FALSE(sampler.shouldCompress());
+  ASSERT_FALSE(sampler.shouldCompress());
+  ASSERT_TRUE(sampler.shouldCompress());
+  sampler.update(100, 100);
+  sampler.update(100, 100);
+  for (int32_t i = 0; i < 4; ++i) {
+    ASSERT_FALSE(sampler.shouldCompress());
+  }
+  ASSERT_TRUE(sampler.shouldCompress());
+  ASSERT_EQ(sampler.numSkipped(), 7);
+
+  // A payload compressing well resets the backoff.
+  sampler.update(100, 10);
+  sampler.update(100, 95);
+  ASSERT_FALSE(sampler.shouldCompress());
+  ASSERT_TRUE(sampler.shouldCompress());
+}
+
+TEST_F(CompressionTest, compressibilitySamplerDisabled) {
+  CompressibilitySampler sampler(-1, 4);
+  sampler.update(100, 300);
+  ASSERT_TRUE(sampler.shouldCompress());
+  ASSERT_EQ(sampler.numSkipped(), 0);
+}
+
+} // namespace gluten
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni/ConcurrentMap.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace gluten {
+
+TEST(ConcurrentMapTest, staleHandle) {
+  ConcurrentMap<std::shared_ptr<int32_t>> map;
+  auto first = map.insert(std::make_shared<int32_t>(1));
+  auto second = map.insert(std::make_shared<int32_t>(2));
+  ASSERT_NE(first, second);
+  ASSERT_EQ(*map.lookup(first), 1);
+  ASSERT_EQ(map.size(), 2);
+
+  map.erase(first);
+  ASSERT_EQ(map.lookup(first), nullptr);
+  ASSERT_EQ(*map.lookup(second), 2);
+
+  // Erased ids are not handed out again.
+  auto third = map.insert(std::make_shared<int32_t>(3));
+  ASSERT_NE(third, first);
+  ASSERT_EQ(map.lookup(first), nullptr);
+
+  map.clear();
+  ASSERT_EQ(map.size(), 0);
+  ASSERT_EQ(map.lookup(second), nullptr);
+}
+
+TEST(ConcurrentMapTest, concurrentAccess) {
+  ConcurrentMap<std::shared_ptr<int32_t>> map;
+  const int32_t numThreads = 8;
+  const int32_t numHandles = 1000;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<jlong>> handles(numThreads);
+  for (auto i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      for (auto j = 0; j < numHandles; ++j) {
+        handles[i].push_back(map.insert(std::make_shared<int32_t>(i * numHandles + j)));
+      }
+      for (auto j = 0; j < numHandles; ++j) {
+        ASSERT_EQ(*map.lookup(handles[i][j]), i * numHandles + j);
+      }
+      for (auto j = 0; j < numHandles; j += 2) {
+        map.erase(handles[i][j]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(map.size(), numThreads * numHandles / 2);
+  for (auto i = 0; i < numThreads; ++i) {
+    for (auto j = 0; j < numHandles; ++j) {
+      auto holder = map.lookup(handles[i][j]);
+      if (j % 2 == 0) {
+        ASSERT_EQ(holder, nullptr);
+      } else {
+        ASSERT_EQ(*holder, i * numHandles + j);
+      }
+    }
+  }
+}
+
+} // namespace gluten
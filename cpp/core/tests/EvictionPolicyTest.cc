@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shuffle/EvictionPolicy.h"
+
+#include <gtest/gtest.h>
+
+namespace gluten {
+
+namespace {
+
+// bufferedBytes, shrinkableBytes, cachedBytes, numSpills per partition.
+EvictionState makeState(std::vector<PartitionMemoryUsage> partitions, bool canSpillPartition = true) {
+  return EvictionState{std::move(partitions), canSpillPartition};
+}
+
+void assertSteps(const std::vector<EvictStep>& steps, const std::vector<EvictStep>& expected) {
+  ASSERT_EQ(steps.size(), expected.size());
+  for (size_t i = 0; i < steps.size(); ++i) {
+    ASSERT_EQ(steps[i].action, expected[i].action) << "step " << i;
+    ASSERT_EQ(steps[i].partitionId, expected[i].partitionId) << "step " << i;
+    ASSERT_EQ(steps[i].bytes, expected[i].bytes) << "step " << i;
+  }
+}
+
+} // namespace
+
+TEST(EvictionPolicyTest, create) {
+  ASSERT_TRUE(EvictionPolicy::create(kLargestFirstEvictionPolicy).ok());
+  ASSERT_TRUE(EvictionPolicy::create(kSpillAllEvictionPolicy).ok());
+  ASSERT_TRUE(EvictionPolicy::create("unknown").status().IsInvalid());
+}
+
+TEST(EvictionPolicyTest, largestFirstStopsAtTarget) {
+  LargestFirstEvictionPolicy policy;
+  auto state = makeState({{0, 0, 100, 0}, {0, 0, 300, 0}, {0, 0, 200, 0}});
+  assertSteps(policy.plan(state, 250), {{EvictAction::kSpillPayloads, 1, 300}});
+  assertSteps(
+      policy.plan(state, 301), {{EvictAction::kSpillPayloads, 1, 300}, {EvictAction::kSpillPayloads, 2, 200}});
+  ASSERT_TRUE(policy.plan(state, 0).empty());
+}
+
+TEST(EvictionPolicyTest, largestFirstPrefersSpilledPartitions) {
+  LargestFirstEvictionPolicy policy;
+  auto state = makeState({{0, 0, 100, 0}, {0, 0, 100, 2}});
+  assertSteps(policy.plan(state, 50), {{EvictAction::kSpillPayloads, 1, 100}});
+}
+
+TEST(EvictionPolicyTest, largestFirstShrinksThenSpillsThenFlushes) {
+  LargestFirstEvictionPolicy policy;
+  auto state = makeState({{400, 50, 0, 0}, {100, 100, 20, 0}, {300, 0, 30, 0}});
+  assertSteps(policy.plan(state, 120), {{EvictAction::kShrinkBuffers, 1, 100}, {EvictAction::kShrinkBuffers, 0, 50}});
+  assertSteps(
+      policy.plan(state, 500),
+      {{EvictAction::kShrinkBuffers, 1, 100},
+       {EvictAction::kShrinkBuffers, 0, 50},
+       {EvictAction::kSpillPayloads, 2, 30},
+       {EvictAction::kSpillPayloads, 1, 20},
+       {EvictAction::kFlushBuffers, 0, 350},
+       {EvictAction::kSpillPayloads, 0, 0}});
+}
+
+TEST(EvictionPolicyTest, largestFirstSpillsAllWithoutSinglePartitionSpill) {
+  LargestFirstEvictionPolicy policy;
+  auto state = makeState({{200, 0, 100, 0}, {300, 0, 50, 0}}, false);
+  assertSteps(policy.plan(state, 100), {{EvictAction::kSpillPayloads, -1, 150}});
+  assertSteps(
+      policy.plan(state, 400),
+      {{EvictAction::kSpillPayloads, -1, 150},
+       {EvictAction::kFlushBuffers, 1, 300},
+       {EvictAction::kSpillPayloads, -1, 0}});
+}
+
+TEST(EvictionPolicyTest, spillAll) {
+  SpillAllEvictionPolicy policy;
+  auto state = makeState({{200, 0, 100, 0}, {0, 0, 50, 0}});
+  assertSteps(policy.plan(state, 100), {{EvictAction::kSpillPayloads, -1, 150}});
+  assertSteps(
+      policy.plan(state, 200),
+      {{EvictAction::kSpillPayloads, -1, 150},
+       {EvictAction::kFlushBuffers, 0, 200},
+       {EvictAction::kSpillPayloads, -1, 0}});
+}
+
+} // namespace gluten
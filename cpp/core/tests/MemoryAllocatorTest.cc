@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory/MemoryAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace gluten {
+
+TEST(MemoryAllocatorTest, blockReservation) {
+  const int64_t blockSize = 100;
+  BlockReservation reservation(blockSize);
+
+  ASSERT_EQ(reservation.reserve(1), 100);
+  ASSERT_EQ(reservation.reserve(99), 0);
+  ASSERT_EQ(reservation.reserve(1), 100);
+  ASSERT_EQ(reservation.reserve(-1), -100);
+  ASSERT_EQ(reservation.reserve(250), 300);
+  ASSERT_EQ(reservation.reserve(-350), -400);
+  ASSERT_EQ(reservation.bytesReserved(), 0);
+  ASSERT_EQ(reservation.maxBytesReserved(), 350);
+}
+
+TEST(MemoryAllocatorTest, blockReservationConcurrent) {
+  const int64_t blockSize = 1024;
+  const int32_t numThreads = 8;
+  const int32_t numIterations = 100000;
+  BlockReservation reservation(blockSize);
+
+  std::atomic_int64_t granted{0};
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      int64_t local = 0;
+      for (auto j = 0; j < numIterations; ++j) {
+        auto size = (i + 1) * 37 + j % 113;
+        local += reservation.reserve(size);
+        local += reservation.reserve(-size);
+      }
+      granted += local;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Whatever the interleaving, the granted bytes add up to the reserved blocks.
+  ASSERT_EQ(reservation.bytesReserved(), 0);
+  ASSERT_EQ(reservation.blocksReserved(), 0);
+  ASSERT_EQ(granted, 0);
+}
+
+TEST(MemoryAllocatorTest, listenerOnlyNotifiedPerBlock) {
+  class CountingListener : public AllocationListener {
+   public:
+    void allocationChanged(int64_t diff) override {
+      auto granted = reservation_.reserve(diff);
+      if (granted != 0) {
+        ++calls_;
+      }
+    }
+
+    BlockReservation reservation_{1 << 20};
+    int32_t calls_ = 0;
+  };
+
+  auto listener = std::make_shared<CountingListener>();
+  ListenableMemoryAllocator allocator(defaultMemoryAllocator().get(), listener);
+  std::vector<void*> buffers(64);
+  for (auto& buffer : buffers) {
+    ASSERT_TRUE(allocator.allocate(1024, &buffer));
+  }
+  for (auto& buffer : buffers) {
+    ASSERT_TRUE(allocator.free(buffer, 1024));
+  }
+  ASSERT_EQ(listener->calls_, 2);
+  ASSERT_EQ(allocator.getBytes(), 0);
+}
+
+} // namespace gluten
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shuffle/HashPartitioner.h"
+#include "shuffle/RoundRobinPartitioner.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+namespace gluten {
+
+TEST(PartitionerTest, widePartitionId) {
+  ASSERT_FALSE(ShuffleWriter::Partitioner::needWidePartitionId(1));
+  ASSERT_FALSE(ShuffleWriter::Partitioner::needWidePartitionId(64 * 1024));
+  ASSERT_TRUE(ShuffleWriter::Partitioner::needWidePartitionId(64 * 1024 + 1));
+}
+
+TEST(PartitionerTest, hashPartitionIdWidth) {
+  const int32_t numPartitions = 1000;
+  std::vector<int32_t> hashes = {-1, 0, 1, 999, 1000, -1001, 123456};
+  std::vector<uint32_t> expected = {999, 0, 1, 999, 0, 999, 456};
+
+  auto partitioner16 = ShuffleWriter::Partitioner::create<HashPartitioner>(numPartitions, true);
+  std::vector<uint16_t> partitionId16;
+  std::vector<uint32_t> partitionIdCnt16(numPartitions);
+  ASSERT_TRUE(partitioner16->compute(hashes.data(), hashes.size(), partitionId16, partitionIdCnt16).ok());
+
+  auto partitioner32 = ShuffleWriter::Partitioner::create<HashPartitioner>(numPartitions, true);
+  std::vector<uint32_t> partitionId32;
+  std::vector<uint32_t> partitionIdCnt32(numPartitions);
+  ASSERT_TRUE(partitioner32->compute(hashes.data(), hashes.size(), partitionId32, partitionIdCnt32).ok());
+
+  ASSERT_EQ(partitionId32, expected);
+  ASSERT_EQ(std::vector<uint32_t>(partitionId16.begin(), partitionId16.end()), expected);
+  ASSERT_EQ(partitionIdCnt16, partitionIdCnt32);
+}
+
+TEST(PartitionerTest, hashKernels) {
+  std::vector<int32_t> hashes;
+  for (int32_t i = 0; i < 1000; ++i) {
+    hashes.push_back(static_cast<int32_t>(i * 2654435761U));
+  }
+  hashes.push_back(std::numeric_limits<int32_t>::min());
+  hashes.push_back(std::numeric_limits<int32_t>::max());
+
+  for (int32_t numPartitions : {1, 2, 7, 200, 2048, 10000, 65536, 100000}) {
+    std::vector<uint32_t> expected(hashes.size());
+    std::vector<uint32_t> expectedCnt(numPartitions);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+      auto pid = hashes[i] % numPartitions;
+      expected[i] = pid < 0 ? pid + numPartitions : pid;
+      expectedCnt[expected[i]]++;
+    }
+
+    for (auto kernel :
+         {HashPartitioner::Kernel::kScalar, HashPartitioner::Kernel::kAvx2, HashPartitioner::Kernel::kAvx512}) {
+      if (kernel > HashPartitioner::detectKernel(true)) {
+        continue;
+      }
+      auto partitioner = ShuffleWriter::Partitioner::create<HashPartitioner>(numPartitions, true, kernel);
+      std::vector<uint32_t> partitionId;
+      std::vector<uint32_t> partitionIdCnt(numPartitions);
+      ASSERT_TRUE(partitioner->compute(hashes.data(), hashes.size(), partitionId, partitionIdCnt).ok());
+      ASSERT_EQ(partitionId, expected) << "numPartitions " << numPartitions;
+      ASSERT_EQ(partitionIdCnt, expectedCnt) << "numPartitions " << numPartitions;
+    }
+  }
+}
+
+TEST(PartitionerTest, roundRobinBeyond64k) {
+  const int32_t numPartitions = 100000;
+  const int64_t numRows = 150000;
+  auto partitioner = ShuffleWriter::Partitioner::create<RoundRobinPartitioner>(numPartitions, false);
+  std::vector<uint32_t> partitionId;
+  std::vector<uint32_t> partitionIdCnt(numPartitions);
+  ASSERT_TRUE(partitioner->compute(nullptr, numRows, partitionId, partitionIdCnt).ok());
+
+  ASSERT_EQ(partitionId.size(), numRows);
+  ASSERT_EQ(partitionId[numPartitions - 1], numPartitions - 1);
+  ASSERT_EQ(partitionId[numPartitions], 0);
+  ASSERT_EQ(partitionIdCnt[0], 2);
+  ASSERT_EQ(partitionIdCnt[numPartitions - 1], 1);
+}
+
+} // namespace gluten
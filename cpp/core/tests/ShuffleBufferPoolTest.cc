@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shuffle/ShuffleWriter.h"
+
+#include <gtest/gtest.h>
+
+namespace gluten {
+
+class ShuffleBufferPoolTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<arrow::Buffer> allocate(uint32_t size) {
+    std::shared_ptr<arrow::Buffer> buffer;
+    EXPECT_TRUE(bufferPool_.allocate(buffer, size).ok());
+    return buffer;
+  }
+
+  std::shared_ptr<arrow::MemoryPool> memoryPool_ =
+      std::make_shared<arrow::ProxyMemoryPool>(arrow::default_memory_pool());
+  ShuffleBufferPool bufferPool_{memoryPool_};
+};
+
+TEST_F(ShuffleBufferPoolTest, sizeClasses) {
+  ASSERT_EQ(allocate(1)->capacity(), 64);
+  ASSERT_EQ(allocate(100)->capacity(), 128);
+  ASSERT_EQ(allocate(256)->capacity(), 256);
+  ASSERT_EQ(allocate(300)->capacity(), 320);
+  ASSERT_EQ(allocate(513)->capacity(), 640);
+  ASSERT_EQ(allocate(4097)->capacity(), 5120);
+}
+
+TEST_F(ShuffleBufferPoolTest, reuseReleasedBuffers) {
+  auto buffer = allocate(100);
+  auto data = buffer->data();
+  buffer.reset();
+  ASSERT_EQ(bufferPool_.freeBytes(), 128);
+
+  // A slice keeps the buffer out of the free list.
+  buffer = allocate(120);
+  ASSERT_EQ(buffer->data(), data);
+  auto slice = arrow::SliceBuffer(buffer, 0, 10);
+  buffer.reset();
+  ASSERT_EQ(bufferPool_.freeBytes(), 0);
+  ASSERT_NE(allocate(120)->data(), data);
+  slice.reset();
+
+  ASSERT_EQ(allocate(128)->data(), data);
+  ASSERT_EQ(bufferPool_.numHits(), 2);
+  ASSERT_EQ(bufferPool_.numMisses(), 2);
+}
+
+TEST_F(ShuffleBufferPoolTest, shrink) {
+  allocate(1000);
+  {
+    auto buffer = allocate(100);
+    allocate(100);
+  }
+  ASSERT_EQ(bufferPool_.freeBytes(), 1024 + 128 * 2);
+  auto allocated = memoryPool_->bytes_allocated();
+
+  // The largest buffers go first.
+  ASSERT_EQ(bufferPool_.shrink(1), 1024);
+  ASSERT_EQ(memoryPool_->bytes_allocated(), allocated - 1024);
+  ASSERT_EQ(bufferPool_.shrink(), 128 * 2);
+  ASSERT_EQ(bufferPool_.freeBytes(), 0);
+  ASSERT_EQ(memoryPool_->bytes_allocated(), 0);
+}
+
+TEST_F(ShuffleBufferPoolTest, bufferOutlivesPool) {
+  auto bufferPool = std::make_unique<ShuffleBufferPool>(memoryPool_);
+  std::shared_ptr<arrow::Buffer> buffer;
+  ASSERT_TRUE(bufferPool->allocate(buffer, 100).ok());
+  bufferPool.reset();
+  ASSERT_EQ(memoryPool_->bytes_allocated(), 128);
+  buffer.reset();
+  ASSERT_EQ(memoryPool_->bytes_allocated(), 0);
+}
+
+} // namespace gluten
@@ -19,6 +19,9 @@
 
 #include <arrow/util/compression.h>
 #include <bits/stl_algo.h>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #ifdef GLUTEN_ENABLE_QAT
@@ -42,15 +45,96 @@ static const std::vector<arrow::Compression::type> kSupportedCodec = {
     arrow::Compression::ZSTD};
 #endif
 
-arrow::Result<std::unique_ptr<arrow::util::Codec>> createArrowIpcCodec(arrow::Compression::type compressedType) {
-  if (std::any_of(kSupportedCodec.begin(), kSupportedCodec.end(), [compressedType](const auto& codec) {
-        return codec == compressedType;
-      })) {
-    auto ret = arrow::util::Codec::Create(compressedType);
-    return ret;
-  } else {
-    return nullptr;
+using ArrowIpcCodecFactory = std::function<arrow::Result<std::unique_ptr<arrow::util::Codec>>(int32_t level)>;
+
+namespace detail {
+
+struct ArrowIpcCodecRegistry {
+  ArrowIpcCodecRegistry() {
+    for (auto type : kSupportedCodec) {
+      factories[type] = [type](int32_t level) { return arrow::util::Codec::Create(type, level); };
+    }
+  }
+
+  std::mutex mutex;
+  std::unordered_map<arrow::Compression::type, ArrowIpcCodecFactory> factories;
+};
+
+inline ArrowIpcCodecRegistry& arrowIpcCodecRegistry() {
+  static ArrowIpcCodecRegistry registry;
+  return registry;
+}
+
+} // namespace detail
+
+/// Registers the codec used for a compression type, replacing the Arrow one. Only the compression types Arrow IPC
+/// can read back are accepted, the codec is only a different implementation of the same format. Returns the factory
+/// replaced, empty if there was none.
+inline ArrowIpcCodecFactory registerArrowIpcCodec(
+    arrow::Compression::type compressedType,
+    ArrowIpcCodecFactory factory) {
+  auto& registry = detail::arrowIpcCodecRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::swap(registry.factories[compressedType], factory);
+  return factory;
+}
+
+/// Returns nullptr for the compression types without a codec, e.g. UNCOMPRESSED.
+inline arrow::Result<std::unique_ptr<arrow::util::Codec>> createArrowIpcCodec(
+    arrow::Compression::type compressedType,
+    int32_t level = arrow::util::kUseDefaultCompressionLevel) {
+  ArrowIpcCodecFactory factory;
+  {
+    auto& registry = detail::arrowIpcCodecRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.factories.find(compressedType);
+    if (it == registry.factories.end()) {
+      return nullptr;
+    }
+    factory = it->second;
   }
+  return factory(level);
 }
 
+/// Decides whether the payloads of a writer are worth compressing, from how well the last compressed ones did. Once a
+/// payload saves less than `minSavings` of its size, the next payloads are written uncompressed, twice as many each
+/// time in a row compression doesn't pay off, up to `maxBackoff`. Then compression is tried again.
+class CompressibilitySampler {
+ public:
+  CompressibilitySampler(double minSavings, int32_t maxBackoff) : minSavings_(minSavings), maxBackoff_(maxBackoff) {}
+
+  bool shouldCompress() {
+    if (toSkip_ > 0) {
+      toSkip_--;
+      numSkipped_++;
+      return false;
+    }
+    return true;
+  }
+
+  void update(int64_t uncompressedSize, int64_t compressedSize) {
+    if (minSavings_ < 0 || uncompressedSize <= 0) {
+      return;
+    }
+    if (1.0 - static_cast<double>(compressedSize) / uncompressedSize >= minSavings_) {
+      backoff_ = 0;
+      return;
+    }
+    backoff_ = std::min(std::max(1, backoff_ * 2), maxBackoff_);
+    toSkip_ = backoff_;
+  }
+
+  /// Payloads written uncompressed because of the previous ones.
+  int64_t numSkipped() const {
+    return numSkipped_;
+  }
+
+ private:
+  const double minSavings_;
+  const int32_t maxBackoff_;
+  int32_t backoff_ = 0;
+  int32_t toSkip_ = 0;
+  int64_t numSkipped_ = 0;
+};
+
 } // namespace gluten
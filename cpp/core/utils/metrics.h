@@ -36,6 +36,13 @@ struct Metrics {
   long* wallNanos;
   long veloxToArrow;
 
+  // Batches handed out by the iterator, after resizing.
+  long outputBatches = 0;
+  long outputBatchRows = 0;
+  long outputBatchBytes = 0;
+  long coalescedBatches = 0;
+  long splitBatches = 0;
+
   long* peakMemoryBytes;
   long* numMemoryAllocations;
 
@@ -56,6 +63,9 @@ struct Metrics {
   long* skippedStrides;
   long* processedStrides;
 
+  // Time scans waited for their reads.
+  long* ioWaitTime;
+
   Metrics(int size) : numMetrics(size) {
     inputRows = new long[numMetrics]();
     inputVectors = new long[numMetrics]();
@@ -82,6 +92,7 @@ struct Metrics {
     processedSplits = new long[numMetrics]();
     skippedStrides = new long[numMetrics]();
     processedStrides = new long[numMetrics]();
+    ioWaitTime = new long[numMetrics]();
   }
 
   Metrics(const Metrics&) = delete;
@@ -115,6 +126,7 @@ struct Metrics {
     delete[] processedSplits;
     delete[] skippedStrides;
     delete[] processedStrides;
+    delete[] ioWaitTime;
   }
 };
 
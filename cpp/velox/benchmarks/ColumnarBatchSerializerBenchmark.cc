@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "BenchmarkUtils.h"
+#include "memory/ArrowMemory.h"
+#include "memory/ArrowMemoryPool.h"
+#include "memory/VeloxColumnarBatch.h"
+#include "memory/VeloxMemoryPool.h"
+#include "operators/serializer/VeloxColumnarBatchSerializer.h"
+#include "velox/vector/FlatVector.h"
+#include "velox/vector/arrow/Bridge.h"
+
+using namespace facebook::velox;
+
+namespace gluten {
+
+namespace {
+
+constexpr vector_size_t kNumRows = 4096;
+constexpr int32_t kNumBatches = 16;
+
+RowVectorPtr makeBatch(std::mt19937& gen, memory::MemoryPool* pool) {
+  auto rowType = ROW({"l", "d", "s", "i"}, {BIGINT(), DOUBLE(), VARCHAR(), INTEGER()});
+  auto longs = BaseVector::create<FlatVector<int64_t>>(BIGINT(), kNumRows, pool);
+  auto doubles = BaseVector::create<FlatVector<double>>(DOUBLE(), kNumRows, pool);
+  auto strings = BaseVector::create<FlatVector<StringView>>(VARCHAR(), kNumRows, pool);
+  auto ints = BaseVector::create<FlatVector<int32_t>>(INTEGER(), kNumRows, pool);
+  constexpr int32_t kMaxStringLength = 40;
+  auto stringBuffer = AlignedBuffer::allocate<char>(kNumRows * kMaxStringLength, pool);
+  strings->setStringBuffers({stringBuffer});
+  auto stringData = stringBuffer->asMutable<char>();
+
+  std::uniform_int_distribution<int32_t> lengthDist(0, kMaxStringLength);
+  std::uniform_int_distribution<int64_t> valueDist(0, 1'000'000);
+  for (auto i = 0; i < kNumRows; i++) {
+    longs->set(i, valueDist(gen));
+    doubles->set(i, valueDist(gen) / 3.0);
+    auto length = lengthDist(gen);
+    memset(stringData, 'a' + i % 26, length);
+    strings->set(i, StringView(stringData, length));
+    stringData += length;
+    if (i % 10 == 0) {
+      ints->setNull(i, true);
+    } else {
+      ints->set(i, static_cast<int32_t>(valueDist(gen)));
+    }
+  }
+  return std::make_shared<RowVector>(
+      pool, rowType, nullptr, kNumRows, std::vector<VectorPtr>{longs, doubles, strings, ints});
+}
+
+std::vector<std::shared_ptr<ColumnarBatch>> makeBatches() {
+  std::mt19937 gen(42);
+  std::vector<std::shared_ptr<ColumnarBatch>> batches;
+  for (auto i = 0; i < kNumBatches; i++) {
+    batches.push_back(std::make_shared<VeloxColumnarBatch>(makeBatch(gen, defaultLeafVeloxMemoryPool().get())));
+  }
+  return batches;
+}
+
+int64_t totalRows(const std::vector<std::shared_ptr<ColumnarBatch>>& batches) {
+  int64_t numRows = 0;
+  for (auto& batch : batches) {
+    numRows += batch->numRows();
+  }
+  return numRows;
+}
+
+// The former serialization, one IndexRange per row, as the baseline. The page is flushed into an Arrow buffer the
+// same way as serializeColumnarBatches does without compression.
+void serializePerRow(benchmark::State& state) {
+  auto batches = makeBatches();
+  auto pool = defaultLeafVeloxMemoryPool();
+  auto arrowPool = defaultArrowMemoryPool();
+  serializer::presto::PrestoVectorSerde serde;
+  int64_t serializedSize = 0;
+  for (auto _ : state) {
+    auto arena = std::make_unique<StreamArena>(pool.get());
+    auto rowType = asRowType(std::dynamic_pointer_cast<VeloxColumnarBatch>(batches[0])->getRowVector()->type());
+    auto serializer = serde.createSerializer(rowType, kNumRows, arena.get(), nullptr);
+    for (auto& batch : batches) {
+      auto rowVector = std::dynamic_pointer_cast<VeloxColumnarBatch>(batch)->getRowVector();
+      std::vector<IndexRange> rows(rowVector->size());
+      for (int i = 0; i < rowVector->size(); i++) {
+        rows[i] = IndexRange{i, 1};
+      }
+      serializer->append(rowVector, folly::Range(rows.data(), rows.size()));
+    }
+    std::shared_ptr<arrow::ResizableBuffer> buffer;
+    GLUTEN_ASSIGN_OR_THROW(buffer, arrow::AllocateResizableBuffer(serializer->maxSerializedSize(), arrowPool.get()));
+    auto output = std::make_shared<arrow::io::FixedSizeBufferWriter>(buffer);
+    serializer::presto::PrestoOutputStreamListener listener;
+    ArrowFixedSizeBufferOutputStream out(output, &listener);
+    serializer->flush(&out);
+    GLUTEN_ASSIGN_OR_THROW(serializedSize, output->Tell());
+    GLUTEN_THROW_NOT_OK(output->Close());
+    GLUTEN_THROW_NOT_OK(buffer->Resize(serializedSize, /*shrink_to_fit=*/false));
+    benchmark::DoNotOptimize(buffer->data());
+  }
+  state.SetItemsProcessed(state.iterations() * totalRows(batches));
+  state.counters["serialized_bytes"] = serializedSize;
+}
+
+template <arrow::Compression::type compressionType>
+void serialize(benchmark::State& state) {
+  auto batches = makeBatches();
+  auto serializer = std::make_shared<VeloxColumnarBatchSerializer>(
+      defaultArrowMemoryPool(), defaultLeafVeloxMemoryPool(), nullptr, compressionType);
+  int64_t serializedSize = 0;
+  for (auto _ : state) {
+    auto buffer = serializer->serializeColumnarBatches(batches);
+    serializedSize = buffer->size();
+    benchmark::DoNotOptimize(buffer->data());
+  }
+  state.SetItemsProcessed(state.iterations() * totalRows(batches));
+  state.counters["serialized_bytes"] = serializedSize;
+}
+
+template <arrow::Compression::type compressionType>
+void deserialize(benchmark::State& state) {
+  auto batches = makeBatches();
+  auto serializer = std::make_shared<VeloxColumnarBatchSerializer>(
+      defaultArrowMemoryPool(), defaultLeafVeloxMemoryPool(), nullptr, compressionType);
+  auto buffer = serializer->serializeColumnarBatches(batches);
+
+  ArrowSchema cSchema;
+  exportToArrow(std::dynamic_pointer_cast<VeloxColumnarBatch>(batches[0])->getRowVector(), cSchema);
+  auto deserializer =
+      std::make_shared<VeloxColumnarBatchSerializer>(defaultArrowMemoryPool(), defaultLeafVeloxMemoryPool(), &cSchema);
+  for (auto _ : state) {
+    auto batch = deserializer->deserialize(const_cast<uint8_t*>(buffer->data()), buffer->size());
+    benchmark::DoNotOptimize(batch);
+  }
+  state.SetItemsProcessed(state.iterations() * totalRows(batches));
+  state.SetBytesProcessed(state.iterations() * buffer->size());
+}
+
+} // namespace
+
+BENCHMARK(serializePerRow);
+BENCHMARK_TEMPLATE(serialize, arrow::Compression::UNCOMPRESSED);
+BENCHMARK_TEMPLATE(serialize, arrow::Compression::LZ4_FRAME);
+BENCHMARK_TEMPLATE(serialize, arrow::Compression::ZSTD);
+BENCHMARK_TEMPLATE(deserialize, arrow::Compression::UNCOMPRESSED);
+BENCHMARK_TEMPLATE(deserialize, arrow::Compression::LZ4_FRAME);
+BENCHMARK_TEMPLATE(deserialize, arrow::Compression::ZSTD);
+
+} // namespace gluten
+
+BENCHMARK_MAIN();
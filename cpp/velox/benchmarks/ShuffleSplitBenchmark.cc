@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 
+#include <arrow/array/builder_primitive.h>
 #include <arrow/filesystem/filesystem.h>
 #include <arrow/io/interfaces.h>
 #include <arrow/memory_pool.h>
@@ -57,6 +58,10 @@ using gluten::ShuffleWriterOptions;
 using gluten::VeloxShuffleWriter;
 
 DEFINE_bool(prefer_evict, true, "SplitOptions prefer_evict=true");
+DEFINE_bool(sort_based, false, "SplitOptions sort_based=true");
+DEFINE_bool(async_spill, false, "SplitOptions async_spill=true");
+DEFINE_bool(compare_sort_based, false, "Compare hash and sort based split at 200, 2k and 20k partitions");
+DEFINE_bool(wide_schema, false, "Split generated batches of 100, 500 and 1000 fixed-width columns");
 DEFINE_int32(partitions, -1, "Shuffle partitions");
 DEFINE_string(file, "", "Input file to split");
 
@@ -71,6 +76,8 @@ class BenchmarkShuffleSplit {
     getRecordBatchReader(fileName);
   }
 
+  virtual ~BenchmarkShuffleSplit() = default;
+
   void getRecordBatchReader(const std::string& inputFile) {
     std::unique_ptr<::parquet::arrow::FileReader> parquetReader;
     std::shared_ptr<RecordBatchReader> recordBatchReader;
@@ -111,14 +118,20 @@ class BenchmarkShuffleSplit {
 
     std::shared_ptr<arrow::MemoryPool> pool = defaultArrowMemoryPool();
 
+    // Args: prefer_evict, partitions, sort_based
+    bool preferEvict = state.range(0);
+    int32_t numPartitions = state.range(1);
+
     std::shared_ptr<ShuffleWriter::PartitionWriterCreator> partitionWriterCreator =
-        std::make_shared<LocalPartitionWriterCreator>(FLAGS_prefer_evict);
+        std::make_shared<LocalPartitionWriterCreator>(preferEvict);
 
     auto options = ShuffleWriterOptions::defaults();
     options.buffer_size = kSplitBufferSize;
     options.buffered_write = true;
     options.offheap_per_task = 128 * 1024 * 1024 * 1024L;
-    options.prefer_evict = FLAGS_prefer_evict;
+    options.prefer_evict = preferEvict;
+    options.sort_based = state.range(2);
+    options.async_spill = FLAGS_async_spill;
     options.write_schema = false;
     options.memory_pool = pool;
     options.partitioning_name = "rr";
@@ -136,7 +149,7 @@ class BenchmarkShuffleSplit {
         numBatches,
         numRows,
         splitTime,
-        FLAGS_partitions,
+        numPartitions,
         partitionWriterCreator,
         options,
         state);
@@ -157,7 +170,7 @@ class BenchmarkShuffleSplit {
     state.counters["num_rows"] =
         benchmark::Counter(numRows, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
     state.counters["num_partitions"] =
-        benchmark::Counter(FLAGS_partitions, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+        benchmark::Counter(numPartitions, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
     state.counters["batch_buffer_size"] =
         benchmark::Counter(kBatchBufferSize, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1024);
     state.counters["split_buffer_size"] =
@@ -171,6 +184,12 @@ class BenchmarkShuffleSplit {
         shuffleWriter->rawPartitionBytes(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1024);
     state.counters["bytes_spilled"] = benchmark::Counter(
         shuffleWriter->totalBytesEvicted(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1024);
+    state.counters["num_spills"] = benchmark::Counter(
+        shuffleWriter->numSpills(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["buffer_pool_hits"] = benchmark::Counter(
+        shuffleWriter->pool()->numHits(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
+    state.counters["buffer_pool_misses"] = benchmark::Counter(
+        shuffleWriter->pool()->numMisses(), benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
 
     state.counters["parquet_parse"] =
         benchmark::Counter(elapseRead, benchmark::Counter::kAvgThreads, benchmark::Counter::OneK::kIs1000);
@@ -193,6 +212,9 @@ class BenchmarkShuffleSplit {
   }
 
  protected:
+  // For the benchmarks which don't read a file.
+  BenchmarkShuffleSplit() = default;
+
   long setCpu(uint32_t cpuindex) {
     cpu_set_t cs;
     CPU_ZERO(&cs);
@@ -355,13 +377,96 @@ class BenchmarkShuffleSplitIterateScanBenchmark : public BenchmarkShuffleSplit {
   }
 };
 
+// Splits generated batches of fixed-width columns, a quarter of them with nulls. The number of columns is the fourth
+// argument.
+class BenchmarkShuffleSplitWideSchemaBenchmark : public BenchmarkShuffleSplit {
+ public:
+  BenchmarkShuffleSplitWideSchemaBenchmark() = default;
+
+ protected:
+  void doSplit(
+      std::shared_ptr<VeloxShuffleWriter>& shuffleWriter,
+      int64_t& elapseRead,
+      int64_t& numBatches,
+      int64_t& numRows,
+      int64_t& splitTime,
+      const int numPartitions,
+      std::shared_ptr<ShuffleWriter::PartitionWriterCreator> partitionWriterCreator,
+      ShuffleWriterOptions options,
+      benchmark::State& state) {
+    const int32_t numColumns = state.range(3);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    TIME_NANO_OR_THROW(elapseRead, makeBatches(numColumns, batches));
+    GLUTEN_ASSIGN_OR_THROW(
+        shuffleWriter,
+        VeloxShuffleWriter::create(numPartitions, std::move(partitionWriterCreator), std::move(options)));
+
+    for (auto _ : state) {
+      for (const auto& recordBatch : batches) {
+        numBatches += 1;
+        numRows += recordBatch->num_rows();
+        std::shared_ptr<ColumnarBatch> cb;
+        ARROW_ASSIGN_OR_THROW(cb, recordBatch2VeloxColumnarBatch(*recordBatch));
+        TIME_NANO_OR_THROW(splitTime, shuffleWriter->split(cb));
+      }
+    }
+    TIME_NANO_OR_THROW(splitTime, shuffleWriter->stop());
+  }
+
+ private:
+  static constexpr int32_t kNumBatches = 16;
+
+  template <typename Builder, typename Value>
+  static arrow::Result<std::shared_ptr<arrow::Array>> makeColumn(bool nullable, Value (*value)(uint32_t)) {
+    Builder builder;
+    ARROW_RETURN_NOT_OK(builder.Reserve(kBatchBufferSize));
+    for (int32_t row = 0; row < kBatchBufferSize; ++row) {
+      uint32_t random = row * 2654435761u;
+      if (nullable && random % 8 == 0) {
+        builder.UnsafeAppendNull();
+      } else {
+        builder.UnsafeAppend(value(random));
+      }
+    }
+    return builder.Finish();
+  }
+
+  arrow::Status makeBatches(int32_t numColumns, std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+    arrow::FieldVector fields;
+    arrow::ArrayVector columns;
+    for (int32_t col = 0; col < numColumns; ++col) {
+      bool nullable = col % 4 == 3;
+      std::shared_ptr<arrow::Array> column;
+      switch (col % 3) {
+        case 0:
+          ARROW_ASSIGN_OR_RAISE(
+              column, (makeColumn<arrow::Int32Builder, int32_t>(nullable, [](uint32_t r) { return (int32_t)r; })));
+          break;
+        case 1:
+          ARROW_ASSIGN_OR_RAISE(
+              column, (makeColumn<arrow::Int64Builder, int64_t>(nullable, [](uint32_t r) { return (int64_t)r << 8; })));
+          break;
+        default:
+          ARROW_ASSIGN_OR_RAISE(
+              column, (makeColumn<arrow::DoubleBuilder, double>(nullable, [](uint32_t r) { return r / 7.0; })));
+          break;
+      }
+      fields.push_back(arrow::field("c" + std::to_string(col), column->type()));
+      columns.push_back(std::move(column));
+    }
+    auto batch = arrow::RecordBatch::Make(arrow::schema(fields), kBatchBufferSize, std::move(columns));
+    batches.assign(kNumBatches, batch);
+    return arrow::Status::OK();
+  }
+};
+
 } // namespace gluten
 
 int main(int argc, char** argv) {
   benchmark::Initialize(&argc, argv);
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
-  if (FLAGS_file.size() == 0) {
+  if (FLAGS_file.size() == 0 && !FLAGS_wide_schema) {
     std::cerr << "No input data file. Please specify via argument --file" << std::endl;
   }
 
@@ -369,15 +474,33 @@ int main(int argc, char** argv) {
     FLAGS_partitions = std::thread::hardware_concurrency();
   }
 
-  gluten::BenchmarkShuffleSplitIterateScanBenchmark iterateScanBenchmark(FLAGS_file);
-
-  auto bm = benchmark::RegisterBenchmark("BenchmarkShuffleSplit::IterateScan", iterateScanBenchmark)
-                ->Args({
-                    FLAGS_prefer_evict,
-                })
-                ->ReportAggregatesOnly(false)
-                ->MeasureProcessCPUTime()
-                ->Unit(benchmark::kSecond);
+  benchmark::internal::Benchmark* bm;
+  if (FLAGS_wide_schema) {
+    // Generated batches, no input file is needed.
+    bm = benchmark::RegisterBenchmark(
+             "BenchmarkShuffleSplit::WideSchema", gluten::BenchmarkShuffleSplitWideSchemaBenchmark())
+             ->ArgNames({"prefer_evict", "partitions", "sort_based", "columns"})
+             ->ArgsProduct({{0}, {FLAGS_partitions, 2000}, {0}, {100, 500, 1000}})
+             ->ReportAggregatesOnly(false)
+             ->MeasureProcessCPUTime()
+             ->Unit(benchmark::kSecond);
+  } else if (FLAGS_compare_sort_based) {
+    gluten::BenchmarkShuffleSplitIterateScanBenchmark iterateScanBenchmark(FLAGS_file);
+    // Spill into a single partition-ordered file so that both modes write the same number of files.
+    bm = benchmark::RegisterBenchmark("BenchmarkShuffleSplit::IterateScan", iterateScanBenchmark)
+             ->ArgNames({"prefer_evict", "partitions", "sort_based"})
+             ->ArgsProduct({{0}, {200, 2000, 20000}, {0, 1}})
+             ->ReportAggregatesOnly(false)
+             ->MeasureProcessCPUTime()
+             ->Unit(benchmark::kSecond);
+  } else {
+    gluten::BenchmarkShuffleSplitIterateScanBenchmark iterateScanBenchmark(FLAGS_file);
+    bm = benchmark::RegisterBenchmark("BenchmarkShuffleSplit::IterateScan", iterateScanBenchmark)
+             ->Args({FLAGS_prefer_evict, FLAGS_partitions, FLAGS_sort_based})
+             ->ReportAggregatesOnly(false)
+             ->MeasureProcessCPUTime()
+             ->Unit(benchmark::kSecond);
+  }
 
   if (FLAGS_threads > 0) {
     bm->Threads(FLAGS_threads);
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "compute/ResultIterator.h"
 #include "memory/VeloxColumnarBatch.h"
 #include "velox/exec/Driver.h"
@@ -45,15 +47,50 @@ class RowVectorStream {
   const facebook::velox::RowTypePtr outputType_;
 };
 
+/// The input iterators of the running tasks. The plan nodes only refer to an input by its index, so a plan can be
+/// shared by the tasks of a stage, each reading its own inputs.
+class ValueStreamRegistry {
+ public:
+  static void registerTask(
+      const facebook::velox::exec::Task* task,
+      std::vector<std::shared_ptr<ResultIterator>> inputIters) {
+    std::lock_guard<std::mutex> lock(mutex());
+    tasks()[task] = std::move(inputIters);
+  }
+
+  static void unregisterTask(const facebook::velox::exec::Task* task) {
+    std::lock_guard<std::mutex> lock(mutex());
+    tasks().erase(task);
+  }
+
+  static std::shared_ptr<ResultIterator> getInputIter(const facebook::velox::exec::Task* task, int32_t iterIdx) {
+    std::lock_guard<std::mutex> lock(mutex());
+    auto it = tasks().find(task);
+    VELOX_CHECK(it != tasks().end(), "No input iterators registered for task.");
+    VELOX_CHECK_LT(iterIdx, it->second.size(), "Invalid input iterator.");
+    return it->second[iterIdx];
+  }
+
+ private:
+  static std::mutex& mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::unordered_map<const facebook::velox::exec::Task*, std::vector<std::shared_ptr<ResultIterator>>>&
+  tasks() {
+    static std::unordered_map<const facebook::velox::exec::Task*, std::vector<std::shared_ptr<ResultIterator>>> tasks;
+    return tasks;
+  }
+};
+
 class ValueStreamNode : public facebook::velox::core::PlanNode {
  public:
   ValueStreamNode(
       const facebook::velox::core::PlanNodeId& id,
       const facebook::velox::RowTypePtr& outputType,
-      std::shared_ptr<RowVectorStream> valueStream)
-      : facebook::velox::core::PlanNode(id), outputType_(outputType), valueStream_(std::move(valueStream)) {
-    VELOX_CHECK_NOT_NULL(valueStream_);
-  }
+      int32_t iterIdx)
+      : facebook::velox::core::PlanNode(id), outputType_(outputType), iterIdx_(iterIdx) {}
 
   const facebook::velox::RowTypePtr& outputType() const override {
     return outputType_;
@@ -63,8 +100,8 @@ class ValueStreamNode : public facebook::velox::core::PlanNode {
     return kEmptySources;
   };
 
-  const std::shared_ptr<RowVectorStream>& rowVectorStream() const {
-    return valueStream_;
+  int32_t iterIdx() const {
+    return iterIdx_;
   }
 
   std::string_view name() const override {
@@ -79,7 +116,7 @@ class ValueStreamNode : public facebook::velox::core::PlanNode {
   void addDetails(std::stringstream& stream) const {};
 
   const facebook::velox::RowTypePtr outputType_;
-  std::shared_ptr<RowVectorStream> valueStream_;
+  const int32_t iterIdx_;
   const std::vector<facebook::velox::core::PlanNodePtr> kEmptySources;
 };
 
@@ -95,7 +132,8 @@ class ValueStream : public facebook::velox::exec::SourceOperator {
             operatorId,
             valueStreamNode->id(),
             "ValueStream") {
-    valueStream_ = valueStreamNode->rowVectorStream();
+    auto inputIter = ValueStreamRegistry::getInputIter(driverCtx->task.get(), valueStreamNode->iterIdx());
+    valueStream_ = std::make_shared<RowVectorStream>(std::move(inputIter), valueStreamNode->outputType());
   }
 
   facebook::velox::RowVectorPtr getOutput() override {
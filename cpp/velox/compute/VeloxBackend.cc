@@ -61,6 +61,40 @@ void VeloxBackend::getInfoAndIds(
   }
 }
 
+std::shared_ptr<const VeloxPlanTemplate> VeloxBackend::getPlanTemplate(
+    std::vector<std::shared_ptr<velox::substrait::SplitInfo>>& scanInfos) {
+  auto& planCache = VeloxPlanCache::instance();
+  std::optional<std::vector<::substrait::ReadRel*>> fileReads;
+  std::string key;
+  if (planCache.enabled() && (fileReads = collectFileReads(substraitPlan_))) {
+    key = makePlanCacheKey(substraitPlan_, *fileReads);
+    if (auto planTemplate = planCache.get(key)) {
+      // Bind the files of this task.
+      for (int32_t idx = 0; idx < planTemplate->scanIds.size(); idx++) {
+        const auto& fileRead = *(*fileReads)[planTemplate->fileReadIndices[idx]];
+        scanInfos.emplace_back(makeSplitInfo(fileRead, *planTemplate->scanInfos[idx]));
+      }
+      return planTemplate;
+    }
+  }
+
+  auto planTemplate = std::make_shared<VeloxPlanTemplate>();
+  auto veloxPlanConverter = std::make_unique<VeloxPlanConverter>(inputIters_);
+  planTemplate->plan = veloxPlanConverter->toVeloxPlan(substraitPlan_);
+  // Separate the scan ids and stream ids, and get the scan infos.
+  getInfoAndIds(
+      veloxPlanConverter->splitInfos(),
+      planTemplate->plan->leafPlanNodeIds(),
+      planTemplate->scanInfos,
+      planTemplate->scanIds,
+      planTemplate->streamIds);
+  scanInfos = planTemplate->scanInfos;
+  if (fileReads && matchFileReads(*planTemplate, *fileReads)) {
+    planCache.put(key, planTemplate);
+  }
+  return planTemplate;
+}
+
 std::shared_ptr<ResultIterator> VeloxBackend::getResultIterator(
     MemoryAllocator* allocator,
     const std::string& spillDir,
@@ -72,27 +106,26 @@ std::shared_ptr<ResultIterator> VeloxBackend::getResultIterator(
 
   auto veloxPool = asAggregateVeloxMemoryPool(allocator);
   auto ctxPool = veloxPool->addAggregateChild("result_iterator", facebook::velox::memory::MemoryReclaimer::create());
-  auto veloxPlanConverter = std::make_unique<VeloxPlanConverter>(inputIters_);
-  veloxPlan_ = veloxPlanConverter->toVeloxPlan(substraitPlan_);
 
   // Scan node can be required.
   std::vector<std::shared_ptr<velox::substrait::SplitInfo>> scanInfos;
-  std::vector<velox::core::PlanNodeId> scanIds;
-  std::vector<velox::core::PlanNodeId> streamIds;
-
-  // Separate the scan ids and stream ids, and get the scan infos.
-  getInfoAndIds(veloxPlanConverter->splitInfos(), veloxPlan_->leafPlanNodeIds(), scanInfos, scanIds, streamIds);
+  auto planTemplate = getPlanTemplate(scanInfos);
+  veloxPlan_ = planTemplate->plan;
+  const auto& scanIds = planTemplate->scanIds;
+  const auto& streamIds = planTemplate->streamIds;
 
+  std::unique_ptr<WholeStageResultIterator> wholestageIter;
   if (scanInfos.size() == 0) {
     // Source node is not required.
-    auto wholestageIter = std::make_unique<WholeStageResultIteratorMiddleStage>(
+    wholestageIter = std::make_unique<WholeStageResultIteratorMiddleStage>(
         ctxPool, veloxPlan_, streamIds, spillDir, sessionConf, taskInfo_);
-    return std::make_shared<ResultIterator>(std::move(wholestageIter), shared_from_this());
   } else {
-    auto wholestageIter = std::make_unique<WholeStageResultIteratorFirstStage>(
+    wholestageIter = std::make_unique<WholeStageResultIteratorFirstStage>(
         ctxPool, veloxPlan_, scanIds, scanInfos, streamIds, spillDir, sessionConf, taskInfo_);
-    return std::make_shared<ResultIterator>(std::move(wholestageIter), shared_from_this());
   }
+  // The plan may be shared with other tasks, the input streams are bound to this task.
+  ValueStreamRegistry::registerTask(wholestageIter->task_.get(), inputIters_);
+  return std::make_shared<ResultIterator>(std::move(wholestageIter), shared_from_this());
 }
 
 arrow::Result<std::shared_ptr<ColumnarToRowConverter>> VeloxBackend::getColumnar2RowConverter(
@@ -112,10 +145,9 @@ arrow::Result<std::shared_ptr<ColumnarToRowConverter>> VeloxBackend::getColumnar
 std::shared_ptr<RowToColumnarConverter> VeloxBackend::getRowToColumnarConverter(
     MemoryAllocator* allocator,
     struct ArrowSchema* cSchema) {
-  // TODO: wait to fix task memory pool
-  auto veloxPool = defaultLeafVeloxMemoryPool();
-  // AsWrappedVeloxAggregateMemoryPool(allocator)->addChild("row_to_columnar", velox::memory::MemoryPool::Kind::kLeaf);
-  return std::make_shared<VeloxRowToColumnarConverter>(cSchema, veloxPool);
+  auto veloxPool = asAggregateVeloxMemoryPool(allocator);
+  auto ctxVeloxPool = veloxPool->addLeafChild("row_to_columnar");
+  return std::make_shared<VeloxRowToColumnarConverter>(cSchema, ctxVeloxPool);
 }
 
 std::shared_ptr<ShuffleWriter> VeloxBackend::makeShuffleWriter(
@@ -130,11 +162,12 @@ std::shared_ptr<ShuffleWriter> VeloxBackend::makeShuffleWriter(
 
 std::shared_ptr<ColumnarBatchSerializer> VeloxBackend::getColumnarBatchSerializer(
     MemoryAllocator* allocator,
-    struct ArrowSchema* cSchema) {
+    struct ArrowSchema* cSchema,
+    arrow::Compression::type compressionType) {
   auto arrowPool = asArrowMemoryPool(allocator);
   auto veloxPool = asAggregateVeloxMemoryPool(allocator);
   auto ctxVeloxPool = veloxPool->addLeafChild("velox_columnar_batch_serializer");
-  return std::make_shared<VeloxColumnarBatchSerializer>(arrowPool, ctxVeloxPool, cSchema);
+  return std::make_shared<VeloxColumnarBatchSerializer>(arrowPool, ctxVeloxPool, cSchema, compressionType);
 }
 
 } // namespace gluten
@@ -28,6 +28,7 @@
 #include "WholeStageResultIterator.h"
 #include "compute/Backend.h"
 #include "compute/VeloxParquetDatasource.h"
+#include "compute/VeloxPlanCache.h"
 #include "operators/serializer/VeloxColumnarBatchSerializer.h"
 #include "shuffle/ShuffleWriter.h"
 #include "shuffle/VeloxShuffleReader.h"
@@ -82,7 +83,8 @@ class VeloxBackend final : public Backend {
 
   std::shared_ptr<ColumnarBatchSerializer> getColumnarBatchSerializer(
       MemoryAllocator* allocator,
-      struct ArrowSchema* cSchema) override;
+      struct ArrowSchema* cSchema,
+      arrow::Compression::type compressionType = arrow::Compression::UNCOMPRESSED) override;
 
   std::shared_ptr<const facebook::velox::core::PlanNode> getVeloxPlan() {
     return veloxPlan_;
@@ -98,6 +100,11 @@ class VeloxBackend final : public Backend {
       std::vector<facebook::velox::core::PlanNodeId>& streamIds);
 
  private:
+  /// Converts the substrait plan, or takes the Velox plan from the plan cache if another task of the stage already
+  /// did. Returns the scan infos of this task in scanInfos.
+  std::shared_ptr<const VeloxPlanTemplate> getPlanTemplate(
+      std::vector<std::shared_ptr<facebook::velox::substrait::SplitInfo>>& scanInfos);
+
   std::vector<std::shared_ptr<ResultIterator>> inputIters_;
   std::shared_ptr<const facebook::velox::core::PlanNode> veloxPlan_;
 };
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VeloxBatchResizer.h"
+
+#include <algorithm>
+
+using namespace facebook;
+
+namespace gluten {
+
+velox::RowVectorPtr VeloxBatchResizer::next() {
+  if (splitting_ != nullptr) {
+    return nextSlice();
+  }
+  auto vector = pull();
+  if (vector == nullptr) {
+    return nullptr;
+  }
+  if (targetBytes_ <= 0) {
+    // Resizing is off, don't pay for the size estimate.
+    return emit(std::move(vector), 0);
+  }
+  int64_t bytes = vector->estimateFlatSize();
+  if (bytes > 2 * targetBytes_ && vector->size() > 1) {
+    numSplit_++;
+    bytesPerRow_ = std::max<int64_t>(1, bytes / vector->size());
+    sliceRows_ = std::clamp<int64_t>(targetBytes_ / bytesPerRow_, 1, vector->size());
+    splitting_ = std::move(vector);
+    splitOffset_ = 0;
+    return nextSlice();
+  }
+  if (bytes < targetBytes_ / 2 && vector->size() < maxRows_) {
+    return coalesce(std::move(vector), bytes);
+  }
+  return emit(std::move(vector), bytes);
+}
+
+velox::RowVectorPtr VeloxBatchResizer::pull() {
+  if (pending_ != nullptr) {
+    return std::move(pending_);
+  }
+  if (sourceFinished_) {
+    return nullptr;
+  }
+  auto vector = source_();
+  sourceFinished_ = vector == nullptr;
+  return vector;
+}
+
+velox::RowVectorPtr VeloxBatchResizer::nextSlice() {
+  auto rows = std::min(sliceRows_, splitting_->size() - splitOffset_);
+  auto slice = std::static_pointer_cast<velox::RowVector>(splitting_->slice(splitOffset_, rows));
+  splitOffset_ += rows;
+  if (splitOffset_ == splitting_->size()) {
+    splitting_ = nullptr;
+  }
+  return emit(std::move(slice), rows * bytesPerRow_);
+}
+
+velox::RowVectorPtr VeloxBatchResizer::coalesce(velox::RowVectorPtr first, int64_t firstBytes) {
+  std::vector<velox::RowVectorPtr> vectors{first};
+  int64_t rows = first->size();
+  int64_t bytes = firstBytes;
+  while (rows < maxRows_ && bytes < targetBytes_) {
+    auto vector = pull();
+    if (vector == nullptr) {
+      break;
+    }
+    int64_t vectorBytes = vector->estimateFlatSize();
+    if (rows + vector->size() > maxRows_ || bytes + vectorBytes > targetBytes_) {
+      // Left for the next batch.
+      pending_ = std::move(vector);
+      break;
+    }
+    rows += vector->size();
+    bytes += vectorBytes;
+    vectors.emplace_back(std::move(vector));
+  }
+  if (vectors.size() == 1) {
+    return emit(std::move(first), firstBytes);
+  }
+
+  auto result = std::static_pointer_cast<velox::RowVector>(velox::BaseVector::create(first->type(), rows, pool_));
+  velox::vector_size_t offset = 0;
+  for (const auto& vector : vectors) {
+    result->copy(vector.get(), offset, 0, vector->size());
+    offset += vector->size();
+  }
+  numCoalesced_ += vectors.size();
+  return emit(std::move(result), bytes);
+}
+
+velox::RowVectorPtr VeloxBatchResizer::emit(velox::RowVectorPtr vector, int64_t bytes) {
+  numBatches_++;
+  numRows_ += vector->size();
+  numBytes_ += bytes;
+  return vector;
+}
+
+} // namespace gluten
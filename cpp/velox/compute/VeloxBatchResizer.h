@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "velox/vector/ComplexVector.h"
+
+namespace gluten {
+
+/// Resizes the vectors coming out of a Velox task toward a byte target, so that each batch handed to Spark carries a
+/// similar amount of data whatever the selectivity or the width of the rows. Vectors under half the target are
+/// coalesced, up to the target and `maxRows`. Vectors over twice the target are split into zero-copy slices of about
+/// the target.
+class VeloxBatchResizer {
+ public:
+  /// Returns the next vector of the task, or nullptr once it has no more.
+  using Source = std::function<facebook::velox::RowVectorPtr()>;
+
+  /// A `targetBytes` of 0 passes the vectors through unchanged.
+  VeloxBatchResizer(facebook::velox::memory::MemoryPool* pool, int32_t maxRows, int64_t targetBytes, Source source)
+      : pool_(pool), maxRows_(maxRows), targetBytes_(targetBytes), source_(std::move(source)) {}
+
+  facebook::velox::RowVectorPtr next();
+
+  int64_t numBatches() const {
+    return numBatches_;
+  }
+
+  int64_t numRows() const {
+    return numRows_;
+  }
+
+  /// Estimated flat size of the emitted vectors, not tracked when resizing is off.
+  int64_t numBytes() const {
+    return numBytes_;
+  }
+
+  /// Vectors of the task which were copied into another one.
+  int64_t numCoalesced() const {
+    return numCoalesced_;
+  }
+
+  /// Vectors of the task which were split.
+  int64_t numSplit() const {
+    return numSplit_;
+  }
+
+ private:
+  facebook::velox::RowVectorPtr pull();
+
+  facebook::velox::RowVectorPtr nextSlice();
+
+  facebook::velox::RowVectorPtr coalesce(facebook::velox::RowVectorPtr first, int64_t firstBytes);
+
+  facebook::velox::RowVectorPtr emit(facebook::velox::RowVectorPtr vector, int64_t bytes);
+
+  facebook::velox::memory::MemoryPool* pool_;
+  const int32_t maxRows_;
+  const int64_t targetBytes_;
+  Source source_;
+  bool sourceFinished_ = false;
+
+  // A vector pulled while coalescing which didn't fit in the batch.
+  facebook::velox::RowVectorPtr pending_;
+
+  // The vector being split, with the next row to slice from.
+  facebook::velox::RowVectorPtr splitting_;
+  facebook::velox::vector_size_t splitOffset_ = 0;
+  facebook::velox::vector_size_t sliceRows_ = 0;
+  int64_t bytesPerRow_ = 0;
+
+  int64_t numBatches_ = 0;
+  int64_t numRows_ = 0;
+  int64_t numBytes_ = 0;
+  int64_t numCoalesced_ = 0;
+  int64_t numSplit_ = 0;
+};
+
+} // namespace gluten
@@ -17,229 +17,295 @@
 
 #include "VeloxColumnarToRowConverter.h"
 
-#include <arrow/array/array_base.h>
 #include <arrow/buffer.h>
-#include <arrow/c/abi.h>
-#include <arrow/type_traits.h>
 #include <arrow/util/decimal.h>
 
-#include "ArrowTypeUtils.h"
-#include "arrow/c/bridge.h"
-#include "arrow/c/helpers.h"
+#include <limits>
+
 #include "memory/VeloxColumnarBatch.h"
-#include "velox/row/UnsafeRowDeserializers.h"
-#include "velox/row/UnsafeRowFast.h"
-#include "velox/vector/arrow/Bridge.h"
 
 using namespace facebook;
 using arrow::MemoryPool;
 
 namespace gluten {
 
-arrow::Status VeloxColumnarToRowConverter::init() {
-  numRows_ = rv_->size();
-  numCols_ = rv_->childrenSize();
+namespace {
 
-  ArrowSchema cSchema{};
-  velox::exportToArrow(rv_, cSchema);
-  ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Schema> schema, arrow::ImportSchema(&cSchema));
-  if (numCols_ != schema->num_fields()) {
-    return arrow::Status::Invalid("Mismatch: num_cols_ != schema->num_fields()");
-  }
-  schema_ = schema;
+// Fixed-width values take a whole 8-byte word in UnsafeRow, zero-extended.
+template <typename T>
+inline void writeWord(uint8_t* address, T value) {
+  uint64_t word = 0;
+  memcpy(&word, &value, sizeof(T));
+  *reinterpret_cast<uint64_t*>(address) = word;
+}
+
+template <typename T>
+inline T toUnsafeRowValue(T value) {
+  return value;
+}
+
+inline int64_t toUnsafeRowValue(velox::Timestamp value) {
+  return value.toMicros();
+}
+
+inline int32_t toUnsafeRowValue(velox::Date value) {
+  return value.days();
+}
 
-  // The input is Arrow batch. We need to resume Velox Vector here.
-  vecs_.clear();
-  resumeVeloxVector();
+} // namespace
+
+arrow::Status VeloxColumnarToRowConverter::init() {
+  numCols_ = rv_->childrenSize();
+  auto batchRows = rv_->size();
+  const auto& rowType = rv_->type()->asRow();
 
   // Calculate the initial size
   nullBitsetWidthInBytes_ = calculateBitSetWidthInBytes(numCols_);
-  int64_t fixedSizePerRow = calculatedFixeSizePerRow(schema_, numCols_);
+  int64_t fixedSizePerRow = nullBitsetWidthInBytes_ + 8L * numCols_;
 
-  // Initialize the offsets_ , lengths_, buffer_cursor_
-  lengths_.clear();
-  offsets_.clear();
-  bufferCursor_.clear();
-
-  lengths_.resize(numRows_, fixedSizePerRow);
-  offsets_.resize(numRows_, 0);
-  bufferCursor_.resize(numRows_, nullBitsetWidthInBytes_ + 8 * numCols_);
-
-  // Calculated the lengths_
-  for (int64_t colIdx = 0; colIdx < numCols_; colIdx++) {
-    std::shared_ptr<arrow::Field> field = schema_->field(colIdx);
-    if (arrow::is_binary_like(field->type()->id())) {
-      auto strViews = vecs_[colIdx]->asFlatVector<velox::StringView>()->rawValues();
-      for (int rowIdx = 0; rowIdx < numRows_; rowIdx++) {
-        auto length = strViews[rowIdx].size();
-        int64_t bytes = roundNumberOfBytesToNearestWord(length);
-        lengths_[rowIdx] += bytes;
+  decoded_.resize(numCols_);
+  for (int32_t colIdx = 0; colIdx < numCols_; colIdx++) {
+    const auto& type = rowType.childAt(colIdx);
+    switch (type->kind()) {
+      // We should keep supported types consistent with that in #buildCheck of GlutenColumnarToRowExec.scala.
+      case velox::TypeKind::BOOLEAN:
+      case velox::TypeKind::TINYINT:
+      case velox::TypeKind::SMALLINT:
+      case velox::TypeKind::INTEGER:
+      case velox::TypeKind::BIGINT:
+      case velox::TypeKind::REAL:
+      case velox::TypeKind::DOUBLE:
+      case velox::TypeKind::DATE:
+      case velox::TypeKind::TIMESTAMP:
+      case velox::TypeKind::VARCHAR:
+      case velox::TypeKind::VARBINARY:
+        break;
+      case velox::TypeKind::HUGEINT:
+        if (type->isLongDecimal()) {
+          // Long decimals always reserve 16 bytes of variable length data.
+          fixedSizePerRow += 16;
+          break;
+        }
+        [[fallthrough]];
+      default:
+        return arrow::Status::Invalid(
+            "Type " + type->toString() + " is not supported in VeloxColumnarToRow conversion.");
+    }
+    decoded_[colIdx].decode(*rv_->childAt(colIdx));
+  }
+
+  // Calculate the size of every row of the batch.
+  rowSizes_.clear();
+  rowSizes_.resize(batchRows, fixedSizePerRow);
+  for (int32_t colIdx = 0; colIdx < numCols_; colIdx++) {
+    auto kind = rowType.childAt(colIdx)->kind();
+    if (kind != velox::TypeKind::VARCHAR && kind != velox::TypeKind::VARBINARY) {
+      continue;
+    }
+    const auto& decoded = decoded_[colIdx];
+    for (int32_t rowIdx = 0; rowIdx < batchRows; rowIdx++) {
+      if (!decoded.isNullAt(rowIdx)) {
+        rowSizes_[rowIdx] += roundNumberOfBytesToNearestWord(decoded.valueAt<velox::StringView>(rowIdx).size());
       }
     }
   }
+  return arrow::Status::OK();
+}
+
+arrow::Status VeloxColumnarToRowConverter::initChunk(int32_t startRow, int64_t memoryThreshold) {
+  int32_t batchRows = rowSizes_.size();
+  if (startRow < 0 || (startRow >= batchRows && batchRows > 0)) {
+    return arrow::Status::Invalid(
+        "Start row " + std::to_string(startRow) + " is out of the batch of " + std::to_string(batchRows) + " rows.");
+  }
 
-  // Calculated the offsets_  and total memory size based on lengths_
-  int64_t totalMemorySize = lengths_[0];
-  for (int64_t rowIdx = 1; rowIdx < numRows_; rowIdx++) {
-    offsets_[rowIdx] = offsets_[rowIdx - 1] + lengths_[rowIdx - 1];
-    totalMemorySize += lengths_[rowIdx];
+  // Take rows until the threshold is reached, at least one row.
+  int64_t totalMemorySize = 0;
+  int32_t endRow = startRow;
+  while (endRow < batchRows && (endRow == startRow || totalMemorySize + rowSizes_[endRow] <= memoryThreshold)) {
+    totalMemorySize += rowSizes_[endRow++];
   }
+  startRow_ = startRow;
+  numRows_ = endRow - startRow;
 
-  if (buffer_ == nullptr) {
-    // First allocate memory
-    ARROW_ASSIGN_OR_RAISE(buffer_, arrow::AllocateBuffer(totalMemorySize * 1.2, arrowPool_.get()));
-  } else if (buffer_->capacity() < totalMemorySize) {
-    ARROW_ASSIGN_OR_RAISE(buffer_, arrow::AllocateBuffer(totalMemorySize * 1.2, arrowPool_.get()));
+  // Initialize the offsets_ , lengths_, buffer_cursor_
+  lengths_.assign(rowSizes_.begin() + startRow, rowSizes_.begin() + endRow);
+  offsets_.resize(numRows_);
+  bufferCursor_.assign(numRows_, nullBitsetWidthInBytes_ + 8 * numCols_);
+  int64_t offset = 0;
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    offsets_[rowIdx] = offset;
+    offset += lengths_[rowIdx];
   }
 
+  // The buffer is reused across chunks and batches. The old buffer is released before allocating a larger one, its
+  // content is never needed.
+  if (buffer_ == nullptr || buffer_->capacity() < totalMemorySize) {
+    buffer_.reset();
+    auto capacity = std::max(totalMemorySize, std::min<int64_t>(totalMemorySize * 1.2, memoryThreshold));
+    ARROW_ASSIGN_OR_RAISE(buffer_, arrow::AllocateBuffer(capacity, arrowPool_.get()));
+  }
   bufferAddress_ = buffer_->mutable_data();
-  memset(bufferAddress_, 0, sizeof(int8_t) * totalMemorySize);
+
+  // Only the null bits need zeroing, all the fields and the padding of variable length data are written.
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    memset(bufferAddress_ + offsets_[rowIdx], 0, nullBitsetWidthInBytes_);
+  }
   return arrow::Status::OK();
 }
 
-void VeloxColumnarToRowConverter::resumeVeloxVector() {
-  vecs_.reserve(numCols_);
-  for (int colIdx = 0; colIdx < numCols_; colIdx++) {
-    vecs_.push_back(rv_->childAt(colIdx));
+void VeloxColumnarToRowConverter::writeNulls(int32_t colIdx) {
+  const auto& decoded = decoded_[colIdx];
+  if (!decoded.mayHaveNulls()) {
+    return;
+  }
+  auto fieldOffset = getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    if (decoded.isNullAt(startRow_ + rowIdx)) {
+      setNullAt(bufferAddress_, offsets_[rowIdx], fieldOffset, colIdx);
+    }
   }
 }
 
-arrow::Status VeloxColumnarToRowConverter::write(std::shared_ptr<ColumnarBatch> cb) {
-  auto veloxBatch = std::dynamic_pointer_cast<VeloxColumnarBatch>(cb);
-  rv_ = veloxBatch->getFlattenedRowVector();
-  RETURN_NOT_OK(init());
-  for (int col_idx = 0; col_idx < numCols_; col_idx++) {
-    auto vec = vecs_[col_idx];
-    bool mayHaveNulls = vec->mayHaveNulls();
-
-    int64_t field_offset = getFieldOffset(nullBitsetWidthInBytes_, col_idx);
-    velox::row::UnsafeRowFast fast(rv_);
-#define SERIALIZE_COLUMN(DataType)                                             \
-  do {                                                                         \
-    if (mayHaveNulls) {                                                        \
-      for (int row_idx = 0; row_idx < numRows_; row_idx++) {                   \
-        if (vec->isNullAt(row_idx)) {                                          \
-          setNullAt(bufferAddress_, offsets_[row_idx], field_offset, col_idx); \
-        } else {                                                               \
-          auto write_address = (char*)(bufferAddress_ + offsets_[row_idx]);    \
-          fast.serialize(row_idx, write_address);                              \
-        }                                                                      \
-      }                                                                        \
-    } else {                                                                   \
-      for (int row_idx = 0; row_idx < numRows_; row_idx++) {                   \
-        auto write_address = (char*)(bufferAddress_ + offsets_[row_idx]);      \
-        fast.serialize(row_idx, write_address);                                \
-      }                                                                        \
-    }                                                                          \
-  } while (0)
-
-    auto colTypeId = schema_->field(col_idx)->type()->id();
-    switch (colTypeId) {
-      // We should keep supported types consistent with that in #buildCheck of GlutenColumnarToRowExec.scala.
-      case arrow::Int8Type::type_id: {
-        SERIALIZE_COLUMN(TinyintType);
-        break;
+template <typename T>
+void VeloxColumnarToRowConverter::writeFixedWidth(int32_t colIdx) {
+  const auto& decoded = decoded_[colIdx];
+  auto fieldAddress = bufferAddress_ + getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  // Booleans are bit-packed in Velox, they can't be read from the raw values.
+  if constexpr (!std::is_same_v<T, bool>) {
+    if (decoded.isIdentityMapping() && !decoded.mayHaveNulls()) {
+      auto values = decoded.data<T>() + startRow_;
+      for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+        writeWord(fieldAddress + offsets_[rowIdx], toUnsafeRowValue(values[rowIdx]));
       }
-      case arrow::Int16Type::type_id: {
-        SERIALIZE_COLUMN(SmallintType);
+      return;
+    }
+  }
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    if (!decoded.isNullAt(startRow_ + rowIdx)) {
+      writeWord(fieldAddress + offsets_[rowIdx], toUnsafeRowValue(decoded.valueAt<T>(startRow_ + rowIdx)));
+    }
+  }
+}
+
+void VeloxColumnarToRowConverter::writeString(int32_t colIdx) {
+  const auto& decoded = decoded_[colIdx];
+  auto fieldOffset = getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    if (decoded.isNullAt(startRow_ + rowIdx)) {
+      continue;
+    }
+    auto value = decoded.valueAt<velox::StringView>(startRow_ + rowIdx);
+    int32_t length = value.size();
+    int32_t paddedLength = roundNumberOfBytesToNearestWord(length);
+    auto rowAddress = bufferAddress_ + offsets_[rowIdx];
+    auto& cursor = bufferCursor_[rowIdx];
+    if (paddedLength > length) {
+      // Zero the padding.
+      *reinterpret_cast<uint64_t*>(rowAddress + cursor + paddedLength - 8) = 0;
+    }
+    // Write the variable value.
+    memcpy(rowAddress + cursor, value.data(), length);
+    // Write the offset and size.
+    writeWord(rowAddress + fieldOffset, (static_cast<int64_t>(cursor) << 32) | length);
+    cursor += paddedLength;
+  }
+}
+
+void VeloxColumnarToRowConverter::writeLongDecimal(int32_t colIdx) {
+  const auto& decoded = decoded_[colIdx];
+  auto fieldOffset = getFieldOffset(nullBitsetWidthInBytes_, colIdx);
+  for (int32_t rowIdx = 0; rowIdx < numRows_; rowIdx++) {
+    auto rowAddress = bufferAddress_ + offsets_[rowIdx];
+    auto& cursor = bufferCursor_[rowIdx];
+    memset(rowAddress + cursor, 0, 16);
+    if (!decoded.isNullAt(startRow_ + rowIdx)) {
+      auto value = decoded.valueAt<velox::int128_t>(startRow_ + rowIdx);
+      int64_t high = value >> 64;
+      uint64_t lower = static_cast<uint64_t>(value);
+      int32_t size;
+      auto out = toByteArray(arrow::Decimal128(high, lower), &size);
+      assert(size <= 16);
+      // write the variable value
+      memcpy(rowAddress + cursor, &out[0], size);
+      // write the offset and size
+      writeWord(rowAddress + fieldOffset, (static_cast<int64_t>(cursor) << 32) | size);
+    }
+    // Update the cursor of the buffer.
+    cursor += 16;
+  }
+}
+
+arrow::Status VeloxColumnarToRowConverter::convert() {
+  // One pass per column.
+  for (int32_t colIdx = 0; colIdx < numCols_; colIdx++) {
+    writeNulls(colIdx);
+    switch (rv_->childAt(colIdx)->typeKind()) {
+      case velox::TypeKind::BOOLEAN:
+        writeFixedWidth<bool>(colIdx);
         break;
-      }
-      case arrow::Int32Type::type_id: {
-        SERIALIZE_COLUMN(IntegerType);
+      case velox::TypeKind::TINYINT:
+        writeFixedWidth<int8_t>(colIdx);
         break;
-      }
-      case arrow::Int64Type::type_id: {
-        SERIALIZE_COLUMN(BigintType);
+      case velox::TypeKind::SMALLINT:
+        writeFixedWidth<int16_t>(colIdx);
         break;
-      }
-      case arrow::Date32Type::type_id: {
-        SERIALIZE_COLUMN(DateType);
+      case velox::TypeKind::INTEGER:
+        writeFixedWidth<int32_t>(colIdx);
         break;
-      }
-      case arrow::FloatType::type_id: {
-        SERIALIZE_COLUMN(RealType);
+      // Includes short decimals, written as their unscaled long value.
+      case velox::TypeKind::BIGINT:
+        writeFixedWidth<int64_t>(colIdx);
         break;
-      }
-      case arrow::DoubleType::type_id: {
-        SERIALIZE_COLUMN(DoubleType);
+      case velox::TypeKind::REAL:
+        writeFixedWidth<float>(colIdx);
         break;
-      }
-      case arrow::BooleanType::type_id: {
-        SERIALIZE_COLUMN(BooleanType);
+      case velox::TypeKind::DOUBLE:
+        writeFixedWidth<double>(colIdx);
         break;
-      }
-      case arrow::BinaryType::type_id:
-      case arrow::StringType::type_id: {
-        auto strViews = vec->asFlatVector<velox::StringView>()->rawValues();
-        for (int rowIdx = 0; rowIdx < numRows_; rowIdx++) {
-          if (mayHaveNulls && vec->isNullAt(rowIdx)) {
-            setNullAt(bufferAddress_, offsets_[rowIdx], field_offset, col_idx);
-          } else {
-            int32_t length = (int32_t)strViews[rowIdx].size();
-            auto value = strViews[rowIdx].data();
-            // Write the variable value.
-            memcpy(bufferAddress_ + offsets_[rowIdx] + bufferCursor_[rowIdx], value, length);
-            int64_t offsetAndSize = ((int64_t)bufferCursor_[rowIdx] << 32) | length;
-            // Write the offset and size.
-            memcpy(bufferAddress_ + offsets_[rowIdx] + field_offset, &offsetAndSize, sizeof(int64_t));
-            bufferCursor_[rowIdx] += roundNumberOfBytesToNearestWord(length);
-          }
-        }
+      case velox::TypeKind::DATE:
+        writeFixedWidth<velox::Date>(colIdx);
         break;
-      }
-      case arrow::Decimal128Type::type_id: {
-        for (auto rowIdx = 0; rowIdx < numRows_; rowIdx++) {
-          bool flag = vec->isNullAt(rowIdx);
-          if (vec->typeKind() == velox::TypeKind::BIGINT) {
-            auto shortDecimal = vec->asFlatVector<int64_t>()->rawValues();
-            if (!flag) {
-              // Get the long value and write the long value
-              // Refer to the int64_t() method of Decimal128
-              int64_t longValue = shortDecimal[rowIdx];
-              memcpy(bufferAddress_ + offsets_[rowIdx] + field_offset, &longValue, sizeof(long));
-            } else {
-              setNullAt(bufferAddress_, offsets_[rowIdx], field_offset, col_idx);
-            }
-          } else {
-            if (flag) {
-              setNullAt(bufferAddress_, offsets_[rowIdx], field_offset, col_idx);
-            } else {
-              auto longDecimal = vec->asFlatVector<facebook::velox::int128_t>()->rawValues();
-              int32_t size;
-              velox::int128_t veloxInt128 = longDecimal[rowIdx];
-
-              velox::int128_t orignalValue = veloxInt128;
-              int64_t high = veloxInt128 >> 64;
-              uint64_t lower = (uint64_t)orignalValue;
-
-              auto out = toByteArray(arrow::Decimal128(high, lower), &size);
-              assert(size <= 16);
-
-              // write the variable value
-              memcpy(bufferAddress_ + bufferCursor_[rowIdx] + offsets_[rowIdx], &out[0], size);
-              // write the offset and size
-              int64_t offsetAndSize = ((int64_t)bufferCursor_[rowIdx] << 32) | size;
-              memcpy(bufferAddress_ + offsets_[rowIdx] + field_offset, &offsetAndSize, sizeof(int64_t));
-            }
-
-            // Update the cursor of the buffer.
-            bufferCursor_[rowIdx] += 16;
-          }
-        }
+      case velox::TypeKind::TIMESTAMP:
+        writeFixedWidth<velox::Timestamp>(colIdx);
         break;
-      }
-      case arrow::TimestampType::type_id: {
-        SERIALIZE_COLUMN(TimestampType);
+      case velox::TypeKind::VARCHAR:
+      case velox::TypeKind::VARBINARY:
+        writeString(colIdx);
+        break;
+      case velox::TypeKind::HUGEINT:
+        writeLongDecimal(colIdx);
         break;
-      }
       default:
         return arrow::Status::Invalid(
-            "Type " + schema_->field(col_idx)->type()->name() + " is not supported in VeloxColumnarToRow conversion.");
+            "Type " + rv_->childAt(colIdx)->type()->toString() +
+            " is not supported in VeloxColumnarToRow conversion.");
     }
-
-#undef SERIALIZE_COLUMN
   }
   return arrow::Status::OK();
 }
 
+arrow::Status VeloxColumnarToRowConverter::write(std::shared_ptr<ColumnarBatch> cb) {
+  auto veloxBatch = std::dynamic_pointer_cast<VeloxColumnarBatch>(cb);
+  rv_ = veloxBatch->getRowVector();
+  RETURN_NOT_OK(init());
+  RETURN_NOT_OK(initChunk(0, std::numeric_limits<int64_t>::max()));
+  return convert();
+}
+
+arrow::Status VeloxColumnarToRowConverter::writeChunk(
+    std::shared_ptr<ColumnarBatch> cb,
+    int32_t startRow,
+    int64_t memoryThreshold) {
+  auto veloxBatch = std::dynamic_pointer_cast<VeloxColumnarBatch>(cb);
+  auto rv = veloxBatch->getRowVector();
+  // The batch is decoded and its row sizes computed once, on its first chunk.
+  if (startRow == 0 || rv != rv_) {
+    rv_ = rv;
+    RETURN_NOT_OK(init());
+  }
+  RETURN_NOT_OK(initChunk(startRow, memoryThreshold));
+  return convert();
+}
+
 } // namespace gluten
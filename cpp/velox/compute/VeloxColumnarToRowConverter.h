@@ -23,6 +23,7 @@
 #include "operators/c2r/ArrowColumnarToRowConverter.h"
 #include "operators/c2r/ColumnarToRow.h"
 #include "velox/vector/ComplexVector.h"
+#include "velox/vector/DecodedVector.h"
 
 namespace gluten {
 
@@ -35,15 +36,34 @@ class VeloxColumnarToRowConverter final : public ColumnarToRowConverter {
 
   arrow::Status write(std::shared_ptr<ColumnarBatch> cb) override;
 
- private:
-  void resumeVeloxVector();
+  arrow::Status writeChunk(std::shared_ptr<ColumnarBatch> cb, int32_t startRow, int64_t memoryThreshold) override;
 
+ private:
+  // Decodes the columns of rv_ and computes the size of every row.
   arrow::Status init();
 
+  // Selects the rows of the next chunk and prepares the buffer for them.
+  arrow::Status initChunk(int32_t startRow, int64_t memoryThreshold);
+
+  arrow::Status convert();
+
+  // Sets the null bits and zeroes the fields of the null rows of a column.
+  void writeNulls(int32_t colIdx);
+
+  template <typename T>
+  void writeFixedWidth(int32_t colIdx);
+
+  void writeString(int32_t colIdx);
+
+  void writeLongDecimal(int32_t colIdx);
+
   facebook::velox::RowVectorPtr rv_;
   std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool_;
-  std::vector<facebook::velox::VectorPtr> vecs_;
-  std::shared_ptr<arrow::Schema> schema_;
+  // Columns are read through DecodedVector, dictionary and constant encoded columns are not flattened.
+  std::vector<facebook::velox::DecodedVector> decoded_;
+  std::vector<int32_t> rowSizes_;
+  // The first row of rv_ in the current chunk.
+  int32_t startRow_ = 0;
 };
 
 } // namespace gluten
@@ -68,6 +68,15 @@ const std::string kVeloxIOThreadsDefault = "0";
 const std::string kVeloxSplitPreloadPerDriver = "spark.gluten.sql.columnar.backend.velox.SplitPreloadPerDriver";
 const std::string kVeloxSplitPreloadPerDriverDefault = "2";
 
+// multi-driver execution
+const std::string kVeloxNumDrivers = "spark.gluten.sql.columnar.backend.velox.numDrivers";
+const std::string kVeloxNumDriversDefault = "1";
+const std::string kVeloxDriverThreads = "spark.gluten.sql.columnar.backend.velox.driverThreads";
+
+// plan cache
+const std::string kVeloxPlanCacheSize = "spark.gluten.sql.columnar.backend.velox.planCacheSize";
+const std::string kVeloxPlanCacheSizeDefault = "128";
+
 // spill, mem ratios and thresholds
 const std::string kSpillStrategy = "spark.gluten.sql.columnar.backend.velox.spillStrategy";
 const std::string kMemoryCapRatio = "spark.gluten.sql.columnar.backend.velox.memoryCapRatio";
@@ -201,6 +210,13 @@ void VeloxInitializer::init(const std::unordered_map<std::string, std::string>&
 
   initCache(conf);
   initIOExecutor(conf);
+  initDriverExecutor(conf);
+
+  {
+    auto got = conf.find(kVeloxPlanCacheSize);
+    auto planCacheSize = got == conf.end() ? kVeloxPlanCacheSizeDefault : got->second;
+    VeloxPlanCache::instance().setCapacity(std::stoul(planCacheSize));
+  }
 
 #ifdef GLUTEN_PRINT_DEBUG
   printConf(conf);
@@ -307,6 +323,23 @@ void VeloxInitializer::initIOExecutor(const std::unordered_map<std::string, std:
   }
 }
 
+void VeloxInitializer::initDriverExecutor(const std::unordered_map<std::string, std::string>& conf) {
+  auto got = conf.find(kVeloxNumDrivers);
+  int32_t numDrivers = std::stoi(got == conf.end() ? kVeloxNumDriversDefault : got->second);
+  if (numDrivers <= 1) {
+    return;
+  }
+  // Shared by the tasks of the executor, which bounds the threads used whatever the number of running tasks.
+  int32_t driverThreads = std::thread::hardware_concurrency();
+  got = conf.find(kVeloxDriverThreads);
+  if (got != conf.end() && std::stoi(got->second) > 0) {
+    driverThreads = std::stoi(got->second);
+  }
+  driverExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(driverThreads);
+  LOG(INFO) << "STARTUP: Using multi-driver execution, drivers per task: " << numDrivers
+            << ", driver threads: " << driverThreads;
+}
+
 void VeloxInitializer::create(const std::unordered_map<std::string, std::string>& conf) {
   std::lock_guard<std::mutex> lockGuard(mutex_);
   if (instance_ != nullptr) {
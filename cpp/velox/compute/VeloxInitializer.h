@@ -21,10 +21,12 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 #include <filesystem>
 
 #include "VeloxColumnarToRowConverter.h"
+#include "VeloxPlanCache.h"
 #include "velox/common/caching/AsyncDataCache.h"
 
 namespace gluten {
@@ -33,6 +35,7 @@ namespace gluten {
 class VeloxInitializer {
  public:
   ~VeloxInitializer() {
+    LOG(INFO) << VeloxPlanCache::instance().toString();
     if (dynamic_cast<facebook::velox::cache::AsyncDataCache*>(asyncDataCache_.get())) {
       LOG(INFO) << asyncDataCache_->toString();
       for (const auto& entry : std::filesystem::directory_iterator(cachePathPrefix_)) {
@@ -58,6 +61,11 @@ class VeloxInitializer {
     return spillThreshold_;
   }
 
+  /// Executor running the drivers of multi-threaded tasks, nullptr if multi-driver execution is disabled.
+  folly::Executor* getDriverExecutor() const {
+    return driverExecutor_.get();
+  }
+
  private:
   explicit VeloxInitializer(const std::unordered_map<std::string, std::string>& conf) {
     init(conf);
@@ -66,6 +74,7 @@ class VeloxInitializer {
   void init(const std::unordered_map<std::string, std::string>& conf);
   void initCache(const std::unordered_map<std::string, std::string>& conf);
   void initIOExecutor(const std::unordered_map<std::string, std::string>& conf);
+  void initDriverExecutor(const std::unordered_map<std::string, std::string>& conf);
 
   void printConf(const std::unordered_map<std::string, std::string>& conf);
 
@@ -86,6 +95,7 @@ class VeloxInitializer {
 
   std::unique_ptr<folly::IOThreadPoolExecutor> ssdCacheExecutor_;
   std::unique_ptr<folly::IOThreadPoolExecutor> ioExecutor_;
+  std::unique_ptr<folly::CPUThreadPoolExecutor> driverExecutor_;
 
   std::string cachePathPrefix_;
   std::string cacheFilePrefix_;
@@ -0,0 +1,217 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VeloxPlanCache.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace facebook;
+
+namespace gluten {
+
+namespace {
+
+const std::string kIteratorPrefix = "iterator:";
+
+bool isFileRead(const ::substrait::ReadRel& read) {
+  if (!read.has_local_files()) {
+    return false;
+  }
+  const auto& items = read.local_files().items();
+  return items.size() > 0 && items[0].uri_file().rfind(kIteratorPrefix, 0) != 0;
+}
+
+bool collectFileReads(::substrait::Rel* rel, std::vector<::substrait::ReadRel*>& fileReads) {
+  switch (rel->rel_type_case()) {
+    case ::substrait::Rel::RelTypeCase::kRead:
+      if (isFileRead(rel->read())) {
+        fileReads.emplace_back(rel->mutable_read());
+      }
+      return true;
+    case ::substrait::Rel::RelTypeCase::kFilter:
+      return collectFileReads(rel->mutable_filter()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kFetch:
+      return collectFileReads(rel->mutable_fetch()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kAggregate:
+      return collectFileReads(rel->mutable_aggregate()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kSort:
+      return collectFileReads(rel->mutable_sort()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kProject:
+      return collectFileReads(rel->mutable_project()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kExpand:
+      return collectFileReads(rel->mutable_expand()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kWindow:
+      return collectFileReads(rel->mutable_window()->mutable_input(), fileReads);
+    case ::substrait::Rel::RelTypeCase::kJoin:
+      return collectFileReads(rel->mutable_join()->mutable_left(), fileReads) &&
+          collectFileReads(rel->mutable_join()->mutable_right(), fileReads);
+    default:
+      return false;
+  }
+}
+
+bool sameFiles(const ::substrait::ReadRel& fileRead, const velox::substrait::SplitInfo& splitInfo) {
+  const auto& items = fileRead.local_files().items();
+  if (items.size() != splitInfo.paths.size() || items.size() != splitInfo.starts.size() ||
+      items.size() != splitInfo.lengths.size()) {
+    return false;
+  }
+  for (int32_t i = 0; i < items.size(); ++i) {
+    if (items[i].uri_file() != splitInfo.paths[i] || items[i].start() != splitInfo.starts[i] ||
+        items[i].length() != splitInfo.lengths[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+std::optional<std::vector<::substrait::ReadRel*>> collectFileReads(::substrait::Plan& plan) {
+  std::vector<::substrait::ReadRel*> fileReads;
+  for (auto& relation : *plan.mutable_relations()) {
+    if (relation.has_root() && !collectFileReads(relation.mutable_root()->mutable_input(), fileReads)) {
+      return std::nullopt;
+    }
+    if (relation.has_rel() && !collectFileReads(relation.mutable_rel(), fileReads)) {
+      return std::nullopt;
+    }
+  }
+  return fileReads;
+}
+
+std::string makePlanCacheKey(::substrait::Plan& plan, const std::vector<::substrait::ReadRel*>& fileReads) {
+  // The file lists are swapped out while serializing rather than copying the plan.
+  std::vector<::substrait::ReadRel::LocalFiles> localFiles(fileReads.size());
+  for (size_t i = 0; i < fileReads.size(); ++i) {
+    localFiles[i].Swap(fileReads[i]->mutable_local_files());
+  }
+  std::string key;
+  plan.SerializeToString(&key);
+  for (size_t i = 0; i < fileReads.size(); ++i) {
+    fileReads[i]->mutable_local_files()->Swap(&localFiles[i]);
+    // The format is the only part of the files the converted plan depends on.
+    key += "#" + std::to_string(localFiles[i].items(0).file_format_case());
+  }
+  return key;
+}
+
+bool matchFileReads(VeloxPlanTemplate& planTemplate, const std::vector<::substrait::ReadRel*>& fileReads) {
+  if (planTemplate.scanInfos.size() != fileReads.size()) {
+    return false;
+  }
+  planTemplate.fileReadIndices.clear();
+  for (const auto& scanInfo : planTemplate.scanInfos) {
+    int32_t readIdx = -1;
+    for (int32_t i = 0; i < fileReads.size(); ++i) {
+      if (sameFiles(*fileReads[i], *scanInfo)) {
+        if (readIdx != -1) {
+          // Two reads of the same files, e.g. a self join.
+          return false;
+        }
+        readIdx = i;
+      }
+    }
+    auto& indices = planTemplate.fileReadIndices;
+    if (readIdx == -1 || std::find(indices.begin(), indices.end(), readIdx) != indices.end()) {
+      return false;
+    }
+    planTemplate.fileReadIndices.emplace_back(readIdx);
+  }
+  return true;
+}
+
+std::shared_ptr<velox::substrait::SplitInfo> makeSplitInfo(
+    const ::substrait::ReadRel& fileRead,
+    const velox::substrait::SplitInfo& templateInfo) {
+  auto splitInfo = std::make_shared<velox::substrait::SplitInfo>(templateInfo);
+  const auto& items = fileRead.local_files().items();
+  splitInfo->paths.clear();
+  splitInfo->starts.clear();
+  splitInfo->lengths.clear();
+  splitInfo->paths.reserve(items.size());
+  splitInfo->starts.reserve(items.size());
+  splitInfo->lengths.reserve(items.size());
+  for (const auto& item : items) {
+    splitInfo->paths.emplace_back(item.uri_file());
+    splitInfo->starts.emplace_back(item.start());
+    splitInfo->lengths.emplace_back(item.length());
+  }
+  return splitInfo;
+}
+
+VeloxPlanCache& VeloxPlanCache::instance() {
+  static VeloxPlanCache cache;
+  return cache;
+}
+
+void VeloxPlanCache::setCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  evict();
+}
+
+std::shared_ptr<const VeloxPlanTemplate> VeloxPlanCache::get(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->second;
+}
+
+void VeloxPlanCache::put(const std::string& key, std::shared_ptr<const VeloxPlanTemplate> value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (capacity_ == 0) {
+    return;
+  }
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Another task of the stage converted the plan meanwhile.
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  entries_.emplace_front(key, std::move(value));
+  index_.emplace(entries_.front().first, entries_.begin());
+  evict();
+}
+
+size_t VeloxPlanCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::string VeloxPlanCache::toString() {
+  std::ostringstream oss;
+  oss << "VeloxPlanCache: size " << size() << "/" << capacity_ << ", hits " << hits_ << ", misses " << misses_
+      << ", evictions " << evictions_;
+  return oss.str();
+}
+
+void VeloxPlanCache::evict() {
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    evictions_++;
+  }
+}
+
+} // namespace gluten
@@ -0,0 +1,114 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "substrait/plan.pb.h"
+#include "velox/core/PlanNode.h"
+#include "velox/substrait/SubstraitToVeloxPlan.h"
+
+namespace gluten {
+
+/// A Velox plan converted from a substrait plan, without the splits of the task it was converted for. The tasks of a
+/// stage only differ in the files they scan, so they can share it.
+struct VeloxPlanTemplate {
+  std::shared_ptr<const facebook::velox::core::PlanNode> plan;
+
+  /// The scan nodes, with the index of the substrait file read each of them comes from.
+  std::vector<facebook::velox::core::PlanNodeId> scanIds;
+  std::vector<int32_t> fileReadIndices;
+
+  /// The split infos the plan was converted with, holding everything but the files of a scan.
+  std::vector<std::shared_ptr<facebook::velox::substrait::SplitInfo>> scanInfos;
+
+  std::vector<facebook::velox::core::PlanNodeId> streamIds;
+};
+
+/// The reads of a substrait plan which scan files rather than input iterators, in plan order. Returns std::nullopt if
+/// the plan has a relation the cache doesn't know how to walk.
+std::optional<std::vector<::substrait::ReadRel*>> collectFileReads(::substrait::Plan& plan);
+
+/// Cache key of a plan: its serialized bytes with the file lists of the given reads left out, plus their formats.
+/// The plan is left as it was.
+std::string makePlanCacheKey(::substrait::Plan& plan, const std::vector<::substrait::ReadRel*>& fileReads);
+
+/// Finds the file read each scan of the template was converted from, by comparing their files. Returns false if a scan
+/// doesn't match exactly one read, the template can't be bound to the files of another task then.
+bool matchFileReads(VeloxPlanTemplate& planTemplate, const std::vector<::substrait::ReadRel*>& fileReads);
+
+/// The split info of a file read, based on the one the template was converted with.
+std::shared_ptr<facebook::velox::substrait::SplitInfo> makeSplitInfo(
+    const ::substrait::ReadRel& fileRead,
+    const facebook::velox::substrait::SplitInfo& templateInfo);
+
+/// Process-wide LRU cache of converted plans, shared by all tasks of the executor.
+class VeloxPlanCache {
+ public:
+  static VeloxPlanCache& instance();
+
+  explicit VeloxPlanCache(size_t capacity = 0) : capacity_(capacity) {}
+
+  /// A capacity of 0 disables the cache.
+  void setCapacity(size_t capacity);
+
+  bool enabled() const {
+    return capacity_ > 0;
+  }
+
+  std::shared_ptr<const VeloxPlanTemplate> get(const std::string& key);
+
+  void put(const std::string& key, std::shared_ptr<const VeloxPlanTemplate> value);
+
+  size_t size();
+
+  int64_t hits() const {
+    return hits_;
+  }
+
+  int64_t misses() const {
+    return misses_;
+  }
+
+  int64_t evictions() const {
+    return evictions_;
+  }
+
+  std::string toString();
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<const VeloxPlanTemplate>>;
+
+  void evict();
+
+  std::atomic<size_t> capacity_;
+  std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> evictions_{0};
+};
+
+} // namespace gluten
@@ -104,7 +104,7 @@ void VeloxPlanConverter::setInputPlanNode(const ::substrait::ReadRel& sread) {
   if (iterIdx == -1) {
     return;
   }
-  if (inputIters_.size() == 0) {
+  if (iterIdx >= inputIters_.size()) {
     throw std::runtime_error("Invalid input iterator.");
   }
   // Get the input schema of this iterator.
@@ -130,8 +130,8 @@ void VeloxPlanConverter::setInputPlanNode(const ::substrait::ReadRel& sread) {
     veloxTypeList.push_back(velox::substrait::toVeloxType(subType->type));
   }
   auto outputType = ROW(std::move(outNames), std::move(veloxTypeList));
-  auto vectorStream = std::make_shared<RowVectorStream>(std::move(inputIters_[iterIdx]), outputType);
-  auto valuesNode = std::make_shared<ValueStreamNode>(nextPlanNodeId(), outputType, std::move(vectorStream));
+  // The iterator is bound when the task runs, see ValueStreamRegistry.
+  auto valuesNode = std::make_shared<ValueStreamNode>(nextPlanNodeId(), outputType, iterIdx);
   subVeloxPlanConverter_->insertInputNode(iterIdx, valuesNode, planNodeId_);
 }
 
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "velox/common/future/VeloxPromise.h"
+#include "velox/exec/Driver.h"
+
+namespace gluten {
+
+/// Bounded queue between the drivers of a multi-threaded Velox task and the thread pulling the task's output. A
+/// driver is blocked once the queue holds `capacity` vectors, until the consumer takes one.
+class VeloxResultQueue {
+ public:
+  explicit VeloxResultQueue(size_t capacity) : capacity_(capacity) {}
+
+  /// Called by the drivers. A null vector means a driver finished.
+  facebook::velox::exec::BlockingReason enqueue(
+      facebook::velox::RowVectorPtr vector,
+      facebook::velox::ContinueFuture* future) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return facebook::velox::exec::BlockingReason::kNotBlocked;
+    }
+    notEmpty_.notify_one();
+    if (vector == nullptr) {
+      return facebook::velox::exec::BlockingReason::kNotBlocked;
+    }
+    queue_.push_back(std::move(vector));
+    if (queue_.size() < capacity_) {
+      return facebook::velox::exec::BlockingReason::kNotBlocked;
+    }
+    auto [promise, semiFuture] = facebook::velox::makeVeloxContinuePromiseContract("VeloxResultQueue::enqueue");
+    promises_.emplace_back(std::move(promise));
+    *future = std::move(semiFuture);
+    return facebook::velox::exec::BlockingReason::kWaitForConsumer;
+  }
+
+  /// Takes the next vector, waiting for one if the queue is empty. Returns nullptr once the queue is empty and
+  /// `finished` returns true.
+  facebook::velox::RowVectorPtr dequeue(const std::function<bool()>& finished) {
+    std::vector<facebook::velox::ContinuePromise> promises;
+    facebook::velox::RowVectorPtr vector;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // The drivers don't signal the task's end, poll for it.
+      while (queue_.empty() && !closed_ && !finished()) {
+        notEmpty_.wait_for(lock, std::chrono::milliseconds(10));
+      }
+      if (queue_.empty()) {
+        return nullptr;
+      }
+      vector = std::move(queue_.front());
+      queue_.pop_front();
+      promises.swap(promises_);
+    }
+    // Resume the blocked drivers outside the lock.
+    for (auto& promise : promises) {
+      promise.setValue();
+    }
+    return vector;
+  }
+
+  /// Drops the queued vectors and unblocks the drivers, for the task to be cancelled.
+  void close() {
+    std::vector<facebook::velox::ContinuePromise> promises;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      queue_.clear();
+      promises.swap(promises_);
+    }
+    notEmpty_.notify_all();
+    for (auto& promise : promises) {
+      promise.setValue();
+    }
+  }
+
+ private:
+  const size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::deque<facebook::velox::RowVectorPtr> queue_;
+  std::vector<facebook::velox::ContinuePromise> promises_;
+  bool closed_ = false;
+};
+
+} // namespace gluten
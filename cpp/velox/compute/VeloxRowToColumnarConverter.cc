@@ -18,21 +18,243 @@
 #include "VeloxRowToColumnarConverter.h"
 #include "memory/VeloxColumnarBatch.h"
 #include "velox/row/UnsafeRowDeserializers.h"
+#include "velox/vector/FlatVector.h"
 #include "velox/vector/arrow/Bridge.h"
 
 using namespace facebook::velox;
 namespace gluten {
+
+namespace {
+
+inline bool isNullAt(const uint8_t* row, int32_t index) {
+  return (reinterpret_cast<const uint64_t*>(row)[index >> 6] >> (index & 0x3f)) & 1;
+}
+
+template <typename T>
+inline T readField(const uint8_t* field) {
+  T value;
+  memcpy(&value, field, sizeof(T));
+  return value;
+}
+
+template <>
+inline Date readField<Date>(const uint8_t* field) {
+  return Date(readField<int32_t>(field));
+}
+
+template <>
+inline Timestamp readField<Timestamp>(const uint8_t* field) {
+  return Timestamp::fromMicros(readField<int64_t>(field));
+}
+
+// Spark writes long decimals as big-endian two's complement bytes of minimal length.
+inline int128_t readBigEndianDecimal(const uint8_t* bytes, int32_t size) {
+  unsigned __int128 value = (size > 0 && static_cast<int8_t>(bytes[0]) < 0) ? ~static_cast<unsigned __int128>(0) : 0;
+  for (int32_t i = 0; i < size; i++) {
+    value = (value << 8) | bytes[i];
+  }
+  return static_cast<int128_t>(value);
+}
+
+bool isPrimitiveOnly(const RowType& rowType) {
+  for (const auto& type : rowType.children()) {
+    switch (type->kind()) {
+      case TypeKind::BOOLEAN:
+      case TypeKind::TINYINT:
+      case TypeKind::SMALLINT:
+      case TypeKind::INTEGER:
+      case TypeKind::BIGINT:
+      case TypeKind::REAL:
+      case TypeKind::DOUBLE:
+      case TypeKind::DATE:
+      case TypeKind::TIMESTAMP:
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+      case TypeKind::HUGEINT:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 VeloxRowToColumnarConverter::VeloxRowToColumnarConverter(
     struct ArrowSchema* cSchema,
     std::shared_ptr<memory::MemoryPool> memoryPool)
     : RowToColumnarConverter(cSchema), pool_(memoryPool) {
   rowType_ = importFromArrow(*cSchema);
   ArrowSchemaRelease(cSchema);
+
+  const auto& rowType = rowType_->asRow();
+  primitiveOnly_ = isPrimitiveOnly(rowType);
+  auto numFields = rowType.size();
+  int64_t nullBitsetWidthInBytes = ((numFields + 63) >> 6) << 3;
+  fieldOffsets_.resize(numFields);
+  for (auto i = 0; i < numFields; i++) {
+    fieldOffsets_[i] = nullBitsetWidthInBytes + 8L * i;
+  }
+}
+
+template <typename T>
+VectorPtr VeloxRowToColumnarConverter::readFixedWidth(int32_t colIdx, int64_t numRows) {
+  auto vector = BaseVector::create<FlatVector<T>>(rowType_->childAt(colIdx), numRows, pool_.get());
+  auto fieldOffset = fieldOffsets_[colIdx];
+  uint64_t* rawNulls = nullptr;
+  if constexpr (std::is_same_v<T, bool>) {
+    for (auto i = 0; i < numRows; i++) {
+      if (isNullAt(rows_[i], colIdx)) {
+        vector->setNull(i, true);
+      } else {
+        vector->set(i, readField<bool>(rows_[i] + fieldOffset));
+      }
+    }
+  } else {
+    auto rawValues = vector->mutableRawValues();
+    for (auto i = 0; i < numRows; i++) {
+      if (isNullAt(rows_[i], colIdx)) {
+        if (rawNulls == nullptr) {
+          rawNulls = vector->mutableRawNulls();
+        }
+        bits::setNull(rawNulls, i);
+        rawValues[i] = T();
+      } else {
+        rawValues[i] = readField<T>(rows_[i] + fieldOffset);
+      }
+    }
+  }
+  return vector;
+}
+
+VectorPtr VeloxRowToColumnarConverter::readString(int32_t colIdx, int64_t numRows) {
+  auto vector = BaseVector::create<FlatVector<StringView>>(rowType_->childAt(colIdx), numRows, pool_.get());
+  auto fieldOffset = fieldOffsets_[colIdx];
+
+  // All the strings not inlined in StringView are copied to one buffer.
+  int64_t totalSize = 0;
+  for (auto i = 0; i < numRows; i++) {
+    if (!isNullAt(rows_[i], colIdx)) {
+      auto size = static_cast<uint32_t>(readField<int64_t>(rows_[i] + fieldOffset));
+      if (!StringView::isInline(size)) {
+        totalSize += size;
+      }
+    }
+  }
+  char* arena = nullptr;
+  if (totalSize > 0) {
+    auto buffer = AlignedBuffer::allocate<char>(totalSize, pool_.get());
+    arena = buffer->asMutable<char>();
+    vector->setStringBuffers({buffer});
+  }
+
+  auto rawValues = vector->mutableRawValues();
+  uint64_t* rawNulls = nullptr;
+  for (auto i = 0; i < numRows; i++) {
+    if (isNullAt(rows_[i], colIdx)) {
+      if (rawNulls == nullptr) {
+        rawNulls = vector->mutableRawNulls();
+      }
+      bits::setNull(rawNulls, i);
+      rawValues[i] = StringView();
+      continue;
+    }
+    auto offsetAndSize = readField<int64_t>(rows_[i] + fieldOffset);
+    auto size = static_cast<uint32_t>(offsetAndSize);
+    auto data = reinterpret_cast<const char*>(rows_[i] + (offsetAndSize >> 32));
+    if (StringView::isInline(size)) {
+      rawValues[i] = StringView(data, size);
+    } else {
+      memcpy(arena, data, size);
+      rawValues[i] = StringView(arena, size);
+      arena += size;
+    }
+  }
+  return vector;
+}
+
+VectorPtr VeloxRowToColumnarConverter::readLongDecimal(int32_t colIdx, int64_t numRows) {
+  auto vector = BaseVector::create<FlatVector<int128_t>>(rowType_->childAt(colIdx), numRows, pool_.get());
+  auto fieldOffset = fieldOffsets_[colIdx];
+  auto rawValues = vector->mutableRawValues();
+  uint64_t* rawNulls = nullptr;
+  for (auto i = 0; i < numRows; i++) {
+    if (isNullAt(rows_[i], colIdx)) {
+      if (rawNulls == nullptr) {
+        rawNulls = vector->mutableRawNulls();
+      }
+      bits::setNull(rawNulls, i);
+      rawValues[i] = 0;
+      continue;
+    }
+    auto offsetAndSize = readField<int64_t>(rows_[i] + fieldOffset);
+    auto size = static_cast<int32_t>(static_cast<uint32_t>(offsetAndSize));
+    rawValues[i] = readBigEndianDecimal(rows_[i] + (offsetAndSize >> 32), size);
+  }
+  return vector;
+}
+
+RowVectorPtr VeloxRowToColumnarConverter::readRows(int64_t numRows) {
+  const auto& rowType = rowType_->asRow();
+  std::vector<VectorPtr> children(rowType.size());
+  for (auto colIdx = 0; colIdx < rowType.size(); colIdx++) {
+    switch (rowType.childAt(colIdx)->kind()) {
+      case TypeKind::BOOLEAN:
+        children[colIdx] = readFixedWidth<bool>(colIdx, numRows);
+        break;
+      case TypeKind::TINYINT:
+        children[colIdx] = readFixedWidth<int8_t>(colIdx, numRows);
+        break;
+      case TypeKind::SMALLINT:
+        children[colIdx] = readFixedWidth<int16_t>(colIdx, numRows);
+        break;
+      case TypeKind::INTEGER:
+        children[colIdx] = readFixedWidth<int32_t>(colIdx, numRows);
+        break;
+      case TypeKind::BIGINT:
+        children[colIdx] = readFixedWidth<int64_t>(colIdx, numRows);
+        break;
+      case TypeKind::REAL:
+        children[colIdx] = readFixedWidth<float>(colIdx, numRows);
+        break;
+      case TypeKind::DOUBLE:
+        children[colIdx] = readFixedWidth<double>(colIdx, numRows);
+        break;
+      case TypeKind::DATE:
+        children[colIdx] = readFixedWidth<Date>(colIdx, numRows);
+        break;
+      case TypeKind::TIMESTAMP:
+        children[colIdx] = readFixedWidth<Timestamp>(colIdx, numRows);
+        break;
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+        children[colIdx] = readString(colIdx, numRows);
+        break;
+      case TypeKind::HUGEINT:
+        children[colIdx] = readLongDecimal(colIdx, numRows);
+        break;
+      default:
+        VELOX_UNREACHABLE();
+    }
+  }
+  return std::make_shared<RowVector>(pool_.get(), rowType_, nullptr, numRows, std::move(children));
 }
 
 std::shared_ptr<ColumnarBatch>
 VeloxRowToColumnarConverter::convert(int64_t numRows, int64_t* rowLength, uint8_t* memoryAddress) {
+  if (primitiveOnly_) {
+    rows_.resize(numRows);
+    int64_t offset = 0;
+    for (auto i = 0; i < numRows; i++) {
+      rows_[i] = memoryAddress + offset;
+      offset += rowLength[i];
+    }
+    return std::make_shared<VeloxColumnarBatch>(readRows(numRows));
+  }
+
   std::vector<std::optional<std::string_view>> data;
+  data.reserve(numRows);
   int64_t offset = 0;
   for (auto i = 0; i < numRows; i++) {
     data.emplace_back(std::string_view(reinterpret_cast<const char*>(memoryAddress + offset), rowLength[i]));
@@ -34,8 +34,23 @@ class VeloxRowToColumnarConverter final : public RowToColumnarConverter {
   std::shared_ptr<ColumnarBatch> convert(int64_t numRows, int64_t* rowLength, uint8_t* memoryAddress);
 
  protected:
+  // Reads the rows straight into flat vectors, for schemas with only primitive types.
+  facebook::velox::RowVectorPtr readRows(int64_t numRows);
+
+  template <typename T>
+  facebook::velox::VectorPtr readFixedWidth(int32_t colIdx, int64_t numRows);
+
+  facebook::velox::VectorPtr readString(int32_t colIdx, int64_t numRows);
+
+  facebook::velox::VectorPtr readLongDecimal(int32_t colIdx, int64_t numRows);
+
   facebook::velox::TypePtr rowType_;
   std::shared_ptr<facebook::velox::memory::MemoryPool> pool_;
+  // Whether all the columns can be read by readRows, otherwise the generic UnsafeRow deserializer is used.
+  bool primitiveOnly_;
+  std::vector<int64_t> fieldOffsets_;
+  // Start address of every row of the current batch, reused across batches.
+  std::vector<const uint8_t*> rows_;
 };
 
 } // namespace gluten
@@ -38,6 +38,17 @@ const std::string kSpillPartitionBits = "spark.gluten.sql.columnar.backend.velox
 const std::string kSpillableReservationGrowthPct =
     "spark.gluten.sql.columnar.backend.velox.spillableReservationGrowthPct";
 
+// scan I/O
+const std::string kMaxCoalescedBytes = "spark.gluten.sql.columnar.backend.velox.maxCoalescedBytes";
+const std::string kMaxCoalescedDistanceBytes = "spark.gluten.sql.columnar.backend.velox.maxCoalescedDistanceBytes";
+const std::string kPrefetchRowGroups = "spark.gluten.sql.columnar.backend.velox.prefetchRowGroups";
+
+// output batches
+const std::string kOutputBatchBytes = "spark.gluten.sql.columnar.backend.velox.outputBatchBytes";
+
+// multi-driver execution
+const std::string kNumDrivers = "spark.gluten.sql.columnar.backend.velox.numDrivers";
+
 // metrics
 const std::string kDynamicFiltersProduced = "dynamicFiltersProduced";
 const std::string kDynamicFiltersAccepted = "dynamicFiltersAccepted";
@@ -48,10 +59,32 @@ const std::string kSkippedSplits = "skippedSplits";
 const std::string kProcessedSplits = "processedSplits";
 const std::string kSkippedStrides = "skippedStrides";
 const std::string kProcessedStrides = "processedStrides";
+const std::string kIoWaitTime = "ioWaitNanos";
 
 // others
 const std::string kHiveDefaultPartition = "__HIVE_DEFAULT_PARTITION__";
 
+// Whether each driver can produce its part of the output independently: scans, filters, projections and partial
+// aggregations, whose output is merged by Spark in a later stage anyway.
+bool canRunInParallel(const std::shared_ptr<const velox::core::PlanNode>& planNode) {
+  if (auto aggregation = std::dynamic_pointer_cast<const velox::core::AggregationNode>(planNode)) {
+    if (aggregation->step() != velox::core::AggregationNode::Step::kPartial) {
+      return false;
+    }
+  } else if (
+      !std::dynamic_pointer_cast<const velox::core::TableScanNode>(planNode) &&
+      !std::dynamic_pointer_cast<const velox::core::FilterNode>(planNode) &&
+      !std::dynamic_pointer_cast<const velox::core::ProjectNode>(planNode)) {
+    return false;
+  }
+  for (const auto& source : planNode->sources()) {
+    if (!canRunInParallel(source)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 } // namespace
 
 WholeStageResultIterator::WholeStageResultIterator(
@@ -64,13 +97,19 @@ WholeStageResultIterator::WholeStageResultIterator(
 #endif
   spillStrategy_ = getConfigValue(kSpillStrategy, "threshold");
   getOrderedNodeIds(veloxPlan_, orderedNodeIds_);
+  resizerPool_ = pool_->addLeafChild("output_batch_resizer");
+  resizer_ = std::make_unique<VeloxBatchResizer>(
+      resizerPool_.get(),
+      std::stoi(getConfigValue(kSparkBatchSize, "4096")),
+      std::stol(getConfigValue(kOutputBatchBytes, "0")),
+      [this]() { return nextFromTask(); });
 }
 
-std::shared_ptr<velox::core::QueryCtx> WholeStageResultIterator::createNewVeloxQueryCtx() {
+std::shared_ptr<velox::core::QueryCtx> WholeStageResultIterator::createNewVeloxQueryCtx(folly::Executor* executor) {
   std::unordered_map<std::string, std::shared_ptr<velox::Config>> connectorConfigs;
   connectorConfigs[kHiveConnectorId] = createConnectorConfig();
   std::shared_ptr<velox::core::QueryCtx> ctx = std::make_shared<velox::core::QueryCtx>(
-      nullptr,
+      executor,
       getQueryContextConf(),
       connectorConfigs,
       gluten::VeloxInitializer::get()->getAsyncDataCache(),
@@ -80,12 +119,77 @@ std::shared_ptr<velox::core::QueryCtx> WholeStageResultIterator::createNewVeloxQ
   return ctx;
 }
 
+int32_t WholeStageResultIterator::numDriversFor(const std::shared_ptr<const velox::core::PlanNode>& planNode) {
+  auto numDrivers = std::stoi(getConfigValue(kNumDrivers, "1"));
+  if (numDrivers <= 1 || VeloxInitializer::get()->getDriverExecutor() == nullptr || !canRunInParallel(planNode)) {
+    return 1;
+  }
+  return numDrivers;
+}
+
+void WholeStageResultIterator::createTask(
+    const std::string& taskId,
+    const std::shared_ptr<const velox::core::PlanNode>& planNode,
+    int32_t numDrivers,
+    const std::string& spillDir) {
+  std::unordered_set<velox::core::PlanNodeId> emptySet;
+  velox::core::PlanFragment planFragment{planNode, velox::core::ExecutionStrategy::kUngrouped, 1, emptySet};
+
+  if (numDrivers <= 1) {
+    task_ = velox::exec::Task::create(taskId, std::move(planFragment), 0, createNewVeloxQueryCtx());
+    if (!task_->supportsSingleThreadedExecution()) {
+      throw std::runtime_error("Task doesn't support single thread execution: " + planNode->toString());
+    }
+  } else {
+    // The drivers share the memory pool of the query context, the memory is still reserved for this Spark task. The
+    // queue holds a vector per driver before they are blocked, which keeps the back-pressure of next().
+    numDrivers_ = numDrivers;
+    resultQueue_ = std::make_shared<VeloxResultQueue>(numDrivers);
+    auto queryCtx = createNewVeloxQueryCtx(VeloxInitializer::get()->getDriverExecutor());
+    task_ = velox::exec::Task::create(
+        taskId,
+        std::move(planFragment),
+        0,
+        std::move(queryCtx),
+        [queue = resultQueue_](velox::RowVectorPtr vector, velox::ContinueFuture* future) {
+          return queue->enqueue(std::move(vector), future);
+        });
+  }
+  task_->setSpillDirectory(spillDir);
+}
+
+velox::RowVectorPtr WholeStageResultIterator::nextFromDrivers() {
+  if (!driversStarted_) {
+    // The splits are all added already, the drivers take them from the task as they go.
+    velox::exec::Task::start(task_, numDrivers_);
+    driversStarted_ = true;
+  }
+  auto vector = resultQueue_->dequeue([this]() { return !task_->isRunning(); });
+  if (vector == nullptr && task_->error() != nullptr) {
+    std::rethrow_exception(task_->error());
+  }
+  return vector;
+}
+
 std::shared_ptr<ColumnarBatch> WholeStageResultIterator::next() {
-  addSplits_(task_.get());
-  if (task_->isFinished()) {
+  auto vector = resizer_->next();
+  if (vector == nullptr) {
     return nullptr;
   }
-  velox::RowVectorPtr vector = task_->next();
+  return std::make_shared<VeloxColumnarBatch>(vector);
+}
+
+velox::RowVectorPtr WholeStageResultIterator::nextFromTask() {
+  addSplits_(task_.get());
+  velox::RowVectorPtr vector;
+  if (resultQueue_ != nullptr) {
+    vector = nextFromDrivers();
+  } else {
+    if (task_->isFinished()) {
+      return nullptr;
+    }
+    vector = task_->next();
+  }
   if (vector == nullptr) {
     return nullptr;
   }
@@ -96,8 +200,7 @@ std::shared_ptr<ColumnarBatch> WholeStageResultIterator::next() {
   for (auto& child : vector->children()) {
     child->loadedVector();
   }
-
-  return std::make_shared<VeloxColumnarBatch>(vector);
+  return vector;
 }
 
 int64_t WholeStageResultIterator::spillFixedSize(int64_t size) {
@@ -196,6 +299,8 @@ void WholeStageResultIterator::collectMetrics() {
       metrics_->processedSplits[metricsIdx] = runtimeMetric("sum", entry.second->customStats, kProcessedSplits);
       metrics_->skippedStrides[metricsIdx] = runtimeMetric("sum", entry.second->customStats, kSkippedStrides);
       metrics_->processedStrides[metricsIdx] = runtimeMetric("sum", entry.second->customStats, kProcessedStrides);
+      // Time the scan waited for its reads, next to its wallNanos.
+      metrics_->ioWaitTime[metricsIdx] = runtimeMetric("sum", entry.second->customStats, kIoWaitTime);
       metricsIdx += 1;
     }
   }
@@ -302,6 +407,17 @@ void WholeStageResultIterator::updateHdfsTokens() {
 std::shared_ptr<velox::Config> WholeStageResultIterator::createConnectorConfig() {
   std::unordered_map<std::string, std::string> configs = {};
   configs[velox::connector::hive::HiveConfig::kCaseSensitive] = getConfigValue(kCaseSensitive, "true");
+  // Scan I/O settings are only forwarded when set in Spark, otherwise the Velox defaults apply.
+  const std::vector<std::pair<std::string, std::string>> scanIoConfigs = {
+      {kMaxCoalescedBytes, velox::connector::hive::HiveConfig::kMaxCoalescedBytes},
+      {kMaxCoalescedDistanceBytes, velox::connector::hive::HiveConfig::kMaxCoalescedDistanceBytes},
+      {kPrefetchRowGroups, velox::connector::hive::HiveConfig::kPrefetchRowGroups}};
+  for (const auto& [sparkKey, veloxKey] : scanIoConfigs) {
+    auto got = confMap_.find(sparkKey);
+    if (got != confMap_.end()) {
+      configs[veloxKey] = got->second;
+    }
+  }
   return std::make_shared<velox::core::MemConfig>(configs);
 }
 
@@ -351,21 +467,11 @@ WholeStageResultIteratorFirstStage::WholeStageResultIteratorFirstStage(
     splits_.emplace_back(scanSplits);
   }
 
-  // Set task parameters.
-  std::unordered_set<velox::core::PlanNodeId> emptySet;
-  velox::core::PlanFragment planFragment{planNode, velox::core::ExecutionStrategy::kUngrouped, 1, emptySet};
-  std::shared_ptr<velox::core::QueryCtx> queryCtx = createNewVeloxQueryCtx();
-
-  task_ = velox::exec::Task::create(
+  createTask(
       fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId),
-      std::move(planFragment),
-      0,
-      std::move(queryCtx));
-
-  if (!task_->supportsSingleThreadedExecution()) {
-    throw std::runtime_error("Task doesn't support single thread execution: " + planNode->toString());
-  }
-  task_->setSpillDirectory(spillDir);
+      planNode,
+      numDriversFor(planNode),
+      spillDir);
   addSplits_ = [&](velox::exec::Task* task) {
     if (noMoreSplits_) {
       return;
@@ -431,20 +537,8 @@ WholeStageResultIteratorMiddleStage::WholeStageResultIteratorMiddleStage(
     const std::unordered_map<std::string, std::string>& confMap,
     const SparkTaskInfo taskInfo)
     : WholeStageResultIterator(pool, planNode, confMap), streamIds_(streamIds) {
-  std::unordered_set<velox::core::PlanNodeId> emptySet;
-  velox::core::PlanFragment planFragment{planNode, velox::core::ExecutionStrategy::kUngrouped, 1, emptySet};
-  std::shared_ptr<velox::core::QueryCtx> queryCtx = createNewVeloxQueryCtx();
-
-  task_ = velox::exec::Task::create(
-      fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId),
-      std::move(planFragment),
-      0,
-      std::move(queryCtx));
-
-  if (!task_->supportsSingleThreadedExecution()) {
-    throw std::runtime_error("Task doesn't support single thread execution: " + planNode->toString());
-  }
-  task_->setSpillDirectory(spillDir);
+  // The input streams are pulled by a single driver.
+  createTask(fmt::format("Gluten stage-{} task-{}", taskInfo.stageId, taskInfo.taskId), planNode, 1, spillDir);
   addSplits_ = [&](velox::exec::Task* task) {
     if (noMoreSplits_) {
       return;
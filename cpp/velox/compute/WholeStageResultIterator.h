@@ -1,6 +1,9 @@
 #pragma once
 
 #include "compute/Backend.h"
+#include "compute/RowVectorStream.h"
+#include "compute/VeloxBatchResizer.h"
+#include "compute/VeloxResultQueue.h"
 #include "memory/ColumnarBatchIterator.h"
 #include "memory/VeloxColumnarBatch.h"
 #include "substrait/plan.pb.h"
@@ -19,10 +22,17 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
       const std::unordered_map<std::string, std::string>& confMap);
 
   virtual ~WholeStageResultIterator() {
+    if (resultQueue_ != nullptr) {
+      // Unblock the drivers waiting for the queue, or the task can't be cancelled.
+      resultQueue_->close();
+    }
     if (task_ != nullptr && task_->isRunning()) {
       // calling .wait() may take no effect in single thread execution mode
       task_->requestCancel().wait();
     }
+    if (task_ != nullptr) {
+      ValueStreamRegistry::unregisterTask(task_.get());
+    }
   };
 
   std::shared_ptr<ColumnarBatch> next() override;
@@ -32,6 +42,11 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
   std::shared_ptr<Metrics> getMetrics(int64_t exportNanos) {
     collectMetrics();
     metrics_->veloxToArrow = exportNanos;
+    metrics_->outputBatches = resizer_->numBatches();
+    metrics_->outputBatchRows = resizer_->numRows();
+    metrics_->outputBatchBytes = resizer_->numBytes();
+    metrics_->coalescedBatches = resizer_->numCoalesced();
+    metrics_->splitBatches = resizer_->numSplit();
     return metrics_;
   }
 
@@ -47,7 +62,18 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
   /// Get config value by key.
   std::string getConfigValue(const std::string& key, const std::optional<std::string>& fallbackValue = std::nullopt);
 
-  std::shared_ptr<facebook::velox::core::QueryCtx> createNewVeloxQueryCtx();
+  std::shared_ptr<facebook::velox::core::QueryCtx> createNewVeloxQueryCtx(folly::Executor* executor = nullptr);
+
+  /// Number of drivers to run the plan with. Velox doesn't merge the output of the drivers, plans are converted for a
+  /// single one. So only plans whose drivers can each produce a part of the output on their own run in parallel.
+  int32_t numDriversFor(const std::shared_ptr<const facebook::velox::core::PlanNode>& planNode);
+
+  /// Creates the task, multi-threaded if numDrivers is more than 1.
+  void createTask(
+      const std::string& taskId,
+      const std::shared_ptr<const facebook::velox::core::PlanNode>& planNode,
+      int32_t numDrivers,
+      const std::string& spillDir);
 
  private:
   /// Get the Spark confs to Velox query context.
@@ -66,6 +92,12 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
   /// Collect Velox metrics.
   void collectMetrics();
 
+  /// Get the next vector of the task, before resizing. Returns nullptr once the task is finished.
+  facebook::velox::RowVectorPtr nextFromTask();
+
+  /// Get the next vector of a multi-threaded task, starting its drivers on the first call.
+  facebook::velox::RowVectorPtr nextFromDrivers();
+
   /// Return a certain type of runtime metric. Supported metric types are: sum, count, min, max.
   int64_t runtimeMetric(
       const std::string& metricType,
@@ -87,6 +119,15 @@ class WholeStageResultIterator : public ColumnarBatchIterator {
 
   /// Node ids should be ommited in metrics.
   std::unordered_set<facebook::velox::core::PlanNodeId> omittedNodeIds_;
+
+  // Coalesces and splits the output of the task toward a byte target.
+  std::shared_ptr<facebook::velox::memory::MemoryPool> resizerPool_;
+  std::unique_ptr<VeloxBatchResizer> resizer_;
+
+  // Multi-driver execution.
+  int32_t numDrivers_ = 1;
+  bool driversStarted_ = false;
+  std::shared_ptr<VeloxResultQueue> resultQueue_;
 };
 
 class WholeStageResultIteratorFirstStage final : public WholeStageResultIterator {
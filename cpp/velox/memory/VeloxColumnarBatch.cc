@@ -1,4 +1,8 @@
 #include "VeloxColumnarBatch.h"
+
+#include <algorithm>
+#include <chrono>
+
 #include "velox/type/Type.h"
 #include "velox/vector/FlatVector.h"
 
@@ -23,6 +27,24 @@ RowVectorPtr makeRowVector(
 
   return std::make_shared<RowVector>(pool, rowType, BufferPtr(nullptr), vectorSize, std::move(children));
 }
+
+// Whether the vector and its nested vectors are all flat, so that they can be exported as they are.
+bool isFlat(const BaseVector& vector) {
+  switch (vector.encoding()) {
+    case VectorEncoding::Simple::FLAT:
+      return true;
+    case VectorEncoding::Simple::ROW: {
+      const auto& children = vector.as<RowVector>()->children();
+      return std::all_of(children.begin(), children.end(), [](const auto& child) { return isFlat(*child); });
+    }
+    case VectorEncoding::Simple::ARRAY:
+      return isFlat(*vector.as<ArrayVector>()->elements());
+    case VectorEncoding::Simple::MAP:
+      return isFlat(*vector.as<MapVector>()->mapKeys()) && isFlat(*vector.as<MapVector>()->mapValues());
+    default:
+      return false;
+  }
+}
 } // namespace
 
 void VeloxColumnarBatch::ensureFlattened() {
@@ -30,16 +52,21 @@ void VeloxColumnarBatch::ensureFlattened() {
     return;
   }
   auto startTime = std::chrono::steady_clock::now();
-  // Make sure to load lazy vector if not loaded already.
-  for (auto& child : rowVector_->children()) {
-    child->loadedVector();
+  // Only the children which aren't flat yet are copied, the flat ones are shared with the original vector.
+  std::vector<VectorPtr> children;
+  children.reserve(rowVector_->childrenSize());
+  for (const auto& child : rowVector_->children()) {
+    // Make sure to load lazy vector if not loaded already.
+    auto loaded = BaseVector::loadedVectorShared(child);
+    if (loaded->size() != rowVector_->size() || !isFlat(*loaded)) {
+      auto copy = BaseVector::create(loaded->type(), rowVector_->size(), rowVector_->pool());
+      copy->copy(loaded.get(), 0, 0, rowVector_->size());
+      loaded = std::move(copy);
+    }
+    children.emplace_back(std::move(loaded));
   }
-
-  // Perform copy to flatten dictionary vectors.
-  velox::RowVectorPtr copy = std::dynamic_pointer_cast<velox::RowVector>(
-      velox::BaseVector::create(rowVector_->type(), rowVector_->size(), rowVector_->pool()));
-  copy->copy(rowVector_.get(), 0, 0, rowVector_->size());
-  flattened_ = copy;
+  flattened_ = std::make_shared<RowVector>(
+      rowVector_->pool(), rowVector_->type(), rowVector_->nulls(), rowVector_->size(), std::move(children));
   auto endTime = std::chrono::steady_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
   exportNanos_ += duration;
@@ -60,8 +87,15 @@ std::shared_ptr<ArrowArray> VeloxColumnarBatch::exportArrowArray() {
 }
 
 int64_t VeloxColumnarBatch::numBytes() {
-  ensureFlattened();
-  return flattened_->estimateFlatSize();
+  if (flattened_ != nullptr) {
+    return flattened_->estimateFlatSize();
+  }
+  // Estimated from the encoded children, without flattening them.
+  int64_t numBytes = 0;
+  for (const auto& child : rowVector_->children()) {
+    numBytes += BaseVector::loadedVectorShared(child)->estimateFlatSize();
+  }
+  return numBytes;
 }
 
 velox::RowVectorPtr VeloxColumnarBatch::getRowVector() const {
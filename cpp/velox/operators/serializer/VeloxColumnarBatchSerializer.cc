@@ -19,6 +19,7 @@
 
 #include "memory/ArrowMemory.h"
 #include "memory/VeloxColumnarBatch.h"
+#include "utils/compression.h"
 #include "velox/common/memory/Memory.h"
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/FlatVector.h"
@@ -31,6 +32,27 @@ using namespace facebook::velox;
 namespace gluten {
 
 namespace {
+
+// The serialized output starts with the compression type and the uncompressed size of the Presto page that follows.
+struct SerializedHeader {
+  int32_t compressionType;
+  int64_t uncompressedSize;
+};
+
+constexpr int64_t kHeaderSize = sizeof(int32_t) + sizeof(int64_t);
+
+void writeHeader(uint8_t* out, const SerializedHeader& header) {
+  memcpy(out, &header.compressionType, sizeof(int32_t));
+  memcpy(out + sizeof(int32_t), &header.uncompressedSize, sizeof(int64_t));
+}
+
+SerializedHeader readHeader(const uint8_t* in) {
+  SerializedHeader header;
+  memcpy(&header.compressionType, in, sizeof(int32_t));
+  memcpy(&header.uncompressedSize, in + sizeof(int32_t), sizeof(int64_t));
+  return header;
+}
+
 std::unique_ptr<ByteStream> toByteStream(uint8_t* data, int32_t size) {
   auto byteStream = std::make_unique<ByteStream>();
   ByteRange byteRange{data, size, 0};
@@ -42,7 +64,8 @@ std::unique_ptr<ByteStream> toByteStream(uint8_t* data, int32_t size) {
 VeloxColumnarBatchSerializer::VeloxColumnarBatchSerializer(
     std::shared_ptr<arrow::MemoryPool> arrowPool,
     std::shared_ptr<memory::MemoryPool> veloxPool,
-    struct ArrowSchema* cSchema)
+    struct ArrowSchema* cSchema,
+    arrow::Compression::type compressionType)
     : ColumnarBatchSerializer(arrowPool, cSchema), veloxPool_(std::move(veloxPool)) {
   // serializeColumnarBatches don't need rowType_
   if (cSchema != nullptr) {
@@ -50,40 +73,92 @@ VeloxColumnarBatchSerializer::VeloxColumnarBatchSerializer(
     ArrowSchemaRelease(cSchema);
   }
   serde_ = std::make_unique<serializer::presto::PrestoVectorSerde>();
+  if (compressionType != arrow::Compression::UNCOMPRESSED) {
+    GLUTEN_ASSIGN_OR_THROW(codec_, createArrowIpcCodec(compressionType));
+    GLUTEN_CHECK(
+        codec_ != nullptr, "Unsupported compression type " + arrow::util::Codec::GetCodecAsString(compressionType));
+  }
 }
 
 std::shared_ptr<arrow::Buffer> VeloxColumnarBatchSerializer::serializeColumnarBatches(
     const std::vector<std::shared_ptr<ColumnarBatch>>& batches) {
   VELOX_DCHECK(batches.size() != 0, "Should serialize at least 1 vector");
   auto firstRowVector = std::dynamic_pointer_cast<VeloxColumnarBatch>(batches[0])->getRowVector();
-  auto numRows = firstRowVector->size();
+  vector_size_t numRows = 0;
+  for (auto& batch : batches) {
+    numRows += batch->numRows();
+  }
   auto arena = std::make_unique<StreamArena>(veloxPool_.get());
   auto rowType = asRowType(firstRowVector->type());
   auto serializer = serde_->createSerializer(rowType, numRows, arena.get(), /* serdeOptions */ nullptr);
+  // Every batch is appended as a single range.
   for (auto& batch : batches) {
     auto rowVector = std::dynamic_pointer_cast<VeloxColumnarBatch>(batch)->getRowVector();
-    auto numRows = rowVector->size();
-    std::vector<IndexRange> rows(numRows);
-    for (int i = 0; i < numRows; i++) {
-      rows[i] = IndexRange{i, 1};
-    }
-    serializer->append(rowVector, folly::Range(rows.data(), numRows));
+    IndexRange range{0, rowVector->size()};
+    serializer->append(rowVector, folly::Range(&range, 1));
   }
 
-  std::shared_ptr<arrow::Buffer> valueBuffer;
-  GLUTEN_ASSIGN_OR_THROW(
-      valueBuffer, arrow::AllocateResizableBuffer(serializer->maxSerializedSize(), arrowPool_.get()));
-  auto output = std::make_shared<arrow::io::FixedSizeBufferWriter>(valueBuffer);
+  // maxSerializedSize() is an upper bound of the Presto page. The returned buffer is only resized to the bytes written,
+  // not reallocated, since the caller copies it out and frees it right away.
+  auto serializedSize = serializer->maxSerializedSize();
+  std::shared_ptr<arrow::ResizableBuffer> pageBuffer;
+  // Without compression the page is written after the header of the output, otherwise to a separate buffer that is
+  // compressed into the output.
+  auto pageOffset = codec_ == nullptr ? kHeaderSize : 0;
+  GLUTEN_ASSIGN_OR_THROW(pageBuffer, arrow::AllocateResizableBuffer(pageOffset + serializedSize, arrowPool_.get()));
+  auto output = std::make_shared<arrow::io::FixedSizeBufferWriter>(pageBuffer);
+  GLUTEN_THROW_NOT_OK(output->Seek(pageOffset));
   serializer::presto::PrestoOutputStreamListener listener;
   ArrowFixedSizeBufferOutputStream out(output, &listener);
   serializer->flush(&out);
+  GLUTEN_ASSIGN_OR_THROW(auto pageEnd, output->Tell());
   GLUTEN_THROW_NOT_OK(output->Close());
-  return valueBuffer;
+  auto pageSize = pageEnd - pageOffset;
+
+  if (codec_ == nullptr) {
+    writeHeader(pageBuffer->mutable_data(), {arrow::Compression::UNCOMPRESSED, pageSize});
+    GLUTEN_THROW_NOT_OK(pageBuffer->Resize(pageEnd, /*shrink_to_fit=*/false));
+    return pageBuffer;
+  }
+
+  auto maxCompressedSize = codec_->MaxCompressedLen(pageSize, pageBuffer->data());
+  std::shared_ptr<arrow::ResizableBuffer> compressed;
+  GLUTEN_ASSIGN_OR_THROW(
+      compressed, arrow::AllocateResizableBuffer(kHeaderSize + maxCompressedSize, arrowPool_.get()));
+  GLUTEN_ASSIGN_OR_THROW(
+      auto compressedSize,
+      codec_->Compress(pageSize, pageBuffer->data(), maxCompressedSize, compressed->mutable_data() + kHeaderSize));
+  writeHeader(compressed->mutable_data(), {codec_->compression_type(), pageSize});
+  GLUTEN_THROW_NOT_OK(compressed->Resize(kHeaderSize + compressedSize, /*shrink_to_fit=*/false));
+  return compressed;
 }
 
 std::shared_ptr<ColumnarBatch> VeloxColumnarBatchSerializer::deserialize(uint8_t* data, int32_t size) {
+  GLUTEN_CHECK(size >= kHeaderSize, "Serialized columnar batch is too small: " + std::to_string(size));
+  auto header = readHeader(data);
+  auto compressionType = static_cast<arrow::Compression::type>(header.compressionType);
+
   RowVectorPtr result;
-  auto byteStream = toByteStream(data, size);
+  if (compressionType == arrow::Compression::UNCOMPRESSED) {
+    // The Presto page is read in place.
+    auto byteStream = toByteStream(data + kHeaderSize, size - kHeaderSize);
+    serde_->deserialize(byteStream.get(), veloxPool_.get(), rowType_, &result, /* serdeOptions */ nullptr);
+    return std::make_shared<VeloxColumnarBatch>(result);
+  }
+
+  GLUTEN_ASSIGN_OR_THROW(auto codec, createArrowIpcCodec(compressionType));
+  GLUTEN_CHECK(
+      codec != nullptr, "Unsupported compression type " + arrow::util::Codec::GetCodecAsString(compressionType));
+  std::shared_ptr<arrow::Buffer> page;
+  GLUTEN_ASSIGN_OR_THROW(page, arrow::AllocateBuffer(header.uncompressedSize, arrowPool_.get()));
+  GLUTEN_ASSIGN_OR_THROW(
+      auto decompressedSize,
+      codec->Decompress(size - kHeaderSize, data + kHeaderSize, header.uncompressedSize, page->mutable_data()));
+  GLUTEN_CHECK(
+      decompressedSize == header.uncompressedSize,
+      "Decompressed size " + std::to_string(decompressedSize) + " doesn't match " +
+          std::to_string(header.uncompressedSize));
+  auto byteStream = toByteStream(page->mutable_data(), header.uncompressedSize);
   serde_->deserialize(byteStream.get(), veloxPool_.get(), rowType_, &result, /* serdeOptions */ nullptr);
   return std::make_shared<VeloxColumnarBatch>(result);
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <arrow/c/abi.h>
+#include <arrow/util/compression.h>
 
 #include "memory/ColumnarBatch.h"
 #include "operators/serializer/ColumnarBatchSerializer.h"
@@ -30,7 +31,8 @@ class VeloxColumnarBatchSerializer final : public ColumnarBatchSerializer {
   VeloxColumnarBatchSerializer(
       std::shared_ptr<arrow::MemoryPool> arrowPool,
       std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool,
-      struct ArrowSchema* cSchema);
+      struct ArrowSchema* cSchema,
+      arrow::Compression::type compressionType = arrow::Compression::UNCOMPRESSED);
 
   std::shared_ptr<arrow::Buffer> serializeColumnarBatches(
       const std::vector<std::shared_ptr<ColumnarBatch>>& batches) override;
@@ -41,6 +43,8 @@ class VeloxColumnarBatchSerializer final : public ColumnarBatchSerializer {
   std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool_;
   facebook::velox::RowTypePtr rowType_;
   std::unique_ptr<facebook::velox::serializer::presto::PrestoVectorSerde> serde_;
+  // Codec of the serialized output, nullptr if uncompressed. Deserialization reads the codec from the input.
+  std::unique_ptr<arrow::util::Codec> codec_;
 };
 
 } // namespace gluten
@@ -0,0 +1,389 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ComplexColumnBuilder.h"
+
+#include <algorithm>
+
+#include "shuffle/SplitKernels.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/FlatVector.h"
+
+using namespace facebook::velox;
+
+namespace gluten {
+
+namespace {
+
+constexpr int64_t kMinBufferCapacity = 64;
+
+// Appends the bits `rows` of `src` after the first `offset` bits of `dst`.
+void appendBits(
+    const uint64_t* src,
+    const uint32_t* rows,
+    uint32_t numRows,
+    bool ascending,
+    uint8_t* dst,
+    uint32_t offset) {
+  auto srcBits = reinterpret_cast<const uint8_t*>(src);
+  if (ascending) {
+    gatherBits(srcBits, rows, numRows, dst, offset);
+    return;
+  }
+  for (uint32_t i = 0; i < numRows; ++i) {
+    arrow::bit_util::SetBitTo(dst, offset + i, arrow::bit_util::GetBit(srcBits, rows[i]));
+  }
+}
+
+arrow::Status checkEncoding(const BaseVector& vector, VectorEncoding::Simple expected) {
+  if (vector.encoding() != expected) {
+    auto encoding = VectorEncoding::mapSimpleToName(vector.encoding());
+    return arrow::Status::Invalid("Vector of ", vector.type()->toString(), " is not flat, its encoding is ", encoding);
+  }
+  return arrow::Status::OK();
+}
+
+template <TypeKind kind>
+class FlatColumnBuilder : public ComplexColumnBuilder {
+  using T = typename TypeTraits<kind>::NativeType;
+
+ public:
+  explicit FlatColumnBuilder(arrow::MemoryPool* pool) : ComplexColumnBuilder(pool), values_(pool) {}
+
+  int64_t capacity() const override {
+    return ComplexColumnBuilder::capacity() + values_.capacity();
+  }
+
+ protected:
+  arrow::Status appendValues(
+      const BaseVector& vector,
+      const uint32_t* rows,
+      uint32_t numRows,
+      bool ascending) override {
+    RETURN_NOT_OK(checkEncoding(vector, VectorEncoding::Simple::FLAT));
+    auto values = vector.asUnchecked<FlatVector<T>>()->values();
+    if constexpr (std::is_same_v<T, bool>) {
+      RETURN_NOT_OK(values_.resize(arrow::bit_util::BytesForBits(numRows_ + numRows)));
+      if (values != nullptr) {
+        appendBits(values->template as<uint64_t>(), rows, numRows, ascending, values_.data(), numRows_);
+      }
+    } else {
+      RETURN_NOT_OK(values_.resize((numRows_ + numRows) * sizeof(T)));
+      auto dst = values_.data() + numRows_ * sizeof(T);
+      if (values == nullptr) {
+        // Only null rows, as in columns of UNKNOWN type.
+        memset(dst, 0, numRows * sizeof(T));
+      } else if (auto gather = gatherFixedWidthFn(sizeof(T)); ascending && gather != nullptr) {
+        gather(values->template as<uint8_t>(), rows, numRows, dst);
+      } else {
+        auto src = values->template as<T>();
+        for (uint32_t i = 0; i < numRows; ++i) {
+          memcpy(dst + i * sizeof(T), src + rows[i], sizeof(T));
+        }
+      }
+    }
+    return arrow::Status::OK();
+  }
+
+  arrow::Status finishValues(std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    ARROW_ASSIGN_OR_RAISE(auto values, values_.finish());
+    buffers.emplace_back(std::move(values));
+    return arrow::Status::OK();
+  }
+
+ private:
+  GrowableBuffer values_;
+};
+
+class StringColumnBuilder : public ComplexColumnBuilder {
+ public:
+  explicit StringColumnBuilder(arrow::MemoryPool* pool) : ComplexColumnBuilder(pool), offsets_(pool), chars_(pool) {}
+
+  int64_t capacity() const override {
+    return ComplexColumnBuilder::capacity() + offsets_.capacity() + chars_.capacity();
+  }
+
+ protected:
+  arrow::Status appendValues(
+      const BaseVector& vector,
+      const uint32_t* rows,
+      uint32_t numRows,
+      bool /* ascending */) override {
+    RETURN_NOT_OK(checkEncoding(vector, VectorEncoding::Simple::FLAT));
+    auto flat = vector.asUnchecked<FlatVector<StringView>>();
+    auto rawValues = flat->rawValues();
+    auto rawNulls = flat->rawNulls();
+
+    RETURN_NOT_OK(offsets_.resize((numRows_ + numRows + 1) * sizeof(int32_t)));
+    auto offsets = reinterpret_cast<int32_t*>(offsets_.data()) + numRows_;
+    if (numRows_ == 0) {
+      offsets[0] = 0;
+    }
+    int64_t numChars = 0;
+    for (uint32_t i = 0; i < numRows; ++i) {
+      if (rawNulls == nullptr || !bits::isBitNull(rawNulls, rows[i])) {
+        numChars += rawValues[rows[i]].size();
+      }
+    }
+    auto charsBegin = chars_.size();
+    RETURN_NOT_OK(chars_.resize(charsBegin + numChars));
+    auto chars = chars_.data() + charsBegin;
+    auto offset = offsets[0];
+    for (uint32_t i = 0; i < numRows; ++i) {
+      if (rawNulls == nullptr || !bits::isBitNull(rawNulls, rows[i])) {
+        const auto& value = rawValues[rows[i]];
+        memcpy(chars, value.data(), value.size());
+        chars += value.size();
+        offset += value.size();
+      }
+      offsets[i + 1] = offset;
+    }
+    return arrow::Status::OK();
+  }
+
+  arrow::Status finishValues(std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    ARROW_ASSIGN_OR_RAISE(auto offsets, offsets_.finish());
+    ARROW_ASSIGN_OR_RAISE(auto chars, chars_.finish());
+    buffers.emplace_back(std::move(offsets));
+    buffers.emplace_back(std::move(chars));
+    return arrow::Status::OK();
+  }
+
+ private:
+  GrowableBuffer offsets_;
+  GrowableBuffer chars_;
+};
+
+class RowColumnBuilder : public ComplexColumnBuilder {
+ public:
+  RowColumnBuilder(const TypePtr& type, arrow::MemoryPool* pool) : ComplexColumnBuilder(pool) {
+    for (const auto& childType : type->asRow().children()) {
+      children_.emplace_back(create(childType, pool));
+    }
+  }
+
+  int64_t capacity() const override {
+    auto capacity = ComplexColumnBuilder::capacity();
+    for (const auto& child : children_) {
+      capacity += child->capacity();
+    }
+    return capacity;
+  }
+
+ protected:
+  arrow::Status appendValues(
+      const BaseVector& vector,
+      const uint32_t* rows,
+      uint32_t numRows,
+      bool ascending) override {
+    RETURN_NOT_OK(checkEncoding(vector, VectorEncoding::Simple::ROW));
+    auto rowVector = vector.asUnchecked<RowVector>();
+    for (size_t i = 0; i < children_.size(); ++i) {
+      RETURN_NOT_OK(children_[i]->append(*rowVector->childAt(i), rows, numRows, ascending));
+    }
+    return arrow::Status::OK();
+  }
+
+  arrow::Status finishValues(std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    for (auto& child : children_) {
+      RETURN_NOT_OK(child->finish(buffers));
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  std::vector<std::unique_ptr<ComplexColumnBuilder>> children_;
+};
+
+// Builds ARRAY and MAP columns, whose rows are ranges of rows of their children.
+class ArrayOrMapColumnBuilder : public ComplexColumnBuilder {
+ public:
+  ArrayOrMapColumnBuilder(const TypePtr& type, arrow::MemoryPool* pool)
+      : ComplexColumnBuilder(pool), offsets_(pool), sizes_(pool) {
+    // The elements, or the keys and the values.
+    for (uint32_t i = 0; i < type->size(); ++i) {
+      children_.emplace_back(create(type->childAt(i), pool));
+    }
+  }
+
+  int64_t capacity() const override {
+    auto capacity = ComplexColumnBuilder::capacity() + offsets_.capacity() + sizes_.capacity();
+    for (const auto& child : children_) {
+      capacity += child->capacity();
+    }
+    return capacity;
+  }
+
+ protected:
+  arrow::Status appendValues(
+      const BaseVector& vector,
+      const uint32_t* rows,
+      uint32_t numRows,
+      bool /* ascending */) override {
+    const vector_size_t* rawOffsets;
+    const vector_size_t* rawSizes;
+    std::vector<const BaseVector*> children;
+    if (vector.typeKind() == TypeKind::ARRAY) {
+      RETURN_NOT_OK(checkEncoding(vector, VectorEncoding::Simple::ARRAY));
+      auto arrayVector = vector.asUnchecked<ArrayVector>();
+      rawOffsets = arrayVector->rawOffsets();
+      rawSizes = arrayVector->rawSizes();
+      children = {arrayVector->elements().get()};
+    } else {
+      RETURN_NOT_OK(checkEncoding(vector, VectorEncoding::Simple::MAP));
+      auto mapVector = vector.asUnchecked<MapVector>();
+      rawOffsets = mapVector->rawOffsets();
+      rawSizes = mapVector->rawSizes();
+      children = {mapVector->mapKeys().get(), mapVector->mapValues().get()};
+    }
+
+    RETURN_NOT_OK(offsets_.resize((numRows_ + numRows) * sizeof(vector_size_t)));
+    RETURN_NOT_OK(sizes_.resize((numRows_ + numRows) * sizeof(vector_size_t)));
+    auto offsets = reinterpret_cast<vector_size_t*>(offsets_.data()) + numRows_;
+    auto sizes = reinterpret_cast<vector_size_t*>(sizes_.data()) + numRows_;
+    auto rawNulls = vector.rawNulls();
+    childRows_.clear();
+    bool childAscending = true;
+    for (uint32_t i = 0; i < numRows; ++i) {
+      auto row = rows[i];
+      auto size = rawNulls != nullptr && bits::isBitNull(rawNulls, row) ? 0 : rawSizes[row];
+      offsets[i] = numChildRows_ + childRows_.size();
+      sizes[i] = size;
+      if (size > 0) {
+        childAscending &= childRows_.empty() || childRows_.back() < static_cast<uint32_t>(rawOffsets[row]);
+        for (vector_size_t j = 0; j < size; ++j) {
+          childRows_.push_back(rawOffsets[row] + j);
+        }
+      }
+    }
+    for (size_t i = 0; i < children_.size(); ++i) {
+      RETURN_NOT_OK(children_[i]->append(*children[i], childRows_.data(), childRows_.size(), childAscending));
+    }
+    numChildRows_ += childRows_.size();
+    return arrow::Status::OK();
+  }
+
+  arrow::Status finishValues(std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    ARROW_ASSIGN_OR_RAISE(auto offsets, offsets_.finish());
+    ARROW_ASSIGN_OR_RAISE(auto sizes, sizes_.finish());
+    buffers.emplace_back(std::move(offsets));
+    buffers.emplace_back(std::move(sizes));
+    for (auto& child : children_) {
+      RETURN_NOT_OK(child->finish(buffers));
+    }
+    numChildRows_ = 0;
+    return arrow::Status::OK();
+  }
+
+ private:
+  GrowableBuffer offsets_;
+  GrowableBuffer sizes_;
+  // The elements, or the keys and the values.
+  std::vector<std::unique_ptr<ComplexColumnBuilder>> children_;
+  uint32_t numChildRows_ = 0;
+  // Scratch for the rows of the children to append.
+  std::vector<uint32_t> childRows_;
+};
+
+template <TypeKind kind>
+std::unique_ptr<ComplexColumnBuilder> createFlatColumnBuilder(arrow::MemoryPool* pool) {
+  if constexpr (kind == TypeKind::VARCHAR || kind == TypeKind::VARBINARY) {
+    return std::make_unique<StringColumnBuilder>(pool);
+  } else {
+    return std::make_unique<FlatColumnBuilder<kind>>(pool);
+  }
+}
+
+} // namespace
+
+arrow::Status GrowableBuffer::resize(int64_t size) {
+  if (buffer_ == nullptr) {
+    ARROW_ASSIGN_OR_RAISE(buffer_, arrow::AllocateResizableBuffer(std::max(size, kMinBufferCapacity), pool_));
+  } else if (size > buffer_->capacity()) {
+    RETURN_NOT_OK(buffer_->Reserve(std::max(size, buffer_->capacity() * 2)));
+  }
+  size_ = size;
+  return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Buffer>> GrowableBuffer::finish() {
+  if (buffer_ == nullptr) {
+    return nullptr;
+  }
+  RETURN_NOT_OK(buffer_->Resize(size_, /*shrink_to_fit=*/false));
+  size_ = 0;
+  return std::move(buffer_);
+}
+
+std::unique_ptr<ComplexColumnBuilder> ComplexColumnBuilder::create(const TypePtr& type, arrow::MemoryPool* pool) {
+  switch (type->kind()) {
+    case TypeKind::ROW:
+      return std::make_unique<RowColumnBuilder>(type, pool);
+    case TypeKind::ARRAY:
+    case TypeKind::MAP:
+      return std::make_unique<ArrayOrMapColumnBuilder>(type, pool);
+    default:
+      return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH_ALL(createFlatColumnBuilder, type->kind(), pool);
+  }
+}
+
+arrow::Status ComplexColumnBuilder::append(
+    const BaseVector& vector,
+    const uint32_t* rows,
+    uint32_t numRows,
+    bool ascending) {
+  if (numRows == 0) {
+    return arrow::Status::OK();
+  }
+  RETURN_NOT_OK(appendNulls(vector.rawNulls(), rows, numRows, ascending));
+  RETURN_NOT_OK(appendValues(vector, rows, numRows, ascending));
+  numRows_ += numRows;
+  return arrow::Status::OK();
+}
+
+arrow::Status ComplexColumnBuilder::finish(std::vector<std::shared_ptr<arrow::Buffer>>& buffers) {
+  ARROW_ASSIGN_OR_RAISE(auto nulls, nulls_.finish());
+  buffers.emplace_back(std::move(nulls));
+  RETURN_NOT_OK(finishValues(buffers));
+  numRows_ = 0;
+  hasNulls_ = false;
+  return arrow::Status::OK();
+}
+
+arrow::Status ComplexColumnBuilder::appendNulls(
+    const uint64_t* rawNulls,
+    const uint32_t* rows,
+    uint32_t numRows,
+    bool ascending) {
+  if (rawNulls == nullptr && !hasNulls_) {
+    return arrow::Status::OK();
+  }
+  RETURN_NOT_OK(nulls_.resize(arrow::bit_util::BytesForBits(numRows_ + numRows)));
+  if (!hasNulls_) {
+    // None of the rows appended so far was null.
+    arrow::bit_util::SetBitsTo(nulls_.data(), 0, numRows_, true);
+    hasNulls_ = true;
+  }
+  if (rawNulls == nullptr) {
+    arrow::bit_util::SetBitsTo(nulls_.data(), numRows_, numRows, true);
+  } else {
+    appendBits(rawNulls, rows, numRows, ascending, nulls_.data(), numRows_);
+  }
+  return arrow::Status::OK();
+}
+
+} // namespace gluten
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include "velox/vector/BaseVector.h"
+
+namespace gluten {
+
+/// A buffer appended to by a ComplexColumnBuilder, growing geometrically.
+class GrowableBuffer {
+ public:
+  explicit GrowableBuffer(arrow::MemoryPool* pool) : pool_(pool) {}
+
+  /// Resizes the buffer to `size` bytes. The new bytes are left uninitialized.
+  arrow::Status resize(int64_t size);
+
+  uint8_t* data() const {
+    return buffer_->mutable_data();
+  }
+
+  int64_t size() const {
+    return size_;
+  }
+
+  int64_t capacity() const {
+    return buffer_ == nullptr ? 0 : buffer_->capacity();
+  }
+
+  /// Hands the buffer over, nullptr if it was never resized, and starts a new one.
+  arrow::Result<std::shared_ptr<arrow::Buffer>> finish();
+
+ private:
+  arrow::MemoryPool* pool_;
+  std::shared_ptr<arrow::ResizableBuffer> buffer_;
+  int64_t size_ = 0;
+};
+
+/// Accumulates the rows of a ROW, ARRAY or MAP column going to one shuffle partition. The rows are copied into one
+/// buffer per nulls, offsets, sizes and values of the type tree, which are written to the shuffle as they are and
+/// wrapped without copy by the reader. The buffers are laid out in pre-order:
+///  - ROW: nulls, then the buffers of each child.
+///  - ARRAY: nulls, offsets, sizes, then the buffers of the elements.
+///  - MAP: nulls, offsets, sizes, then the buffers of the keys and of the values.
+///  - VARCHAR and VARBINARY: nulls, offsets (one more than the rows) and the characters.
+///  - Other scalar types: nulls and the values, in the layout of Velox.
+/// The nulls are nullptr if none of the rows is null.
+class ComplexColumnBuilder {
+ public:
+  static std::unique_ptr<ComplexColumnBuilder> create(const facebook::velox::TypePtr& type, arrow::MemoryPool* pool);
+
+  explicit ComplexColumnBuilder(arrow::MemoryPool* pool) : nulls_(pool) {}
+
+  virtual ~ComplexColumnBuilder() = default;
+
+  /// Appends the rows `rows` of `vector`, which must be flat down to its leaves. With `ascending` set, `rows` is
+  /// strictly increasing, which enables copying contiguous rows at once.
+  arrow::Status append(
+      const facebook::velox::BaseVector& vector,
+      const uint32_t* rows,
+      uint32_t numRows,
+      bool ascending);
+
+  /// Moves the buffers out in pre-order and resets the builder.
+  arrow::Status finish(std::vector<std::shared_ptr<arrow::Buffer>>& buffers);
+
+  uint32_t numRows() const {
+    return numRows_;
+  }
+
+  /// Bytes allocated by the builder and its children.
+  virtual int64_t capacity() const {
+    return nulls_.capacity();
+  }
+
+ protected:
+  virtual arrow::Status appendValues(
+      const facebook::velox::BaseVector& vector,
+      const uint32_t* rows,
+      uint32_t numRows,
+      bool ascending) = 0;
+
+  virtual arrow::Status finishValues(std::vector<std::shared_ptr<arrow::Buffer>>& buffers) = 0;
+
+  // Rows appended since the last finish.
+  uint32_t numRows_ = 0;
+
+ private:
+  arrow::Status appendNulls(const uint64_t* rawNulls, const uint32_t* rows, uint32_t numRows, bool ascending);
+
+  // Only allocated once a null row is appended.
+  GrowableBuffer nulls_;
+  bool hasNulls_ = false;
+};
+
+} // namespace gluten
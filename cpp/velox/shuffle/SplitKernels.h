@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <arrow/util/bit_util.h>
+#include <arrow/util/bitmap_ops.h>
+#include <arrow/util/endian.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Kernels copying the rows of one partition out of a column, used by the hash-based shuffle split. The rows are given
+// by their ids, which are ascending within a partition: a run of ids is contiguous exactly when its ends are as far
+// apart as its length, which is checked in constant time.
+
+namespace gluten {
+
+/// Rows checked at once for a contiguous run, and gathered at once otherwise.
+constexpr uint32_t kGatherBlockRows = 16;
+
+/// Copies the value of `rowIds[i]` in `src` to the i-th value of `dst`.
+using GatherFixedWidthFn = void (*)(const uint8_t* src, const uint32_t* rowIds, uint32_t numRows, uint8_t* dst);
+
+inline bool isContiguous(const uint32_t* rowIds, uint32_t numRows) {
+  return rowIds[numRows - 1] - rowIds[0] == numRows - 1;
+}
+
+template <int32_t kWidth>
+inline void copyValue(const uint8_t* src, uint32_t rowId, uint8_t* dst) {
+  // A fixed-size memcpy compiles to unaligned moves, int128_t accesses would be emitted as movdqa.
+  memcpy(dst, src + static_cast<uint64_t>(rowId) * kWidth, kWidth);
+}
+
+template <int32_t kWidth>
+inline void gatherBlock(const uint8_t* src, const uint32_t* rowIds, uint8_t* dst) {
+  // The hardware gathers have 32 and 64-bit lanes. Narrower values would need wider reads, which can go past the end
+  // of the source buffer.
+#if defined(__AVX512F__)
+  if constexpr (kWidth == 4) {
+    auto indices = _mm512_loadu_si512(rowIds);
+    _mm512_storeu_si512(dst, _mm512_i32gather_epi32(indices, src, 4));
+    return;
+  } else if constexpr (kWidth == 8) {
+    for (uint32_t i = 0; i < kGatherBlockRows; i += 8) {
+      auto indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowIds + i));
+      _mm512_storeu_si512(dst + i * 8, _mm512_i32gather_epi64(indices, src, 8));
+    }
+    return;
+  }
+#elif defined(__AVX2__)
+  if constexpr (kWidth == 4) {
+    for (uint32_t i = 0; i < kGatherBlockRows; i += 8) {
+      auto indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowIds + i));
+      auto values = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src), indices, 4);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), values);
+    }
+    return;
+  } else if constexpr (kWidth == 8) {
+    for (uint32_t i = 0; i < kGatherBlockRows; i += 4) {
+      auto indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowIds + i));
+      auto values = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(src), indices, 8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 8), values);
+    }
+    return;
+  }
+#endif
+  for (uint32_t i = 0; i < kGatherBlockRows; ++i) {
+    copyValue<kWidth>(src, rowIds[i], dst + i * kWidth);
+  }
+}
+
+/// Gathers `numRows` values of `kWidth` bytes. Contiguous runs are copied with memcpy.
+template <int32_t kWidth>
+void gatherFixedWidth(const uint8_t* src, const uint32_t* rowIds, uint32_t numRows, uint8_t* dst) {
+  if (numRows == 0) {
+    return;
+  }
+  if (isContiguous(rowIds, numRows)) {
+    memcpy(dst, src + static_cast<uint64_t>(rowIds[0]) * kWidth, static_cast<uint64_t>(numRows) * kWidth);
+    return;
+  }
+  uint32_t i = 0;
+  for (; i + kGatherBlockRows <= numRows; i += kGatherBlockRows) {
+    if (isContiguous(rowIds + i, kGatherBlockRows)) {
+      memcpy(dst + i * kWidth, src + static_cast<uint64_t>(rowIds[i]) * kWidth, kGatherBlockRows * kWidth);
+    } else {
+      gatherBlock<kWidth>(src, rowIds + i, dst + i * kWidth);
+    }
+  }
+  for (; i < numRows; ++i) {
+    copyValue<kWidth>(src, rowIds[i], dst + i * kWidth);
+  }
+}
+
+/// Returns the kernel for values of `width` bytes, or nullptr if there is none.
+inline GatherFixedWidthFn gatherFixedWidthFn(int32_t width) {
+  switch (width) {
+    case 1:
+      return gatherFixedWidth<1>;
+    case 2:
+      return gatherFixedWidth<2>;
+    case 4:
+      return gatherFixedWidth<4>;
+    case 8:
+      return gatherFixedWidth<8>;
+    case 16:
+      return gatherFixedWidth<16>;
+    default:
+      return nullptr;
+  }
+}
+
+/// Gathers `numRows` bits of `src` into `dst` from bit `dstOffset`, leaving the other bits of `dst` unchanged. Once
+/// `dstOffset` is byte-aligned, the bits are assembled in a word and stored 64 at a time.
+inline void gatherBits(const uint8_t* src, const uint32_t* rowIds, uint32_t numRows, uint8_t* dst, uint64_t dstOffset) {
+  if (numRows == 0) {
+    return;
+  }
+  if (isContiguous(rowIds, numRows)) {
+    arrow::internal::CopyBitmap(src, rowIds[0], numRows, dst, dstOffset);
+    return;
+  }
+  uint32_t i = 0;
+  for (; i < numRows && ((dstOffset + i) & 7) != 0; ++i) {
+    arrow::bit_util::SetBitTo(dst, dstOffset + i, arrow::bit_util::GetBit(src, rowIds[i]));
+  }
+  for (; i + 64 <= numRows; i += 64) {
+    if (isContiguous(rowIds + i, 64)) {
+      arrow::internal::CopyBitmap(src, rowIds[i], 64, dst, dstOffset + i);
+      continue;
+    }
+    uint64_t word = 0;
+    for (uint32_t k = 0; k < 64; ++k) {
+      word |= static_cast<uint64_t>(arrow::bit_util::GetBit(src, rowIds[i + k])) << k;
+    }
+    word = arrow::bit_util::ToLittleEndian(word);
+    memcpy(dst + ((dstOffset + i) >> 3), &word, sizeof(word));
+  }
+  for (; i < numRows; ++i) {
+    arrow::bit_util::SetBitTo(dst, dstOffset + i, arrow::bit_util::GetBit(src, rowIds[i]));
+  }
+}
+
+} // namespace gluten
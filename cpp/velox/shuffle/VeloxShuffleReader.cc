@@ -20,7 +20,7 @@
 #include <arrow/array/array_binary.h>
 
 #include "memory/VeloxColumnarBatch.h"
-#include "velox/serializers/PrestoSerializer.h"
+#include "utils/macros.h"
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/FlatVector.h"
 #include "velox/vector/arrow/Bridge.h"
@@ -34,6 +34,8 @@ namespace gluten {
 
 namespace {
 
+// Holds the arrow buffer a Velox buffer view points into. When the shuffle input is wrapped without copy, the buffer
+// is a slice of the Java-owned input, which is then kept alive until the Velox vector is released.
 struct BufferViewReleaser {
   BufferViewReleaser() : BufferViewReleaser(nullptr) {}
   BufferViewReleaser(std::shared_ptr<arrow::Buffer> arrowBuffer) : bufferReleaser_(std::move(arrowBuffer)) {}
@@ -159,38 +161,98 @@ VectorPtr readFlatVector<TypeKind::VARBINARY>(
   return readFlatVectorStringView(buffers, bufferIdx, length, type, pool);
 }
 
-std::unique_ptr<ByteStream> toByteStream(uint8_t* data, int32_t size) {
-  auto byteStream = std::make_unique<ByteStream>();
-  ByteRange byteRange{data, size, 0};
-  byteStream->resetInput({byteRange});
-  return byteStream;
+BufferPtr readNulls(const std::shared_ptr<arrow::Buffer>& buffer) {
+  if (buffer == nullptr || buffer->size() == 0) {
+    return nullptr;
+  }
+  return convertToVeloxBuffer(buffer);
 }
 
-RowVectorPtr readComplexType(std::shared_ptr<arrow::Buffer> buffer, RowTypePtr& rowType, memory::MemoryPool* pool) {
-  RowVectorPtr result;
-  auto byteStream = toByteStream(const_cast<uint8_t*>(buffer->data()), buffer->size());
-  auto serde = std::make_unique<serializer::presto::PrestoVectorSerde>();
-  serde->deserialize(byteStream.get(), pool, rowType, &result, /* serdeOptions */ nullptr);
-  return result;
+// The number of buffers written for a column of `type`, see ComplexColumnBuilder.
+int32_t numBuffers(const TypePtr& type) {
+  switch (type->kind()) {
+    case TypeKind::ROW:
+    case TypeKind::ARRAY:
+    case TypeKind::MAP: {
+      int32_t num = type->kind() == TypeKind::ROW ? 1 : 3;
+      for (uint32_t i = 0; i < type->size(); ++i) {
+        num += numBuffers(type->childAt(i));
+      }
+      return num;
+    }
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      return 3;
+    default:
+      return 2;
+  }
 }
 
-RowTypePtr getComplexWriteType(const std::vector<TypePtr>& types) {
-  std::vector<std::string> complexTypeColNames;
-  std::vector<TypePtr> complexTypeChildrens;
-  for (int32_t i = 0; i < types.size(); ++i) {
-    auto kind = types[i]->kind();
-    switch (kind) {
-      case TypeKind::ROW:
-      case TypeKind::MAP:
-      case TypeKind::ARRAY: {
-        complexTypeColNames.emplace_back(types[i]->name());
-        complexTypeChildrens.emplace_back(types[i]);
-      } break;
-      default:
-        break;
+VectorPtr readVector(
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    int32_t& bufferIdx,
+    uint32_t length,
+    const TypePtr& type,
+    memory::MemoryPool* pool);
+
+// Reads the children of a ROW, ARRAY or MAP column, which follow the buffers of their parent.
+std::vector<VectorPtr> readChildren(
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    int32_t& bufferIdx,
+    uint32_t length,
+    const TypePtr& type,
+    memory::MemoryPool* pool) {
+  std::vector<VectorPtr> children;
+  children.reserve(type->size());
+  for (uint32_t i = 0; i < type->size(); ++i) {
+    children.emplace_back(readVector(buffers, bufferIdx, length, type->childAt(i), pool));
+  }
+  return children;
+}
+
+VectorPtr readVector(
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    int32_t& bufferIdx,
+    uint32_t length,
+    const TypePtr& type,
+    memory::MemoryPool* pool) {
+  if (length == 0) {
+    // The buffers of nested columns without rows are not allocated by the writer.
+    bufferIdx += numBuffers(type);
+    return BaseVector::create(type, 0, pool);
+  }
+  switch (type->kind()) {
+    case TypeKind::ROW: {
+      auto nulls = readNulls(buffers[bufferIdx++]);
+      auto children = readChildren(buffers, bufferIdx, length, type, pool);
+      return std::make_shared<RowVector>(pool, type, std::move(nulls), length, std::move(children));
     }
+    case TypeKind::ARRAY:
+    case TypeKind::MAP: {
+      auto nulls = readNulls(buffers[bufferIdx++]);
+      auto offsets = convertToVeloxBuffer(buffers[bufferIdx++]);
+      auto sizes = convertToVeloxBuffer(buffers[bufferIdx++]);
+      // The ranges of the rows are written back to back.
+      auto numChildRows = offsets->as<vector_size_t>()[length - 1] + sizes->as<vector_size_t>()[length - 1];
+      auto children = readChildren(buffers, bufferIdx, numChildRows, type, pool);
+      if (type->kind() == TypeKind::ARRAY) {
+        return std::make_shared<ArrayVector>(
+            pool, type, std::move(nulls), length, std::move(offsets), std::move(sizes), std::move(children[0]));
+      }
+      return std::make_shared<MapVector>(
+          pool,
+          type,
+          std::move(nulls),
+          length,
+          std::move(offsets),
+          std::move(sizes),
+          std::move(children[0]),
+          std::move(children[1]));
+    }
+    default:
+      return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH_ALL(
+          readFlatVector, type->kind(), buffers, bufferIdx, length, type, pool);
   }
-  return std::make_shared<const RowType>(std::move(complexTypeColNames), std::move(complexTypeChildrens));
 }
 
 void readColumns(
@@ -200,28 +262,8 @@ void readColumns(
     const std::vector<TypePtr>& types,
     std::vector<VectorPtr>& result) {
   int32_t bufferIdx = 0;
-  std::vector<VectorPtr> complexChildren;
-  auto complexRowType = getComplexWriteType(types);
-  if (complexRowType->children().size() > 0) {
-    complexChildren = readComplexType(buffers[buffers.size() - 1], complexRowType, pool)->children();
-  }
-
-  int32_t complexIdx = 0;
   for (int32_t i = 0; i < types.size(); ++i) {
-    auto kind = types[i]->kind();
-    switch (kind) {
-      case TypeKind::ROW:
-      case TypeKind::MAP:
-      case TypeKind::ARRAY: {
-        result.emplace_back(std::move(complexChildren[complexIdx]));
-        complexIdx++;
-      } break;
-      default: {
-        auto res = VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH_ALL(
-            readFlatVector, types[i]->kind(), buffers, bufferIdx, numRows, types[i], pool);
-        result.emplace_back(std::move(res));
-      } break;
-    }
+    result.emplace_back(readVector(buffers, bufferIdx, numRows, types[i], pool));
   }
 }
 
@@ -257,6 +299,135 @@ RowVectorPtr readRowVectorInternal(const arrow::RecordBatch& batch, RowTypePtr r
   }
   return deserialize(rowType, length, buffers, pool);
 }
+
+void concatNulls(const VectorPtr& source, vector_size_t offset, BaseVector& result) {
+  if (source->mayHaveNulls()) {
+    bits::copyBits(source->rawNulls(), 0, result.mutableRawNulls(), offset, source->size());
+  }
+}
+
+// Fixed width columns are concatenated by copying their value buffers.
+template <TypeKind kind>
+VectorPtr concatFlatVectors(
+    const std::vector<VectorPtr>& sources,
+    vector_size_t numRows,
+    const TypePtr& type,
+    memory::MemoryPool* pool) {
+  using T = typename TypeTraits<kind>::NativeType;
+  auto result = BaseVector::create<FlatVector<T>>(type, numRows, pool);
+  vector_size_t offset = 0;
+  for (const auto& source : sources) {
+    concatNulls(source, offset, *result);
+    auto flat = source->asUnchecked<FlatVector<T>>();
+    if constexpr (std::is_same_v<T, bool>) {
+      bits::copyBits(
+          flat->values()->template as<uint64_t>(),
+          0,
+          result->mutableValues(numRows)->template asMutable<uint64_t>(),
+          offset,
+          source->size());
+    } else {
+      memcpy(result->mutableRawValues() + offset, flat->rawValues(), source->size() * sizeof(T));
+    }
+    offset += source->size();
+  }
+  return result;
+}
+
+// The string buffers of all sources are copied into one buffer, then the non-inlined StringViews are rebased on it.
+VectorPtr concatStringVectors(
+    const std::vector<VectorPtr>& sources,
+    vector_size_t numRows,
+    const TypePtr& type,
+    memory::MemoryPool* pool) {
+  auto result = BaseVector::create<FlatVector<StringView>>(type, numRows, pool);
+  size_t totalBytes = 0;
+  for (const auto& source : sources) {
+    for (const auto& buffer : source->asUnchecked<FlatVector<StringView>>()->stringBuffers()) {
+      totalBytes += buffer->size();
+    }
+  }
+  auto stringBuffer = AlignedBuffer::allocate<char>(totalBytes, pool);
+  auto rawChars = stringBuffer->asMutable<char>();
+  auto rawValues = result->mutableRawValues();
+
+  struct Rebase {
+    const char* begin;
+    const char* end;
+    char* target;
+  };
+  std::vector<Rebase> rebases;
+  vector_size_t offset = 0;
+  for (const auto& source : sources) {
+    concatNulls(source, offset, *result);
+    auto flat = source->asUnchecked<FlatVector<StringView>>();
+    rebases.clear();
+    for (const auto& buffer : flat->stringBuffers()) {
+      memcpy(rawChars, buffer->as<char>(), buffer->size());
+      rebases.push_back({buffer->as<char>(), buffer->as<char>() + buffer->size(), rawChars});
+      rawChars += buffer->size();
+    }
+    auto sourceValues = flat->rawValues();
+    auto sourceNulls = source->rawNulls();
+    for (vector_size_t i = 0; i < source->size(); ++i) {
+      const auto& value = sourceValues[i];
+      if (sourceNulls && bits::isBitNull(sourceNulls, i)) {
+        rawValues[offset + i] = StringView();
+        continue;
+      }
+      if (value.isInline()) {
+        rawValues[offset + i] = value;
+        continue;
+      }
+      auto rebase = std::find_if(rebases.begin(), rebases.end(), [&](const Rebase& r) {
+        return value.data() >= r.begin && value.data() < r.end;
+      });
+      VELOX_CHECK(rebase != rebases.end(), "String data is not held by the vector's string buffers");
+      rawValues[offset + i] = StringView(rebase->target + (value.data() - rebase->begin), value.size());
+    }
+    offset += source->size();
+  }
+  result->setStringBuffers({std::move(stringBuffer)});
+  return result;
+}
+
+RowVectorPtr concatRowVectors(
+    const std::vector<RowVectorPtr>& rowVectors,
+    const RowTypePtr& rowType,
+    memory::MemoryPool* pool) {
+  vector_size_t numRows = 0;
+  for (const auto& rowVector : rowVectors) {
+    numRows += rowVector->size();
+  }
+
+  std::vector<VectorPtr> children;
+  std::vector<VectorPtr> sources(rowVectors.size());
+  for (auto col = 0; col < rowType->size(); ++col) {
+    const auto& type = rowType->childAt(col);
+    bool allFlat = true;
+    for (auto i = 0; i < rowVectors.size(); ++i) {
+      sources[i] = rowVectors[i]->childAt(col);
+      allFlat &= sources[i]->encoding() == VectorEncoding::Simple::FLAT;
+    }
+
+    if (allFlat && (type->kind() == TypeKind::VARCHAR || type->kind() == TypeKind::VARBINARY)) {
+      children.emplace_back(concatStringVectors(sources, numRows, type, pool));
+    } else if (allFlat && type->isPrimitiveType() && type->kind() != TypeKind::UNKNOWN) {
+      children.emplace_back(
+          VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(concatFlatVectors, type->kind(), sources, numRows, type, pool));
+    } else {
+      // Complex types are copied row-wise.
+      auto child = BaseVector::create(type, numRows, pool);
+      vector_size_t offset = 0;
+      for (const auto& source : sources) {
+        child->copy(source.get(), offset, 0, source->size());
+        offset += source->size();
+      }
+      children.emplace_back(std::move(child));
+    }
+  }
+  return std::make_shared<RowVector>(pool, rowType, BufferPtr(nullptr), numRows, std::move(children));
+}
 } // namespace
 
 VeloxShuffleReader::VeloxShuffleReader(
@@ -271,13 +442,51 @@ VeloxShuffleReader::VeloxShuffleReader(
   rowType_ = asRowType(importFromArrow(cSchema));
 }
 
-arrow::Result<std::shared_ptr<ColumnarBatch>> VeloxShuffleReader::next() {
+arrow::Result<RowVectorPtr> VeloxShuffleReader::readNextRowVector() {
+  if (lookahead_ != nullptr) {
+    return std::move(lookahead_);
+  }
   ARROW_ASSIGN_OR_RAISE(auto batch, Reader::next());
   if (batch == nullptr) {
     return nullptr;
   }
   auto rb = std::dynamic_pointer_cast<ArrowColumnarBatch>(batch)->getRecordBatch();
-  auto vp = readRowVectorInternal(*rb, rowType_, veloxPool_.get());
+  return readRowVectorInternal(*rb, rowType_, veloxPool_.get());
+}
+
+arrow::Result<std::shared_ptr<ColumnarBatch>> VeloxShuffleReader::next() {
+  std::vector<RowVectorPtr> rowVectors;
+  int64_t numRows = 0;
+  int64_t numBytes = 0;
+  while (true) {
+    ARROW_ASSIGN_OR_RAISE(auto vp, readNextRowVector());
+    if (vp == nullptr) {
+      break;
+    }
+    auto vpBytes = options_.coalesce_batch_size > 0 ? vp->estimateFlatSize() : 0;
+    if (!rowVectors.empty() &&
+        (numRows + vp->size() > options_.coalesce_batch_size ||
+         numBytes + vpBytes > options_.coalesce_batch_max_bytes)) {
+      lookahead_ = std::move(vp);
+      break;
+    }
+    numRows += vp->size();
+    numBytes += vpBytes;
+    rowVectors.emplace_back(std::move(vp));
+    if (numRows >= options_.coalesce_batch_size || numBytes >= options_.coalesce_batch_max_bytes) {
+      break;
+    }
+  }
+
+  if (rowVectors.empty()) {
+    return nullptr;
+  }
+  if (rowVectors.size() == 1) {
+    return std::make_shared<VeloxColumnarBatch>(std::move(rowVectors[0]));
+  }
+  TIME_NANO_START(coalesceTime_)
+  auto vp = concatRowVectors(rowVectors, rowType_, veloxPool_.get());
+  TIME_NANO_END(coalesceTime_)
   return std::make_shared<VeloxColumnarBatch>(vp);
 }
 
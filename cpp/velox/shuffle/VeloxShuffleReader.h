@@ -40,8 +40,12 @@ class VeloxShuffleReader final : public Reader {
       facebook::velox::memory::MemoryPool* pool);
 
  private:
+  arrow::Result<facebook::velox::RowVectorPtr> readNextRowVector();
+
   facebook::velox::RowTypePtr rowType_;
   std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool_;
+  // Batch read while coalescing that didn't fit into the previous output, returned first by the next call.
+  facebook::velox::RowVectorPtr lookahead_;
 };
 
 } // namespace gluten
@@ -1,6 +1,5 @@
 #include "VeloxShuffleWriter.h"
 #include "compute/ArrowTypeUtils.h"
-#include "memory/ArrowMemory.h"
 #include "memory/VeloxColumnarBatch.h"
 #include "memory/VeloxMemoryPool.h"
 #include "velox/vector/arrow/Bridge.h"
@@ -18,7 +17,10 @@
 #include <arm_neon.h>
 #endif
 
+#include <folly/ScopeGuard.h>
+
 #include <iostream>
+#include <numeric>
 
 using namespace facebook;
 using namespace facebook::velox;
@@ -192,36 +194,39 @@ arrow::Status VeloxShuffleWriter::init() {
   supportAvx512_ = false;
 #endif
 
-  // partition number should be less than 64k
-  VELOX_CHECK_LE(numPartitions_, 64 * 1024);
+  // partition ids are kept in 16 bits unless there are more than 64k partitions
+  widePartitionId_ = Partitioner::needWidePartitionId(numPartitions_);
 
   // split record batch size should be less than 32k
   VELOX_CHECK_LE(options_.buffer_size, 32 * 1024);
 
   ARROW_ASSIGN_OR_RAISE(partitionWriter_, partitionWriterCreator_->make(this));
+  ARROW_ASSIGN_OR_RAISE(evictionPolicy_, EvictionPolicy::create(options_.eviction_policy));
 
-  ARROW_ASSIGN_OR_RAISE(partitioner_, Partitioner::make(options_.partitioning_name, numPartitions_));
+  ARROW_ASSIGN_OR_RAISE(partitioner_, Partitioner::make(options_.partitioning_name, numPartitions_, supportAvx512_));
 
   // pre-allocated buffer size for each partition, unit is row count
   // when partitioner is SinglePart, partial variables don`t need init
   if (options_.partitioning_name != "single") {
     partition2RowCount_.resize(numPartitions_);
     partition2BufferSize_.resize(numPartitions_);
-    partitionBufferIdxOffset_.resize(numPartitions_);
     partition2RowOffset_.resize(numPartitions_ + 1);
+    if (options_.sort_based) {
+      sortPartitionRowCount_.resize(numPartitions_);
+    }
   }
 
   partitionBufferIdxBase_.resize(numPartitions_);
 
   partitionCachedRecordbatch_.resize(numPartitions_);
   partitionCachedRecordbatchSize_.resize(numPartitions_);
+  partitionNumSpills_.resize(numPartitions_);
 
   partitionLengths_.resize(numPartitions_);
   rawPartitionLengths_.resize(numPartitions_);
 
   RETURN_NOT_OK(setCompressType(options_.compression_type));
 
-  RETURN_NOT_OK(pool_->init());
   RETURN_NOT_OK(initIpcWriteOptions());
 
   return arrow::Status::OK();
@@ -241,6 +246,12 @@ arrow::Status VeloxShuffleWriter::initIpcWriteOptions() {
   //  }
   ipcWriteOptions.memory_pool = options_.memory_pool.get();
   ipcWriteOptions.use_threads = false;
+  if (options_.compression_min_savings >= 0) {
+    // Arrow writes the buffers which don't save enough uncompressed, flagged in the payload for the reader.
+    ipcWriteOptions.min_space_savings = std::min(options_.compression_min_savings, 1.0);
+  }
+  compressibilitySampler_ =
+      std::make_unique<CompressibilitySampler>(options_.compression_min_savings, options_.compression_max_backoff);
 
   tinyBatchWriteOptions_ = ipcWriteOptions;
   tinyBatchWriteOptions_.codec = nullptr;
@@ -275,7 +286,8 @@ arrow::Status VeloxShuffleWriter::initPartitions(const velox::RowVector& rv) {
 }
 
 arrow::Status VeloxShuffleWriter::setCompressType(arrow::Compression::type compressedType) {
-  ARROW_ASSIGN_OR_RAISE(options_.ipc_write_options.codec, createArrowIpcCodec(compressedType));
+  ARROW_ASSIGN_OR_RAISE(
+      options_.ipc_write_options.codec, createArrowIpcCodec(compressedType, options_.compression_level));
   return arrow::Status::OK();
 }
 
@@ -351,66 +363,172 @@ void collectFlatVectorBuffer<velox::TypeKind::VARBINARY>(
 
 } // namespace
 
-std::shared_ptr<arrow::Buffer> VeloxShuffleWriter::generateComplexTypeBuffers(velox::RowVectorPtr vector) {
-  auto arena = std::make_unique<StreamArena>(veloxPool_.get());
-  auto serializer =
-      serde_->createSerializer(asRowType(vector->type()), vector->size(), arena.get(), /* serdeOptions */ nullptr);
-  const IndexRange allRows{0, vector->size()};
-  serializer->append(vector, folly::Range(&allRows, 1));
-  auto serializedSize = serializer->maxSerializedSize();
-  auto flushBuffer = complexTypeFlushBuffer_[0];
-  if (flushBuffer == nullptr) {
-    GLUTEN_ASSIGN_OR_THROW(flushBuffer, arrow::AllocateResizableBuffer(serializedSize, options_.memory_pool.get()));
-  } else if (serializedSize > flushBuffer->capacity()) {
-    GLUTEN_THROW_NOT_OK(flushBuffer->Reserve(serializedSize));
-  }
-
-  auto valueBuffer = arrow::SliceMutableBuffer(flushBuffer, 0, serializedSize);
-  auto output = std::make_shared<arrow::io::FixedSizeBufferWriter>(valueBuffer);
-  serializer::presto::PrestoOutputStreamListener listener;
-  ArrowFixedSizeBufferOutputStream out(output, &listener);
-  serializer->flush(&out);
-  return valueBuffer;
-}
-
 arrow::Status VeloxShuffleWriter::split(std::shared_ptr<ColumnarBatch> cb) {
+  splitting_ = true;
+  SCOPE_EXIT {
+    splitting_ = false;
+  };
   auto veloxColumnBatch = VeloxColumnarBatch::from(defaultLeafVeloxMemoryPool().get(), cb);
-  auto& rv = *veloxColumnBatch->getFlattenedRowVector();
+  auto rowVector = veloxColumnBatch->getFlattenedRowVector();
+  auto& rv = *rowVector;
   RETURN_NOT_OK(initFromRowVector(rv));
   if (options_.partitioning_name == "single") {
-    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
-    std::vector<VectorPtr> complexChildren;
-    for (auto& child : rv.children()) {
-      if (child->encoding() == VectorEncoding::Simple::FLAT) {
-        VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH_ALL(
-            collectFlatVectorBuffer, child->typeKind(), child.get(), buffers, pool_.get());
-      } else {
-        complexChildren.emplace_back(child);
-      }
-    }
-    if (complexChildren.size() > 0) {
-      auto rowVector = std::make_shared<RowVector>(
-          veloxPool_.get(), complexWriteType_, BufferPtr(nullptr), rv.size(), std::move(complexChildren));
-      buffers.emplace_back(generateComplexTypeBuffers(rowVector));
-    }
-
-    auto rb = makeRecordBatch(rv.size(), buffers, writeSchema(), pool_.get());
-    RETURN_NOT_OK(cacheRecordBatch(0, *rb, false));
+    RETURN_NOT_OK(cacheRowVector(0, rv));
+  } else if (options_.sort_based) {
+    RETURN_NOT_OK(bufferRowVectorForSort(std::move(rowVector)));
   } else {
     if (partitioner_->hasPid()) {
       auto pidArr = getFirstColumn(rv);
-      RETURN_NOT_OK(partitioner_->compute(pidArr, rv.size(), row2Partition_, partition2RowCount_));
+      RETURN_NOT_OK(computePartitionIds(pidArr, rv.size()));
       auto strippedRv = getStrippedRowVector(rv);
       RETURN_NOT_OK(doSplit(*strippedRv));
     } else {
-      RETURN_NOT_OK(partitioner_->compute(nullptr, rv.size(), row2Partition_, partition2RowCount_));
+      RETURN_NOT_OK(computePartitionIds(nullptr, rv.size()));
       RETURN_NOT_OK(doSplit(rv));
     }
   }
   return arrow::Status::OK();
 }
 
+arrow::Status VeloxShuffleWriter::cacheRowVector(uint32_t partitionId, const velox::RowVector& rv) {
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  std::vector<uint32_t> allRows;
+  for (auto& child : rv.children()) {
+    if (child->encoding() == VectorEncoding::Simple::FLAT) {
+      VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH_ALL(
+          collectFlatVectorBuffer, child->typeKind(), child.get(), buffers, pool_.get());
+    } else {
+      if (allRows.empty()) {
+        allRows.resize(rv.size());
+        std::iota(allRows.begin(), allRows.end(), 0);
+      }
+      auto builder = ComplexColumnBuilder::create(child->type(), options_.memory_pool.get());
+      RETURN_NOT_OK(builder->append(*child, allRows.data(), rv.size(), true));
+      RETURN_NOT_OK(builder->finish(buffers));
+    }
+  }
+
+  auto rb = makeRecordBatch(rv.size(), buffers, writeSchema(), pool_.get());
+  RETURN_NOT_OK(cacheRecordBatch(partitionId, *rb, false));
+  return arrow::Status::OK();
+}
+
+arrow::Status VeloxShuffleWriter::bufferRowVectorForSort(velox::RowVectorPtr rv) {
+  if (partitioner_->hasPid()) {
+    auto pidArr = getFirstColumn(*rv);
+    RETURN_NOT_OK(computePartitionIds(pidArr, rv->size()));
+    rv = getStrippedRowVector(*rv);
+  } else {
+    RETURN_NOT_OK(computePartitionIds(nullptr, rv->size()));
+  }
+
+  for (auto pid = 0; pid < numPartitions_; ++pid) {
+    sortPartitionRowCount_[pid] += partition2RowCount_[pid];
+  }
+  if (widePartitionId_) {
+    sortBufferedWidePartitionIds_.emplace_back(row2PartitionWide_.begin(), row2PartitionWide_.begin() + rv->size());
+  } else {
+    sortBufferedPartitionIds_.emplace_back(row2Partition_.begin(), row2Partition_.begin() + rv->size());
+  }
+  sortBufferedBytes_ += rv->estimateFlatSize();
+  sortBufferedRowVectors_.emplace_back(std::move(rv));
+
+  if (sortBufferedBytes_ >= options_.sort_buffer_max_size) {
+    RETURN_NOT_OK(sortAndCacheBufferedRows());
+    RETURN_NOT_OK(evictSortedPartitions());
+  }
+  return arrow::Status::OK();
+}
+
+template <typename T>
+void VeloxShuffleWriter::sortBufferedRowIds(std::vector<std::vector<T>>& bufferedPartitionIds) {
+  for (uint64_t batchIdx = 0; batchIdx < bufferedPartitionIds.size(); ++batchIdx) {
+    const auto& partitionIds = bufferedPartitionIds[batchIdx];
+    for (uint32_t row = 0; row < partitionIds.size(); ++row) {
+      auto pid = partitionIds[row];
+      sortedRowIds_[partition2RowOffset_[pid]++] = batchIdx << 32 | row;
+    }
+  }
+  bufferedPartitionIds.clear();
+}
+
+arrow::Status VeloxShuffleWriter::sortAndCacheBufferedRows() {
+  if (sortBufferedRowVectors_.empty()) {
+    return arrow::Status::OK();
+  }
+
+  // Counting sort on partition id. Rows of the same partition keep the order of
+  // (batch, row), so each partition is a sequence of runs over the buffered batches.
+  partition2RowOffset_[0] = 0;
+  for (auto pid = 1; pid <= numPartitions_; ++pid) {
+    partition2RowOffset_[pid] = partition2RowOffset_[pid - 1] + sortPartitionRowCount_[pid - 1];
+  }
+  sortedRowIds_.resize(partition2RowOffset_[numPartitions_]);
+  if (widePartitionId_) {
+    sortBufferedRowIds(sortBufferedWidePartitionIds_);
+  } else {
+    sortBufferedRowIds(sortBufferedPartitionIds_);
+  }
+
+  // Emit at most buffer_size rows per record batch, the same as a full partition buffer.
+  uint32_t maxRowsPerBatch = options_.buffer_size;
+  uint32_t end = 0;
+  for (auto pid = 0; pid < numPartitions_; ++pid) {
+    auto begin = end;
+    end = partition2RowOffset_[pid];
+    for (auto offset = begin; offset < end; offset += maxRowsPerBatch) {
+      auto numRows = std::min(end - offset, maxRowsPerBatch);
+      auto rowVector = gatherSortedRows(sortedRowIds_.data() + offset, numRows);
+      RETURN_NOT_OK(cacheRowVector(pid, *rowVector));
+    }
+  }
+
+  sortBufferedRowVectors_.clear();
+  std::fill(sortPartitionRowCount_.begin(), sortPartitionRowCount_.end(), 0);
+  sortBufferedBytes_ = 0;
+  return arrow::Status::OK();
+}
+
+velox::RowVectorPtr VeloxShuffleWriter::gatherSortedRows(const uint64_t* rowIds, uint32_t numRows) {
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(sortBufferedRowVectors_[0]->type(), numRows, veloxPool_.get()));
+  sortGatherIndices_.resize(numRows);
+  SelectivityVector rows(numRows, false);
+  uint32_t runStart = 0;
+  while (runStart < numRows) {
+    auto batchIdx = rowIds[runStart] >> 32;
+    auto runEnd = runStart;
+    for (; runEnd < numRows && (rowIds[runEnd] >> 32) == batchIdx; ++runEnd) {
+      sortGatherIndices_[runEnd] = static_cast<vector_size_t>(rowIds[runEnd] & 0xffffffff);
+    }
+    // Runs are adjacent, only the bits of the previous run need clearing.
+    rows.setValidRange(rows.begin(), rows.end(), false);
+    rows.setValidRange(runStart, runEnd, true);
+    rows.updateBounds();
+    result->copy(sortBufferedRowVectors_[batchIdx].get(), rows, sortGatherIndices_.data());
+    runStart = runEnd;
+  }
+  return result;
+}
+
+arrow::Status VeloxShuffleWriter::evictSortedPartitions() {
+  if (options_.prefer_evict) {
+    for (auto pid = 0; pid < numPartitions_; ++pid) {
+      if (partitionCachedRecordbatchSize_[pid] > 0) {
+        RETURN_NOT_OK(evictPartition(pid));
+      }
+    }
+  } else if (totalCachedPayloadSize() > 0) {
+    // All partitions go into one partition-ordered spill file.
+    RETURN_NOT_OK(evictPartition(-1));
+  }
+  return arrow::Status::OK();
+}
+
 arrow::Status VeloxShuffleWriter::stop() {
+  if (options_.sort_based) {
+    RETURN_NOT_OK(sortAndCacheBufferedRows());
+  }
   EVAL_START("write", options_.thread_id)
   RETURN_NOT_OK(partitionWriter_->stop());
   EVAL_END("write", options_.thread_id, options_.task_attempt_id)
@@ -418,6 +536,12 @@ arrow::Status VeloxShuffleWriter::stop() {
   return arrow::Status::OK();
 }
 
+arrow::Status VeloxShuffleWriter::computePartitionIds(const int32_t* pidArr, uint32_t numRows) {
+  return dispatchRow2Partition([&](auto& row2Partition) {
+    return partitioner_->compute(pidArr, numRows, row2Partition, partition2RowCount_);
+  });
+}
+
 arrow::Status VeloxShuffleWriter::createPartition2Row(uint32_t rowNum) {
   // calc partition2RowOffset_
   partition2RowOffset_[0] = 0;
@@ -427,11 +551,14 @@ arrow::Status VeloxShuffleWriter::createPartition2Row(uint32_t rowNum) {
 
   // calc rowOffset2RowId_
   rowOffset2RowId_.resize(rowNum);
-  for (auto row = 0; row < rowNum; ++row) {
-    auto pid = row2Partition_[row];
-    PREFETCHT0((rowOffset2RowId_.data() + partition2RowOffset_[pid] + 32));
-    rowOffset2RowId_[partition2RowOffset_[pid]++] = row;
-  }
+  RETURN_NOT_OK(dispatchRow2Partition([&](const auto& row2Partition) {
+    for (auto row = 0; row < rowNum; ++row) {
+      auto pid = row2Partition[row];
+      PREFETCHT0((rowOffset2RowId_.data() + partition2RowOffset_[pid] + 32));
+      rowOffset2RowId_[partition2RowOffset_[pid]++] = row;
+    }
+    return arrow::Status::OK();
+  }));
   std::transform(
       partition2RowOffset_.begin(),
       std::prev(partition2RowOffset_.end()),
@@ -508,9 +635,8 @@ arrow::Status VeloxShuffleWriter::doSplit(const velox::RowVector& rv) {
           if (options_.prefer_evict) {
             // if prefer_evict is set, evict current RowVector
             RETURN_NOT_OK(evictPartition(pid));
-          } else {
-            RETURN_NOT_OK(resetValidityBuffers(pid));
           }
+          RETURN_NOT_OK(resetValidityBuffers(pid));
         }
       }
     }
@@ -532,833 +658,743 @@ arrow::Status VeloxShuffleWriter::doSplit(const velox::RowVector& rv) {
 
 arrow::Status VeloxShuffleWriter::splitRowVector(const velox::RowVector& rv) {
   // now start to split the RowVector
-  RETURN_NOT_OK(splitFixedWidthValueBuffer(rv));
-  RETURN_NOT_OK(splitValidityBuffer(rv));
+  RETURN_NOT_OK(prepareSplitColumns(rv));
+  splitFixedWidthAndValidity();
   RETURN_NOT_OK(splitBinaryArray(rv));
   RETURN_NOT_OK(splitComplexType(rv));
   return arrow::Status::OK();
 }
 
-arrow::Status VeloxShuffleWriter::splitFixedWidthValueBuffer(const velox::RowVector& rv) {
+arrow::Status VeloxShuffleWriter::prepareSplitColumns(const velox::RowVector& rv) {
+  splitColumns_.clear();
   for (auto col = 0; col < fixedWidthColumnCount_; ++col) {
     auto colIdx = simpleColumnIndices_[col];
     auto column = rv.childAt(colIdx);
     assert(column->isFlatEncoding());
 
-    const uint8_t* srcAddr = (const uint8_t*)column->valuesAsVoid();
-    const auto& dstAddrs = partitionFixedWidthValueAddrs_[col];
-
+    int32_t width;
     switch (arrow::bit_width(arrowColumnTypes_[colIdx]->id())) {
       case 1: // arrow::BooleanType::type_id:
-        RETURN_NOT_OK(splitBoolType(srcAddr, dstAddrs));
+        width = 0;
         break;
       case 8:
-        RETURN_NOT_OK(splitFixedType<uint8_t>(srcAddr, dstAddrs));
-        break;
       case 16:
-        RETURN_NOT_OK(splitFixedType<uint16_t>(srcAddr, dstAddrs));
-        break;
       case 32:
-        RETURN_NOT_OK(splitFixedType<uint32_t>(srcAddr, dstAddrs));
+        width = arrow::bit_width(arrowColumnTypes_[colIdx]->id()) >> 3;
         break;
-      case 64: {
-        if (column->type()->kind() == velox::TypeKind::TIMESTAMP) {
-          RETURN_NOT_OK(splitFixedType<int128_t>(srcAddr, dstAddrs));
-          break;
+      case 64:
+        width = column->type()->kind() == velox::TypeKind::TIMESTAMP ? sizeof(int128_t) : sizeof(int64_t);
+        break;
+      case 128: // arrow::Decimal128Type::type_id
+        if (column->type()->isShortDecimal()) {
+          width = sizeof(int64_t);
+        } else if (column->type()->isLongDecimal()) {
+          width = sizeof(int128_t);
         } else {
-#ifdef PROCESSAVX
-          std::transform(
-              dstAddrs.begin(),
-              dstAddrs.end(),
-              partitionBufferIdxBase_.begin(),
-              partitionBufferIdxOffset_.begin(),
-              [](uint8_t* x, row_offset_type y) { return x + y * sizeof(uint64_t); });
-          for (auto pid = 0; pid < numPartitions_; pid++) {
-            auto dstPidBase = reinterpret_cast<uint64_t*>(partitionBufferIdxOffset_[pid]); /*32k*/
-            auto r = partition2RowOffset_[pid]; /*8k*/
-            auto size = partition2RowOffset_[pid + 1];
-#if 1
-            for (r; r < size && (((uint64_t)dstPidBase & 0x1f) > 0); r++) {
-              auto srcOffset = rowOffset2RowId_[r]; /*16k*/
-              *dstPidBase = reinterpret_cast<uint64_t*>(srcAddr)[srcOffset]; /*64k*/
-              _mm_prefetch(&(srcAddr)[srcOffset * sizeof(uint64_t) + 64], _MM_HINT_T2);
-              dstPidBase += 1;
-            }
-#if 0
-          for (r; r+4<size; r+=4)                              
-          {                                                                                    
-            auto srcOffset = rowOffset2RowId_[r];                                 /*16k*/
-            __m128i srcLd = _mm_loadl_epi64((__m128i*)(&rowOffset2RowId_[r]));
-            __m128i srcOffset4x = _mm_cvtepu16_epi32(srcLd);
-            
-            __m256i src4x = _mm256_i32gather_epi64((const long long int*)srcAddr,srcOffset4x,8);
-            //_mm256_store_si256((__m256i*)dstPidBase,src4x);
-            _mm_stream_si128((__m128i*)dstPidBase,src2x);
-                                                         
-            _mm_prefetch(&(srcAddr)[(uint32_t)rowOffset2RowId_[r]*sizeof(uint64_t)+64], _MM_HINT_T2);
-            _mm_prefetch(&(srcAddr)[(uint32_t)rowOffset2RowId_[r+1]*sizeof(uint64_t)+64], _MM_HINT_T2);
-            _mm_prefetch(&(srcAddr)[(uint32_t)rowOffset2RowId_[r+2]*sizeof(uint64_t)+64], _MM_HINT_T2);
-            _mm_prefetch(&(srcAddr)[(uint32_t)rowOffset2RowId_[r+3]*sizeof(uint64_t)+64], _MM_HINT_T2);
-            dstPidBase+=4;
-          }
-#endif
-            for (r; r + 2 < size; r += 2) {
-              __m128i srcOffset2x = _mm_cvtsi32_si128(*((int32_t*)(rowOffset2RowId_.data() + r)));
-              srcOffset2x = _mm_shufflelo_epi16(srcOffset2x, 0x98);
-
-              __m128i src2x = _mm_i32gather_epi64((const long long int*)srcAddr, srcOffset2x, 8);
-              _mm_store_si128((__m128i*)dstPidBase, src2x);
-              //_mm_stream_si128((__m128i*)dstPidBase,src2x);
-
-              _mm_prefetch(&(srcAddr)[(uint32_t)rowOffset2RowId_[r] * sizeof(uint64_t) + 64], _MM_HINT_T2);
-              _mm_prefetch(&(srcAddr)[(uint32_t)rowOffset2RowId_[r + 1] * sizeof(uint64_t) + 64], _MM_HINT_T2);
-              dstPidBase += 2;
-            }
-#endif
-            for (r; r < size; r++) {
-              auto srcOffset = rowOffset2RowId_[r]; /*16k*/
-              *dstPidBase = reinterpret_cast<const uint64_t*>(srcAddr)[srcOffset]; /*64k*/
-              _mm_prefetch(&(srcAddr)[srcOffset * sizeof(uint64_t) + 64], _MM_HINT_T2);
-              dstPidBase += 1;
-            }
-            break;
-#else
-          RETURN_NOT_OK(splitFixedType<uint64_t>(srcAddr, dstAddrs));
-#endif
-            break;
-          }
-        }
-
-        case 128: // arrow::Decimal128Type::type_id
-          // too bad gcc generates movdqa even we use __m128i_u data type.
-          // splitFixedType<__m128i_u>(srcAddr, dstAddrs);
-          {
-            if (column->type()->isShortDecimal()) {
-              RETURN_NOT_OK(splitFixedType<int64_t>(srcAddr, dstAddrs));
-            } else if (column->type()->isLongDecimal()) {
-              // assume batch size = 32k; reducer# = 4K; row/reducer = 8
-              RETURN_NOT_OK(splitFixedType<int128_t>(srcAddr, dstAddrs));
-            } else {
-              return arrow::Status::Invalid(
-                  "Column type " + schema_->field(colIdx)->type()->ToString() + " is not supported.");
-            }
-          }
-          break;
-        default:
           return arrow::Status::Invalid(
-              "Column type " + schema_->field(colIdx)->type()->ToString() + " is not fixed width");
-      }
+              "Column type " + schema_->field(colIdx)->type()->ToString() + " is not supported.");
+        }
+        break;
+      default:
+        return arrow::Status::Invalid(
+            "Column type " + schema_->field(colIdx)->type()->ToString() + " is not fixed width");
     }
-
-    return arrow::Status::OK();
+    auto srcAddr = (const uint8_t*)column->valuesAsVoid();
+    splitColumns_.push_back({srcAddr, partitionFixedWidthValueAddrs_[col].data(), width, gatherFixedWidthFn(width)});
   }
 
-  arrow::Status VeloxShuffleWriter::splitBoolType(const uint8_t* srcAddr, const std::vector<uint8_t*>& dstAddrs) {
-    // assume batch size = 32k; reducer# = 4K; row/reducer = 8
-    for (auto pid = 0; pid < numPartitions_; ++pid) {
-      // set the last byte
-      auto dstaddr = dstAddrs[pid];
-      if (partition2RowCount_[pid] > 0 && dstaddr != nullptr) {
-        auto r = partition2RowOffset_[pid]; /*8k*/
-        auto size = partition2RowOffset_[pid + 1];
-        uint32_t dstOffset = partitionBufferIdxBase_[pid];
-        uint32_t dstOffsetInByte = (8 - (dstOffset & 0x7)) & 0x7;
-        uint32_t dstIdxByte = dstOffsetInByte;
-        uint8_t dst = dstaddr[dstOffset >> 3];
-        if (pid + 1 < numPartitions_) {
-          PREFETCHT1((&dstaddr[partitionBufferIdxBase_[pid + 1] >> 3]));
-        }
-        for (; r < size && dstIdxByte > 0; r++, dstIdxByte--) {
-          auto srcOffset = rowOffset2RowId_[r]; /*16k*/
-          uint8_t src = srcAddr[srcOffset >> 3];
-          src = src >> (srcOffset & 7) | 0xfe; // get the bit in bit 0, other bits set to 1
-#if defined(__x86_64__)
-          src = __rolb(src, 8 - dstIdxByte);
-#else
-        src = rotateLeft(src, (8 - dstIdxByte));
-#endif
-          dst = dst & src; // only take the useful bit.
-        }
-        dstaddr[dstOffset >> 3] = dst;
-        if (r == size) {
-          continue;
-        }
-        dstOffset += dstOffsetInByte;
-        // now dst_offset is 8 aligned
-        for (; r + 8 < size; r += 8) {
-          uint8_t src = 0;
-          auto srcOffset = rowOffset2RowId_[r]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          // PREFETCHT0((&(srcAddr)[(srcOffset >> 3) + 64]));
-          dst = src >> (srcOffset & 7) | 0xfe; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 1]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 1 | 0xfd; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 2]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 2 | 0xfb; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 3]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 3 | 0xf7; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 4]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 4 | 0xef; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 5]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 5 | 0xdf; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 6]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 6 | 0xbf; // get the bit in bit 0, other bits set to 1
-
-          srcOffset = rowOffset2RowId_[r + 7]; /*16k*/
-          src = srcAddr[srcOffset >> 3];
-          dst &= src >> (srcOffset & 7) << 7 | 0x7f; // get the bit in bit 0, other bits set to 1
-
-          dstaddr[dstOffset >> 3] = dst;
-          dstOffset += 8;
-          //_mm_prefetch(dstaddr + (dst_offset >> 3) + 64, _MM_HINT_T0);
-        }
-        // last byte, set it to 0xff is ok
-        dst = 0xff;
-        dstIdxByte = 0;
-        for (; r < size; r++, dstIdxByte++) {
-          auto srcOffset = rowOffset2RowId_[r]; /*16k*/
-          uint8_t src = srcAddr[srcOffset >> 3];
-          src = src >> (srcOffset & 7) | 0xfe; // get the bit in bit 0, other bits set to 1
-#if defined(__x86_64__)
-          src = __rolb(src, dstIdxByte);
-#else
-        src = rotateLeft(src, dstIdxByte);
-#endif
-          dst = dst & src; // only take the useful bit.
+  for (size_t col = 0; col < simpleColumnIndices_.size(); ++col) {
+    auto colIdx = simpleColumnIndices_[col];
+    auto column = rv.childAt(colIdx);
+    if (vectorHasNull(column)) {
+      auto& dstAddrs = partitionValidityAddrs_[col];
+      for (auto pid = 0; pid < numPartitions_; ++pid) {
+        if (partition2RowCount_[pid] > 0 && dstAddrs[pid] == nullptr) {
+          // init bitmap if it's null, initialize the buffer as true
+          auto newSize = std::max(partition2RowCount_[pid], (uint32_t)options_.buffer_size);
+          std::shared_ptr<arrow::Buffer> validityBuffer;
+          auto status = pool_->allocate(validityBuffer, arrow::bit_util::BytesForBits(newSize));
+          ARROW_RETURN_NOT_OK(status);
+          dstAddrs[pid] = const_cast<uint8_t*>(validityBuffer->data());
+          memset(validityBuffer->mutable_data(), 0xff, validityBuffer->capacity());
+          partitionBuffers_[col][pid][kValidityBufferIndex] = std::move(validityBuffer);
         }
-        dstaddr[dstOffset >> 3] = dst;
       }
+      splitColumns_.push_back({(const uint8_t*)column->rawNulls(), dstAddrs.data(), 0, nullptr});
+    } else {
+      VsPrintLF(colIdx, " column hasn't null");
     }
-    return arrow::Status::OK();
   }
+  return arrow::Status::OK();
+}
 
-  arrow::Status VeloxShuffleWriter::splitValidityBuffer(const velox::RowVector& rv) {
-    for (size_t col = 0; col < simpleColumnIndices_.size(); ++col) {
-      auto colIdx = simpleColumnIndices_[col];
-      auto column = rv.childAt(colIdx);
-      if (vectorHasNull(column)) {
-        auto& dstAddrs = partitionValidityAddrs_[col];
-        for (auto pid = 0; pid < numPartitions_; ++pid) {
-          if (partition2RowCount_[pid] > 0 && dstAddrs[pid] == nullptr) {
-            // init bitmap if it's null, initialize the buffer as true
-            auto newSize = std::max(partition2RowCount_[pid], (uint32_t)options_.buffer_size);
-            std::shared_ptr<arrow::Buffer> validityBuffer;
-            auto status = pool_->allocate(validityBuffer, arrow::bit_util::BytesForBits(newSize));
-            ARROW_RETURN_NOT_OK(status);
-            dstAddrs[pid] = const_cast<uint8_t*>(validityBuffer->data());
-            memset(validityBuffer->mutable_data(), 0xff, validityBuffer->capacity());
-            partitionBuffers_[col][pid][kValidityBufferIndex] = std::move(validityBuffer);
-          }
+void VeloxShuffleWriter::splitFixedWidthAndValidity() {
+  // Tiles of a partition's rows go through all the columns, so that their row ids stay in cache.
+  for (uint32_t pid = 0; pid < numPartitions_; ++pid) {
+    auto begin = partition2RowOffset_[pid];
+    auto end = partition2RowOffset_[pid + 1];
+    for (auto tileBegin = begin; tileBegin < end; tileBegin += kSplitTileRows) {
+      auto numRows = std::min(end - tileBegin, kSplitTileRows);
+      auto rowIds = rowOffset2RowId_.data() + tileBegin;
+      uint64_t dstRow = partitionBufferIdxBase_[pid] + (tileBegin - begin);
+      for (const auto& column : splitColumns_) {
+        auto dst = column.dstAddrs[pid];
+        if (column.width == 0) {
+          gatherBits(column.src, rowIds, numRows, dst, dstRow);
+        } else {
+          column.gather(column.src, rowIds, numRows, dst + dstRow * column.width);
         }
-
-        auto srcAddr = (const uint8_t*)(column->mutableRawNulls());
-        RETURN_NOT_OK(splitBoolType(srcAddr, dstAddrs));
-      } else {
-        VsPrintLF(colIdx, " column hasn't null");
       }
     }
-    return arrow::Status::OK();
   }
+}
 
-  arrow::Status VeloxShuffleWriter::splitBinaryType(
-      uint32_t binaryIdx, const velox::FlatVector<velox::StringView>& src, std::vector<BinaryBuf>& dst) {
-    auto rawValues = src.rawValues();
-
-    for (auto pid = 0; pid < numPartitions_; ++pid) {
-      auto& binaryBuf = dst[pid];
-
-      // use 32bit offset
-      using offset_type = arrow::BinaryType::offset_type;
-      auto dstOffsetBase = (offset_type*)(binaryBuf.offsetPtr) + partitionBufferIdxBase_[pid];
-
-      auto valueOffset = binaryBuf.valueOffset;
-      auto dstValuePtr = binaryBuf.valuePtr + valueOffset;
-      auto capacity = binaryBuf.valueCapacity;
-
-      auto r = partition2RowOffset_[pid];
-      auto size = partition2RowOffset_[pid + 1] - r;
-      auto multiply = 1;
-
-      for (uint32_t x = 0; x < size; x++) {
-        auto rowId = rowOffset2RowId_[x + r];
-        auto& stringView = rawValues[rowId];
-        auto stringLen = stringView.size();
-
-        // 1. copy offset
-        valueOffset = dstOffsetBase[x + 1] = valueOffset + stringLen;
-
-        if (valueOffset >= capacity) {
-          auto oldCapacity = capacity;
-          (void)oldCapacity; // suppress warning
-          capacity = capacity + std::max((capacity >> multiply), (uint64_t)stringLen);
-          multiply = std::min(3, multiply + 1);
-
-          auto valueBuffer = std::static_pointer_cast<arrow::ResizableBuffer>(
-              partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][pid][kValueBufferIndex]);
-
-          RETURN_NOT_OK(valueBuffer->Reserve(capacity));
-
-          binaryBuf.valuePtr = valueBuffer->mutable_data();
-          binaryBuf.valueCapacity = capacity;
-          dstValuePtr = binaryBuf.valuePtr + valueOffset - stringLen;
-
-          std::cout << "Split value buffer resized colIdx" << binaryIdx << std::endl;
-          VsPrintSplit(" dst_start", dstOffsetBase[x]);
-          VsPrintSplit(" dst_end", dstOffsetBase[x + 1]);
-          VsPrintSplit(" old size", oldCapacity);
-          VsPrintSplit(" new size", capacity);
-          VsPrintSplit(" row", partitionBufferIdxBase_[pid]);
-          VsPrintSplitLF(" string len", stringLen);
-        }
-
-        // 2. copy value
-        memcpy(dstValuePtr, stringView.data(), stringLen);
+arrow::Status VeloxShuffleWriter::splitBinaryType(
+    uint32_t binaryIdx, const velox::FlatVector<velox::StringView>& src, std::vector<BinaryBuf>& dst) {
+  auto rawValues = src.rawValues();
 
-        dstValuePtr += stringLen;
+  for (auto pid = 0; pid < numPartitions_; ++pid) {
+    auto& binaryBuf = dst[pid];
+
+    // use 32bit offset
+    using offset_type = arrow::BinaryType::offset_type;
+    auto dstOffsetBase = (offset_type*)(binaryBuf.offsetPtr) + partitionBufferIdxBase_[pid];
+
+    auto valueOffset = binaryBuf.valueOffset;
+    auto dstValuePtr = binaryBuf.valuePtr + valueOffset;
+    auto capacity = binaryBuf.valueCapacity;
+
+    auto r = partition2RowOffset_[pid];
+    auto size = partition2RowOffset_[pid + 1] - r;
+    auto multiply = 1;
+
+    for (uint32_t x = 0; x < size; x++) {
+      auto rowId = rowOffset2RowId_[x + r];
+      auto& stringView = rawValues[rowId];
+      auto stringLen = stringView.size();
+
+      // 1. copy offset
+      valueOffset = dstOffsetBase[x + 1] = valueOffset + stringLen;
+
+      if (valueOffset >= capacity) {
+        auto oldCapacity = capacity;
+        (void)oldCapacity; // suppress warning
+        capacity = capacity + std::max((capacity >> multiply), (uint64_t)stringLen);
+        multiply = std::min(3, multiply + 1);
+
+        auto valueBuffer = std::static_pointer_cast<arrow::ResizableBuffer>(
+            partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][pid][kValueBufferIndex]);
+
+        RETURN_NOT_OK(valueBuffer->Reserve(capacity));
+
+        binaryBuf.valuePtr = valueBuffer->mutable_data();
+        binaryBuf.valueCapacity = capacity;
+        dstValuePtr = binaryBuf.valuePtr + valueOffset - stringLen;
+
+        std::cout << "Split value buffer resized colIdx" << binaryIdx << std::endl;
+        VsPrintSplit(" dst_start", dstOffsetBase[x]);
+        VsPrintSplit(" dst_end", dstOffsetBase[x + 1]);
+        VsPrintSplit(" old size", oldCapacity);
+        VsPrintSplit(" new size", capacity);
+        VsPrintSplit(" row", partitionBufferIdxBase_[pid]);
+        VsPrintSplitLF(" string len", stringLen);
       }
 
-      binaryBuf.valueOffset = valueOffset;
+      // 2. copy value
+      memcpy(dstValuePtr, stringView.data(), stringLen);
+
+      dstValuePtr += stringLen;
     }
 
-    return arrow::Status::OK();
+    binaryBuf.valueOffset = valueOffset;
   }
 
-  arrow::Status VeloxShuffleWriter::splitBinaryArray(const velox::RowVector& rv) {
-    for (auto col = fixedWidthColumnCount_; col < simpleColumnIndices_.size(); ++col) {
-      auto binaryIdx = col - fixedWidthColumnCount_;
-      auto& dstAddrs = partitionBinaryAddrs_[binaryIdx];
-      auto colIdx = simpleColumnIndices_[col];
-      auto column = rv.childAt(colIdx);
-      auto stringColumn = column->asFlatVector<velox::StringView>();
-      assert(stringColumn);
-      RETURN_NOT_OK(splitBinaryType(binaryIdx, *stringColumn, dstAddrs));
-    }
-    return arrow::Status::OK();
+  return arrow::Status::OK();
+}
+
+arrow::Status VeloxShuffleWriter::splitBinaryArray(const velox::RowVector& rv) {
+  for (auto col = fixedWidthColumnCount_; col < simpleColumnIndices_.size(); ++col) {
+    auto binaryIdx = col - fixedWidthColumnCount_;
+    auto& dstAddrs = partitionBinaryAddrs_[binaryIdx];
+    auto colIdx = simpleColumnIndices_[col];
+    auto column = rv.childAt(colIdx);
+    auto stringColumn = column->asFlatVector<velox::StringView>();
+    assert(stringColumn);
+    RETURN_NOT_OK(splitBinaryType(binaryIdx, *stringColumn, dstAddrs));
   }
+  return arrow::Status::OK();
+}
 
-  arrow::Status VeloxShuffleWriter::splitComplexType(const velox::RowVector& rv) {
-    if (complexColumnIndices_.size() == 0) {
-      return arrow::Status::OK();
-    }
-    auto numRows = rv.size();
-    std::vector<std::vector<facebook::velox::IndexRange>> rowIndexs;
-    rowIndexs.resize(numPartitions_);
-    // TODO: maybe an estimated row is more reasonable
-    for (auto row = 0; row < numRows; ++row) {
-      auto partition = row2Partition_[row];
-      if (complexTypeData_[partition] == nullptr) {
-        // TODO: maybe memory issue, copy many times
-        complexTypeData_[partition] = std::move(serde_->createSerializer(
-            complexWriteType_, partition2RowCount_[partition], arena_.get(), /* serdeOptions */ nullptr));
+arrow::Status VeloxShuffleWriter::splitComplexType(const velox::RowVector& rv) {
+  for (size_t i = 0; i < complexColumnIndices_.size(); ++i) {
+    auto colIdx = complexColumnIndices_[i];
+    const auto& column = *rv.childAt(colIdx);
+    auto& builders = partitionComplexBuilders_[i];
+    for (auto pid = 0; pid < numPartitions_; ++pid) {
+      auto numRows = partition2RowCount_[pid];
+      if (numRows == 0) {
+        continue;
       }
-      rowIndexs[partition].emplace_back(IndexRange{row, 1});
-    }
-
-    std::vector<VectorPtr> childrens;
-    for (size_t i = 0; i < complexColumnIndices_.size(); ++i) {
-      auto colIdx = complexColumnIndices_[i];
-      auto column = rv.childAt(colIdx);
-      childrens.emplace_back(column);
-    }
-    auto rowVector = std::make_shared<RowVector>(
-        veloxPool_.get(), complexWriteType_, BufferPtr(nullptr), rv.size(), std::move(childrens));
-    for (auto pid = 0; pid < numPartitions_; pid++) {
-      if (rowIndexs[pid].size() != 0) {
-        complexTypeData_[pid]->append(rowVector, folly::Range(rowIndexs[pid].data(), rowIndexs[pid].size()));
+      if (builders[pid] == nullptr) {
+        builders[pid] = ComplexColumnBuilder::create(veloxColumnTypes_[colIdx], options_.memory_pool.get());
       }
+      // The row ids of a partition are ascending.
+      RETURN_NOT_OK(builders[pid]->append(column, rowOffset2RowId_.data() + partition2RowOffset_[pid], numRows, true));
     }
-
-    return arrow::Status::OK();
   }
+  return arrow::Status::OK();
+}
 
-  arrow::Status VeloxShuffleWriter::initColumnTypes(const velox::RowVector& rv) {
-    schema_ = toArrowSchema(rv.type());
+arrow::Status VeloxShuffleWriter::initColumnTypes(const velox::RowVector& rv) {
+  schema_ = toArrowSchema(rv.type());
 
-    // remove the first column
-    if (partitioner_->hasPid()) {
-      ARROW_ASSIGN_OR_RAISE(schema_, schema_->RemoveField(0));
-      // skip the first column
-      for (size_t i = 1; i < rv.childrenSize(); ++i) {
-        veloxColumnTypes_.push_back(rv.childAt(i)->type());
-      }
-    } else {
-      for (size_t i = 0; i < rv.childrenSize(); ++i) {
-        veloxColumnTypes_.push_back(rv.childAt(i)->type());
-      }
+  // remove the first column
+  if (partitioner_->hasPid()) {
+    ARROW_ASSIGN_OR_RAISE(schema_, schema_->RemoveField(0));
+    // skip the first column
+    for (size_t i = 1; i < rv.childrenSize(); ++i) {
+      veloxColumnTypes_.push_back(rv.childAt(i)->type());
     }
+  } else {
+    for (size_t i = 0; i < rv.childrenSize(); ++i) {
+      veloxColumnTypes_.push_back(rv.childAt(i)->type());
+    }
+  }
 
-    VsPrintSplitLF("schema_", schema_->ToString());
-
-    // get arrow_column_types_ from schema
-    ARROW_ASSIGN_OR_RAISE(arrowColumnTypes_, toShuffleWriterTypeId(schema_->fields()));
+  VsPrintSplitLF("schema_", schema_->ToString());
 
-    std::vector<std::string> complexNames;
-    std::vector<TypePtr> complexChildrens;
+  // get arrow_column_types_ from schema
+  ARROW_ASSIGN_OR_RAISE(arrowColumnTypes_, toShuffleWriterTypeId(schema_->fields()));
 
-    for (size_t i = 0; i < arrowColumnTypes_.size(); ++i) {
-      switch (arrowColumnTypes_[i]->id()) {
-        case arrow::BinaryType::type_id:
-        case arrow::StringType::type_id:
-          binaryColumnIndices_.push_back(i);
-          break;
-        case arrow::StructType::type_id:
-        case arrow::MapType::type_id:
-        case arrow::ListType::type_id: {
-          complexColumnIndices_.push_back(i);
-          complexNames.emplace_back(veloxColumnTypes_[i]->name());
-          complexChildrens.emplace_back(veloxColumnTypes_[i]);
-        } break;
-        default:
-          simpleColumnIndices_.push_back(i);
-          break;
-      }
+  for (size_t i = 0; i < arrowColumnTypes_.size(); ++i) {
+    switch (arrowColumnTypes_[i]->id()) {
+      case arrow::BinaryType::type_id:
+      case arrow::StringType::type_id:
+        binaryColumnIndices_.push_back(i);
+        break;
+      case arrow::StructType::type_id:
+      case arrow::MapType::type_id:
+      case arrow::ListType::type_id: {
+        complexColumnIndices_.push_back(i);
+      } break;
+      default:
+        simpleColumnIndices_.push_back(i);
+        break;
     }
+  }
 
-    fixedWidthColumnCount_ = simpleColumnIndices_.size();
-
-    simpleColumnIndices_.insert(simpleColumnIndices_.end(), binaryColumnIndices_.begin(), binaryColumnIndices_.end());
-
-    printColumnsInfo();
+  fixedWidthColumnCount_ = simpleColumnIndices_.size();
 
-    binaryArrayEmpiricalSize_.resize(binaryColumnIndices_.size(), 0);
+  simpleColumnIndices_.insert(simpleColumnIndices_.end(), binaryColumnIndices_.begin(), binaryColumnIndices_.end());
 
-    inputHasNull_.resize(simpleColumnIndices_.size(), false);
+  printColumnsInfo();
 
-    complexTypeData_.resize(numPartitions_);
-    complexTypeFlushBuffer_.resize(numPartitions_);
+  binaryArrayEmpiricalSize_.resize(binaryColumnIndices_.size(), 0);
 
-    complexWriteType_ = std::make_shared<RowType>(std::move(complexNames), std::move(complexChildrens));
+  inputHasNull_.resize(simpleColumnIndices_.size(), false);
 
-    return arrow::Status::OK();
+  partitionComplexBuilders_.resize(complexColumnIndices_.size());
+  for (auto& builders : partitionComplexBuilders_) {
+    builders.resize(numPartitions_);
   }
 
-  arrow::Status VeloxShuffleWriter::initFromRowVector(const velox::RowVector& rv) {
-    if (veloxColumnTypes_.empty()) {
-      RETURN_NOT_OK(initColumnTypes(rv));
+  return arrow::Status::OK();
+}
+
+arrow::Status VeloxShuffleWriter::initFromRowVector(const velox::RowVector& rv) {
+  if (veloxColumnTypes_.empty()) {
+    RETURN_NOT_OK(initColumnTypes(rv));
+    if (!options_.sort_based) {
       RETURN_NOT_OK(initPartitions(rv));
     }
-    return arrow::Status::OK();
   }
+  return arrow::Status::OK();
+}
 
-  uint32_t VeloxShuffleWriter::calculatePartitionBufferSize(const velox::RowVector& rv) {
-    uint32_t sizePerRow = 0;
-    auto numRows = rv.size();
-    for (size_t i = fixedWidthColumnCount_; i < simpleColumnIndices_.size(); ++i) {
-      auto index = i - fixedWidthColumnCount_;
-      if (binaryArrayEmpiricalSize_[index] == 0) {
-        auto column = rv.childAt(simpleColumnIndices_[i]);
-        auto stringViewColumn = column->asFlatVector<velox::StringView>();
-        assert(stringViewColumn);
-
-        // accumulate length
-        uint64_t length = stringViewColumn->values()->size();
-        for (auto& buffer : stringViewColumn->stringBuffers()) {
-          length += buffer->size();
-        }
-
-        binaryArrayEmpiricalSize_[index] = length % numRows == 0 ? length / numRows : length / numRows + 1;
+uint32_t VeloxShuffleWriter::calculatePartitionBufferSize(const velox::RowVector& rv) {
+  if (partitionBufferSize_ > 0) {
+    return partitionBufferSize_;
+  }
+  uint32_t sizePerRow = 0;
+  auto numRows = rv.size();
+  for (size_t i = fixedWidthColumnCount_; i < simpleColumnIndices_.size(); ++i) {
+    auto index = i - fixedWidthColumnCount_;
+    if (binaryArrayEmpiricalSize_[index] == 0) {
+      auto column = rv.childAt(simpleColumnIndices_[i]);
+      auto stringViewColumn = column->asFlatVector<velox::StringView>();
+      assert(stringViewColumn);
+
+      // accumulate length
+      uint64_t length = stringViewColumn->values()->size();
+      for (auto& buffer : stringViewColumn->stringBuffers()) {
+        length += buffer->size();
       }
+
+      binaryArrayEmpiricalSize_[index] = length % numRows == 0 ? length / numRows : length / numRows + 1;
     }
+  }
 
-    VS_PRINT_VECTOR_MAPPING(binaryArrayEmpiricalSize_);
+  VS_PRINT_VECTOR_MAPPING(binaryArrayEmpiricalSize_);
 
-    sizePerRow = std::accumulate(binaryArrayEmpiricalSize_.begin(), binaryArrayEmpiricalSize_.end(), 0);
+  sizePerRow = std::accumulate(binaryArrayEmpiricalSize_.begin(), binaryArrayEmpiricalSize_.end(), 0);
 
-    for (size_t col = 0; col < simpleColumnIndices_.size(); ++col) {
-      auto colIdx = simpleColumnIndices_[col];
-      // `bool(1) >> 3` gets 0, so +7
-      sizePerRow += ((arrow::bit_width(arrowColumnTypes_[colIdx]->id()) + 7) >> 3);
-    }
+  for (size_t col = 0; col < simpleColumnIndices_.size(); ++col) {
+    auto colIdx = simpleColumnIndices_[col];
+    // `bool(1) >> 3` gets 0, so +7
+    sizePerRow += ((arrow::bit_width(arrowColumnTypes_[colIdx]->id()) + 7) >> 3);
+  }
 
-    VS_PRINTLF(sizePerRow);
+  VS_PRINTLF(sizePerRow);
 
-    uint64_t preAllocRowCnt = options_.offheap_per_task > 0 && sizePerRow > 0
-        ? options_.offheap_per_task / sizePerRow / numPartitions_ >> 2
-        : options_.buffer_size;
-    preAllocRowCnt = std::min(preAllocRowCnt, (uint64_t)options_.buffer_size);
+  uint64_t preAllocRowCnt = options_.offheap_per_task > 0 && sizePerRow > 0
+      ? options_.offheap_per_task / sizePerRow / numPartitions_ >> 2
+      : options_.buffer_size;
+  preAllocRowCnt = std::min(preAllocRowCnt, (uint64_t)options_.buffer_size);
 
-    VS_PRINTLF(preallocRowCnt);
+  VS_PRINTLF(preallocRowCnt);
 
-    return preAllocRowCnt;
+  // The estimate only changes while a binary column has no empirical size. Keeping it keeps the partition buffers in
+  // the same size classes of the buffer pool.
+  if (std::find(binaryArrayEmpiricalSize_.begin(), binaryArrayEmpiricalSize_.end(), 0) ==
+      binaryArrayEmpiricalSize_.end()) {
+    partitionBufferSize_ = preAllocRowCnt;
   }
+  return preAllocRowCnt;
+}
 
-  arrow::Status VeloxShuffleWriter::allocatePartitionBuffers(uint32_t partitionId, uint32_t newSize) {
-    // try to allocate new
-    auto numFields = schema_->num_fields();
-    assert(numFields == arrowColumnTypes_.size());
-
-    auto fixedWidthIdx = 0;
-    auto binaryIdx = 0;
-    for (auto i = 0; i < numFields; ++i) {
-      switch (arrowColumnTypes_[i]->id()) {
-        case arrow::BinaryType::type_id:
-        case arrow::StringType::type_id: {
-          std::shared_ptr<arrow::Buffer> offsetBuffer;
-          std::shared_ptr<arrow::Buffer> validityBuffer = nullptr;
-          auto valueBufSize = binaryArrayEmpiricalSize_[binaryIdx] * newSize + 1024;
-          ARROW_ASSIGN_OR_RAISE(
-              std::shared_ptr<arrow::Buffer> valueBuffer,
-              arrow::AllocateResizableBuffer(valueBufSize, options_.memory_pool.get()));
-          ARROW_RETURN_NOT_OK(pool_->allocate(offsetBuffer, newSize * sizeof(arrow::StringType::offset_type) + 1));
-
-          // set the first offset to 0
-          uint8_t* offsetaddr = offsetBuffer->mutable_data();
-          memset(offsetaddr, 0, 8);
-
-          partitionBinaryAddrs_[binaryIdx][partitionId] =
-              BinaryBuf(valueBuffer->mutable_data(), offsetBuffer->mutable_data(), valueBufSize);
-
-          auto index = fixedWidthColumnCount_ + binaryIdx;
-          if (inputHasNull_[index]) {
-            ARROW_RETURN_NOT_OK(pool_->allocate(validityBuffer, arrow::bit_util::BytesForBits(newSize)));
-            // initialize all true once allocated
-            memset(validityBuffer->mutable_data(), 0xff, validityBuffer->capacity());
-            partitionValidityAddrs_[index][partitionId] = validityBuffer->mutable_data();
-          } else {
-            partitionValidityAddrs_[index][partitionId] = nullptr;
-          }
-          partitionBuffers_[index][partitionId] = {
-              std::move(validityBuffer), std::move(offsetBuffer), std::move(valueBuffer)};
-          binaryIdx++;
-          break;
+arrow::Status VeloxShuffleWriter::allocatePartitionBuffers(uint32_t partitionId, uint32_t newSize) {
+  // try to allocate new
+  auto numFields = schema_->num_fields();
+  assert(numFields == arrowColumnTypes_.size());
+
+  auto fixedWidthIdx = 0;
+  auto binaryIdx = 0;
+  for (auto i = 0; i < numFields; ++i) {
+    switch (arrowColumnTypes_[i]->id()) {
+      case arrow::BinaryType::type_id:
+      case arrow::StringType::type_id: {
+        std::shared_ptr<arrow::Buffer> offsetBuffer;
+        std::shared_ptr<arrow::Buffer> validityBuffer = nullptr;
+        auto valueBufSize = binaryArrayEmpiricalSize_[binaryIdx] * newSize + 1024;
+        ARROW_ASSIGN_OR_RAISE(
+            std::shared_ptr<arrow::Buffer> valueBuffer,
+            arrow::AllocateResizableBuffer(valueBufSize, options_.memory_pool.get()));
+        ARROW_RETURN_NOT_OK(pool_->allocate(offsetBuffer, newSize * sizeof(arrow::StringType::offset_type) + 1));
+
+        // set the first offset to 0
+        uint8_t* offsetaddr = offsetBuffer->mutable_data();
+        memset(offsetaddr, 0, 8);
+
+        partitionBinaryAddrs_[binaryIdx][partitionId] =
+            BinaryBuf(valueBuffer->mutable_data(), offsetBuffer->mutable_data(), valueBufSize);
+
+        auto index = fixedWidthColumnCount_ + binaryIdx;
+        if (inputHasNull_[index]) {
+          ARROW_RETURN_NOT_OK(pool_->allocate(validityBuffer, arrow::bit_util::BytesForBits(newSize)));
+          // initialize all true once allocated
+          memset(validityBuffer->mutable_data(), 0xff, validityBuffer->capacity());
+          partitionValidityAddrs_[index][partitionId] = validityBuffer->mutable_data();
+        } else {
+          partitionValidityAddrs_[index][partitionId] = nullptr;
         }
-        case arrow::StructType::type_id:
-        case arrow::MapType::type_id:
-        case arrow::ListType::type_id:
-          break;
-        default: {
-          std::shared_ptr<arrow::Buffer> valueBuffer;
-          std::shared_ptr<arrow::Buffer> validityBuffer = nullptr;
-          if (arrowColumnTypes_[i]->id() == arrow::BooleanType::type_id) {
-            ARROW_RETURN_NOT_OK(pool_->allocate(valueBuffer, arrow::bit_util::BytesForBits(newSize)));
-          } else if (veloxColumnTypes_[i]->isShortDecimal()) {
-            ARROW_RETURN_NOT_OK(
-                pool_->allocate(valueBuffer, newSize * (arrow::bit_width(arrow::Int64Type::type_id) >> 3)));
-          } else if (veloxColumnTypes_[i]->kind() == TypeKind::TIMESTAMP) {
-            ARROW_RETURN_NOT_OK(pool_->allocate(valueBuffer, BaseVector::byteSize<Timestamp>(newSize)));
-          } else {
-            ARROW_RETURN_NOT_OK(
-                pool_->allocate(valueBuffer, newSize * (arrow::bit_width(arrowColumnTypes_[i]->id()) >> 3)));
-          }
-          partitionFixedWidthValueAddrs_[fixedWidthIdx][partitionId] = valueBuffer->mutable_data();
+        partitionBuffers_[index][partitionId] = {
+            std::move(validityBuffer), std::move(offsetBuffer), std::move(valueBuffer)};
+        binaryIdx++;
+        break;
+      }
+      case arrow::StructType::type_id:
+      case arrow::MapType::type_id:
+      case arrow::ListType::type_id:
+        break;
+      default: {
+        std::shared_ptr<arrow::Buffer> valueBuffer;
+        std::shared_ptr<arrow::Buffer> validityBuffer = nullptr;
+        if (arrowColumnTypes_[i]->id() == arrow::BooleanType::type_id) {
+          ARROW_RETURN_NOT_OK(pool_->allocate(valueBuffer, arrow::bit_util::BytesForBits(newSize)));
+        } else if (veloxColumnTypes_[i]->isShortDecimal()) {
+          ARROW_RETURN_NOT_OK(
+              pool_->allocate(valueBuffer, newSize * (arrow::bit_width(arrow::Int64Type::type_id) >> 3)));
+        } else if (veloxColumnTypes_[i]->kind() == TypeKind::TIMESTAMP) {
+          ARROW_RETURN_NOT_OK(pool_->allocate(valueBuffer, BaseVector::byteSize<Timestamp>(newSize)));
+        } else {
+          ARROW_RETURN_NOT_OK(
+              pool_->allocate(valueBuffer, newSize * (arrow::bit_width(arrowColumnTypes_[i]->id()) >> 3)));
+        }
+        partitionFixedWidthValueAddrs_[fixedWidthIdx][partitionId] = valueBuffer->mutable_data();
 
-          if (inputHasNull_[fixedWidthIdx]) {
-            ARROW_RETURN_NOT_OK(pool_->allocate(validityBuffer, arrow::bit_util::BytesForBits(newSize)));
-            // initialize all true once allocated
-            memset(validityBuffer->mutable_data(), 0xff, validityBuffer->capacity());
-            partitionValidityAddrs_[fixedWidthIdx][partitionId] = validityBuffer->mutable_data();
-          } else {
-            partitionValidityAddrs_[fixedWidthIdx][partitionId] = nullptr;
-          }
-          partitionBuffers_[fixedWidthIdx][partitionId] = {std::move(validityBuffer), std::move(valueBuffer)};
-          fixedWidthIdx++;
-          break;
+        if (inputHasNull_[fixedWidthIdx]) {
+          ARROW_RETURN_NOT_OK(pool_->allocate(validityBuffer, arrow::bit_util::BytesForBits(newSize)));
+          // initialize all true once allocated
+          memset(validityBuffer->mutable_data(), 0xff, validityBuffer->capacity());
+          partitionValidityAddrs_[fixedWidthIdx][partitionId] = validityBuffer->mutable_data();
+        } else {
+          partitionValidityAddrs_[fixedWidthIdx][partitionId] = nullptr;
         }
+        partitionBuffers_[fixedWidthIdx][partitionId] = {std::move(validityBuffer), std::move(valueBuffer)};
+        fixedWidthIdx++;
+        break;
       }
     }
-
-    partition2BufferSize_[partitionId] = newSize;
-    return arrow::Status::OK();
   }
 
-  arrow::Status VeloxShuffleWriter::allocatePartitionBuffersWithRetry(uint32_t partitionId, uint32_t newSize) {
-    auto retry = 0;
-    auto status = allocatePartitionBuffers(partitionId, newSize);
-    while (status.IsOutOfMemory() && retry < 3) {
-      // retry allocate
-      ++retry;
-      std::cout << status.ToString() << std::endl
-                << std::to_string(retry) << " retry to allocate new buffer for partition "
-                << std::to_string(partitionId) << std::endl;
-
-      int64_t evictedSize = 0;
-      RETURN_NOT_OK(evictPartitionsOnDemand(&evictedSize));
-      if (evictedSize <= 0) {
-        std::cout << "Failed to allocate new buffer for partition " << std::to_string(partitionId)
-                  << ". No partition buffer to evict." << std::endl;
-        return status;
-      }
+  partition2BufferSize_[partitionId] = newSize;
+  return arrow::Status::OK();
+}
 
-      status = allocatePartitionBuffers(partitionId, newSize);
+arrow::Status VeloxShuffleWriter::allocatePartitionBuffersWithRetry(uint32_t partitionId, uint32_t newSize) {
+  auto retry = 0;
+  auto status = allocatePartitionBuffers(partitionId, newSize);
+  while (status.IsOutOfMemory() && retry < 3) {
+    // retry allocate
+    ++retry;
+    std::cout << status.ToString() << std::endl
+              << std::to_string(retry) << " retry to allocate new buffer for partition "
+              << std::to_string(partitionId) << std::endl;
+
+    // The bytes the allocation needs aren't known upfront, the largest cached payload is spilled.
+    auto allocatedBefore = options_.memory_pool->bytes_allocated();
+    RETURN_NOT_OK(evict(1));
+    RETURN_NOT_OK(partitionWriter_->waitForEvicted());
+    pool_->shrink();
+    if (options_.memory_pool->bytes_allocated() >= allocatedBefore) {
+      std::cout << "Failed to allocate new buffer for partition " << std::to_string(partitionId)
+                << ". No partition buffer to evict." << std::endl;
+      return status;
     }
 
-    if (status.IsOutOfMemory()) {
-      std::cout << "Failed to allocate new buffer for partition " << std::to_string(partitionId) << ". Out of memory."
-                << std::endl;
-    }
+    status = allocatePartitionBuffers(partitionId, newSize);
+  }
 
-    return status;
+  if (status.IsOutOfMemory()) {
+    std::cout << "Failed to allocate new buffer for partition " << std::to_string(partitionId) << ". Out of memory."
+              << std::endl;
   }
 
-  arrow::Result<std::shared_ptr<arrow::ipc::IpcPayload>> VeloxShuffleWriter::createArrowIpcPayload(
-      const arrow::RecordBatch& rb, bool reuseBuffers) {
-    auto payload = std::make_shared<arrow::ipc::IpcPayload>();
+  return status;
+}
+
+arrow::Result<std::shared_ptr<arrow::ipc::IpcPayload>> VeloxShuffleWriter::createArrowIpcPayload(
+    const arrow::RecordBatch& rb, bool reuseBuffers) {
+  auto payload = std::make_shared<arrow::ipc::IpcPayload>();
 #ifndef SKIPCOMPRESS
-    auto isTinyBatch = rb.num_rows() <= options_.batch_compress_threshold;
+  auto isTinyBatch = rb.num_rows() <= options_.batch_compress_threshold;
 #else
-  auto isTinyBatch = true;
+auto isTinyBatch = true;
 #endif
-    if (isTinyBatch) {
-      TIME_NANO_OR_RAISE(
-          totalCompressTime_, arrow::ipc::GetRecordBatchPayload(rb, tinyBatchWriteOptions_, payload.get()));
-    } else {
-      TIME_NANO_OR_RAISE(
-          totalCompressTime_, arrow::ipc::GetRecordBatchPayload(rb, options_.ipc_write_options, payload.get()));
-    }
-    if (isTinyBatch || options_.ipc_write_options.codec == nullptr) {
-      // Without compression, we need to perform a manual copy of the original buffers
-      // so that we can reuse them for next split.
-      if (reuseBuffers) {
-        for (auto i = 0; i < payload->body_buffers.size(); ++i) {
-          auto& buffer = payload->body_buffers[i];
-          if (buffer) {
-            auto memoryPool = options_.ipc_write_options.memory_pool;
-            ARROW_ASSIGN_OR_RAISE(auto copy, ::arrow::AllocateResizableBuffer(buffer->size(), memoryPool));
-            if (buffer->size() > 0) {
-              memcpy(copy->mutable_data(), buffer->data(), static_cast<size_t>(buffer->size()));
-            }
-            buffer = std::move(copy);
+  auto compress = !isTinyBatch && options_.ipc_write_options.codec != nullptr &&
+      compressibilitySampler_->shouldCompress();
+  if (!compress) {
+    TIME_NANO_OR_RAISE(
+        totalCompressTime_, arrow::ipc::GetRecordBatchPayload(rb, tinyBatchWriteOptions_, payload.get()));
+  } else {
+    TIME_NANO_OR_RAISE(
+        totalCompressTime_, arrow::ipc::GetRecordBatchPayload(rb, options_.ipc_write_options, payload.get()));
+    compressibilitySampler_->update(payload->raw_body_length, payload->body_length);
+  }
+  if (!compress) {
+    // Without compression, we need to perform a manual copy of the original buffers
+    // so that we can reuse them for next split.
+    if (reuseBuffers) {
+      for (auto i = 0; i < payload->body_buffers.size(); ++i) {
+        auto& buffer = payload->body_buffers[i];
+        if (buffer) {
+          auto memoryPool = options_.ipc_write_options.memory_pool;
+          ARROW_ASSIGN_OR_RAISE(auto copy, ::arrow::AllocateResizableBuffer(buffer->size(), memoryPool));
+          if (buffer->size() > 0) {
+            memcpy(copy->mutable_data(), buffer->data(), static_cast<size_t>(buffer->size()));
           }
+          buffer = std::move(copy);
         }
       }
-    } else {
-      // With compression, make buffers shrink-to-fit
-      for (auto i = 0; i < payload->body_buffers.size(); ++i) {
-        auto& buffer = payload->body_buffers[i];
-        if (buffer && buffer->size() > 0) {
-          if (buffer->parent()) { // A compressed Buffer is created from SliceBuffer(parent)
-            auto parent = std::dynamic_pointer_cast<arrow::ResizableBuffer>(buffer->parent());
-            RETURN_NOT_OK(parent->Resize(buffer->size(), /* shrink_to_fit= */ true));
-            if (parent->data() != buffer->data()) {
-              payload->body_buffers[i] = arrow::SliceBuffer(parent, 0, buffer->size());
-            }
-          } else {
-            return arrow::Status::Invalid("Cannot shrink buffer.");
+    }
+  } else {
+    // With compression, make buffers shrink-to-fit
+    for (auto i = 0; i < payload->body_buffers.size(); ++i) {
+      auto& buffer = payload->body_buffers[i];
+      if (buffer && buffer->size() > 0) {
+        if (buffer->parent()) { // A compressed Buffer is created from SliceBuffer(parent)
+          auto parent = std::dynamic_pointer_cast<arrow::ResizableBuffer>(buffer->parent());
+          RETURN_NOT_OK(parent->Resize(buffer->size(), /* shrink_to_fit= */ true));
+          if (parent->data() != buffer->data()) {
+            payload->body_buffers[i] = arrow::SliceBuffer(parent, 0, buffer->size());
           }
+        } else {
+          return arrow::Status::Invalid("Cannot shrink buffer.");
         }
       }
     }
-    return payload;
   }
+  return payload;
+}
 
-  arrow::Status VeloxShuffleWriter::createRecordBatchFromBuffer(uint32_t partitionId, bool resetBuffers) {
-    ARROW_ASSIGN_OR_RAISE(auto rb, createArrowRecordBatchFromBuffer(partitionId, resetBuffers));
-    if (rb) {
-      RETURN_NOT_OK(cacheRecordBatch(partitionId, *rb, false));
-    }
-    return arrow::Status::OK();
+arrow::Status VeloxShuffleWriter::createRecordBatchFromBuffer(uint32_t partitionId, bool resetBuffers) {
+  ARROW_ASSIGN_OR_RAISE(auto rb, createArrowRecordBatchFromBuffer(partitionId, resetBuffers));
+  if (rb) {
+    RETURN_NOT_OK(cacheRecordBatch(partitionId, *rb, false));
   }
+  return arrow::Status::OK();
+}
 
-  arrow::Result<std::shared_ptr<arrow::RecordBatch>> VeloxShuffleWriter::createArrowRecordBatchFromBuffer(
-      uint32_t partitionId, bool resetBuffers) {
-    if (partitionBufferIdxBase_[partitionId] <= 0) {
-      return nullptr;
-    }
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> VeloxShuffleWriter::createArrowRecordBatchFromBuffer(
+    uint32_t partitionId, bool resetBuffers) {
+  if (partitionBufferIdxBase_[partitionId] <= 0) {
+    return nullptr;
+  }
 
-    auto numRows = partitionBufferIdxBase_[partitionId];
-
-    // already filled
-    auto fixedWidthIdx = 0;
-    auto binaryIdx = 0;
-    auto numFields = schema_->num_fields();
-
-    std::vector<std::shared_ptr<arrow::Array>> arrays(numFields);
-    std::vector<std::shared_ptr<arrow::Buffer>> allBuffers;
-    // one column should have 2 buffers at least, string column has 3 column buffers
-    allBuffers.reserve(fixedWidthColumnCount_ * 2 + binaryColumnIndices_.size() * 3);
-    bool hasComplexType = false;
-    for (int i = 0; i < numFields; ++i) {
-      switch (arrowColumnTypes_[i]->id()) {
-        case arrow::BinaryType::type_id:
-        case arrow::StringType::type_id: {
-          auto buffers = partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][partitionId];
-          // validity buffer
-          if (buffers[kValidityBufferIndex] != nullptr) {
-            buffers[kValidityBufferIndex] =
-                arrow::SliceBuffer(buffers[kValidityBufferIndex], 0, arrow::bit_util::BytesForBits(numRows));
-          }
-          // offset buffer
-          if (buffers[kOffsetBufferIndex] != nullptr) {
-            buffers[kOffsetBufferIndex] =
-                arrow::SliceBuffer(buffers[kOffsetBufferIndex], 0, (numRows + 1) * sizeof(int32_t));
-          }
-          // value buffer
-          if (buffers[kValueBufferIndex] != nullptr) {
-            VELOX_DCHECK_NE(buffers[kOffsetBufferIndex], nullptr);
-            buffers[kValueBufferIndex] = arrow::SliceBuffer(
-                buffers[kValueBufferIndex],
-                0,
-                reinterpret_cast<const int32_t*>(buffers[kOffsetBufferIndex]->data())[numRows]);
-          }
+  auto numRows = partitionBufferIdxBase_[partitionId];
+
+  // already filled
+  auto fixedWidthIdx = 0;
+  auto binaryIdx = 0;
+  auto complexIdx = 0;
+  auto numFields = schema_->num_fields();
+
+  std::vector<std::shared_ptr<arrow::Array>> arrays(numFields);
+  std::vector<std::shared_ptr<arrow::Buffer>> allBuffers;
+  // one column should have 2 buffers at least, string column has 3 column buffers
+  allBuffers.reserve(fixedWidthColumnCount_ * 2 + binaryColumnIndices_.size() * 3);
+  for (int i = 0; i < numFields; ++i) {
+    switch (arrowColumnTypes_[i]->id()) {
+      case arrow::BinaryType::type_id:
+      case arrow::StringType::type_id: {
+        auto buffers = partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][partitionId];
+        // validity buffer
+        if (buffers[kValidityBufferIndex] != nullptr) {
+          buffers[kValidityBufferIndex] =
+              arrow::SliceBuffer(buffers[kValidityBufferIndex], 0, arrow::bit_util::BytesForBits(numRows));
+        }
+        // offset buffer
+        if (buffers[kOffsetBufferIndex] != nullptr) {
+          buffers[kOffsetBufferIndex] =
+              arrow::SliceBuffer(buffers[kOffsetBufferIndex], 0, (numRows + 1) * sizeof(int32_t));
+        }
+        // value buffer
+        if (buffers[kValueBufferIndex] != nullptr) {
+          VELOX_DCHECK_NE(buffers[kOffsetBufferIndex], nullptr);
+          buffers[kValueBufferIndex] = arrow::SliceBuffer(
+              buffers[kValueBufferIndex],
+              0,
+              reinterpret_cast<const int32_t*>(buffers[kOffsetBufferIndex]->data())[numRows]);
+        }
 
-          allBuffers.emplace_back(buffers[kValidityBufferIndex]);
-          allBuffers.emplace_back(buffers[kOffsetBufferIndex]);
-          allBuffers.emplace_back(buffers[kValueBufferIndex]);
+        allBuffers.emplace_back(buffers[kValidityBufferIndex]);
+        allBuffers.emplace_back(buffers[kOffsetBufferIndex]);
+        allBuffers.emplace_back(buffers[kValueBufferIndex]);
 
-          if (resetBuffers) {
-            partitionValidityAddrs_[fixedWidthColumnCount_ + binaryIdx][partitionId] = nullptr;
-            partitionBinaryAddrs_[binaryIdx][partitionId] = BinaryBuf();
-            partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][partitionId].clear();
+        if (resetBuffers) {
+          partitionValidityAddrs_[fixedWidthColumnCount_ + binaryIdx][partitionId] = nullptr;
+          partitionBinaryAddrs_[binaryIdx][partitionId] = BinaryBuf();
+          partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][partitionId].clear();
+        } else {
+          // reset the offset
+          partitionBinaryAddrs_[binaryIdx][partitionId].valueOffset = 0;
+        }
+        binaryIdx++;
+        break;
+      }
+      case arrow::StructType::type_id:
+      case arrow::MapType::type_id:
+      case arrow::ListType::type_id: {
+        auto& builder = partitionComplexBuilders_[complexIdx++][partitionId];
+        if (builder == nullptr || builder->numRows() != numRows) {
+          return arrow::Status::Invalid("Complex column ", i, " of partition ", partitionId, " is out of sync.");
+        }
+        RETURN_NOT_OK(builder->finish(allBuffers));
+      } break;
+      default: {
+        auto buffers = partitionBuffers_[fixedWidthIdx][partitionId];
+        if (buffers[kValidityBufferIndex] != nullptr) {
+          buffers[kValidityBufferIndex] =
+              arrow::SliceBuffer(buffers[kValidityBufferIndex], 0, arrow::bit_util::BytesForBits(numRows));
+        }
+        if (buffers[1] != nullptr) {
+          if (arrowColumnTypes_[i]->id() == arrow::BooleanType::type_id) {
+            buffers[1] = arrow::SliceBuffer(buffers[1], 0, arrow::bit_util::BytesForBits(numRows));
+          } else if (veloxColumnTypes_[i]->isShortDecimal()) {
+            buffers[1] =
+                arrow::SliceBuffer(buffers[1], 0, numRows * (arrow::bit_width(arrow::Int64Type::type_id) >> 3));
+          } else if (veloxColumnTypes_[i]->kind() == TypeKind::TIMESTAMP) {
+            buffers[1] = arrow::SliceBuffer(buffers[1], 0, BaseVector::byteSize<Timestamp>(numRows));
           } else {
-            // reset the offset
-            partitionBinaryAddrs_[binaryIdx][partitionId].valueOffset = 0;
+            buffers[1] =
+                arrow::SliceBuffer(buffers[1], 0, numRows * (arrow::bit_width(arrowColumnTypes_[i]->id()) >> 3));
           }
-          binaryIdx++;
-          break;
         }
-        case arrow::StructType::type_id:
-        case arrow::MapType::type_id:
-        case arrow::ListType::type_id: {
-          hasComplexType = true;
-        } break;
-        default: {
-          auto buffers = partitionBuffers_[fixedWidthIdx][partitionId];
-          if (buffers[kValidityBufferIndex] != nullptr) {
-            buffers[kValidityBufferIndex] =
-                arrow::SliceBuffer(buffers[kValidityBufferIndex], 0, arrow::bit_util::BytesForBits(numRows));
-          }
-          if (buffers[1] != nullptr) {
-            if (arrowColumnTypes_[i]->id() == arrow::BooleanType::type_id) {
-              buffers[1] = arrow::SliceBuffer(buffers[1], 0, arrow::bit_util::BytesForBits(numRows));
-            } else if (veloxColumnTypes_[i]->isShortDecimal()) {
-              buffers[1] =
-                  arrow::SliceBuffer(buffers[1], 0, numRows * (arrow::bit_width(arrow::Int64Type::type_id) >> 3));
-            } else if (veloxColumnTypes_[i]->kind() == TypeKind::TIMESTAMP) {
-              buffers[1] = arrow::SliceBuffer(buffers[1], 0, BaseVector::byteSize<Timestamp>(numRows));
-            } else {
-              buffers[1] =
-                  arrow::SliceBuffer(buffers[1], 0, numRows * (arrow::bit_width(arrowColumnTypes_[i]->id()) >> 3));
-            }
-          }
-          allBuffers.emplace_back(buffers[kValidityBufferIndex]);
-          allBuffers.emplace_back(buffers[1]);
-          if (resetBuffers) {
-            partitionValidityAddrs_[fixedWidthIdx][partitionId] = nullptr;
-            partitionFixedWidthValueAddrs_[fixedWidthIdx][partitionId] = nullptr;
-            partitionBuffers_[fixedWidthIdx][partitionId].clear();
-          }
-          fixedWidthIdx++;
-          break;
+        allBuffers.emplace_back(buffers[kValidityBufferIndex]);
+        allBuffers.emplace_back(buffers[1]);
+        if (resetBuffers) {
+          partitionValidityAddrs_[fixedWidthIdx][partitionId] = nullptr;
+          partitionFixedWidthValueAddrs_[fixedWidthIdx][partitionId] = nullptr;
+          partitionBuffers_[fixedWidthIdx][partitionId].clear();
         }
+        fixedWidthIdx++;
+        break;
       }
     }
-    if (hasComplexType && complexTypeData_[partitionId] != nullptr) {
-      auto flushBuffer = complexTypeFlushBuffer_[partitionId];
-      auto serializedSize = complexTypeData_[partitionId]->maxSerializedSize();
-      if (flushBuffer == nullptr) {
-        GLUTEN_ASSIGN_OR_THROW(flushBuffer, arrow::AllocateResizableBuffer(serializedSize, options_.memory_pool.get()));
-      } else if (serializedSize > flushBuffer->capacity()) {
-        GLUTEN_THROW_NOT_OK(flushBuffer->Reserve(serializedSize));
-      }
-      auto valueBuffer = arrow::SliceMutableBuffer(flushBuffer, 0, serializedSize);
-      auto output = std::make_shared<arrow::io::FixedSizeBufferWriter>(valueBuffer);
-      serializer::presto::PrestoOutputStreamListener listener;
-      ArrowFixedSizeBufferOutputStream out(output, &listener);
-      complexTypeData_[partitionId]->flush(&out);
-      allBuffers.emplace_back(valueBuffer);
-      complexTypeData_[partitionId] = nullptr;
+  }
+  return makeRecordBatch(numRows, allBuffers, writeSchema(), pool_.get());
+}
+
+arrow::Status VeloxShuffleWriter::cacheRecordBatch(
+    uint32_t partitionId, const arrow::RecordBatch& rb, bool reuseBuffers) {
+  rawPartitionLengths_[partitionId] += getBatchNbytes(rb);
+  ARROW_ASSIGN_OR_RAISE(auto payload, createArrowIpcPayload(rb, reuseBuffers));
+  partitionCachedRecordbatchSize_[partitionId] += payload->body_length;
+  partitionCachedRecordbatch_[partitionId].push_back(std::move(payload));
+  partitionBufferIdxBase_[partitionId] = 0;
+  return arrow::Status::OK();
+}
+
+arrow::Status VeloxShuffleWriter::evictFixedSize(int64_t size, int64_t* actual) {
+  auto pool = options_.memory_pool.get();
+  auto allocatedBefore = pool->bytes_allocated();
+  int64_t sortBufferedEvicted = 0;
+  if (options_.sort_based && sortBufferedBytes_ > 0) {
+    // Buffered input batches are allocated from the upstream pools, the writer releases their retained size once
+    // they are sorted and evicted.
+    for (const auto& rv : sortBufferedRowVectors_) {
+      sortBufferedEvicted += rv->retainedSize();
     }
+    RETURN_NOT_OK(sortAndCacheBufferedRows());
+    RETURN_NOT_OK(evictSortedPartitions());
+  }
+  RETURN_NOT_OK(evict(size - sortBufferedEvicted));
+  RETURN_NOT_OK(partitionWriter_->waitForEvicted());
+  // The partition buffers released by the eviction went back to the buffer pool.
+  pool_->shrink();
+  *actual = sortBufferedEvicted + std::max<int64_t>(0, allocatedBefore - pool->bytes_allocated());
+  return arrow::Status::OK();
+}
 
-    return makeRecordBatch(numRows, allBuffers, writeSchema(), pool_.get());
+EvictionState VeloxShuffleWriter::evictionState() const {
+  EvictionState state;
+  state.canSpillPartition = partitionWriter_->canEvictPartition();
+  state.partitions.resize(numPartitions_);
+  for (auto pid = 0; pid < numPartitions_; ++pid) {
+    auto& usage = state.partitions[pid];
+    usage.cachedBytes = partitionCachedRecordbatchSize_[pid];
+    usage.numSpills = partitionNumSpills_[pid];
+    // Only the hash-based split has partition buffers.
+    if (splitting_ || partition2BufferSize_.empty() || partition2BufferSize_[pid] == 0) {
+      continue;
+    }
+    for (const auto& columnBuffers : partitionBuffers_) {
+      for (const auto& buffer : columnBuffers[pid]) {
+        usage.bufferedBytes += buffer == nullptr ? 0 : buffer->capacity();
+      }
+    }
+    for (const auto& builders : partitionComplexBuilders_) {
+      usage.bufferedBytes += builders[pid] == nullptr ? 0 : builders[pid]->capacity();
+    }
+    if (partitionBufferIdxBase_[pid] == 0) {
+      usage.shrinkableBytes = usage.bufferedBytes;
+    } else {
+      for (const auto& binaryBufs : partitionBinaryAddrs_) {
+        usage.shrinkableBytes += binaryBufs[pid].valueCapacity - binaryBufs[pid].valueOffset;
+      }
+    }
   }
+  return state;
+}
 
-  arrow::Status VeloxShuffleWriter::cacheRecordBatch(
-      uint32_t partitionId, const arrow::RecordBatch& rb, bool reuseBuffers) {
-    rawPartitionLengths_[partitionId] += getBatchNbytes(rb);
-    ARROW_ASSIGN_OR_RAISE(auto payload, createArrowIpcPayload(rb, reuseBuffers));
-    partitionCachedRecordbatchSize_[partitionId] += payload->body_length;
-    partitionCachedRecordbatch_[partitionId].push_back(std::move(payload));
-    partitionBufferIdxBase_[partitionId] = 0;
+arrow::Status VeloxShuffleWriter::evict(int64_t target) {
+  // Payloads still queued for an asynchronous spill are about to be released.
+  target -= partitionWriter_->inFlightBytes();
+  // The free buffers of the buffer pool go first, nothing has to be written for them.
+  if (target > 0) {
+    target -= pool_->shrink(target);
+  }
+  if (target <= 0) {
     return arrow::Status::OK();
   }
-
-  arrow::Status VeloxShuffleWriter::evictFixedSize(int64_t size, int64_t * actual) {
-    int64_t currentEvicted = 0L;
-    auto tryCount = 0;
-    while (currentEvicted < size && tryCount < 5) {
-      tryCount++;
-      int64_t singleCallEvicted = 0;
-      RETURN_NOT_OK(evictPartitionsOnDemand(&singleCallEvicted));
-      if (singleCallEvicted <= 0) {
+  for (const auto& step : evictionPolicy_->plan(evictionState(), target)) {
+    switch (step.action) {
+      case EvictAction::kShrinkBuffers:
+        RETURN_NOT_OK(shrinkPartitionBuffers(step.partitionId));
+        break;
+      case EvictAction::kFlushBuffers:
+        RETURN_NOT_OK(flushPartitionBuffers(step.partitionId));
+        break;
+      case EvictAction::kSpillPayloads:
+        if (step.partitionId == -1 && !partitionWriter_->canEvictPartition()) {
+          if (totalCachedPayloadSize() > 0) {
+            RETURN_NOT_OK(evictPartition(-1));
+          }
+          break;
+        }
+        for (auto pid = 0; pid < numPartitions_; ++pid) {
+          if ((step.partitionId == -1 || pid == step.partitionId) && partitionCachedRecordbatchSize_[pid] > 0) {
+            RETURN_NOT_OK(evictPartition(pid));
+          }
+        }
         break;
-      }
-      currentEvicted += singleCallEvicted;
     }
-    *actual = currentEvicted;
-    return arrow::Status::OK();
   }
+  return arrow::Status::OK();
+}
 
-  arrow::Status VeloxShuffleWriter::evictPartitionsOnDemand(int64_t * size) {
-    if (options_.prefer_evict) {
-      // evict the largest partition
-      auto maxSize = 0;
-      int32_t partitionToEvict = -1;
-      for (auto i = 0; i < numPartitions_; ++i) {
-        if (partitionCachedRecordbatchSize_[i] > maxSize) {
-          maxSize = partitionCachedRecordbatchSize_[i];
-          partitionToEvict = i;
-        }
-      }
-      if (partitionToEvict != -1) {
-        RETURN_NOT_OK(evictPartition(partitionToEvict));
-#ifdef GLUTEN_PRINT_DEBUG
-        std::cout << "Evicted partition " << std::to_string(partitionToEvict) << ", " << std::to_string(maxSize)
-                  << " bytes released" << std::endl;
-#endif
-        *size = maxSize;
-      } else {
-        *size = 0;
-      }
-    } else {
-      // Evict all cached partitions
-      int64_t totalCachedSize =
-          std::accumulate(partitionCachedRecordbatchSize_.begin(), partitionCachedRecordbatchSize_.end(), 0);
-      RETURN_NOT_OK(evictPartition(-1));
-#ifdef GLUTEN_PRINT_DEBUG
-      std::cout << "Evicted all partition. " << std::to_string(totalCachedSize) << " bytes released" << std::endl;
-#endif
-      *size = totalCachedSize;
+arrow::Status VeloxShuffleWriter::shrinkPartitionBuffers(uint32_t partitionId) {
+  if (partitionBufferIdxBase_[partitionId] == 0) {
+    // The next split bringing rows to the partition allocates new buffers.
+    for (auto col = 0; col < simpleColumnIndices_.size(); ++col) {
+      partitionValidityAddrs_[col][partitionId] = nullptr;
+      partitionBuffers_[col][partitionId].clear();
+    }
+    for (auto fixedWidthIdx = 0; fixedWidthIdx < fixedWidthColumnCount_; ++fixedWidthIdx) {
+      partitionFixedWidthValueAddrs_[fixedWidthIdx][partitionId] = nullptr;
     }
+    for (auto& binaryBufs : partitionBinaryAddrs_) {
+      binaryBufs[partitionId] = BinaryBuf();
+    }
+    partition2BufferSize_[partitionId] = 0;
     return arrow::Status::OK();
   }
+  // The other buffers have the fixed sizes of the buffer pool, only the binary value buffers can shrink in place.
+  for (auto binaryIdx = 0; binaryIdx < binaryColumnIndices_.size(); ++binaryIdx) {
+    auto& binaryBuf = partitionBinaryAddrs_[binaryIdx][partitionId];
+    auto valueBuffer = std::static_pointer_cast<arrow::ResizableBuffer>(
+        partitionBuffers_[fixedWidthColumnCount_ + binaryIdx][partitionId][kValueBufferIndex]);
+    RETURN_NOT_OK(valueBuffer->Resize(binaryBuf.valueOffset, /*shrink_to_fit=*/true));
+    binaryBuf.valuePtr = valueBuffer->mutable_data();
+    binaryBuf.valueCapacity = valueBuffer->capacity();
+  }
+  return arrow::Status::OK();
+}
 
-  arrow::Status VeloxShuffleWriter::resetValidityBuffers(uint32_t partitionId) {
-    std::for_each(
-        partitionBuffers_.begin(), partitionBuffers_.end(), [partitionId](std::vector<arrow::BufferVector>& bufs) {
-          if (bufs[partitionId].size() != 0 && bufs[partitionId][0] != nullptr) {
-            // initialize all true once allocated
-            auto addr = bufs[partitionId][0]->mutable_data();
-            memset(addr, 0xff, bufs[partitionId][0]->capacity());
-          }
-        });
-    return arrow::Status::OK();
+arrow::Status VeloxShuffleWriter::flushPartitionBuffers(uint32_t partitionId) {
+  if (partitionBufferIdxBase_[partitionId] == 0) {
+    return shrinkPartitionBuffers(partitionId);
   }
+  RETURN_NOT_OK(createRecordBatchFromBuffer(partitionId, /*resetBuffers=*/true));
+  // The next split bringing rows to the partition allocates new buffers.
+  partition2BufferSize_[partitionId] = 0;
+  return arrow::Status::OK();
+}
 
-  // TODO: Move into PartitionWriter
-  arrow::Status VeloxShuffleWriter::evictPartition(int32_t partitionId) {
-    RETURN_NOT_OK(partitionWriter_->evictPartition(partitionId));
-    // reset validity buffer after evict
-    if (partitionId == -1) {
-      // Reset for all partitions
-      for (auto i = 0; i < numPartitions_; ++i) {
-        RETURN_NOT_OK(resetValidityBuffers(i));
-      }
-    } else {
-      RETURN_NOT_OK(resetValidityBuffers(partitionId));
+arrow::Status VeloxShuffleWriter::resetValidityBuffers(uint32_t partitionId) {
+  std::for_each(
+      partitionBuffers_.begin(), partitionBuffers_.end(), [partitionId](std::vector<arrow::BufferVector>& bufs) {
+        if (bufs[partitionId].size() != 0 && bufs[partitionId][0] != nullptr) {
+          // initialize all true once allocated
+          auto addr = bufs[partitionId][0]->mutable_data();
+          memset(addr, 0xff, bufs[partitionId][0]->capacity());
+        }
+      });
+  return arrow::Status::OK();
+}
+
+// TODO: Move into PartitionWriter
+arrow::Status VeloxShuffleWriter::evictPartition(int32_t partitionId) {
+  if (partitionId == -1) {
+    for (auto pid = 0; pid < numPartitions_; ++pid) {
+      partitionNumSpills_[pid] += partitionCachedRecordbatchSize_[pid] > 0;
     }
-    return arrow::Status::OK();
+  } else {
+    partitionNumSpills_[partitionId]++;
   }
+  numSpills_++;
+  // Only the cached payloads are spilled, the rows in the partition buffers stay.
+  return partitionWriter_->evictPartition(partitionId);
+}
 
 } // namespace gluten
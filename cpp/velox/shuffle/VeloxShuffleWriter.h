@@ -22,11 +22,9 @@
 #include <string>
 #include <vector>
 
-#include "velox/serializers/PrestoSerializer.h"
 #include "velox/type/Type.h"
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/FlatVector.h"
-#include "velox/vector/VectorStream.h"
 
 #include <arrow/filesystem/filesystem.h>
 #include <arrow/filesystem/localfs.h>
@@ -44,12 +42,16 @@
 #include "arrow/result.h"
 
 #include "memory/VeloxMemoryPool.h"
+#include "shuffle/ComplexColumnBuilder.h"
+#include "shuffle/EvictionPolicy.h"
 #include "shuffle/PartitionWriterCreator.h"
 #include "shuffle/Partitioner.h"
 #include "shuffle/ShuffleWriter.h"
+#include "shuffle/SplitKernels.h"
 #include "shuffle/utils.h"
 
 #include "utils/Print.h"
+#include "utils/compression.h"
 
 namespace gluten {
 
@@ -196,9 +198,7 @@ class VeloxShuffleWriter final : public ShuffleWriter {
       uint32_t numPartitions,
       std::shared_ptr<PartitionWriterCreator> partitionWriterCreator,
       const ShuffleWriterOptions& options)
-      : ShuffleWriter(numPartitions, partitionWriterCreator, options),
-        veloxPool_(defaultLeafVeloxMemoryPool()),
-        arena_(std::make_unique<facebook::velox::StreamArena>(veloxPool_.get())) {}
+      : ShuffleWriter(numPartitions, partitionWriterCreator, options), veloxPool_(defaultLeafVeloxMemoryPool()) {}
 
   arrow::Status init();
 
@@ -212,6 +212,17 @@ class VeloxShuffleWriter final : public ShuffleWriter {
 
   arrow::Status initFromRowVector(const facebook::velox::RowVector& rv);
 
+  arrow::Status computePartitionIds(const int32_t* pidArr, uint32_t numRows);
+
+  // Calls fn with the row -> partition id mapping of the width chosen in init().
+  template <typename Fn>
+  arrow::Status dispatchRow2Partition(Fn&& fn) {
+    if (widePartitionId_) {
+      return fn(row2PartitionWide_);
+    }
+    return fn(row2Partition_);
+  }
+
   arrow::Status createPartition2Row(uint32_t rowNum);
 
   arrow::Status updateInputHasNull(const facebook::velox::RowVector& rv);
@@ -228,47 +239,44 @@ class VeloxShuffleWriter final : public ShuffleWriter {
 
   arrow::Status cacheRecordBatch(uint32_t partitionId, const arrow::RecordBatch& rb, bool reuseBuffers);
 
-  arrow::Status splitFixedWidthValueBuffer(const facebook::velox::RowVector& rv);
-
-  arrow::Status splitBoolType(const uint8_t* srcAddr, const std::vector<uint8_t*>& dstAddrs);
+  arrow::Status prepareSplitColumns(const facebook::velox::RowVector& rv);
 
-  arrow::Status splitValidityBuffer(const facebook::velox::RowVector& rv);
+  void splitFixedWidthAndValidity();
 
   arrow::Status splitBinaryArray(const facebook::velox::RowVector& rv);
 
   arrow::Status splitComplexType(const facebook::velox::RowVector& rv);
 
-  template <typename T>
-  arrow::Status splitFixedType(const uint8_t* srcAddr, const std::vector<uint8_t*>& dstAddrs) {
-    std::transform(
-        dstAddrs.begin(),
-        dstAddrs.end(),
-        partitionBufferIdxBase_.begin(),
-        partitionBufferIdxOffset_.begin(),
-        [](uint8_t* x, uint32_t y) { return x + y * sizeof(T); });
-
-    for (uint32_t pid = 0; pid < numPartitions_; ++pid) {
-      auto dstPidBase = reinterpret_cast<T*>(partitionBufferIdxOffset_[pid]);
-      auto pos = partition2RowOffset_[pid];
-      auto end = partition2RowOffset_[pid + 1];
-      for (; pos < end; ++pos) {
-        auto rowId = rowOffset2RowId_[pos];
-        *dstPidBase++ = reinterpret_cast<const T*>(srcAddr)[rowId]; // copy
-      }
-    }
-    return arrow::Status::OK();
-  }
-
   arrow::Status splitBinaryType(
       uint32_t binaryIdx,
       const facebook::velox::FlatVector<facebook::velox::StringView>& src,
       std::vector<BinaryBuf>& dst);
 
-  arrow::Status evictPartitionsOnDemand(int64_t* size);
+  arrow::Status cacheRowVector(uint32_t partitionId, const facebook::velox::RowVector& rv);
+
+  arrow::Status bufferRowVectorForSort(facebook::velox::RowVectorPtr rv);
+
+  arrow::Status sortAndCacheBufferedRows();
+
+  template <typename T>
+  void sortBufferedRowIds(std::vector<std::vector<T>>& bufferedPartitionIds);
+
+  arrow::Status evictSortedPartitions();
+
+  facebook::velox::RowVectorPtr gatherSortedRows(const uint64_t* rowIds, uint32_t numRows);
+
+  EvictionState evictionState() const;
+
+  // Carries out the eviction policy's plan to release `target` bytes.
+  arrow::Status evict(int64_t target);
 
   arrow::Status evictPartition(int32_t partitionId);
 
-  std::shared_ptr<arrow::Buffer> generateComplexTypeBuffers(facebook::velox::RowVectorPtr vector);
+  // Releases the buffers of a partition holding no rows, and trims the binary value buffers of the others.
+  arrow::Status shrinkPartitionBuffers(uint32_t partitionId);
+
+  // Caches the rows of the partition buffers as a payload and releases the buffers.
+  arrow::Status flushPartitionBuffers(uint32_t partitionId);
 
  protected:
   arrow::Status resetValidityBuffers(uint32_t partitionId);
@@ -284,11 +292,16 @@ class VeloxShuffleWriter final : public ShuffleWriter {
   // write options for tiny batches
   arrow::ipc::IpcWriteOptions tinyBatchWriteOptions_;
 
+  // Skips compression while the payloads don't compress well.
+  std::unique_ptr<CompressibilitySampler> compressibilitySampler_;
+
   // Row ID -> Partition ID
   // subscript: Row ID
   // value: Partition ID
-  // TODO: rethink, is uint16_t better?
+  // Only one of the two is used: 16-bit ids unless there are more than 64k partitions.
   std::vector<uint16_t> row2Partition_; // note: partition_id_
+  std::vector<uint32_t> row2PartitionWide_;
+  bool widePartitionId_ = false;
 
   // Partition ID -> Row Count
   // subscript: Partition ID
@@ -324,8 +337,19 @@ class VeloxShuffleWriter final : public ShuffleWriter {
   // partid, value is reducer batch's offset, output rb rownum < 64k
   std::vector<uint32_t> partitionBufferIdxBase_;
 
-  // temp array to hold the destination pointer
-  std::vector<uint8_t*> partitionBufferIdxOffset_;
+  // A fixed-width value buffer or a validity buffer filled by the split, with the kernel for its width. Bitmaps have
+  // a width of 0.
+  struct SplitColumn {
+    const uint8_t* src;
+    uint8_t* const* dstAddrs;
+    int32_t width;
+    GatherFixedWidthFn gather;
+  };
+
+  // Rows of a partition split through all the columns at once.
+  static constexpr uint32_t kSplitTileRows = 1024;
+
+  std::vector<SplitColumn> splitColumns_;
 
   typedef uint32_t row_offset_type;
 
@@ -334,20 +358,35 @@ class VeloxShuffleWriter final : public ShuffleWriter {
 
   std::vector<uint64_t> binaryArrayEmpiricalSize_;
 
+  // Rows of newly allocated partition buffers, 0 until all the binary columns had an empirical size.
+  uint32_t partitionBufferSize_ = 0;
+
   std::vector<std::vector<BinaryBuf>> partitionBinaryAddrs_;
 
   std::vector<bool> inputHasNull_;
 
-  // pid
-  std::vector<std::unique_ptr<facebook::velox::VectorSerializer>> complexTypeData_;
-  std::vector<std::shared_ptr<arrow::ResizableBuffer>> complexTypeFlushBuffer_;
-  std::shared_ptr<const facebook::velox::RowType> complexWriteType_;
+  // sort-based split
+  // Buffered input batches (partition key column stripped) and their per-row partition ids
+  std::vector<facebook::velox::RowVectorPtr> sortBufferedRowVectors_;
+  std::vector<std::vector<uint16_t>> sortBufferedPartitionIds_;
+  std::vector<std::vector<uint32_t>> sortBufferedWidePartitionIds_;
+  // Partition ID -> buffered row count across all buffered batches
+  std::vector<uint32_t> sortPartitionRowCount_;
+  int64_t sortBufferedBytes_ = 0;
+  // Sorted by partition id, value is (batch index << 32 | row index)
+  std::vector<uint64_t> sortedRowIds_;
+  std::vector<facebook::velox::vector_size_t> sortGatherIndices_;
+
+  // complex column index, pid
+  std::vector<std::vector<std::unique_ptr<ComplexColumnBuilder>>> partitionComplexBuilders_;
 
   std::shared_ptr<facebook::velox::memory::MemoryPool> veloxPool_;
-  std::unique_ptr<facebook::velox::StreamArena> arena_;
 
-  std::unique_ptr<facebook::velox::serializer::presto::PrestoVectorSerde> serde_ =
-      std::make_unique<facebook::velox::serializer::presto::PrestoVectorSerde>();
+  std::unique_ptr<EvictionPolicy> evictionPolicy_;
+  // Partition ID -> times its payloads were spilled
+  std::vector<int32_t> partitionNumSpills_;
+  // The partition buffers are only released between splits, an eviction during a split only spills payloads.
+  bool splitting_ = false;
 
 }; // class VeloxShuffleWriter
 
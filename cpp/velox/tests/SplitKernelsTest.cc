@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+#include "shuffle/SplitKernels.h"
+
+namespace gluten {
+namespace {
+
+// Ascending row ids mixing a contiguous run, scattered rows and a run crossing a block.
+std::vector<uint32_t> makeRowIds() {
+  std::vector<uint32_t> rowIds(40);
+  std::iota(rowIds.begin(), rowIds.begin() + 20, 3);
+  for (uint32_t i = 20; i < 30; ++i) {
+    rowIds[i] = rowIds[i - 1] + 1 + i % 3;
+  }
+  std::iota(rowIds.begin() + 30, rowIds.end(), rowIds[29] + 7);
+  return rowIds;
+}
+
+template <typename T>
+void testGatherFixedWidth() {
+  std::vector<T> src(200);
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<T>(i * 7 + 1);
+  }
+  auto rowIds = makeRowIds();
+  auto gather = gatherFixedWidthFn(sizeof(T));
+  ASSERT_NE(gather, nullptr);
+  for (uint32_t numRows : {0u, 1u, 16u, 20u, 40u}) {
+    std::vector<T> dst(numRows);
+    auto first = rowIds.size() - numRows;
+    gather(
+        reinterpret_cast<const uint8_t*>(src.data()),
+        rowIds.data() + first,
+        numRows,
+        reinterpret_cast<uint8_t*>(dst.data()));
+    for (uint32_t i = 0; i < numRows; ++i) {
+      ASSERT_EQ(dst[i], src[rowIds[first + i]]) << "numRows " << numRows << " row " << i;
+    }
+  }
+}
+
+} // namespace
+
+TEST(SplitKernelsTest, gatherFixedWidth) {
+  testGatherFixedWidth<uint8_t>();
+  testGatherFixedWidth<uint16_t>();
+  testGatherFixedWidth<uint32_t>();
+  testGatherFixedWidth<uint64_t>();
+  testGatherFixedWidth<__int128_t>();
+  ASSERT_EQ(gatherFixedWidthFn(3), nullptr);
+}
+
+TEST(SplitKernelsTest, gatherBits) {
+  std::vector<uint8_t> src(32);
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  std::vector<uint32_t> rowIds(150);
+  for (uint32_t i = 0; i < rowIds.size(); ++i) {
+    // A contiguous head, then every other row.
+    rowIds[i] = i < 70 ? i : 2 * i - 69;
+  }
+  // The bits around the gathered ones are left as they were.
+  const uint8_t fill = 0xa5;
+  for (uint64_t dstOffset : {0, 3, 8, 13}) {
+    std::vector<uint8_t> dst(32, fill);
+    gatherBits(src.data(), rowIds.data(), rowIds.size(), dst.data(), dstOffset);
+    for (uint64_t bit = 0; bit < dst.size() * 8; ++bit) {
+      bool expected = bit >= dstOffset && bit < dstOffset + rowIds.size()
+          ? arrow::bit_util::GetBit(src.data(), rowIds[bit - dstOffset])
+          : arrow::bit_util::GetBit(&fill, bit % 8);
+      ASSERT_EQ(arrow::bit_util::GetBit(dst.data(), bit), expected) << "offset " << dstOffset << " bit " << bit;
+    }
+  }
+}
+
+} // namespace gluten
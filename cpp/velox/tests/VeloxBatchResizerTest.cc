@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "compute/VeloxBatchResizer.h"
+#include "velox/vector/tests/utils/VectorTestBase.h"
+
+using namespace facebook::velox;
+
+namespace gluten {
+class VeloxBatchResizerTest : public ::testing::Test, public test::VectorTestBase {
+ protected:
+  RowVectorPtr makeVector(int64_t start, vector_size_t size) {
+    return makeRowVector({makeFlatVector<int64_t>(size, [start](auto row) { return start + row; })});
+  }
+
+  VeloxBatchResizer::Source makeSource(std::vector<RowVectorPtr> vectors) {
+    return [vectors = std::move(vectors), idx = 0]() mutable -> RowVectorPtr {
+      return idx < vectors.size() ? vectors[idx++] : nullptr;
+    };
+  }
+
+  std::vector<RowVectorPtr> drain(VeloxBatchResizer& resizer) {
+    std::vector<RowVectorPtr> result;
+    while (auto vector = resizer.next()) {
+      result.emplace_back(vector);
+    }
+    return result;
+  }
+
+  void assertRows(const std::vector<RowVectorPtr>& vectors, int64_t numRows) {
+    int64_t expected = 0;
+    for (const auto& vector : vectors) {
+      auto values = vector->childAt(0)->asFlatVector<int64_t>();
+      for (vector_size_t row = 0; row < vector->size(); ++row) {
+        ASSERT_EQ(values->valueAt(row), expected++);
+      }
+    }
+    ASSERT_EQ(expected, numRows);
+  }
+};
+
+TEST_F(VeloxBatchResizerTest, coalesce) {
+  auto bytes = makeVector(0, 100)->estimateFlatSize();
+  // Room for about ten of the vectors, but at most 250 rows.
+  VeloxBatchResizer resizer(
+      pool(), 250, 10 * bytes, makeSource({makeVector(0, 100), makeVector(100, 100), makeVector(200, 100)}));
+  auto vectors = drain(resizer);
+  ASSERT_EQ(vectors.size(), 2);
+  ASSERT_EQ(vectors[0]->size(), 200);
+  ASSERT_EQ(vectors[1]->size(), 100);
+  assertRows(vectors, 300);
+  ASSERT_EQ(resizer.numBatches(), 2);
+  ASSERT_EQ(resizer.numRows(), 300);
+  ASSERT_EQ(resizer.numCoalesced(), 2);
+  ASSERT_EQ(resizer.numSplit(), 0);
+}
+
+TEST_F(VeloxBatchResizerTest, split) {
+  auto bytes = makeVector(0, 1000)->estimateFlatSize();
+  VeloxBatchResizer resizer(pool(), 4096, bytes / 4, makeSource({makeVector(0, 1000), makeVector(1000, 10)}));
+  auto vectors = drain(resizer);
+  // About 250 rows per slice. The small vector which follows isn't merged into the last one.
+  ASSERT_GE(vectors.size(), 5);
+  ASSERT_NEAR(vectors[0]->size(), 250, 10);
+  ASSERT_EQ(vectors.back()->size(), 10);
+  assertRows(vectors, 1010);
+  ASSERT_EQ(resizer.numSplit(), 1);
+}
+
+TEST_F(VeloxBatchResizerTest, disabled) {
+  VeloxBatchResizer resizer(pool(), 4096, 0, makeSource({makeVector(0, 10), makeVector(10, 10)}));
+  auto vectors = drain(resizer);
+  ASSERT_EQ(vectors.size(), 2);
+  assertRows(vectors, 20);
+  ASSERT_EQ(resizer.numCoalesced(), 0);
+  ASSERT_EQ(resizer.numBytes(), 0);
+}
+
+} // namespace gluten
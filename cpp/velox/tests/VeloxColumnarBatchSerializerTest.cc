@@ -59,4 +59,37 @@ TEST_F(VeloxColumnarBatchSerializerTest, serialize) {
   test::assertEqualVectors(vector, deserializedVector);
 }
 
+TEST_F(VeloxColumnarBatchSerializerTest, serializeCompressed) {
+  auto first = makeRowVector({
+      makeNullableFlatVector<int64_t>({1, std::nullopt, 3}),
+      makeFlatVector<StringView>({"a", "a string longer than the inline size", "c"}),
+  });
+  auto second = makeRowVector({
+      makeNullableFlatVector<int64_t>({std::nullopt, 5}),
+      makeFlatVector<StringView>({"another string longer than the inline size", "e"}),
+  });
+  auto expected = makeRowVector({
+      makeNullableFlatVector<int64_t>({1, std::nullopt, 3, std::nullopt, 5}),
+      makeFlatVector<StringView>(
+          {"a",
+           "a string longer than the inline size",
+           "c",
+           "another string longer than the inline size",
+           "e"}),
+  });
+
+  for (auto compressionType :
+       {arrow::Compression::UNCOMPRESSED, arrow::Compression::LZ4_FRAME, arrow::Compression::ZSTD}) {
+    auto serializer = std::make_shared<VeloxColumnarBatchSerializer>(arrowPool_, veloxPool_, nullptr, compressionType);
+    auto buffer = serializer->serializeColumnarBatches(
+        {std::make_shared<VeloxColumnarBatch>(first), std::make_shared<VeloxColumnarBatch>(second)});
+
+    ArrowSchema cSchema;
+    exportToArrow(expected, cSchema);
+    auto deserializer = std::make_shared<VeloxColumnarBatchSerializer>(arrowPool_, veloxPool_, &cSchema);
+    auto deserialized = deserializer->deserialize(const_cast<uint8_t*>(buffer->data()), buffer->size());
+    test::assertEqualVectors(expected, std::dynamic_pointer_cast<VeloxColumnarBatch>(deserialized)->getRowVector());
+  }
+}
+
 } // namespace gluten
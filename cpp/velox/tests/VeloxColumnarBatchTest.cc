@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "memory/VeloxColumnarBatch.h"
+#include "velox/vector/tests/utils/VectorTestBase.h"
+
+using namespace facebook::velox;
+
+namespace gluten {
+class VeloxColumnarBatchTest : public ::testing::Test, public test::VectorTestBase {};
+
+TEST_F(VeloxColumnarBatchTest, flattenEncodedChildrenOnly) {
+  auto flat = makeFlatVector<int64_t>({1, 2, 3, 4});
+  auto dictionary = wrapInDictionary(makeIndices({3, 2, 1, 0}), 4, makeFlatVector<int32_t>({10, 20, 30, 40}));
+  auto constant = makeConstant<int32_t>(7, 4);
+  auto rowVector = makeRowVector({flat, dictionary, constant});
+  auto batch = std::make_shared<VeloxColumnarBatch>(rowVector);
+
+  // The size is estimated without flattening.
+  ASSERT_GT(batch->numBytes(), 0);
+
+  auto flattened = batch->getFlattenedRowVector();
+  // The flat child is shared, the encoded ones are copied.
+  ASSERT_EQ(flattened->childAt(0), flat);
+  ASSERT_TRUE(flattened->childAt(1)->isFlatEncoding());
+  ASSERT_TRUE(flattened->childAt(2)->isFlatEncoding());
+  test::assertEqualVectors(rowVector, flattened);
+  ASSERT_EQ(batch->numBytes(), flattened->estimateFlatSize());
+}
+
+} // namespace gluten
@@ -452,4 +452,85 @@ TEST_F(VeloxColumnarToRowTest, _allTypes_18rows) {
   makeInputBatch(inputData, schema, &inputBatch);
   testRecordBatchEqual(inputBatch);
 }
+
+TEST_F(VeloxColumnarToRowTest, encodings) {
+  auto toRows = [](const RowVectorPtr& row) {
+    auto converter =
+        std::make_shared<VeloxColumnarToRowConverter>(defaultArrowMemoryPool(), defaultLeafVeloxMemoryPool());
+    GLUTEN_THROW_NOT_OK(converter->write(std::make_shared<VeloxColumnarBatch>(row)));
+    auto lengths = converter->getLengths();
+    int64_t totalLength = 0;
+    for (auto length : lengths) {
+      totalLength += length;
+    }
+    return std::string(reinterpret_cast<const char*>(converter->getBufferAddress()), totalLength);
+  };
+
+  auto indices = makeIndices({3, 0, 2, 2, 1});
+  auto ints = makeNullableFlatVector<int32_t>({1, std::nullopt, 3, 4});
+  auto strings = makeNullableFlatVector<std::string>({"a", "a long string over 12 bytes", std::nullopt, "abcdefgh"});
+  auto decimals = makeNullableFlatVector<int128_t>({1, std::nullopt, -3, 40000000000000000}, DECIMAL(30, 2));
+
+  auto encoded = makeRowVector({
+      BaseVector::wrapInDictionary(nullptr, indices, 5, ints),
+      BaseVector::wrapInDictionary(nullptr, indices, 5, strings),
+      BaseVector::wrapInDictionary(nullptr, indices, 5, decimals),
+      BaseVector::createConstant(BOOLEAN(), true, 5, pool()),
+      BaseVector::createNullConstant(BIGINT(), 5, pool()),
+      BaseVector::createConstant(VARCHAR(), "constant string", 5, pool()),
+      makeFlatVector<Date>({Date(1), Date(2), Date(3), Date(4), Date(5)}),
+  });
+  auto flat = makeRowVector({
+      makeNullableFlatVector<int32_t>({4, 1, 3, 3, std::nullopt}),
+      makeNullableFlatVector<std::string>(
+          {"abcdefgh", "a", std::nullopt, std::nullopt, "a long string over 12 bytes"}),
+      makeNullableFlatVector<int128_t>({40000000000000000, 1, -3, -3, std::nullopt}, DECIMAL(30, 2)),
+      makeFlatVector<bool>({true, true, true, true, true}),
+      makeNullableFlatVector<int64_t>({std::nullopt, std::nullopt, std::nullopt, std::nullopt, std::nullopt}),
+      makeFlatVector<std::string>(
+          {"constant string", "constant string", "constant string", "constant string", "constant string"}),
+      makeFlatVector<Date>({Date(1), Date(2), Date(3), Date(4), Date(5)}),
+  });
+  ASSERT_EQ(toRows(encoded), toRows(flat));
+}
+
+TEST_F(VeloxColumnarToRowTest, chunks) {
+  std::vector<std::optional<std::string>> strings;
+  for (int32_t i = 0; i < 100; i++) {
+    strings.push_back(i % 7 == 0 ? std::nullopt : std::make_optional(std::string(i % 37, 'a' + i % 26)));
+  }
+  auto row = makeRowVector({
+      makeFlatVector<int64_t>(100, [](auto i) { return i; }),
+      makeNullableFlatVector<std::string>(strings),
+  });
+  auto batch = std::make_shared<VeloxColumnarBatch>(row);
+
+  auto expected =
+      std::make_shared<VeloxColumnarToRowConverter>(defaultArrowMemoryPool(), defaultLeafVeloxMemoryPool());
+  GLUTEN_THROW_NOT_OK(expected->write(batch));
+
+  auto converter =
+      std::make_shared<VeloxColumnarToRowConverter>(defaultArrowMemoryPool(), defaultLeafVeloxMemoryPool());
+  constexpr int64_t kMemoryThreshold = 256;
+  int32_t numChunks = 0;
+  for (int32_t startRow = 0; startRow < row->size(); startRow += converter->getNumRows()) {
+    GLUTEN_THROW_NOT_OK(converter->writeChunk(batch, startRow, kMemoryThreshold));
+    ASSERT_GT(converter->getNumRows(), 0);
+    int64_t chunkSize = 0;
+    for (int32_t i = 0; i < converter->getNumRows(); i++) {
+      auto length = converter->getLengths()[i];
+      ASSERT_EQ(length, expected->getLengths()[startRow + i]);
+      ASSERT_EQ(
+          memcmp(
+              converter->getBufferAddress() + converter->getOffsets()[i],
+              expected->getBufferAddress() + expected->getOffsets()[startRow + i],
+              length),
+          0);
+      chunkSize += length;
+    }
+    ASSERT_TRUE(chunkSize <= kMemoryThreshold || converter->getNumRows() == 1);
+    numChunks++;
+  }
+  ASSERT_GT(numChunks, 1);
+}
 } // namespace gluten
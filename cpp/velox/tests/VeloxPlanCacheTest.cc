@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "compute/VeloxPlanCache.h"
+
+namespace gluten {
+namespace {
+
+// A join of two scans, or of a scan and an input iterator.
+::substrait::Plan makePlan(const std::vector<std::string>& leftFiles, const std::vector<std::string>& rightFiles) {
+  ::substrait::Plan plan;
+  auto join = plan.add_relations()->mutable_root()->mutable_input()->mutable_join();
+  auto addFiles = [](::substrait::Rel* rel, const std::vector<std::string>& files) {
+    auto localFiles = rel->mutable_read()->mutable_local_files();
+    for (int32_t i = 0; i < files.size(); ++i) {
+      auto item = localFiles->add_items();
+      item->set_uri_file(files[i]);
+      item->set_start(0);
+      item->set_length(100 + i);
+      item->mutable_parquet();
+    }
+  };
+  addFiles(join->mutable_left(), leftFiles);
+  addFiles(join->mutable_right(), rightFiles);
+  return plan;
+}
+
+std::shared_ptr<facebook::velox::substrait::SplitInfo> makeScanInfo(const std::vector<std::string>& files) {
+  auto scanInfo = std::make_shared<facebook::velox::substrait::SplitInfo>();
+  for (int32_t i = 0; i < files.size(); ++i) {
+    scanInfo->paths.emplace_back(files[i]);
+    scanInfo->starts.emplace_back(0);
+    scanInfo->lengths.emplace_back(100 + i);
+  }
+  return scanInfo;
+}
+
+} // namespace
+
+TEST(VeloxPlanCacheTest, keyIgnoresFiles) {
+  auto plan1 = makePlan({"file:///a/1", "file:///a/2"}, {"file:///b/1"});
+  auto plan2 = makePlan({"file:///a/3"}, {"file:///b/2", "file:///b/3"});
+  auto reads1 = collectFileReads(plan1);
+  auto reads2 = collectFileReads(plan2);
+  ASSERT_TRUE(reads1.has_value());
+  ASSERT_TRUE(reads2.has_value());
+  ASSERT_EQ(reads1->size(), 2);
+  ASSERT_EQ(reads2->size(), 2);
+  ASSERT_EQ(makePlanCacheKey(plan1, *reads1), makePlanCacheKey(plan2, *reads2));
+  // The plan is left as it was.
+  ASSERT_EQ((*reads1)[0]->local_files().items_size(), 2);
+  ASSERT_EQ((*reads1)[0]->local_files().items(1).uri_file(), "file:///a/2");
+
+  // Input iterators are part of the plan.
+  auto plan3 = makePlan({"file:///a/1"}, {"iterator:0"});
+  auto plan4 = makePlan({"file:///a/1"}, {"iterator:1"});
+  auto reads3 = collectFileReads(plan3);
+  auto reads4 = collectFileReads(plan4);
+  ASSERT_EQ(reads3->size(), 1);
+  ASSERT_NE(makePlanCacheKey(plan3, *reads3), makePlanCacheKey(plan4, *reads4));
+
+  // So is the file format.
+  auto plan5 = makePlan({"file:///a/1"}, {"iterator:0"});
+  auto reads5 = collectFileReads(plan5);
+  (*reads5)[0]->mutable_local_files()->mutable_items(0)->mutable_orc();
+  ASSERT_NE(makePlanCacheKey(plan3, *reads3), makePlanCacheKey(plan5, *reads5));
+}
+
+TEST(VeloxPlanCacheTest, bindFiles) {
+  auto plan1 = makePlan({"file:///a/1"}, {"file:///b/1", "file:///b/2"});
+  auto reads1 = collectFileReads(plan1);
+  VeloxPlanTemplate planTemplate;
+  planTemplate.scanIds = {"1", "0"};
+  planTemplate.scanInfos = {makeScanInfo({"file:///b/1", "file:///b/2"}), makeScanInfo({"file:///a/1"})};
+  ASSERT_TRUE(matchFileReads(planTemplate, *reads1));
+  ASSERT_EQ(planTemplate.fileReadIndices, std::vector<int32_t>({1, 0}));
+
+  auto plan2 = makePlan({"file:///a/2", "file:///a/3"}, {"file:///b/3"});
+  auto reads2 = collectFileReads(plan2);
+  auto scanInfo = makeSplitInfo(*(*reads2)[planTemplate.fileReadIndices[0]], *planTemplate.scanInfos[0]);
+  ASSERT_EQ(scanInfo->paths, std::vector<std::string>({"file:///b/3"}));
+  ASSERT_EQ(scanInfo->lengths, std::vector<uint64_t>({100}));
+
+  // Scans of the same files can't be told apart.
+  auto plan3 = makePlan({"file:///a/1"}, {"file:///a/1"});
+  auto reads3 = collectFileReads(plan3);
+  planTemplate.scanInfos = {makeScanInfo({"file:///a/1"}), makeScanInfo({"file:///a/1"})};
+  ASSERT_FALSE(matchFileReads(planTemplate, *reads3));
+}
+
+TEST(VeloxPlanCacheTest, lru) {
+  VeloxPlanCache cache(2);
+  auto planTemplate = std::make_shared<VeloxPlanTemplate>();
+  cache.put("a", planTemplate);
+  cache.put("b", planTemplate);
+  ASSERT_EQ(cache.get("a"), planTemplate);
+  // "b" is the least recently used.
+  cache.put("c", planTemplate);
+  ASSERT_EQ(cache.get("b"), nullptr);
+  ASSERT_EQ(cache.get("a"), planTemplate);
+  ASSERT_EQ(cache.get("c"), planTemplate);
+  ASSERT_EQ(cache.size(), 2);
+  ASSERT_EQ(cache.hits(), 3);
+  ASSERT_EQ(cache.misses(), 1);
+  ASSERT_EQ(cache.evictions(), 1);
+
+  cache.setCapacity(0);
+  ASSERT_FALSE(cache.enabled());
+  ASSERT_EQ(cache.size(), 0);
+  cache.put("a", planTemplate);
+  ASSERT_EQ(cache.get("a"), nullptr);
+}
+
+} // namespace gluten
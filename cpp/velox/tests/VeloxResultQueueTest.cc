@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "compute/VeloxResultQueue.h"
+#include "velox/vector/tests/utils/VectorTestBase.h"
+
+using namespace facebook::velox;
+
+namespace gluten {
+class VeloxResultQueueTest : public ::testing::Test, public test::VectorTestBase {
+ protected:
+  RowVectorPtr makeVector(int32_t value) {
+    return makeRowVector({makeFlatVector<int32_t>({value})});
+  }
+};
+
+TEST_F(VeloxResultQueueTest, backPressure) {
+  VeloxResultQueue queue(2);
+  auto future = ContinueFuture::makeEmpty();
+  ASSERT_EQ(queue.enqueue(makeVector(1), &future), exec::BlockingReason::kNotBlocked);
+  ASSERT_EQ(queue.enqueue(makeVector(2), &future), exec::BlockingReason::kWaitForConsumer);
+  ASSERT_FALSE(future.isReady());
+
+  // Taking a vector resumes the blocked driver.
+  auto vector = queue.dequeue([]() { return false; });
+  ASSERT_EQ(vector->childAt(0)->asFlatVector<int32_t>()->valueAt(0), 1);
+  ASSERT_TRUE(future.isReady());
+
+  // Drivers report their end with a null vector, the queue is drained before ending.
+  auto unused = ContinueFuture::makeEmpty();
+  ASSERT_EQ(queue.enqueue(nullptr, &unused), exec::BlockingReason::kNotBlocked);
+  vector = queue.dequeue([]() { return true; });
+  ASSERT_EQ(vector->childAt(0)->asFlatVector<int32_t>()->valueAt(0), 2);
+  ASSERT_EQ(queue.dequeue([]() { return true; }), nullptr);
+}
+
+TEST_F(VeloxResultQueueTest, close) {
+  VeloxResultQueue queue(1);
+  auto future = ContinueFuture::makeEmpty();
+  ASSERT_EQ(queue.enqueue(makeVector(1), &future), exec::BlockingReason::kWaitForConsumer);
+  queue.close();
+  ASSERT_TRUE(future.isReady());
+  ASSERT_EQ(queue.dequeue([]() { return false; }), nullptr);
+  ASSERT_EQ(queue.enqueue(makeVector(2), &future), exec::BlockingReason::kNotBlocked);
+}
+
+} // namespace gluten
@@ -46,13 +46,16 @@ class VeloxRowToColumnarTest : public ::testing::Test, public test::VectorTestBa
   }
 
   void testRecordBatchEqual(std::shared_ptr<arrow::RecordBatch> inputBatch) {
-    auto row = recordBatch2VeloxRowVector(*inputBatch);
+    testRowVectorEqual(recordBatch2VeloxRowVector(*inputBatch));
+  }
+
+  void testRowVectorEqual(RowVectorPtr row) {
     auto columnarToRowConverter = std::make_shared<VeloxColumnarToRowConverter>(arrowPool_, veloxPool_);
 
     auto columnarBatch = std::make_shared<VeloxColumnarBatch>(row);
     GLUTEN_THROW_NOT_OK(columnarToRowConverter->write(columnarBatch));
 
-    int64_t numRows = inputBatch->num_rows();
+    int64_t numRows = row->size();
 
     uint8_t* address = columnarToRowConverter->getBufferAddress();
     auto lengthVec = columnarToRowConverter->getLengths();
@@ -64,7 +67,7 @@ class VeloxRowToColumnarTest : public ::testing::Test, public test::VectorTestBa
     long* lengthPtr = arr;
 
     ArrowSchema cSchema;
-    GLUTEN_THROW_NOT_OK(arrow::ExportSchema(*inputBatch->schema(), &cSchema));
+    velox::exportToArrow(row, cSchema);
     auto rowToColumnarConverter = std::make_shared<VeloxRowToColumnarConverter>(&cSchema, veloxPool_);
 
     auto cb = rowToColumnarConverter->convert(numRows, lengthPtr, address);
@@ -299,4 +302,20 @@ TEST_F(VeloxRowToColumnarTest, _allTypes_18rows) {
   makeInputBatch(inputData, schema, &inputBatch);
   testRecordBatchEqual(inputBatch);
 }
+
+TEST_F(VeloxRowToColumnarTest, nullsAndVariableLength) {
+  auto row = makeRowVector({
+      makeNullableFlatVector<bool>({true, std::nullopt, false, true}),
+      makeNullableFlatVector<int32_t>({std::nullopt, 1, -2, 3}),
+      makeNullableFlatVector<double>({0.5, 1.5, std::nullopt, -2.5}),
+      makeNullableFlatVector<std::string>(
+          {"short", std::nullopt, "a string longer than the inline size", "another string over 12 bytes"}),
+      makeNullableFlatVector<Date>({Date(0), Date(-1), std::nullopt, Date(18000)}),
+      makeNullableFlatVector<Timestamp>({Timestamp(1, 1000), std::nullopt, Timestamp(-1, 999'000), Timestamp(0, 0)}),
+      makeNullableFlatVector<int128_t>(
+          {std::nullopt, -1, static_cast<int128_t>(1) << 100, -(static_cast<int128_t>(1) << 70)},
+          DECIMAL(38, 2)),
+  });
+  testRowVectorEqual(row);
+}
 } // namespace gluten
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shuffle/VeloxShuffleReader.h"
+#include "compute/ArrowTypeUtils.h"
+#include "memory/VeloxColumnarBatch.h"
+#include "shuffle/LocalPartitionWriter.h"
+#include "shuffle/VeloxShuffleWriter.h"
+#include "utils/TestUtils.h"
+#include "velox/vector/tests/utils/VectorTestBase.h"
+
+#include <arrow/io/api.h>
+#include <arrow/util/io_util.h>
+#include <gtest/gtest.h>
+
+using namespace facebook;
+using namespace facebook::velox;
+
+namespace gluten {
+
+class VeloxShuffleReaderTest : public ::testing::Test, public velox::test::VectorTestBase {
+ protected:
+  void SetUp() override {
+    ARROW_ASSIGN_OR_THROW(tmpDir_, arrow::internal::TemporaryDir::Make("columnar-shuffle-test"))
+    setenv("NATIVESQL_SPARK_LOCAL_DIRS", tmpDir_->path().ToString().c_str(), 1);
+
+    inputVector1_ = makeRowVector({
+        makeNullableFlatVector<int32_t>({1, 2, 3, 4, std::nullopt, 5, 6, 7, 8, std::nullopt}),
+        makeFlatVector<velox::StringView>(
+            {"alice0", "bob1", "alice2", "bob3", "Alice4", "Bob5", "AlicE6", "boB7", "ALICE8", "BOB9"}),
+        makeNullableFlatVector<velox::StringView>(
+            {"alice", "bob", std::nullopt, std::nullopt, "Alice", "Bob", std::nullopt, "alicE", std::nullopt, "boB"}),
+    });
+    inputVector2_ = makeRowVector({
+        makeNullableFlatVector<int32_t>({100, std::nullopt}),
+        makeFlatVector<velox::StringView>({"bob", "alicealicealicealicealicealicealicealicealicealice"}),
+        makeNullableFlatVector<velox::StringView>({std::nullopt, std::nullopt}),
+    });
+  }
+
+  // Splits the vectors round-robin into 2 partitions, returns the data file.
+  std::string writeRoundRobin(const std::vector<RowVectorPtr>& vectors) {
+    auto options = ShuffleWriterOptions::defaults();
+    options.buffer_size = 4;
+    options.partitioning_name = "rr";
+    options.prefer_evict = false;
+    auto partitionWriterCreator = std::make_shared<LocalPartitionWriterCreator>(false);
+    std::shared_ptr<VeloxShuffleWriter> shuffleWriter;
+    ARROW_ASSIGN_OR_THROW(shuffleWriter, VeloxShuffleWriter::create(2, partitionWriterCreator, options));
+    for (const auto& vector : vectors) {
+      GLUTEN_THROW_NOT_OK(shuffleWriter->split(std::make_shared<VeloxColumnarBatch>(vector)));
+    }
+    GLUTEN_THROW_NOT_OK(shuffleWriter->stop());
+    return shuffleWriter->dataFile();
+  }
+
+  RowVectorPtr takeRows(const RowVectorPtr& source, const std::vector<int32_t>& idxs) const {
+    RowVectorPtr copy = RowVector::createEmpty(source->type(), source->pool());
+    for (int32_t idx : idxs) {
+      copy->append(source->slice(idx, 1).get());
+    }
+    return copy;
+  }
+
+  std::shared_ptr<arrow::internal::TemporaryDir> tmpDir_;
+  RowVectorPtr inputVector1_;
+  RowVectorPtr inputVector2_;
+};
+
+TEST_F(VeloxShuffleReaderTest, coalesceBatches) {
+  auto dataFile = writeRoundRobin({inputVector1_, inputVector2_, inputVector1_});
+
+  // Read back the first partition, its blocks are concatenated into one batch.
+  auto options = ReaderOptions::defaults();
+  options.coalesce_batch_size = 100;
+  GLUTEN_ASSIGN_OR_THROW(auto in, arrow::io::ReadableFile::Open(dataFile));
+  VeloxShuffleReader reader(in, toArrowSchema(inputVector1_->type()), options, defaultArrowMemoryPool(), pool_);
+
+  auto expected = takeRows(inputVector1_, {0, 2, 4, 6, 8});
+  expected->append(takeRows(inputVector2_, {0}).get());
+  expected->append(takeRows(inputVector1_, {0, 2, 4, 6, 8}).get());
+
+  GLUTEN_ASSIGN_OR_THROW(auto cb, reader.next());
+  ASSERT_NE(cb, nullptr);
+  velox::test::assertEqualVectors(expected, std::dynamic_pointer_cast<VeloxColumnarBatch>(cb)->getRowVector());
+  GLUTEN_ASSIGN_OR_THROW(cb, reader.next());
+  ASSERT_EQ(cb, nullptr);
+  ASSERT_GT(reader.getCoalesceTime(), 0);
+}
+
+TEST_F(VeloxShuffleReaderTest, coalesceBatchMaxBytes) {
+  auto dataFile = writeRoundRobin({inputVector1_, inputVector2_, inputVector1_});
+
+  // A byte limit smaller than any block leaves the blocks as they are.
+  auto options = ReaderOptions::defaults();
+  options.coalesce_batch_size = 100;
+  options.coalesce_batch_max_bytes = 1;
+  GLUTEN_ASSIGN_OR_THROW(auto in, arrow::io::ReadableFile::Open(dataFile));
+  VeloxShuffleReader reader(in, toArrowSchema(inputVector1_->type()), options, defaultArrowMemoryPool(), pool_);
+
+  std::vector<RowVectorPtr> expected = {
+      takeRows(inputVector1_, {0, 2, 4, 6, 8}), takeRows(inputVector2_, {0}), takeRows(inputVector1_, {0, 2, 4, 6, 8})};
+  for (const auto& vector : expected) {
+    GLUTEN_ASSIGN_OR_THROW(auto cb, reader.next());
+    ASSERT_NE(cb, nullptr);
+    velox::test::assertEqualVectors(vector, std::dynamic_pointer_cast<VeloxColumnarBatch>(cb)->getRowVector());
+  }
+  GLUTEN_ASSIGN_OR_THROW(auto cb, reader.next());
+  ASSERT_EQ(cb, nullptr);
+}
+
+} // namespace gluten
@@ -272,6 +272,21 @@ TEST_P(VeloxShuffleWriterTest, singlePartCompress) {
   testShuffleWrite(*shuffleWriter, {inputVector1_, inputVector1_});
 }
 
+TEST_P(VeloxShuffleWriterTest, singlePartCompressZstd) {
+  shuffleWriterOptions_.buffer_size = 10;
+  shuffleWriterOptions_.partitioning_name = "single";
+  shuffleWriterOptions_.compression_type = arrow::Compression::ZSTD;
+  shuffleWriterOptions_.compression_level = 3;
+  shuffleWriterOptions_.batch_compress_threshold = 1;
+  // Small buffers don't compress, they are written uncompressed within the compressed payload.
+  shuffleWriterOptions_.compression_min_savings = 0.5;
+
+  GLUTEN_ASSIGN_OR_THROW(
+      auto shuffleWriter, VeloxShuffleWriter::create(1, partitionWriterCreator_, shuffleWriterOptions_))
+
+  testShuffleWrite(*shuffleWriter, {inputVector1_, inputVector1_, inputVector2_});
+}
+
 TEST_P(VeloxShuffleWriterTest, singlePartNullVector) {
   shuffleWriterOptions_.buffer_size = 10;
   shuffleWriterOptions_.partitioning_name = "single";
@@ -439,6 +454,44 @@ TEST_P(VeloxShuffleWriterTest, hashPart1VectorComplexType) {
   testShuffleWriteMultiBlocks(*shuffleWriter_, {vector}, 2, dataVector->type(), {{firstBlock}, {secondBlock}});
 }
 
+TEST_P(VeloxShuffleWriterTest, hashPartNestedComplexType) {
+  shuffleWriterOptions_.buffer_size = 4;
+  shuffleWriterOptions_.partitioning_name = "hash";
+
+  ARROW_ASSIGN_OR_THROW(shuffleWriter_, VeloxShuffleWriter::create(2, partitionWriterCreator_, shuffleWriterOptions_))
+  std::vector<VectorPtr> children = {
+      // Arrays of arrays, with empty and null rows at both levels.
+      makeArrayVector(
+          {0, 2, 2, 3, 5, 5},
+          makeNullableArrayVector<int64_t>(
+              std::vector<std::vector<std::optional<int64_t>>>{{1, 2}, {std::nullopt}, {}, {3}, {4, 5, 6}, {7}}),
+          {2}),
+      // Maps of rows, a null map still covering an entry.
+      makeMapVector(
+          {0, 1, 1, 3, 3, 4},
+          makeFlatVector<int32_t>({1, 2, 3, 4, 5}),
+          makeRowVector({
+              makeFlatVector<int64_t>({10, 20, 30, 40, 50}),
+              makeNullableFlatVector<StringView>({"a", std::nullopt, "c", "10 I'm not inline string", "e"}),
+          }),
+          {4}),
+      makeRowVector({makeFlatVector<bool>(6, [](vector_size_t row) { return row % 3 == 0; })}, nullEvery(3)),
+  };
+  auto dataVector = makeRowVector(children);
+  children.insert(children.begin(), makeFlatVector<int32_t>({1, 2, 1, 2, 1, 2}));
+  auto vector = makeRowVector(children);
+
+  auto firstBlock = takeRows(dataVector, {1, 3, 5});
+  auto secondBlock = takeRows(dataVector, {0, 2, 4});
+
+  testShuffleWriteMultiBlocks(
+      *shuffleWriter_,
+      {vector, vector},
+      2,
+      dataVector->type(),
+      {{firstBlock, firstBlock}, {secondBlock, secondBlock}});
+}
+
 TEST_P(VeloxShuffleWriterTest, hashPart3Vectors) {
   shuffleWriterOptions_.buffer_size = 4;
   shuffleWriterOptions_.partitioning_name = "hash";
@@ -480,6 +533,64 @@ TEST_P(VeloxShuffleWriterTest, roundRobin) {
       {{block1Pid1, block2Pid1, block1Pid1}, {block1Pid2, block2Pid2, block1Pid2}});
 }
 
+TEST_P(VeloxShuffleWriterTest, roundRobinSortBased) {
+  int32_t numPartitions = 2;
+  shuffleWriterOptions_.buffer_size = 11;
+  shuffleWriterOptions_.partitioning_name = "rr";
+  shuffleWriterOptions_.sort_based = true;
+  ARROW_ASSIGN_OR_THROW(
+      shuffleWriter_, VeloxShuffleWriter::create(numPartitions, partitionWriterCreator_, shuffleWriterOptions_));
+
+  // All input batches are buffered and sorted, so each partition holds one batch.
+  auto blockPid1 = takeRows(inputVector1_, {0, 2, 4, 6, 8});
+  blockPid1->append(takeRows(inputVector2_, {0}).get());
+  blockPid1->append(takeRows(inputVector1_, {0, 2, 4, 6, 8}).get());
+
+  auto blockPid2 = takeRows(inputVector1_, {1, 3, 5, 7, 9});
+  blockPid2->append(takeRows(inputVector2_, {1}).get());
+  blockPid2->append(takeRows(inputVector1_, {1, 3, 5, 7, 9}).get());
+
+  testShuffleWriteMultiBlocks(
+      *shuffleWriter_,
+      {inputVector1_, inputVector2_, inputVector1_},
+      2,
+      inputVector1_->type(),
+      {{blockPid1}, {blockPid2}});
+}
+
+TEST_P(VeloxShuffleWriterTest, roundRobinAsyncSpill) {
+  int32_t numPartitions = 2;
+  shuffleWriterOptions_.buffer_size = 4;
+  shuffleWriterOptions_.partitioning_name = "rr";
+  shuffleWriterOptions_.buffered_write = true;
+  shuffleWriterOptions_.async_spill = true;
+  ARROW_ASSIGN_OR_THROW(
+      shuffleWriter_, VeloxShuffleWriter::create(numPartitions, partitionWriterCreator_, shuffleWriterOptions_));
+
+  // Spill after every input, the spill is written while the next input is split.
+  for (auto& vector : {inputVector1_, inputVector2_, inputVector1_}) {
+    splitRowVector(*shuffleWriter_, vector);
+    if (shuffleWriter_->totalCachedPayloadSize() > 0) {
+      int64_t evicted = 0;
+      ASSERT_NOT_OK(shuffleWriter_->evictFixedSize(shuffleWriter_->totalCachedPayloadSize(), &evicted));
+      ASSERT_GT(evicted, 0);
+    }
+  }
+
+  auto block1Pid1 = takeRows(inputVector1_, {0, 2, 4, 6, 8});
+  auto block2Pid1 = takeRows(inputVector2_, {0});
+
+  auto block1Pid2 = takeRows(inputVector1_, {1, 3, 5, 7, 9});
+  auto block2Pid2 = takeRows(inputVector2_, {1});
+
+  testShuffleWriteMultiBlocks(
+      *shuffleWriter_,
+      {},
+      2,
+      inputVector1_->type(),
+      {{block1Pid1, block2Pid1, block1Pid1}, {block1Pid2, block2Pid2, block1Pid2}});
+}
+
 TEST_P(VeloxShuffleWriterTest, rangePartition) {
   int32_t numPartitions = 2;
   shuffleWriterOptions_.buffer_size = 4;
@@ -71,7 +71,9 @@ private class CelebornColumnarBatchSerializerInstance(schema: StructType,
         ArrowAbiUtil.exportSchema(allocator, arrowSchema, cSchema)
         val handle = ShuffleReaderJniWrapper.INSTANCE.make(
           jniByteInputStream, cSchema.memoryAddress(),
-          NativeMemoryAllocators.getDefault().contextInstance.getNativeInstanceId)
+          NativeMemoryAllocators.getDefault().contextInstance.getNativeInstanceId,
+          0,
+          0L)
         // Close shuffle reader instance as lately as the end of task processing,
         // since the native reader could hold a reference to memory pool that
         // was used to create all buffers read from shuffle reader. The pool
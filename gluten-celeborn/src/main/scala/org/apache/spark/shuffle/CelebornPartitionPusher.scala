@@ -24,6 +24,7 @@ import org.apache.spark._
 import org.apache.spark.internal.Logging
 
 import java.io.IOException
+import java.nio.ByteBuffer
 
 class CelebornPartitionPusher(
     val appId: String,
@@ -36,10 +37,36 @@ class CelebornPartitionPusher(
     val celebornConf: CelebornConf)
   extends Logging {
 
+  // Reused for every push, Celeborn compresses the data into its own buffers before returning.
+  private var pushBuffer = new Array[Byte](0)
+
+  /**
+   * Pushes the data of the given partitions, laid out back to back in the native memory viewed by
+   * `data`.
+   */
   @throws[IOException]
-  def pushPartitionData(partitionId: Int, buffer: Array[Byte]): Int = {
-    logDebug(s"Push record, size ${buffer.length}.")
-    if (buffer.length > celebornConf.pushBufferMaxSize) {
+  def pushPartitionsData(partitionIds: Array[Int], lengths: Array[Int], data: ByteBuffer): Int = {
+    val size = data.remaining()
+    if (pushBuffer.length < size) {
+      pushBuffer = new Array[Byte](size)
+    }
+    data.get(pushBuffer, 0, size)
+    var offset = 0
+    var pushed = 0
+    for (i <- partitionIds.indices) {
+      pushed += pushPartitionData(partitionIds(i), pushBuffer, offset, lengths(i))
+      offset += lengths(i)
+    }
+    pushed
+  }
+
+  private def pushPartitionData(
+      partitionId: Int,
+      buffer: Array[Byte],
+      offset: Int,
+      length: Int): Int = {
+    logDebug(s"Push record, size $length.")
+    if (length > celebornConf.pushBufferMaxSize) {
       client.pushData(
         appId,
         shuffleId,
@@ -47,8 +74,8 @@ class CelebornPartitionPusher(
         context.attemptNumber,
         partitionId,
         buffer,
-        0,
-        buffer.length,
+        offset,
+        length,
         numMappers,
         numPartitions)
     } else {
@@ -59,8 +86,8 @@ class CelebornPartitionPusher(
         context.attemptNumber,
         partitionId,
         buffer,
-        0,
-        buffer.length,
+        offset,
+        length,
         numMappers,
         numPartitions)
     }
@@ -27,6 +27,9 @@ public class SplitResult {
   private final long totalCompressTime; // overlaps with totalEvictTime and totalWriteTime
   private final long totalBytesWritten;
   private final long totalBytesEvicted;
+  private final long numSpills;
+  private final long bufferPoolHits;
+  private final long bufferPoolMisses;
   private final long[] partitionLengths;
   private final long[] rawPartitionLengths;
 
@@ -39,12 +42,41 @@ public class SplitResult {
       long totalBytesEvicted,
       long[] partitionLengths,
       long[] rawPartitionLengths) {
+    this(
+        totalComputePidTime,
+        totalWriteTime,
+        totalEvictTime,
+        totalCompressTime,
+        totalBytesWritten,
+        totalBytesEvicted,
+        0,
+        0,
+        0,
+        partitionLengths,
+        rawPartitionLengths);
+  }
+
+  public SplitResult(
+      long totalComputePidTime,
+      long totalWriteTime,
+      long totalEvictTime,
+      long totalCompressTime,
+      long totalBytesWritten,
+      long totalBytesEvicted,
+      long numSpills,
+      long bufferPoolHits,
+      long bufferPoolMisses,
+      long[] partitionLengths,
+      long[] rawPartitionLengths) {
     this.totalComputePidTime = totalComputePidTime;
     this.totalWriteTime = totalWriteTime;
     this.totalEvictTime = totalEvictTime;
     this.totalCompressTime = totalCompressTime;
     this.totalBytesWritten = totalBytesWritten;
     this.totalBytesEvicted = totalBytesEvicted;
+    this.numSpills = numSpills;
+    this.bufferPoolHits = bufferPoolHits;
+    this.bufferPoolMisses = bufferPoolMisses;
     this.partitionLengths = partitionLengths;
     this.rawPartitionLengths = rawPartitionLengths;
   }
@@ -77,6 +109,18 @@ public class SplitResult {
     return totalBytesEvicted;
   }
 
+  public long getNumSpills() {
+    return numSpills;
+  }
+
+  public long getBufferPoolHits() {
+    return bufferPoolHits;
+  }
+
+  public long getBufferPoolMisses() {
+    return bufferPoolMisses;
+  }
+
   public long[] getPartitionLengths() {
     return partitionLengths;
   }
@@ -29,6 +29,10 @@ trait MetricsApi extends Serializable {
     Map(
       "pipelineTime" -> SQLMetrics.createTimingMetric(sparkContext, "duration"))
 
+  /** Updates the metrics of the whole stage with the native metrics of one of its tasks. */
+  def genWholeStageTransformerMetricsUpdater(metrics: Map[String, SQLMetric]): IMetrics => Unit =
+    _ => {}
+
   def metricsUpdatingFunction(
       child: SparkPlan,
       relMap: java.util.HashMap[java.lang.Long, java.util.ArrayList[java.lang.Long]],
@@ -22,7 +22,7 @@ import io.glutenproject.GlutenConfig
 import io.glutenproject.backendsapi.BackendsApiManager
 import io.glutenproject.expression._
 import io.glutenproject.extension.GlutenPlan
-import io.glutenproject.metrics.{MetricsUpdater, NoopMetricsUpdater}
+import io.glutenproject.metrics.{IMetrics, MetricsUpdater, NoopMetricsUpdater}
 import io.glutenproject.substrait.SubstraitContext
 import io.glutenproject.substrait.plan.{PlanBuilder, PlanNode}
 import io.glutenproject.substrait.rel.RelNode
@@ -257,12 +257,7 @@ case class WholeStageTransformer(child: SparkPlan)(val transformStageId: Int)
         genFirstNewRDDsForBroadcast(inputRDDs, partitionLength),
         pipelineTime,
         leafMetricsUpdater().updateInputMetrics,
-        BackendsApiManager.getMetricsApiInstance.metricsUpdatingFunction(
-          child,
-          wsCxt.substraitContext.registeredRelMap,
-          wsCxt.substraitContext.registeredJoinParams,
-          wsCxt.substraitContext.registeredAggregationParams
-        )
+        metricsUpdatingFunction(wsCxt.substraitContext)
       )
     } else {
 
@@ -289,16 +284,25 @@ case class WholeStageTransformer(child: SparkPlan)(val transformStageId: Int)
         resCtx,
         pipelineTime,
         buildRelationBatchHolder,
-        BackendsApiManager.getMetricsApiInstance.metricsUpdatingFunction(
-          child,
-          resCtx.substraitContext.registeredRelMap,
-          resCtx.substraitContext.registeredJoinParams,
-          resCtx.substraitContext.registeredAggregationParams
-        )
+        metricsUpdatingFunction(resCtx.substraitContext)
       )
     }
   }
 
+  private def metricsUpdatingFunction(substraitContext: SubstraitContext): IMetrics => Unit = {
+    val updateStageMetrics =
+      BackendsApiManager.getMetricsApiInstance.genWholeStageTransformerMetricsUpdater(metrics)
+    val updateOperatorMetrics = BackendsApiManager.getMetricsApiInstance.metricsUpdatingFunction(
+      child,
+      substraitContext.registeredRelMap,
+      substraitContext.registeredJoinParams,
+      substraitContext.registeredAggregationParams)
+    nativeMetrics => {
+      updateStageMetrics(nativeMetrics)
+      updateOperatorMetrics(nativeMetrics)
+    }
+  }
+
   override def getStreamedLeafPlan: SparkPlan = {
     child.asInstanceOf[TransformSupport].getStreamedLeafPlan
   }
@@ -24,6 +24,8 @@ package io.glutenproject.memory.alloc;
 public class NativeMemoryAllocator {
   enum Type {
     DEFAULT,
+    // Per-task arenas carved from huge page aligned chunks
+    ARENA,
   }
 
   private final long nativeInstanceId;
@@ -59,6 +61,14 @@ public class NativeMemoryAllocator {
     return bytesAllocated(this.nativeInstanceId);
   }
 
+  /**
+   * Number of JNI calls made to reserve or unreserve memory from the listener. Allocations are
+   * reserved in blocks, a call is only made when the number of reserved blocks changes.
+   */
+  public long getReservationCalls() {
+    return reservationCalls(this.nativeInstanceId);
+  }
+
   public void close() {
     releaseAllocator(this.nativeInstanceId);
   }
@@ -71,4 +81,6 @@ public class NativeMemoryAllocator {
   private static native void releaseAllocator(long allocatorId);
 
   private static native long bytesAllocated(long allocatorId);
+
+  private static native long reservationCalls(long allocatorId);
 }
@@ -52,6 +52,10 @@ public class NativeMemoryAllocatorManagerImpl implements NativeMemoryAllocatorMa
 
   @Override
   public void release() throws Exception {
+    if (LOGGER.isDebugEnabled()) {
+      LOGGER.debug(String.format("Native allocator made %d reservation calls",
+          managed.getReservationCalls()));
+    }
     if (managed.getBytesAllocated() != 0L) {
       softClose();
     } else {
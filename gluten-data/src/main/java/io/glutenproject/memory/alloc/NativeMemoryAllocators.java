@@ -17,6 +17,7 @@
 
 package io.glutenproject.memory.alloc;
 
+import io.glutenproject.GlutenConfig;
 import io.glutenproject.memory.GlutenMemoryConsumer;
 import io.glutenproject.memory.Spiller;
 import io.glutenproject.memory.TaskMemoryMetrics;
@@ -50,7 +51,8 @@ public final class NativeMemoryAllocators {
   }
 
   public static NativeMemoryAllocators getDefault() {
-    return forType(NativeMemoryAllocator.Type.DEFAULT);
+    return forType(
+        NativeMemoryAllocator.Type.valueOf(GlutenConfig.getConf().memoryAllocatorType()));
   }
 
   private static NativeMemoryAllocators forType(NativeMemoryAllocator.Type type) {
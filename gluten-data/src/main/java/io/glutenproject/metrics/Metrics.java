@@ -43,6 +43,7 @@ public class Metrics implements IMetrics {
   public long[] processedSplits;
   public long[] skippedStrides;
   public long[] processedStrides;
+  public long[] ioWaitTime;
   public SingleMetric singleMetric = new SingleMetric();
 
   /**
@@ -74,7 +75,13 @@ public class Metrics implements IMetrics {
       long[] skippedSplits,
       long[] processedSplits,
       long[] skippedStrides,
-      long[] processedStrides) {
+      long[] processedStrides,
+      long[] ioWaitTime,
+      long outputBatches,
+      long outputBatchRows,
+      long outputBatchBytes,
+      long coalescedBatches,
+      long splitBatches) {
     this.inputRows = inputRows;
     this.inputVectors = inputVectors;
     this.inputBytes = inputBytes;
@@ -101,6 +108,12 @@ public class Metrics implements IMetrics {
     this.processedSplits = processedSplits;
     this.skippedStrides = skippedStrides;
     this.processedStrides = processedStrides;
+    this.ioWaitTime = ioWaitTime;
+    this.singleMetric.outputBatches = outputBatches;
+    this.singleMetric.outputBatchRows = outputBatchRows;
+    this.singleMetric.outputBatchBytes = outputBatchBytes;
+    this.singleMetric.coalescedBatches = coalescedBatches;
+    this.singleMetric.splitBatches = splitBatches;
   }
 
   public OperatorMetrics getOperatorMetrics(int index) {
@@ -133,7 +146,8 @@ public class Metrics implements IMetrics {
         skippedSplits[index],
         processedSplits[index],
         skippedStrides[index],
-        processedStrides[index]);
+        processedStrides[index],
+        ioWaitTime[index]);
   }
 
   public SingleMetric getSingleMetrics() {
@@ -142,5 +156,10 @@ public class Metrics implements IMetrics {
 
   public static class SingleMetric {
     public long veloxToArrow;
+    public long outputBatches;
+    public long outputBatchRows;
+    public long outputBatchBytes;
+    public long coalescedBatches;
+    public long splitBatches;
   }
 }
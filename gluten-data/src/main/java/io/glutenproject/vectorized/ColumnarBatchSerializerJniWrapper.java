@@ -26,7 +26,8 @@ public class ColumnarBatchSerializerJniWrapper extends JniInitialized {
 
   private ColumnarBatchSerializerJniWrapper()  {}
 
-  public native ColumnarBatchSerializeResult serialize(long[] handles, long allocId);
+  /** Serializes the batches into one buffer, compressed with codec unless it is null. */
+  public native ColumnarBatchSerializeResult serialize(long[] handles, long allocId, String codec);
 
   // Return the native ColumnarBatchSerializer handle
   public native long init(long cSchema, long allocId);
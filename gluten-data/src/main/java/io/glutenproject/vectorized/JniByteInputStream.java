@@ -36,4 +36,26 @@ public interface JniByteInputStream {
    * Close and reclaim the resources.
    */
   void close();
+
+  /**
+   * Size of the remaining data if it can be exposed as off-heap memory via
+   * {@link #directAddress()}; 0 otherwise.
+   */
+  default long directSize() {
+    return 0L;
+  }
+
+  /**
+   * Address of the remaining data in off-heap memory; 0 if not available. The memory stays
+   * valid after {@link #close()} until {@link #releaseDirect()} is called.
+   */
+  default long directAddress() {
+    return 0L;
+  }
+
+  /**
+   * Release the memory returned by {@link #directAddress()}. May be called from any thread.
+   */
+  default void releaseDirect() {
+  }
 }
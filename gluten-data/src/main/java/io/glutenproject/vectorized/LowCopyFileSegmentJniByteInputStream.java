@@ -26,6 +26,7 @@ import java.io.IOException;
 import java.io.InputStream;
 import java.lang.reflect.Field;
 import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
 import java.nio.channels.FileChannel;
 
 /**
@@ -53,6 +54,7 @@ public class LowCopyFileSegmentJniByteInputStream implements JniByteInputStream
 
   private long bytesRead = 0L;
   private long left;
+  private MappedByteBuffer mapped;
 
   public LowCopyFileSegmentJniByteInputStream(InputStream in) {
     this.in = in; // to prevent underlying netty buffer from being collected by GC
@@ -110,6 +112,33 @@ public class LowCopyFileSegmentJniByteInputStream implements JniByteInputStream
     }
   }
 
+  @Override
+  public long directSize() {
+    if (left > Integer.MAX_VALUE) {
+      return 0L;
+    }
+    return left;
+  }
+
+  @Override
+  public long directAddress() {
+    try {
+      mapped = channel.map(FileChannel.MapMode.READ_ONLY, channel.position(), left);
+    } catch (IOException e) {
+      // Fall back to read().
+      return 0L;
+    }
+    return PlatformDependent.directBufferAddress(mapped);
+  }
+
+  @Override
+  public void releaseDirect() {
+    if (mapped != null) {
+      PlatformDependent.freeDirectBuffer(mapped);
+      mapped = null;
+    }
+  }
+
   @Override
   public long tell() {
     return bytesRead;
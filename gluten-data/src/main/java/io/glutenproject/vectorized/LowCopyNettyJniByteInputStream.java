@@ -90,6 +90,29 @@ public class LowCopyNettyJniByteInputStream implements JniByteInputStream {
     }
   }
 
+  @Override
+  public long directSize() {
+    if (!byteBuf.hasMemoryAddress()) {
+      return 0L;
+    }
+    return byteBuf.readableBytes();
+  }
+
+  @Override
+  public long directAddress() {
+    if (!byteBuf.hasMemoryAddress()) {
+      return 0L;
+    }
+    // Retained until native code releases it, the stream may be closed earlier.
+    byteBuf.retain();
+    return byteBuf.memoryAddress() + byteBuf.readerIndex();
+  }
+
+  @Override
+  public void releaseDirect() {
+    byteBuf.release();
+  }
+
   @Override
   public long tell() {
     return readBytesCount;
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.glutenproject.vectorized;
+
+import java.util.Iterator;
+import java.util.NoSuchElementException;
+
+/**
+ * Converts a native batch to rows one chunk of bounded size at a time. All the chunks share the
+ * converter's buffer, the rows of a chunk are only valid until the next chunk is converted.
+ */
+public class NativeColumnarToRowChunkIterator implements Iterator<NativeColumnarToRowInfo> {
+  private final NativeColumnarToRowJniWrapper jniWrapper;
+  private final long batchHandle;
+  private final long instanceId;
+  private final int numRows;
+  private final long memoryThreshold;
+  private int startRow = 0;
+
+  public NativeColumnarToRowChunkIterator(
+      NativeColumnarToRowJniWrapper jniWrapper,
+      long batchHandle,
+      long instanceId,
+      int numRows,
+      long memoryThreshold) {
+    this.jniWrapper = jniWrapper;
+    this.batchHandle = batchHandle;
+    this.instanceId = instanceId;
+    this.numRows = numRows;
+    this.memoryThreshold = memoryThreshold;
+  }
+
+  @Override
+  public boolean hasNext() {
+    return startRow < numRows;
+  }
+
+  @Override
+  public NativeColumnarToRowInfo next() {
+    if (!hasNext()) {
+      throw new NoSuchElementException();
+    }
+    NativeColumnarToRowInfo info =
+        jniWrapper.nativeColumnarToRowConvert(batchHandle, instanceId, startRow, memoryThreshold);
+    startRow += info.lengths.length;
+    return info;
+  }
+}
@@ -34,6 +34,14 @@ public class NativeColumnarToRowJniWrapper extends JniInitialized {
       long batchHandle, long instanceId)
       throws RuntimeException;
 
+  /**
+   * Converts the rows of the batch from startRow until the chunk would exceed memoryThreshold
+   * bytes, at least one row. The chunk's rows are valid until the next call on the instance.
+   */
+  public native NativeColumnarToRowInfo nativeColumnarToRowConvert(
+      long batchHandle, long instanceId, int startRow, long memoryThreshold)
+      throws RuntimeException;
+
   public native void nativeClose(long instanceID);
 
 }
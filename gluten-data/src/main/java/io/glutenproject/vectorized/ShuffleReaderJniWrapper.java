@@ -25,7 +25,12 @@ public class ShuffleReaderJniWrapper extends JniInitialized {
   private ShuffleReaderJniWrapper() {
   }
 
-  public native long make(JniByteInputStream jniIn, long cSchema, long allocatorId);
+  public native long make(
+      JniByteInputStream jniIn,
+      long cSchema,
+      long allocatorId,
+      int coalesceBatchSize,
+      long coalesceBatchMaxBytes);
 
   public native long next(long handle);
 
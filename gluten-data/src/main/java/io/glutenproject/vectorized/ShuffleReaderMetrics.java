@@ -19,6 +19,7 @@ package io.glutenproject.vectorized;
 
 public class ShuffleReaderMetrics {
   private long decompressTime;
+  private long coalesceTime;
 
   public void setDecompressTime(long decompressTime) {
     this.decompressTime = decompressTime;
@@ -27,4 +28,12 @@ public class ShuffleReaderMetrics {
   public long getDecompressTime() {
     return decompressTime;
   }
+
+  public void setCoalesceTime(long coalesceTime) {
+    this.coalesceTime = coalesceTime;
+  }
+
+  public long getCoalesceTime() {
+    return coalesceTime;
+  }
 }
@@ -37,16 +37,23 @@ public class ShuffleWriterJniWrapper extends JniInitialized {
    * @param localDirs configured local directories where Spark can write files
    * @param preferEvict
    * @param memoryPoolId
+   * @param sortBased whether rows are buffered and sorted by partition id instead of split
+   * @param sortBufferMaxSize size of the input batches buffered before sorting them
+   * @param asyncSpill whether spilled data is written on a background thread
+   * @param asyncSpillMaxInflightBytes size of the spilled data waiting to be written
+   * @param evictionPolicy which memory is released first when the writer is asked to free some
    * @return native shuffle writer instance id if created successfully.
    */
   public long make(NativePartitioning part, long offheapPerTask, int bufferSize, String codec,
                    int batchCompressThreshold, String dataFile, int subDirsPerLocalDir,
                    String localDirs, boolean preferEvict, long memoryPoolId, boolean writeSchema,
-                   long handle, long taskAttemptId) {
+                   long handle, long taskAttemptId, boolean sortBased, long sortBufferMaxSize,
+                   boolean asyncSpill, long asyncSpillMaxInflightBytes, String evictionPolicy) {
       return nativeMake(part.getShortName(), part.getNumPartitions(),
           offheapPerTask, bufferSize, codec, batchCompressThreshold, dataFile,
           subDirsPerLocalDir, localDirs, preferEvict, memoryPoolId,
-          writeSchema, handle, taskAttemptId, 0, null, "local");
+          writeSchema, handle, taskAttemptId, 0, null, "local", sortBased, sortBufferMaxSize,
+          asyncSpill, asyncSpillMaxInflightBytes, evictionPolicy);
   }
 
   /**
@@ -66,7 +73,8 @@ public class ShuffleWriterJniWrapper extends JniInitialized {
       return nativeMake(part.getShortName(), part.getNumPartitions(),
           offheapPerTask, bufferSize, codec, batchCompressThreshold, null,
           0, null, true, memoryPoolId,
-          false, handle, taskAttemptId, pushBufferMaxSize, pusher, partitionWriterType);
+          false, handle, taskAttemptId, pushBufferMaxSize, pusher, partitionWriterType, false, 0,
+          false, 0, null);
   }
 
   public native long nativeMake(String shortName, int numPartitions,
@@ -75,7 +83,10 @@ public class ShuffleWriterJniWrapper extends JniInitialized {
                                 int subDirsPerLocalDir, String localDirs, boolean preferEvict,
                                 long memoryPoolId, boolean writeSchema,
                                 long handle, long taskAttemptId, int pushBufferMaxSize,
-                                Object pusher, String partitionWriterType);
+                                Object pusher, String partitionWriterType,
+                                boolean sortBased, long sortBufferMaxSize,
+                                boolean asyncSpill, long asyncSpillMaxInflightBytes,
+                                String evictionPolicy);
 
   /**
    * Evict partition data.
@@ -47,6 +47,7 @@ class BatchScanMetricsUpdater(val metrics: Map[String, SQLMetric]) extends Metri
       metrics("processedSplits") += operatorMetrics.processedSplits
       metrics("skippedStrides") += operatorMetrics.skippedStrides
       metrics("processedStrides") += operatorMetrics.processedStrides
+      metrics("ioWaitTime") += operatorMetrics.ioWaitTime
     }
   }
 }
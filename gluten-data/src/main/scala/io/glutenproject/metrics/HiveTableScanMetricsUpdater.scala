@@ -39,6 +39,7 @@ class HiveTableScanMetricsUpdater (@transient val metrics: Map[String, SQLMetric
   val processedSplits: SQLMetric = metrics("processedSplits")
   val skippedStrides: SQLMetric = metrics("skippedStrides")
   val processedStrides: SQLMetric = metrics("processedStrides")
+  val ioWaitTime: SQLMetric = metrics("ioWaitTime")
 
   override def updateInputMetrics(inputMetrics: InputMetricsWrapper): Unit = {
     inputMetrics.bridgeIncBytesRead(rawInputBytes.value)
@@ -64,6 +65,7 @@ class HiveTableScanMetricsUpdater (@transient val metrics: Map[String, SQLMetric
       processedSplits += operatorMetrics.processedSplits
       skippedStrides += operatorMetrics.skippedStrides
       processedStrides += operatorMetrics.processedStrides
+      ioWaitTime += operatorMetrics.ioWaitTime
     }
   }
 }
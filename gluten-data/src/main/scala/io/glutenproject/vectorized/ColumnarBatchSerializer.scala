@@ -47,13 +47,23 @@ class ColumnarBatchSerializer(
     schema: StructType,
     readBatchNumRows: SQLMetric,
     numOutputRows: SQLMetric,
-    decompressTime: SQLMetric)
+    decompressTime: SQLMetric,
+    coalesceTime: SQLMetric,
+    coalesceBatchSize: Int,
+    coalesceBatchMaxBytes: Long)
   extends Serializer
   with Serializable {
 
   /** Creates a new [[SerializerInstance]]. */
   override def newInstance(): SerializerInstance = {
-    new ColumnarBatchSerializerInstance(schema, readBatchNumRows, numOutputRows, decompressTime)
+    new ColumnarBatchSerializerInstance(
+      schema,
+      readBatchNumRows,
+      numOutputRows,
+      decompressTime,
+      coalesceTime,
+      coalesceBatchSize,
+      coalesceBatchMaxBytes)
   }
 }
 
@@ -61,7 +71,10 @@ private class ColumnarBatchSerializerInstance(
     schema: StructType,
     readBatchNumRows: SQLMetric,
     numOutputRows: SQLMetric,
-    decompressTime: SQLMetric)
+    decompressTime: SQLMetric,
+    coalesceTime: SQLMetric,
+    coalesceBatchSize: Int,
+    coalesceBatchMaxBytes: Long)
   extends SerializerInstance
     with Logging {
 
@@ -83,7 +96,9 @@ private class ColumnarBatchSerializerInstance(
         ArrowAbiUtil.exportSchema(allocator, arrowSchema, cSchema)
         val handle = ShuffleReaderJniWrapper.INSTANCE.make(
           jniByteInputStream, cSchema.memoryAddress(),
-          NativeMemoryAllocators.getDefault().contextInstance.getNativeInstanceId)
+          NativeMemoryAllocators.getDefault().contextInstance.getNativeInstanceId,
+          coalesceBatchSize,
+          coalesceBatchMaxBytes)
         // Close shuffle reader instance as lately as the end of task processing,
         // since the native reader could hold a reference to memory pool that
         // was used to create all buffers read from shuffle reader. The pool
@@ -153,6 +168,7 @@ private class ColumnarBatchSerializerInstance(
           // Collect Metrics
           ShuffleReaderJniWrapper.INSTANCE.populateMetrics(shuffleReaderHandle, readerMetrics)
           decompressTime += readerMetrics.getDecompressTime
+          coalesceTime += readerMetrics.getCoalesceTime
           if (numBatchesTotal > 0) {
             readBatchNumRows.set(numRowsTotal.toDouble / numBatchesTotal)
           }
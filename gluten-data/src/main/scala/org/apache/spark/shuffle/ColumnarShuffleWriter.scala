@@ -69,6 +69,17 @@ class ColumnarShuffleWriter[K, V](shuffleBlockResolver: IndexShuffleBlockResolve
 
   private val writeSchema = GlutenConfig.getConf.columnarShuffleWriteSchema
 
+  private val sortBased = GlutenConfig.getConf.columnarShuffleSortBased
+
+  private val sortBufferMaxSize = GlutenConfig.getConf.columnarShuffleSortBufferMaxSize
+
+  private val asyncSpill = GlutenConfig.getConf.columnarShuffleAsyncSpill
+
+  private val asyncSpillMaxInflightBytes =
+    GlutenConfig.getConf.columnarShuffleAsyncSpillMaxInflightBytes
+
+  private val evictionPolicy = GlutenConfig.getConf.columnarShuffleEvictionPolicy
+
   private val jniWrapper = new ShuffleWriterJniWrapper
 
   private var nativeShuffleWriter: Long = -1L
@@ -141,7 +152,12 @@ class ColumnarShuffleWriter[K, V](shuffleBlockResolver: IndexShuffleBlockResolve
               }).getNativeInstanceId,
             writeSchema,
             handle,
-            taskContext.taskAttemptId())
+            taskContext.taskAttemptId(),
+            sortBased,
+            sortBufferMaxSize,
+            asyncSpill,
+            asyncSpillMaxInflightBytes,
+            evictionPolicy)
         }
         val startTime = System.nanoTime()
         val bytes = jniWrapper.split(nativeShuffleWriter, cb.numRows, handle)
@@ -165,6 +181,9 @@ class ColumnarShuffleWriter[K, V](shuffleBlockResolver: IndexShuffleBlockResolve
     dep.metrics("spillTime").add(splitResult.getTotalSpillTime)
     dep.metrics("compressTime").add(splitResult.getTotalCompressTime)
     dep.metrics("bytesSpilled").add(splitResult.getTotalBytesSpilled)
+    dep.metrics("numSpills").add(splitResult.getNumSpills)
+    dep.metrics("bufferPoolHits").add(splitResult.getBufferPoolHits)
+    dep.metrics("bufferPoolMisses").add(splitResult.getBufferPoolMisses)
     writeMetrics.incBytesWritten(splitResult.getTotalBytesWritten)
     writeMetrics.incWriteTime(splitResult.getTotalWriteTime + splitResult.getTotalSpillTime)
 
@@ -18,10 +18,12 @@
 package org.apache.spark.sql.execution.utils
 
 
+import io.glutenproject.GlutenConfig
 import io.glutenproject.columnarbatch.ColumnarBatches
 import io.glutenproject.memory.alloc.NativeMemoryAllocators
 import io.glutenproject.memory.arrowalloc.ArrowBufferAllocators
-import io.glutenproject.vectorized.{ArrowWritableColumnVector, NativeColumnarToRowInfo, NativeColumnarToRowJniWrapper, NativePartitioning}
+import io.glutenproject.vectorized.{ArrowWritableColumnVector, NativeColumnarToRowChunkIterator,
+  NativeColumnarToRowInfo, NativeColumnarToRowJniWrapper, NativePartitioning}
 
 import org.apache.spark.{Partitioner, RangePartitioner, ShuffleDependency}
 import org.apache.spark.internal.Logging
@@ -45,15 +47,17 @@ object ExecUtil {
 
   def convertColumnarToRow(batch: ColumnarBatch): Iterator[InternalRow] = {
     val jniWrapper = new NativeColumnarToRowJniWrapper()
-    var info: NativeColumnarToRowInfo = null
     val batchHandle = ColumnarBatches.getNativeHandle(batch)
     val instanceId = jniWrapper.nativeColumnarToRowInit(
       batchHandle,
       NativeMemoryAllocators.getDefault().contextInstance().getNativeInstanceId)
-    info = jniWrapper.nativeColumnarToRowWrite(batchHandle, instanceId)
+    val chunks = new NativeColumnarToRowChunkIterator(jniWrapper, batchHandle, instanceId,
+      batch.numRows(), GlutenConfig.getConf.columnarToRowMemoryThreshold)
+    var info: NativeColumnarToRowInfo = null
 
     new Iterator[InternalRow] {
       var rowId = 0
+      var chunkRowId = 0
       val row = new UnsafeRow(batch.numCols())
       var closed = false
 
@@ -75,9 +79,14 @@ object ExecUtil {
 
       override def next: UnsafeRow = {
         if (rowId >= batch.numRows()) throw new NoSuchElementException
-        val (offset, length) = (info.offsets(rowId), info.lengths(rowId))
+        if (info == null || chunkRowId >= info.lengths.length) {
+          info = chunks.next()
+          chunkRowId = 0
+        }
+        val (offset, length) = (info.offsets(chunkRowId), info.lengths(chunkRowId))
         row.pointTo(null, info.memoryAddress + offset, length.toInt)
         rowId += 1
+        chunkRowId += 1
         row
       }
     }
@@ -125,10 +125,23 @@ class GlutenConfig(conf: SQLConf) extends Logging {
 
   def columnarShuffleWriteSchema: Boolean = conf.getConf(COLUMNAR_SHUFFLE_WRITE_SCHEMA_ENABLED)
 
+  def columnarShuffleSortBased: Boolean = conf.getConf(COLUMNAR_SHUFFLE_SORT_BASED_ENABLED)
+
+  def columnarShuffleSortBufferMaxSize: Long = conf.getConf(COLUMNAR_SHUFFLE_SORT_BUFFER_MAX_SIZE)
+
+  def columnarShuffleAsyncSpill: Boolean = conf.getConf(COLUMNAR_SHUFFLE_ASYNC_SPILL_ENABLED)
+
+  def columnarShuffleAsyncSpillMaxInflightBytes: Long =
+    conf.getConf(COLUMNAR_SHUFFLE_ASYNC_SPILL_MAX_INFLIGHT_BYTES)
+
+  def columnarShuffleEvictionPolicy: String = conf.getConf(COLUMNAR_SHUFFLE_EVICTION_POLICY)
+
   def columnarShuffleCodec: Option[String] = conf.getConf(COLUMNAR_SHUFFLE_CODEC)
 
   def columnarShuffleCodecBackend: Option[String] = conf.getConf(COLUMNAR_SHUFFLE_CODEC_BACKEND)
 
+  def columnarBroadcastCodec: Option[String] = conf.getConf(COLUMNAR_BROADCAST_CODEC)
+
   def columnarShuffleEnableQat: Boolean =
     columnarShuffleCodecBackend.contains(GlutenConfig.GLUTEN_QAT_BACKEND_NAME)
 
@@ -138,6 +151,12 @@ class GlutenConfig(conf: SQLConf) extends Logging {
   def columnarShuffleBatchCompressThreshold: Int =
     conf.getConf(COLUMNAR_SHUFFLE_BATCH_COMPRESS_THRESHOLD)
 
+  def columnarShuffleReaderCoalesceBatchSize: Int =
+    conf.getConf(COLUMNAR_SHUFFLE_READER_COALESCE_BATCH_SIZE)
+
+  def columnarShuffleReaderCoalesceMaxBytes: Long =
+    conf.getConf(COLUMNAR_SHUFFLE_READER_COALESCE_MAX_BYTES)
+
   def maxBatchSize: Int = conf.getConf(COLUMNAR_MAX_BATCH_SIZE)
 
   def enableColumnarLimit: Boolean = conf.getConf(COLUMNAR_LIMIT_ENABLED)
@@ -181,6 +200,10 @@ class GlutenConfig(conf: SQLConf) extends Logging {
 
   def taskOffHeapMemorySize: Long = conf.getConf(COLUMNAR_TASK_OFFHEAP_SIZE_IN_BYTES)
 
+  def memoryAllocatorType: String = conf.getConf(COLUMNAR_MEMORY_ALLOCATOR_TYPE)
+
+  def columnarToRowMemoryThreshold: Long = conf.getConf(COLUMNAR_TO_ROW_MEMORY_THRESHOLD)
+
   def enableVeloxCache: Boolean = conf.getConf(COLUMNAR_VELOX_CACHE_ENABLED)
 
   def veloxMemCacheSize: Long = conf.getConf(COLUMNAR_VELOX_MEM_CACHE_SIZE)
@@ -704,6 +727,48 @@ object GlutenConfig {
       .booleanConf
       .createWithDefault(false)
 
+  val COLUMNAR_SHUFFLE_SORT_BASED_ENABLED =
+    buildConf("spark.gluten.sql.columnar.shuffle.sortBased")
+      .internal()
+      .doc(
+        "Whether the shuffle writer buffers input batches and sorts their rows by partition id " +
+          "instead of keeping a set of buffers per partition. Suits shuffles with many partitions.")
+      .booleanConf
+      .createWithDefault(false)
+
+  val COLUMNAR_SHUFFLE_SORT_BUFFER_MAX_SIZE =
+    buildConf("spark.gluten.sql.columnar.shuffle.sortBufferMaxSize")
+      .internal()
+      .doc("The size of the input batches the sort-based shuffle writer buffers before sorting them.")
+      .bytesConf(ByteUnit.BYTE)
+      .createWithDefaultString("64MB")
+
+  val COLUMNAR_SHUFFLE_ASYNC_SPILL_ENABLED =
+    buildConf("spark.gluten.sql.columnar.shuffle.asyncSpill")
+      .internal()
+      .doc("Whether the shuffle writer writes spilled data on a background thread, " +
+        "so that splitting continues while a spill is written.")
+      .booleanConf
+      .createWithDefault(false)
+
+  val COLUMNAR_SHUFFLE_ASYNC_SPILL_MAX_INFLIGHT_BYTES =
+    buildConf("spark.gluten.sql.columnar.shuffle.asyncSpillMaxInflightBytes")
+      .internal()
+      .doc("The size of the spilled data held in memory while waiting to be written " +
+        "in the background. Spilling blocks beyond it.")
+      .bytesConf(ByteUnit.BYTE)
+      .createWithDefaultString("64MB")
+
+  val COLUMNAR_SHUFFLE_EVICTION_POLICY =
+    buildConf("spark.gluten.sql.columnar.shuffle.evictionPolicy")
+      .internal()
+      .doc("How the shuffle writer frees memory when asked to. largest_first releases the " +
+        "largest partitions first until enough is freed, spill_all spills every partition.")
+      .stringConf
+      .transform(_.toLowerCase(Locale.ROOT))
+      .checkValues(Set("largest_first", "spill_all"))
+      .createWithDefault("largest_first")
+
   val COLUMNAR_SHUFFLE_CODEC =
     buildConf("spark.gluten.sql.columnar.shuffle.codec")
       .internal()
@@ -717,6 +782,16 @@ object GlutenConfig {
         GLUTEN_SHUFFLE_SUPPORTED_CODEC ++ GLUTEN_QAT_SUPPORTED_CODEC ++ GLUTEN_IAA_SUPPORTED_CODEC)
       .createOptional
 
+  val COLUMNAR_BROADCAST_CODEC =
+    buildConf("spark.gluten.sql.columnar.broadcast.codec")
+      .internal()
+      .doc("Codec of the serialized broadcast batches collected to the driver, lz4 or zstd. " +
+        "Not compressed by default.")
+      .stringConf
+      .transform(_.toUpperCase(Locale.ROOT))
+      .checkValues(GLUTEN_SHUFFLE_SUPPORTED_CODEC)
+      .createOptional
+
   val COLUMNAR_SHUFFLE_CODEC_BACKEND =
     buildConf(GlutenConfig.GLUTEN_SHUFFLE_CODEC_BACKEND)
       .internal()
@@ -730,6 +805,22 @@ object GlutenConfig {
       .intConf
       .createWithDefault(100)
 
+  val COLUMNAR_SHUFFLE_READER_COALESCE_BATCH_SIZE =
+    buildConf("spark.gluten.sql.columnar.shuffle.reader.coalesceBatchSize")
+      .internal()
+      .doc("The shuffle reader concatenates consecutive batches of a partition up to this many rows. " +
+        "0 disables it.")
+      .intConf
+      .checkValue(_ >= 0, "must be non-negative")
+      .createWithDefault(0)
+
+  val COLUMNAR_SHUFFLE_READER_COALESCE_MAX_BYTES =
+    buildConf("spark.gluten.sql.columnar.shuffle.reader.coalesceMaxBytes")
+      .internal()
+      .doc("Upper bound of the bytes of a batch concatenated by the shuffle reader.")
+      .bytesConf(ByteUnit.BYTE)
+      .createWithDefaultString("16MB")
+
   val COLUMNAR_MAX_BATCH_SIZE =
     buildConf(GLUTEN_MAX_BATCH_SIZE_KEY)
       .internal()
@@ -814,6 +905,25 @@ object GlutenConfig {
       .bytesConf(ByteUnit.BYTE)
       .createWithDefaultString("0")
 
+  val COLUMNAR_MEMORY_ALLOCATOR_TYPE =
+    buildConf("spark.gluten.memory.allocator.type")
+      .internal()
+      .doc(
+        "Native memory allocator of the executor. default: allocate through malloc; " +
+          "arena: allocate from huge page aligned chunks, released per task.")
+      .stringConf
+      .transform(_.toUpperCase(Locale.ROOT))
+      .checkValues(Set("DEFAULT", "ARENA"))
+      .createWithDefault("DEFAULT")
+
+  val COLUMNAR_TO_ROW_MEMORY_THRESHOLD =
+    buildConf("spark.gluten.sql.columnarToRowMemoryThreshold")
+      .internal()
+      .doc("Batches are converted to rows in chunks of at most this size, the buffer holding a " +
+        "chunk is reused by the next one.")
+      .bytesConf(ByteUnit.BYTE)
+      .createWithDefaultString("64MB")
+
   // velox caching options
   val COLUMNAR_VELOX_CACHE_ENABLED =
     buildConf("spark.gluten.sql.columnar.backend.velox.cacheEnabled")
@@ -878,6 +988,70 @@ object GlutenConfig {
       .intConf
       .createWithDefault(2)
 
+  val COLUMNAR_VELOX_NUM_DRIVERS =
+    buildConf("spark.gluten.sql.columnar.backend.velox.numDrivers")
+      .internal()
+      .doc("The number of Velox drivers running a task in parallel. Only first stages made of " +
+        "scans, filters, projections and partial aggregations run in parallel, other tasks use " +
+        "one driver. 1 disables multi-driver execution.")
+      .intConf
+      .checkValue(_ >= 1, "The number of drivers must be positive.")
+      .createWithDefault(1)
+
+  val COLUMNAR_VELOX_DRIVER_THREADS =
+    buildConf("spark.gluten.sql.columnar.backend.velox.driverThreads")
+      .internal()
+      .doc("The threads of the executor shared by the drivers of all tasks when " +
+        "spark.gluten.sql.columnar.backend.velox.numDrivers is more than 1. 0 uses one thread " +
+        "per core.")
+      .intConf
+      .checkValue(_ >= 0, "The number of driver threads must not be negative.")
+      .createWithDefault(0)
+
+  val COLUMNAR_VELOX_OUTPUT_BATCH_BYTES =
+    buildConf("spark.gluten.sql.columnar.backend.velox.outputBatchBytes")
+      .internal()
+      .doc("The size in bytes native output batches are resized toward. Batches under half of " +
+        "it are coalesced, up to spark.gluten.sql.columnar.maxBatchSize rows, and batches over " +
+        "twice of it are split. 0 disables the resizing.")
+      .longConf
+      .checkValue(_ >= 0, "The output batch size must not be negative.")
+      .createWithDefault(0)
+
+  val COLUMNAR_VELOX_MAX_COALESCED_BYTES =
+    buildConf("spark.gluten.sql.columnar.backend.velox.maxCoalescedBytes")
+      .internal()
+      .doc("The largest read in bytes a scan merges nearby column chunks of a file into. " +
+        "Velox's default applies when unset.")
+      .longConf
+      .createOptional
+
+  val COLUMNAR_VELOX_MAX_COALESCED_DISTANCE_BYTES =
+    buildConf("spark.gluten.sql.columnar.backend.velox.maxCoalescedDistanceBytes")
+      .internal()
+      .doc("The largest gap in bytes between two column chunks read with one request. " +
+        "Velox's default applies when unset.")
+      .longConf
+      .createOptional
+
+  val COLUMNAR_VELOX_PREFETCH_ROW_GROUPS =
+    buildConf("spark.gluten.sql.columnar.backend.velox.prefetchRowGroups")
+      .internal()
+      .doc("The number of row groups a scan loads ahead of the one it is decoding. " +
+        "Velox's default applies when unset.")
+      .intConf
+      .checkValue(_ >= 0, "The number of prefetched row groups must not be negative.")
+      .createOptional
+
+  val COLUMNAR_VELOX_PLAN_CACHE_SIZE =
+    buildConf("spark.gluten.sql.columnar.backend.velox.planCacheSize")
+      .internal()
+      .doc("The number of converted Velox plans cached per executor, shared by the tasks of a " +
+        "stage. 0 disables the cache.")
+      .intConf
+      .checkValue(_ >= 0, "The plan cache size must not be negative.")
+      .createWithDefault(128)
+
   val COLUMNAR_VELOX_SPILL_STRATEGY =
     buildConf("spark.gluten.sql.columnar.backend.velox.spillStrategy")
       .internal()